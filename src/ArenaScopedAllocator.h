@@ -0,0 +1,109 @@
+#ifndef _JL_ARENA_SCOPED_ALLOCATOR_H_
+#define _JL_ARENA_SCOPED_ALLOCATOR_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+#include "ScopedAllocator.h"
+
+namespace jl {
+
+/**
+ * A bump-pointer allocator for objects that all die together, e.g. the signals
+ * and observers of a single frame or request. Alloc() is a pointer increment,
+ * Free() does nothing, and Reset() reclaims the whole arena at once.
+ *
+ * To tear down a scope without paying for disconnection:
+ *
+ *   oArena.BeginReset();
+ *   // destroy every signal and observer whose connections use the arena
+ *   oArena.Reset();
+ *
+ * Between BeginReset() and Reset(), signals and observers whose connection
+ * allocator is the arena skip disconnecting from each other when destroyed.
+ * That is only safe if everything they are connected to is destroyed before
+ * Reset() as well, and nothing is emitted in the meantime.
+ */
+class ArenaScopedAllocator : public ScopedAllocator
+{
+public:
+    enum { eAlignment = sizeof(void*) > 8 ? sizeof(void*) : 8 };
+    
+    ArenaScopedAllocator() : m_pBuffer(NULL), m_nCapacity(0), m_nUsed(0), m_bReleasing(false) {}
+    ArenaScopedAllocator( void* pBuffer, size_t nCapacity ) { Init( pBuffer, nCapacity ); }
+    
+    // The buffer must be aligned to eAlignment, and outlive the arena.
+    void Init( void* pBuffer, size_t nCapacity )
+    {
+        JL_ASSERT( pBuffer || nCapacity == 0 );
+        JL_ASSERT( (size_t)pBuffer % eAlignment == 0 );
+        m_pBuffer = static_cast<unsigned char*>( pBuffer );
+        m_nCapacity = nCapacity;
+        m_nUsed = 0;
+        m_bReleasing = false;
+    }
+    
+    size_t GetCapacity() const { return m_nCapacity; }
+    size_t GetBytesUsed() const { return m_nUsed; }
+    
+    // Starts a bulk teardown. See the class comment.
+    void BeginReset() { m_bReleasing = true; }
+    
+    // Reclaims every allocation. Nothing allocated from the arena may be used afterward.
+    void Reset()
+    {
+        m_nUsed = 0;
+        m_bReleasing = false;
+    }
+    
+    // Virtual overrides
+    void* Alloc( size_t nBytes )
+    {
+        JL_ASSERT( ! m_bReleasing );
+        const size_t nAligned = ( nBytes + eAlignment - 1 ) & ~size_t( eAlignment - 1 );
+        
+        if ( nAligned > m_nCapacity - m_nUsed )
+        {
+            return NULL;
+        }
+        
+        void* pObject = m_pBuffer + m_nUsed;
+        m_nUsed += nAligned;
+        return pObject;
+    }
+    
+    void Free( void* pObject )
+    {
+        JL_UNUSED( pObject );
+    }
+    
+    bool IsReleasingAll() const { return m_bReleasing; }
+    
+private:
+    unsigned char* m_pBuffer;
+    size_t m_nCapacity;
+    size_t m_nUsed;
+    bool m_bReleasing;
+};
+
+// An arena with a built-in buffer of _Capacity bytes
+template< size_t _Capacity >
+class StaticArenaAllocator : public ArenaScopedAllocator
+{
+public:
+    StaticArenaAllocator() : ArenaScopedAllocator( m_oBuffer.pBytes, sizeof(m_oBuffer.pBytes) ) {}
+    
+private:
+    union Buffer
+    {
+        unsigned char pBytes[ _Capacity ];
+        void* pAlignPointer;
+        double fAlignDouble;
+    };
+    
+    Buffer m_oBuffer;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_ARENA_SCOPED_ALLOCATOR_H_ )
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "ArenaScopedAllocator.h"
+
+using namespace jl;
+
+namespace
+{
+    // Counts calls and disconnect notifications
+    class ArenaObserver : public SignalObserver
+    {
+    public:
+        explicit ArenaObserver( ScopedAllocator* pAllocator ) : SignalObserver( pAllocator ) {}
+
+        void OnEmit( int n ) { s_nTotal += n; }
+
+        static int s_nTotal;
+        static unsigned s_nDisconnects;
+
+    protected:
+        void OnSignalDisconnectInternal( SignalBase* pSignal ) { JL_UNUSED( pSignal ); ++s_nDisconnects; }
+    };
+
+    int ArenaObserver::s_nTotal = 0;
+    unsigned ArenaObserver::s_nDisconnects = 0;
+
+    typedef Signal1< int > ArenaSignal;
+
+    enum { eSignals = 8, eObservers = 32 };
+
+    // Creates a scope's signals and observers inside the arena, and connects everything
+    // to everything.
+    void BuildScope( ArenaScopedAllocator& oArena, ArenaSignal** ppSignals, ArenaObserver** ppObservers )
+    {
+        for ( unsigned i = 0; i < eSignals; ++i )
+        {
+            ppSignals[i] = new( oArena.Alloc(sizeof(ArenaSignal)) ) ArenaSignal( & oArena );
+        }
+
+        for ( unsigned i = 0; i < eObservers; ++i )
+        {
+            ppObservers[i] = new( oArena.Alloc(sizeof(ArenaObserver)) ) ArenaObserver( & oArena );
+
+            for ( unsigned j = 0; j < eSignals; ++j )
+            {
+                ppSignals[j]->Connect( ppObservers[i], & ArenaObserver::OnEmit );
+            }
+        }
+    }
+
+    void DestroyScope( ArenaSignal** ppSignals, ArenaObserver** ppObservers )
+    {
+        for ( unsigned i = 0; i < eSignals; ++i )
+        {
+            ppSignals[i]->~ArenaSignal();
+        }
+
+        for ( unsigned i = 0; i < eObservers; ++i )
+        {
+            ppObservers[i]->~ArenaObserver();
+        }
+    }
+}
+
+void ArenaScopedAllocatorTest()
+{
+    printf( "Testing arena allocator...\n" );
+
+    StaticArenaAllocator< 64 * 1024 > oArena;
+    ArenaSignal* pSignals[ eSignals ];
+    ArenaObserver* pObservers[ eObservers ];
+
+    // Allocations are aligned and don't overlap
+    void* p1 = oArena.Alloc( 1 );
+    void* p2 = oArena.Alloc( 3 );
+    assert( p1 && p2 );
+    assert( (size_t)p1 % ArenaScopedAllocator::eAlignment == 0 && (size_t)p2 % ArenaScopedAllocator::eAlignment == 0 );
+    assert( (char*)p2 - (char*)p1 == ArenaScopedAllocator::eAlignment );
+    oArena.Free( p1 );
+    assert( oArena.GetBytesUsed() == 2 * ArenaScopedAllocator::eAlignment );
+
+    // Running out returns NULL
+    assert( oArena.Alloc(oArena.GetCapacity()) == NULL );
+    oArena.Reset();
+    assert( oArena.GetBytesUsed() == 0 );
+
+    // Normal teardown disconnects everything
+    BuildScope( oArena, pSignals, pObservers );
+    ArenaObserver::s_nTotal = 0;
+    pSignals[0]->Emit( 1 );
+    assert( ArenaObserver::s_nTotal == eObservers );
+
+    ArenaObserver::s_nDisconnects = 0;
+    DestroyScope( pSignals, pObservers );
+    assert( ArenaObserver::s_nDisconnects == eObservers * eSignals );
+    oArena.Reset();
+
+    // Bulk teardown skips it
+    for ( unsigned nFrame = 0; nFrame < 4; ++nFrame )
+    {
+        BuildScope( oArena, pSignals, pObservers );
+        ArenaObserver::s_nTotal = 0;
+        pSignals[eSignals - 1]->Emit( 2 );
+        assert( ArenaObserver::s_nTotal == 2 * eObservers );
+
+        const size_t nUsed = oArena.GetBytesUsed();
+        ArenaObserver::s_nDisconnects = 0;
+
+        oArena.BeginReset();
+        assert( oArena.IsReleasingAll() );
+        DestroyScope( pSignals, pObservers );
+        assert( ArenaObserver::s_nDisconnects == 0 );
+        oArena.Reset();
+
+        assert( ! oArena.IsReleasingAll() );
+        assert( oArena.GetBytesUsed() == 0 );
+        assert( nUsed > 0 );
+    }
+}
@@ -0,0 +1,388 @@
+#ifndef _JL_COALESCING_SIGNAL_H_
+#define _JL_COALESCING_SIGNAL_H_
+
+#include <stddef.h>
+#include <string.h>
+
+#include "Utils.h"
+#include "SignalDefinitions.h"
+
+namespace jl {
+
+/**
+ * Policies for combining repeated emissions with the same key in a
+ * CoalescingSignal2. Each one merges an incoming value into the pending one.
+ */
+
+// Keeps the most recent value
+struct CoalesceLastValue
+{
+    template< typename TValue >
+    static void Combine( TValue& pending, const TValue& incoming ) { pending = incoming; }
+};
+
+// Adds values together, e.g. movement deltas
+struct CoalesceAccumulate
+{
+    template< typename TValue >
+    static void Combine( TValue& pending, const TValue& incoming ) { pending += incoming; }
+};
+
+// Bitwise-ORs values together, e.g. dirty flags
+struct CoalesceUnion
+{
+    template< typename TValue >
+    static void Combine( TValue& pending, const TValue& incoming ) { pending |= incoming; }
+};
+
+namespace CoalescingSignal {
+
+    // Hashes the bytes of a key. Keys must be plain data that compare equal
+    // with operator== exactly when their bytes are equal, e.g. pointers and
+    // integers.
+    template< typename TKey >
+    unsigned HashKey( const TKey& key )
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>( & key );
+        unsigned nHash = 2166136261u; // FNV-1a
+        
+        for ( size_t i = 0; i < sizeof(TKey); ++i )
+        {
+            nHash = ( nHash ^ p[i] ) * 16777619u;
+        }
+        
+        return nHash;
+    }
+
+    // Smallest power of two that is at least _N
+    template< unsigned _N, unsigned _P = 1, bool _Done = ( _P >= _N ) >
+    struct PowerOfTwoAtLeast { enum { eValue = PowerOfTwoAtLeast< _N, _P * 2 >::eValue }; };
+    
+    template< unsigned _N, unsigned _P >
+    struct PowerOfTwoAtLeast< _N, _P, true > { enum { eValue = _P }; };
+
+    // Value type for signals that only coalesce keys
+    struct NoValue {};
+
+    /**
+     * A fixed-capacity map from keys to pending values, iterated in insertion
+     * order. Lookups go through an open-addressed table of entry indices. Each
+     * table slot is stamped with the generation it was written in, so Clear()
+     * only has to bump the generation instead of wiping the table.
+     */
+    template< typename TKey, typename TValue, unsigned _Capacity >
+    class PendingMap
+    {
+    public:
+        struct Entry
+        {
+            TKey key;
+            TValue value;
+        };
+        
+        enum
+        {
+            eCapacity = _Capacity,
+            eTableSize = PowerOfTwoAtLeast< 2 * _Capacity >::eValue,
+        };
+        
+        JL_COMPILER_ASSERT( _Capacity > 0, Coalescing_Capacity_Must_Be_Positive );
+        
+        PendingMap() : m_nCount(0), m_nGeneration(1)
+        {
+            memset( m_pStamps, 0, sizeof(m_pStamps) );
+        }
+        
+        // Returns the entry for the key, adding it if necessary, or NULL if the key is
+        // new and the map is full. bAdded is true if the entry was just added.
+        Entry* FindOrAdd( const TKey& key, bool& bAdded )
+        {
+            unsigned nSlot = HashKey( key ) & ( eTableSize - 1 );
+            
+            while ( m_pStamps[nSlot] == m_nGeneration )
+            {
+                Entry& oEntry = m_pEntries[ m_pIndices[nSlot] ];
+                
+                if ( oEntry.key == key )
+                {
+                    bAdded = false;
+                    return & oEntry;
+                }
+                
+                nSlot = ( nSlot + 1 ) & ( eTableSize - 1 );
+            }
+            
+            if ( m_nCount == eCapacity )
+            {
+                return NULL;
+            }
+            
+            m_pStamps[nSlot] = m_nGeneration;
+            m_pIndices[nSlot] = m_nCount;
+            
+            Entry& oEntry = m_pEntries[ m_nCount++ ];
+            oEntry.key = key;
+            bAdded = true;
+            return & oEntry;
+        }
+        
+        void Clear()
+        {
+            m_nCount = 0;
+            
+            // Stamps are only ambiguous after the generation wraps around
+            if ( ++m_nGeneration == 0 )
+            {
+                memset( m_pStamps, 0, sizeof(m_pStamps) );
+                m_nGeneration = 1;
+            }
+        }
+        
+        unsigned Count() const { return m_nCount; }
+        const Entry& operator[]( unsigned i ) const { JL_ASSERT( i < m_nCount ); return m_pEntries[i]; }
+        
+    private:
+        Entry m_pEntries[ eCapacity ];
+        unsigned m_nCount;
+        unsigned m_nGeneration;
+        unsigned m_pIndices[ eTableSize ];
+        unsigned m_pStamps[ eTableSize ];
+    };
+
+    /**
+     * The recording and flushing logic shared by CoalescingSignal1 and
+     * CoalescingSignal2. Pending emissions are double-buffered, so slots may
+     * emit into the coalescing signal during Flush(); those emissions are
+     * delivered by the next Flush().
+     */
+    template< typename TKey, typename TValue, unsigned _Capacity >
+    class Recorder
+    {
+    public:
+        typedef PendingMap< TKey, TValue, _Capacity > TPendingMap;
+        typedef typename TPendingMap::Entry Entry;
+        
+        Recorder() : m_nFront(0), m_bFlushing(false) {}
+        
+        unsigned CountPending() const { return m_pPending[m_nFront].Count(); }
+        bool IsFlushing() const { return m_bFlushing; }
+        
+        // Returns the pending entry for the key, or NULL if the key is new and
+        // the pending buffer is full.
+        Entry* Record( const TKey& key, bool& bAdded )
+        {
+            return m_pPending[m_nFront].FindOrAdd( key, bAdded );
+        }
+        
+        // Swaps buffers and returns the one to deliver. Call EndFlush() afterward.
+        TPendingMap& BeginFlush()
+        {
+            JL_ASSERT( ! m_bFlushing );
+            m_bFlushing = true;
+            
+            TPendingMap& oFlushed = m_pPending[m_nFront];
+            m_nFront ^= 1;
+            return oFlushed;
+        }
+        
+        void EndFlush( TPendingMap& oFlushed )
+        {
+            oFlushed.Clear();
+            m_bFlushing = false;
+        }
+        
+    private:
+        TPendingMap m_pPending[2];
+        unsigned m_nFront;
+        bool m_bFlushing;
+    };
+
+} // namespace CoalescingSignal
+
+/**
+ * A signal that defers and de-duplicates emissions by key, e.g.:
+ *
+ *   CoalescingSignal1< Entity*, 1024 > oTransformChanged;
+ *   oTransformChanged.Connect( &oSceneGraph, &SceneGraph::OnTransformChanged );
+ *
+ *   oTransformChanged.Emit( pEntity ); // recorded
+ *   oTransformChanged.Emit( pEntity ); // coalesced with the previous emission
+ *   oTransformChanged.Flush();         // calls OnTransformChanged( pEntity ) once
+ *
+ * Flush() delivers each distinct key once, in the order the keys were first
+ * emitted. Up to _Capacity distinct keys can be pending; an Emit() with a new
+ * key beyond that flushes early, or delivers the key immediately if it can't,
+ * e.g. during a Flush(). Nothing is allocated outside the object.
+ */
+template< typename TKey, unsigned _Capacity >
+class CoalescingSignal1
+{
+public:
+    typedef Signal1< TKey > TSignal;
+    
+    CoalescingSignal1() {}
+    explicit CoalescingSignal1( ScopedAllocator* pAllocator ) : m_oSignal(pAllocator) {}
+    
+    // The signal that Flush() emits. Connect and disconnect through this.
+    TSignal& GetSignal() { return m_oSignal; }
+    const TSignal& GetSignal() const { return m_oSignal; }
+    
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(TKey) ) { m_oSignal.Connect( pObject, fpMethod ); }
+    
+    void Emit( TKey key )
+    {
+        bool bAdded;
+        
+        if ( ! m_oRecorder.Record(key, bAdded) && ! FlushWhenFull(key, bAdded) )
+        {
+            m_oSignal.Emit( key );
+        }
+    }
+    
+    void operator()( TKey key ) { Emit( key ); }
+    
+    unsigned CountPending() const { return m_oRecorder.CountPending(); }
+    
+    // Emits every pending key once. Does nothing if called from inside a Flush().
+    void Flush()
+    {
+        JL_ASSERT( ! m_oRecorder.IsFlushing() );
+        if ( m_oRecorder.IsFlushing() )
+        {
+            return;
+        }
+        
+        typename TRecorder::TPendingMap& oFlushed = m_oRecorder.BeginFlush();
+        
+        for ( unsigned i = 0; i < oFlushed.Count(); ++i )
+        {
+            m_oSignal.Emit( oFlushed[i].key );
+        }
+        
+        m_oRecorder.EndFlush( oFlushed );
+    }
+    
+private:
+    typedef CoalescingSignal::Recorder< TKey, CoalescingSignal::NoValue, _Capacity > TRecorder;
+    
+    // Flushes early to make room for a new key, and records it. Returns NULL if
+    // there's still no room, and the key should be delivered immediately.
+    typename TRecorder::Entry* FlushWhenFull( const TKey& key, bool& bAdded )
+    {
+        // While flushing, both buffers are in use
+        if ( m_oRecorder.IsFlushing() )
+        {
+            return NULL;
+        }
+        
+        // The slots may fill the buffer again during the flush
+        Flush();
+        return m_oRecorder.Record( key, bAdded );
+    }
+    
+    TSignal m_oSignal;
+    TRecorder m_oRecorder;
+};
+
+/**
+ * A signal that defers emissions and combines the values of emissions with the
+ * same key, e.g.:
+ *
+ *   CoalescingSignal2< Entity*, Vector3, CoalesceAccumulate, 1024 > oMoved;
+ *
+ *   oMoved.Emit( pEntity, oDelta1 );
+ *   oMoved.Emit( pEntity, oDelta2 );
+ *   oMoved.Flush(); // emits ( pEntity, oDelta1 + oDelta2 ) once
+ *
+ * TPolicy is CoalesceLastValue, CoalesceAccumulate, CoalesceUnion, or any type
+ * with a static Combine( TValue& pending, const TValue& incoming ). Ordering
+ * and capacity behave as in CoalescingSignal1.
+ */
+template< typename TKey, typename TValue, typename TPolicy, unsigned _Capacity >
+class CoalescingSignal2
+{
+public:
+    typedef Signal2< TKey, TValue > TSignal;
+    
+    CoalescingSignal2() {}
+    explicit CoalescingSignal2( ScopedAllocator* pAllocator ) : m_oSignal(pAllocator) {}
+    
+    // The signal that Flush() emits. Connect and disconnect through this.
+    TSignal& GetSignal() { return m_oSignal; }
+    const TSignal& GetSignal() const { return m_oSignal; }
+    
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(TKey, TValue) ) { m_oSignal.Connect( pObject, fpMethod ); }
+    
+    void Emit( TKey key, TValue value )
+    {
+        bool bAdded;
+        Entry* pEntry = m_oRecorder.Record( key, bAdded );
+        
+        if ( ! pEntry )
+        {
+            pEntry = FlushWhenFull( key, bAdded );
+        }
+        
+        if ( ! pEntry )
+        {
+            m_oSignal.Emit( key, value );
+        }
+        else if ( bAdded )
+        {
+            pEntry->value = value;
+        }
+        else
+        {
+            TPolicy::Combine( pEntry->value, value );
+        }
+    }
+    
+    void operator()( TKey key, TValue value ) { Emit( key, value ); }
+    
+    unsigned CountPending() const { return m_oRecorder.CountPending(); }
+    
+    // Emits every pending key once, with its combined value. Does nothing if called
+    // from inside a Flush().
+    void Flush()
+    {
+        JL_ASSERT( ! m_oRecorder.IsFlushing() );
+        if ( m_oRecorder.IsFlushing() )
+        {
+            return;
+        }
+        
+        typename TRecorder::TPendingMap& oFlushed = m_oRecorder.BeginFlush();
+        
+        for ( unsigned i = 0; i < oFlushed.Count(); ++i )
+        {
+            m_oSignal.Emit( oFlushed[i].key, oFlushed[i].value );
+        }
+        
+        m_oRecorder.EndFlush( oFlushed );
+    }
+    
+private:
+    typedef CoalescingSignal::Recorder< TKey, TValue, _Capacity > TRecorder;
+    typedef typename TRecorder::Entry Entry;
+    
+    // As in CoalescingSignal1. The key may already be pending again after the flush.
+    Entry* FlushWhenFull( const TKey& key, bool& bAdded )
+    {
+        if ( m_oRecorder.IsFlushing() )
+        {
+            return NULL;
+        }
+        
+        Flush();
+        return m_oRecorder.Record( key, bAdded );
+    }
+    
+    TSignal m_oSignal;
+    TRecorder m_oRecorder;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_COALESCING_SIGNAL_H_ )
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "CoalescingSignal.h"
+#include "StaticSignalConnectionAllocators.h"
+
+using namespace jl;
+
+namespace
+{
+    enum { eCapacity = 8, eMaxCalls = 64 };
+
+    struct Entity
+    {
+        int m_nId;
+    };
+
+    // Records every call it receives
+    class FlushObserver : public SignalObserver
+    {
+    public:
+        FlushObserver() : m_nCalls(0), m_pReemit(NULL), m_pReemitValue(NULL) {}
+
+        void OnKey( Entity* pEntity )
+        {
+            m_pKeys[ m_nCalls++ ] = pEntity;
+
+            // Emitting during a flush is deferred to the next flush. Keys past the
+            // capacity aren't emitted again, so overflowing keys are only delivered once.
+            if ( m_pReemit && pEntity->m_nId < eCapacity )
+            {
+                m_pReemit->Emit( pEntity );
+            }
+        }
+
+        void OnValue( Entity* pEntity, int nValue )
+        {
+            m_pKeys[ m_nCalls ] = pEntity;
+            m_pValues[ m_nCalls++ ] = nValue;
+
+            if ( m_pReemitValue && pEntity->m_nId < eCapacity )
+            {
+                m_pReemitValue->Emit( pEntity, nValue );
+            }
+        }
+
+        Entity* m_pKeys[ eMaxCalls ];
+        int m_pValues[ eMaxCalls ];
+        unsigned m_nCalls;
+        CoalescingSignal1< Entity*, eCapacity >* m_pReemit;
+        CoalescingSignal2< Entity*, int, CoalesceAccumulate, eCapacity >* m_pReemitValue;
+    };
+}
+
+void CoalescingSignalTest()
+{
+    StaticSignalConnectionAllocator< 8 > oSignalConnections;
+    StaticObserverConnectionAllocator< 8 > oObserverConnections;
+    SignalBase::SetCommonConnectionAllocator( & oSignalConnections );
+    SignalObserver::SetCommonConnectionAllocator( & oObserverConnections );
+
+    Entity pEntities[ eCapacity * 2 ];
+    for ( unsigned i = 0; i < JL_ARRAY_SIZE(pEntities); ++i )
+    {
+        pEntities[i].m_nId = i;
+    }
+
+    // Key-only coalescing
+    printf( "Testing coalescing signals...\n" );
+    {
+        CoalescingSignal1< Entity*, eCapacity > oSignal;
+        FlushObserver oObserver;
+        oSignal.Connect( & oObserver, & FlushObserver::OnKey );
+
+        oSignal.Emit( & pEntities[2] );
+        oSignal.Emit( & pEntities[0] );
+        oSignal.Emit( & pEntities[2] );
+        oSignal( & pEntities[1] );
+        oSignal.Emit( & pEntities[0] );
+        assert( oSignal.CountPending() == 3 );
+        assert( oObserver.m_nCalls == 0 );
+
+        // One call per distinct key, in order of first emission
+        oSignal.Flush();
+        assert( oSignal.CountPending() == 0 );
+        assert( oObserver.m_nCalls == 3 );
+        assert( oObserver.m_pKeys[0] == & pEntities[2] );
+        assert( oObserver.m_pKeys[1] == & pEntities[0] );
+        assert( oObserver.m_pKeys[2] == & pEntities[1] );
+
+        // Flushing with nothing pending does nothing
+        oSignal.Flush();
+        assert( oObserver.m_nCalls == 3 );
+
+        // Keys emitted during a flush are delivered by the next one
+        oObserver.m_nCalls = 0;
+        oObserver.m_pReemit = & oSignal;
+        oSignal.Emit( & pEntities[3] );
+        oSignal.Flush();
+        assert( oObserver.m_nCalls == 1 );
+        assert( oSignal.CountPending() == 1 );
+
+        oObserver.m_pReemit = NULL;
+        oSignal.Flush();
+        assert( oObserver.m_nCalls == 2 );
+        assert( oObserver.m_pKeys[1] == & pEntities[3] );
+
+        // Running out of room flushes early
+        oObserver.m_nCalls = 0;
+        for ( unsigned i = 0; i < eCapacity + 1; ++i )
+        {
+            oSignal.Emit( & pEntities[i] );
+        }
+
+        assert( oObserver.m_nCalls == eCapacity );
+        assert( oSignal.CountPending() == 1 );
+
+        oSignal.Flush();
+        assert( oObserver.m_nCalls == eCapacity + 1 );
+        for ( unsigned i = 0; i < eCapacity + 1; ++i )
+        {
+            assert( oObserver.m_pKeys[i] == & pEntities[i] );
+        }
+
+        // If the early flush fills the buffer again, the new key is delivered immediately
+        oObserver.m_nCalls = 0;
+        for ( unsigned i = 0; i < eCapacity; ++i )
+        {
+            oSignal.Emit( & pEntities[i] );
+        }
+
+        oObserver.m_pReemit = & oSignal;
+        oSignal.Emit( & pEntities[eCapacity] );
+        assert( oObserver.m_nCalls == eCapacity + 1 );
+        assert( oObserver.m_pKeys[eCapacity] == & pEntities[eCapacity] );
+        assert( oSignal.CountPending() == eCapacity );
+
+        oObserver.m_pReemit = NULL;
+        oSignal.Flush();
+        assert( oObserver.m_nCalls == 2 * eCapacity + 1 && oSignal.CountPending() == 0 );
+
+        // Many flush cycles reuse the index without clearing it
+        oObserver.m_nCalls = 0;
+        for ( unsigned nCycle = 0; nCycle < 1000; ++nCycle )
+        {
+            oSignal.Emit( & pEntities[ nCycle % eCapacity ] );
+            oSignal.Emit( & pEntities[ nCycle % eCapacity ] );
+            oSignal.Flush();
+            assert( oObserver.m_nCalls == 1 );
+            oObserver.m_nCalls = 0;
+        }
+    }
+
+    // Value policies
+    printf( "Testing coalescing policies...\n" );
+    {
+        CoalescingSignal2< Entity*, int, CoalesceLastValue, eCapacity > oLast;
+        CoalescingSignal2< Entity*, int, CoalesceAccumulate, eCapacity > oSum;
+        CoalescingSignal2< Entity*, int, CoalesceUnion, eCapacity > oUnion;
+        FlushObserver oLastObserver;
+        FlushObserver oSumObserver;
+        FlushObserver oUnionObserver;
+        oLast.Connect( & oLastObserver, & FlushObserver::OnValue );
+        oSum.Connect( & oSumObserver, & FlushObserver::OnValue );
+        oUnion.GetSignal().Connect( & oUnionObserver, & FlushObserver::OnValue );
+
+        const int pValues[] = { 1, 2, 4, 2 };
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(pValues); ++i )
+        {
+            oLast.Emit( & pEntities[0], pValues[i] );
+            oSum.Emit( & pEntities[0], pValues[i] );
+            oUnion.Emit( & pEntities[0], pValues[i] );
+        }
+
+        oSum.Emit( & pEntities[1], 10 );
+
+        oLast.Flush();
+        oSum.Flush();
+        oUnion.Flush();
+
+        assert( oLastObserver.m_nCalls == 1 && oLastObserver.m_pValues[0] == 2 );
+        assert( oSumObserver.m_nCalls == 2 && oSumObserver.m_pValues[0] == 9 && oSumObserver.m_pValues[1] == 10 );
+        assert( oUnionObserver.m_nCalls == 1 && oUnionObserver.m_pValues[0] == 7 );
+
+        // The key that overflows keeps its own value
+        oSumObserver.m_nCalls = 0;
+        for ( unsigned i = 0; i < eCapacity + 1; ++i )
+        {
+            oSum.Emit( & pEntities[i], int(i) );
+        }
+
+        oSum.Flush();
+        assert( oSumObserver.m_nCalls == eCapacity + 1 );
+        assert( oSumObserver.m_pKeys[eCapacity] == & pEntities[eCapacity] );
+        assert( oSumObserver.m_pValues[eCapacity] == eCapacity );
+
+        // ...even if the early flush fills the buffer again
+        oSumObserver.m_nCalls = 0;
+        for ( unsigned i = 0; i < eCapacity; ++i )
+        {
+            oSum.Emit( & pEntities[i], 1 );
+        }
+
+        oSumObserver.m_pReemitValue = & oSum;
+        oSum.Emit( & pEntities[eCapacity], 5 );
+        assert( oSumObserver.m_nCalls == eCapacity + 1 );
+        assert( oSumObserver.m_pKeys[eCapacity] == & pEntities[eCapacity] && oSumObserver.m_pValues[eCapacity] == 5 );
+        assert( oSum.CountPending() == eCapacity );
+
+        oSumObserver.m_pReemitValue = NULL;
+        oSum.Flush();
+        assert( oSumObserver.m_nCalls == 2 * eCapacity + 1 && oSum.CountPending() == 0 );
+    }
+
+    SignalBase::SetCommonConnectionAllocator( NULL );
+    SignalObserver::SetCommonConnectionAllocator( NULL );
+}
@@ -76,6 +76,11 @@ public:
             return m_pList != NULL && m_pCurrent != NULL;
         }
         
+        Node* GetNode() const
+        {
+            return m_pCurrent;
+        }
+        
     private:
         friend class DoublyLinkedList<TObject>;
         DoublyLinkedList<TObject>* m_pList;
@@ -168,10 +173,17 @@ public:
         m_pTail = NULL;
         m_nObjectCount = 0;
         m_pNodeAllocator = NULL;
+        m_pCompactCursor = NULL;
     }
     
     ~DoublyLinkedList()
     {
+        // The allocator is about to release every node in one go
+        if ( IsAllocatorReleasingAll() )
+        {
+            return;
+        }
+        
         Clear();
     }
     
@@ -180,6 +192,18 @@ public:
         m_pNodeAllocator = pNodeAllocator;
     }
     
+    ScopedAllocator* GetAllocator() const
+    {
+        return m_pNodeAllocator;
+    }
+    
+    // Allocates up to nCount nodes from this list's allocator in one call, for use
+    // with AddAllocated(). Returns the number allocated.
+    unsigned AllocNodes( void** ppNodes, unsigned nCount )
+    {
+        return m_pNodeAllocator->AllocN( sizeof(Node), ppNodes, nCount );
+    }
+    
     // Returns true if the object was successfully added
     Node* Add( const TObject& object )
     {
@@ -192,6 +216,23 @@ public:
             return NULL;
         }
         
+        return AddNode( pNode, object );
+    }
+    
+    // Appends an object in a node from AllocNodes(). The node can come from any list
+    // that shares this list's allocator.
+    Node* AddAllocated( void* pNodeMemory, const TObject& object )
+    {
+        Node* pNode = static_cast<Node*>( pNodeMemory );
+        pNode->prev = NULL;
+        pNode->next = NULL;
+        
+        return AddNode( pNode, object );
+    }
+    
+private:
+    Node* AddNode( Node* pNode, const TObject& object )
+    {
         // Place the object in the node.
         pNode->object = object;
         
@@ -215,6 +256,135 @@ public:
         return pNode;
     }
     
+public:
+    // Inserts the object before the first object that it is less than, according
+    // to oLess( a, b ). If the list is sorted, it stays sorted, and equal objects
+    // stay in insertion order. O(N).
+    template< typename TLess >
+    Node* AddSorted( const TObject& object, const TLess& oLess )
+    {
+        Node* pNext = m_pHead;
+        
+        while ( pNext && ! oLess(object, pNext->object) )
+        {
+            pNext = pNext->next;
+        }
+        
+        if ( ! pNext )
+        {
+            return Add( object );
+        }
+        
+        Node* pNode = CreateNode();
+        JL_ASSERT( pNode );
+        
+        if ( ! pNode )
+        {
+            return NULL;
+        }
+        
+        pNode->object = object;
+        pNode->next = pNext;
+        pNode->prev = pNext->prev;
+        
+        if ( pNext->prev )
+        {
+            pNext->prev->next = pNode;
+        }
+        else
+        {
+            m_pHead = pNode;
+        }
+        
+        pNext->prev = pNode;
+        m_nObjectCount += 1;
+        
+        return pNode;
+    }
+    
+    // Stable merge sort, according to oLess( a, b ). Relinks nodes without moving or
+    // allocating them. O(N log N).
+    template< typename TLess >
+    void Sort( const TLess& oLess )
+    {
+        if ( m_nObjectCount < 2 )
+        {
+            return;
+        }
+        
+        Node* pList = m_pHead;
+        
+        // Merge runs of nSize nodes in pairs, doubling nSize until a single run is left
+        for ( unsigned nSize = 1; ; nSize *= 2 )
+        {
+            Node* pLeft = pList;
+            Node* pTail = NULL;
+            unsigned nMerges = 0;
+            pList = NULL;
+            
+            while ( pLeft )
+            {
+                ++nMerges;
+                
+                Node* pRight = pLeft;
+                unsigned nLeft = 0;
+                
+                while ( nLeft < nSize && pRight )
+                {
+                    ++nLeft;
+                    pRight = pRight->next;
+                }
+                
+                unsigned nRight = nSize;
+                
+                while ( nLeft > 0 || ( nRight > 0 && pRight ) )
+                {
+                    Node* pNode;
+                    
+                    // Take from the left run unless the right one is strictly less, for stability
+                    if ( nLeft > 0 && ( nRight == 0 || ! pRight || ! oLess(pRight->object, pLeft->object) ) )
+                    {
+                        pNode = pLeft;
+                        pLeft = pLeft->next;
+                        --nLeft;
+                    }
+                    else
+                    {
+                        pNode = pRight;
+                        pRight = pRight->next;
+                        --nRight;
+                    }
+                    
+                    if ( pTail )
+                    {
+                        pTail->next = pNode;
+                    }
+                    else
+                    {
+                        pList = pNode;
+                    }
+                    
+                    pNode->prev = pTail;
+                    pTail = pNode;
+                }
+                
+                pLeft = pRight;
+            }
+            
+            pTail->next = NULL;
+            
+            if ( nMerges <= 1 )
+            {
+                m_pHead = pList;
+                m_pTail = pTail;
+                break;
+            }
+        }
+        
+        // An unfinished Compact() pass starts over
+        m_pCompactCursor = NULL;
+    }
+    
     // Returns true if the object was successfully removed. This will only
     // remove the first instance of the object.
     bool Remove( const TObject& object )
@@ -250,6 +420,13 @@ public:
         return false;
     }    
     
+    // Removes a node that is in this list, e.g. one found through an index of the
+    // list's nodes. Returns true if the node was removed.
+    bool Remove( Node* pNode )
+    {
+        return RemoveNode( pNode );
+    }
+    
     // Returns the number of nodes removed from the list.
     unsigned RemoveAll( const TObject& object )
     {
@@ -278,6 +455,12 @@ public:
         return m_nObjectCount;
     }
     
+    // See ScopedAllocator::IsReleasingAll()
+    bool IsAllocatorReleasingAll() const
+    {
+        return m_pNodeAllocator && m_pNodeAllocator->IsReleasingAll();
+    }
+    
     unsigned IsEmpty() const
     {
         return m_nObjectCount == 0;
@@ -285,20 +468,72 @@ public:
     
     void Clear()
     {
-        Node* pCurrent = NULL;
-        Node* pNext = m_pHead;
+        // Free nodes in batches, to save a virtual call per node
+        enum { eFreeBatchSize = 64 };
+        void* ppBatch[ eFreeBatchSize ];
+        unsigned nBatch = 0;
         
-        while ( pNext )
+        for ( Node* pNext = m_pHead; pNext; )
         {
-            pCurrent = pNext;
-            pNext = pCurrent->next;
+            ppBatch[ nBatch++ ] = pNext;
+            pNext = pNext->next;
             
-            m_pNodeAllocator->Free( pCurrent );
+            if ( nBatch == eFreeBatchSize )
+            {
+                m_pNodeAllocator->FreeN( ppBatch, nBatch );
+                nBatch = 0;
+            }
+        }
+        
+        if ( nBatch )
+        {
+            m_pNodeAllocator->FreeN( ppBatch, nBatch );
         }
         
         m_pHead = NULL;
         m_pTail = NULL;
         m_nObjectCount = 0;
+        m_pCompactCursor = NULL;
+    }
+    
+    // Moves nodes so that their addresses ascend in list order. Each node is moved
+    // into the lowest slot the allocator offers above the previous node, if that is
+    // lower than where the node is, or if the node is out of order. With an
+    // address-ordered object pool, which always hands out its lowest free slot, a full
+    // pass packs the nodes as tightly as the pool's other allocations allow.
+    //
+    // Visits at most nMaxNodes nodes, or every node if nMaxNodes is 0. The next call
+    // continues where this one stopped. Returns true once a pass reaches the end of
+    // the list. Invalidates iterators, so it must not be called while iterating.
+    bool Compact( unsigned nMaxNodes = 0 )
+    {
+        return Compact( nMaxNodes, IgnoreMove() );
+    }
+    
+    // As above, calling fnMoved( pOldNode, pNewNode ) for each node that moves, e.g. to
+    // update pointers to it. The old node still holds the object when it is called.
+    template< class TMoved >
+    bool Compact( unsigned nMaxNodes, TMoved fnMoved )
+    {
+        // Slots offered below the previous node are held here until the end of the call,
+        // so the allocator offers higher ones
+        Node* pReserved = NULL;
+        Node* pNode = m_pCompactCursor ? m_pCompactCursor : m_pHead;
+        
+        for ( unsigned n = 0; pNode && ( nMaxNodes == 0 || n < nMaxNodes ); ++n )
+        {
+            pNode = RelocateNode( pNode, pReserved, fnMoved )->next;
+        }
+        
+        while ( pReserved )
+        {
+            Node* pNext = pReserved->next;
+            m_pNodeAllocator->Free( pReserved );
+            pReserved = pNext;
+        }
+        
+        m_pCompactCursor = pNode;
+        return pNode == NULL;
     }
     
     // O(N) random access
@@ -362,6 +597,70 @@ public:
     }
     
 private:
+    struct IgnoreMove
+    {
+        void operator()( const Node*, const Node* ) const {}
+    };
+    
+    // Returns the node's new location, which may be the same as the old one.
+    template< class TMoved >
+    Node* RelocateNode( Node* pNode, Node*& pReserved, TMoved& fnMoved )
+    {
+        const Node* pPrev = pNode->prev;
+        Node* pNewNode = NULL;
+        
+        for (;;)
+        {
+            pNewNode = (Node*)m_pNodeAllocator->Alloc( sizeof(Node) );
+            
+            if ( ! pNewNode )
+            {
+                return pNode;
+            }
+            
+            if ( pPrev && pNewNode < pPrev )
+            {
+                pNewNode->next = pReserved;
+                pReserved = pNewNode;
+                continue;
+            }
+            
+            break;
+        }
+        
+        if ( pNewNode > pNode && ( ! pPrev || pNode > pPrev ) )
+        {
+            m_pNodeAllocator->Free( pNewNode );
+            return pNode;
+        }
+        
+        pNewNode->object = pNode->object;
+        pNewNode->prev = pNode->prev;
+        pNewNode->next = pNode->next;
+        
+        if ( pNode->prev )
+        {
+            pNode->prev->next = pNewNode;
+        }
+        else
+        {
+            m_pHead = pNewNode;
+        }
+        
+        if ( pNode->next )
+        {
+            pNode->next->prev = pNewNode;
+        }
+        else
+        {
+            m_pTail = pNewNode;
+        }
+        
+        fnMoved( pNode, pNewNode );
+        m_pNodeAllocator->Free( pNode );
+        return pNewNode;
+    }
+    
     bool RemoveNode( Node* pNode )
     {
         JL_ASSERT( m_nObjectCount );
@@ -370,6 +669,12 @@ private:
             return false;
         }
         
+        // Keep an unfinished Compact() pass valid
+        if ( m_pCompactCursor == pNode )
+        {
+            m_pCompactCursor = pNode->next;
+        }
+        
         // Re-assign head/tail pointers, if necessary
         if ( m_pHead == pNode )
         {
@@ -405,6 +710,7 @@ private:
     Node* m_pTail;
     unsigned m_nObjectCount;
     ScopedAllocator* m_pNodeAllocator;
+    Node* m_pCompactCursor;
 };
 
 } // namespace jl
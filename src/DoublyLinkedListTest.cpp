@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "DoublyLinkedList.h"
@@ -11,6 +12,165 @@ namespace
 {
     typedef DoublyLinkedList<const char*> StringList;
     typedef StaticObjectPoolAllocator< sizeof(StringList::Node), 100 > StringNodeAllocator;
+    typedef StaticObjectPoolAllocator< sizeof(StringList::Node), 100, ObjectPool::eFlag_AddressOrdered > OrderedStringNodeAllocator;
+    
+    // Returns true if the list's nodes are in ascending address order.
+    bool IsAddressOrdered( StringList& oList )
+    {
+        const void* pPrevious = NULL;
+        
+        for ( StringList::iterator i = oList.begin(); i.isValid(); ++i )
+        {
+            const void* pCurrent = & (*i);
+            
+            if ( pCurrent <= pPrevious )
+            {
+                return false;
+            }
+            
+            pPrevious = pCurrent;
+        }
+        
+        return true;
+    }
+    
+    // Sorts by the first character only, so that sorting stability is visible
+    struct FirstCharLess
+    {
+        bool operator()( const char* a, const char* b ) const { return a[0] < b[0]; }
+    };
+    
+    void SortTest()
+    {
+        printf( "\nSort test...\n" );
+        
+        const char* pStrings[] = { "c1", "a1", "b1", "c2", "a2", "b2", "a3", "c3", "b3", "a4", "b4" };
+        const char* pSorted[] = { "a1", "a2", "a3", "a4", "a5", "b1", "b2", "b3", "b4", "c1", "c2", "c3" };
+        
+        StringNodeAllocator oAllocator;
+        StringList oList;
+        oList.Init( & oAllocator );
+        
+        oList.Sort( FirstCharLess() );
+        
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(pStrings); ++i )
+        {
+            assert( oList.Add(pStrings[i]) );
+        }
+        
+        oList.Sort( FirstCharLess() );
+        assert( oList.AddSorted(pSorted[4], FirstCharLess()) );
+        assert( oList.Count() == JL_ARRAY_SIZE(pSorted) );
+        
+        unsigned n = 0;
+        for ( StringList::iterator i = oList.begin(); i.isValid(); ++i, ++n )
+        {
+            assert( strcmp(*i, pSorted[n]) == 0 );
+        }
+        
+        // Walk back from the tail to check the prev links
+        StringList::iterator iLast = oList.begin();
+        for ( unsigned i = 1; i < oList.Count(); ++i )
+        {
+            ++iLast;
+        }
+        
+        n = JL_ARRAY_SIZE(pSorted);
+        for ( StringList::iterator i = iLast; i.isValid(); --i )
+        {
+            assert( strcmp(*i, pSorted[--n]) == 0 );
+        }
+        
+        assert( n == 0 );
+        oList.Clear();
+        
+        assert( oAllocator.CountAllocations() == 0 );
+    }
+    
+    // Scatters a list's nodes through a shared pool, then compacts it.
+    void CompactTest( const char** ppTestStrings, unsigned nTestStrings )
+    {
+        printf( "\nCompaction test...\n" );
+        
+        OrderedStringNodeAllocator oAllocator;
+        StringList oList;
+        StringList oOtherList;
+        oList.Init( & oAllocator );
+        oOtherList.Init( & oAllocator );
+        
+        // Interleave the two lists through the pool
+        for ( unsigned i = 0; i < nTestStrings; ++i )
+        {
+            assert( oList.Add(ppTestStrings[i]) );
+            assert( oOtherList.Add(ppTestStrings[i]) );
+        }
+        
+        // Move the front half of the list to the back, so it reuses low slots out of order
+        for ( unsigned i = 0; i < nTestStrings / 2; ++i )
+        {
+            assert( oList.Remove(ppTestStrings[i]) );
+        }
+        
+        for ( unsigned i = nTestStrings / 2; i > 0; --i )
+        {
+            assert( oList.Add(ppTestStrings[i - 1]) );
+        }
+        
+        assert( ! IsAddressOrdered(oList) );
+        
+        // Compact incrementally, removing a node partway through
+        const unsigned nAllocations = oAllocator.CountAllocations();
+        unsigned nSteps = 0;
+        
+        while ( ! oList.Compact(3) )
+        {
+            if ( ++nSteps == 2 )
+            {
+                assert( oList.Remove(ppTestStrings[nTestStrings - 1]) );
+                assert( oList.Add(ppTestStrings[nTestStrings - 1]) );
+            }
+        }
+        
+        // A second pass picks up the node that moved to the end
+        oList.Compact();
+        
+        assert( IsAddressOrdered(oList) );
+        assert( oAllocator.CountAllocations() == nAllocations );
+        assert( oList.Count() == nTestStrings );
+        
+        // Order and contents are unchanged
+        unsigned n = 0;
+        for ( StringList::iterator i = oList.begin(); i.isValid(); ++i, ++n )
+        {
+            unsigned nExpected;
+            
+            if ( n < nTestStrings / 2 - 1 )
+            {
+                nExpected = nTestStrings / 2 + n;
+            }
+            else if ( n < nTestStrings - 1 )
+            {
+                nExpected = nTestStrings - 2 - n;
+            }
+            else
+            {
+                nExpected = nTestStrings - 1;
+            }
+            
+            assert( *i == ppTestStrings[nExpected] );
+        }
+        
+        // The other list was not touched
+        n = 0;
+        for ( StringList::iterator i = oOtherList.begin(); i.isValid(); ++i, ++n )
+        {
+            assert( *i == ppTestStrings[n] );
+        }
+        
+        oList.Clear();
+        oOtherList.Clear();
+        assert( oAllocator.CountAllocations() == 0 );
+    }
 }
 
 void DoublyLinkedListTest()
@@ -178,4 +338,7 @@ void DoublyLinkedListTest()
         assert( oList.Count() == 0 );
         assert( oAllocator.CountAllocations() == 0 );
     }
-}
\ No newline at end of file
+    
+    SortTest();
+    CompactTest( pTestStrings, JL_ARRAY_SIZE(pTestStrings) );
+}
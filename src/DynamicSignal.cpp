@@ -0,0 +1,72 @@
+#include "DynamicSignal.h"
+
+bool jl::DynamicSignature::Init( const DynamicType* pTypes, unsigned nCount )
+{
+    m_nCount = 0;
+    m_nSize = 0;
+
+    if ( nCount > eMaxArguments )
+    {
+        return false;
+    }
+
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        // Every type's size is a power of two, and at most 8 bytes, so eMaxArguments
+        // arguments always fit in eMaxBufferSize
+        const unsigned nTypeSize = GetTypeSize( pTypes[i] );
+        if ( nTypeSize == 0 )
+        {
+            m_nSize = 0;
+            return false;
+        }
+
+        const unsigned nOffset = ( m_nSize + nTypeSize - 1 ) & ~( nTypeSize - 1 );
+
+        m_pTypes[i] = (unsigned char)pTypes[i];
+        m_pOffsets[i] = (unsigned char)nOffset;
+        m_nSize = nOffset + nTypeSize;
+    }
+
+    m_nCount = nCount;
+    JL_ASSERT( m_nSize <= eMaxBufferSize );
+
+    return true;
+}
+
+bool jl::DynamicSignature::Matches( const DynamicType* pTypes, unsigned nCount ) const
+{
+    if ( nCount != m_nCount )
+    {
+        return false;
+    }
+
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        if ( pTypes[i] != DynamicType(m_pTypes[i]) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool jl::DynamicSignature::operator==( const DynamicSignature& oOther ) const
+{
+    return m_nCount == oOther.m_nCount && memcmp( m_pTypes, oOther.m_pTypes, m_nCount ) == 0;
+}
+
+unsigned jl::DynamicSignature::GetTypeSize( DynamicType eType )
+{
+    switch ( eType )
+    {
+        case eDynamicType_Bool: return sizeof( bool );
+        case eDynamicType_Int: return sizeof( int );
+        case eDynamicType_Float: return sizeof( float );
+        case eDynamicType_Double: return sizeof( double );
+        case eDynamicType_String: return sizeof( const char* );
+        case eDynamicType_Pointer: return sizeof( const void* );
+        default: return 0;
+    }
+}
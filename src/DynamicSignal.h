@@ -0,0 +1,540 @@
+#ifndef _JL_DYNAMIC_SIGNAL_H_
+#define _JL_DYNAMIC_SIGNAL_H_
+
+#include <stddef.h>
+#include <string.h>
+
+#include "Utils.h"
+#include "SignalDefinitions.h"
+
+namespace jl {
+
+// Argument types a DynamicSignal can carry
+enum DynamicType
+{
+    eDynamicType_Bool,
+    eDynamicType_Int,
+    eDynamicType_Float,
+    eDynamicType_Double,
+    eDynamicType_String, // const char*. The characters aren't copied.
+    eDynamicType_Pointer, // Any other object pointer, stored as const void*
+
+    eDynamicType_Count
+};
+
+// Maps C++ types to DynamicTypes. Undefined for types that can't be carried.
+template< typename T > struct DynamicTypeOf;
+
+template< typename T, DynamicType _Type >
+struct DynamicValueType
+{
+    enum { eType = _Type };
+    typedef T TStorage;
+    static T Load( T value ) { return value; }
+    static T Store( T value ) { return value; }
+};
+
+template<> struct DynamicTypeOf< bool > : public DynamicValueType< bool, eDynamicType_Bool > {};
+template<> struct DynamicTypeOf< int > : public DynamicValueType< int, eDynamicType_Int > {};
+template<> struct DynamicTypeOf< float > : public DynamicValueType< float, eDynamicType_Float > {};
+template<> struct DynamicTypeOf< double > : public DynamicValueType< double, eDynamicType_Double > {};
+template<> struct DynamicTypeOf< const char* > : public DynamicValueType< const char*, eDynamicType_String > {};
+
+template< typename T >
+struct DynamicTypeOf< T* >
+{
+    enum { eType = eDynamicType_Pointer };
+    typedef const void* TStorage;
+    static T* Load( const void* p ) { return static_cast<T*>( const_cast<void*>(p) ); }
+    static const void* Store( T* p ) { return p; }
+};
+
+// C++ number types, which DynamicArgumentBuffer::Set() converts to any numeric argument
+template< typename T > struct DynamicNumber { enum { eIsNumber = 0 }; };
+
+template<> struct DynamicNumber< bool > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< char > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< signed char > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< unsigned char > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< short > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< unsigned short > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< int > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< unsigned int > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< long > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< unsigned long > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< float > { enum { eIsNumber = 1 }; };
+template<> struct DynamicNumber< double > { enum { eIsNumber = 1 }; };
+
+/**
+ * The argument types of a DynamicSignal, and where each argument lives in a
+ * packed argument buffer. Arguments are laid out in order, each aligned to its
+ * own size.
+ */
+class DynamicSignature
+{
+public:
+    enum { eMaxArguments = 8, eMaxBufferSize = 64 };
+
+    DynamicSignature() : m_nCount(0), m_nSize(0) {}
+    DynamicSignature( const DynamicType* pTypes, unsigned nCount ) { Init( pTypes, nCount ); }
+
+    // Returns false, leaving an empty signature, if there are more than eMaxArguments types, or
+    // a type isn't valid.
+    bool Init( const DynamicType* pTypes, unsigned nCount );
+
+    unsigned Count() const { return m_nCount; }
+    DynamicType GetType( unsigned i ) const { JL_ASSERT( i < m_nCount ); return DynamicType( m_pTypes[i] ); }
+    unsigned GetOffset( unsigned i ) const { JL_ASSERT( i < m_nCount ); return m_pOffsets[i]; }
+
+    // Bytes used in an argument buffer
+    unsigned GetSize() const { return m_nSize; }
+
+    bool Matches( const DynamicType* pTypes, unsigned nCount ) const;
+    bool operator==( const DynamicSignature& oOther ) const;
+    bool operator!=( const DynamicSignature& oOther ) const { return ! ( *this == oOther ); }
+
+    static unsigned GetTypeSize( DynamicType eType );
+
+private:
+    unsigned char m_pTypes[ eMaxArguments ];
+    unsigned char m_pOffsets[ eMaxArguments ];
+    unsigned m_nCount;
+    unsigned m_nSize;
+};
+
+/**
+ * A read-only view of one emission's arguments, as passed to the slots of a
+ * DynamicSignal. Get<T>( i ) must be called with the argument's own type, e.g.
+ * Get<int>() for eDynamicType_Int; slots that don't know the signature ahead of
+ * time can switch on GetType( i ).
+ */
+class DynamicArguments
+{
+public:
+    DynamicArguments( const DynamicSignature& oSignature, const void* pData )
+        : m_pSignature(& oSignature), m_pData(static_cast<const unsigned char*>(pData)) {}
+
+    const DynamicSignature& GetSignature() const { return *m_pSignature; }
+    unsigned Count() const { return m_pSignature->Count(); }
+    DynamicType GetType( unsigned i ) const { return m_pSignature->GetType( i ); }
+
+    template< typename T >
+    T Get( unsigned i ) const
+    {
+        typedef DynamicTypeOf< T > TType;
+        JL_ASSERT( GetType(i) == DynamicType(TType::eType) );
+
+        typename TType::TStorage value;
+        memcpy( & value, m_pData + m_pSignature->GetOffset(i), sizeof(value) );
+        return TType::Load( value );
+    }
+
+private:
+    const DynamicSignature* m_pSignature;
+    const unsigned char* m_pData;
+};
+
+/**
+ * Packs the arguments for one emission of a DynamicSignal. It lives on the
+ * stack, so emitting doesn't allocate:
+ *
+ *   DynamicArgumentBuffer oArguments( oSignal.GetSignature() );
+ *   oArguments.Set( 0, 42 );
+ *   oArguments.Set( 1, 0.5 );
+ *   oSignal.Emit( oArguments );
+ *
+ * Numbers are converted to their argument's type, so the 0.5 above is stored as
+ * a float if argument 1 is eDynamicType_Float. Strings and pointers must have
+ * their argument's type, as with DynamicArguments::Get().
+ */
+class DynamicArgumentBuffer
+{
+public:
+    explicit DynamicArgumentBuffer( const DynamicSignature& oSignature ) : m_pSignature(& oSignature), m_nSetMask(0) {}
+
+    template< typename T >
+    void Set( unsigned i, T value )
+    {
+        Set( i, value, NumberTag< DynamicNumber<T>::eIsNumber != 0 >() );
+    }
+
+    // True once every argument has been set
+    bool IsComplete() const { return m_nSetMask == ( 1u << m_pSignature->Count() ) - 1; }
+
+    const DynamicSignature& GetSignature() const { return *m_pSignature; }
+    DynamicArguments GetArguments() const { return DynamicArguments( *m_pSignature, m_oData.pBytes ); }
+
+private:
+    template< bool _IsNumber > struct NumberTag {};
+
+    template< typename T >
+    void Set( unsigned i, T value, NumberTag<false> )
+    {
+        JL_ASSERT( m_pSignature->GetType(i) == DynamicType(DynamicTypeOf<T>::eType) );
+        Store( i, value );
+    }
+
+    template< typename T >
+    void Set( unsigned i, T value, NumberTag<true> )
+    {
+        switch ( m_pSignature->GetType(i) )
+        {
+            case eDynamicType_Bool: Store( i, value != 0 ); break;
+            case eDynamicType_Int: Store( i, static_cast<int>(value) ); break;
+            case eDynamicType_Float: Store( i, static_cast<float>(value) ); break;
+            case eDynamicType_Double: Store( i, static_cast<double>(value) ); break;
+
+            // Only a null pointer converts to a string or pointer argument
+            default:
+                JL_ASSERT( value == 0 );
+                Store( i, static_cast<const void*>(NULL) );
+                break;
+        }
+    }
+
+    template< typename T >
+    void Store( unsigned i, T value )
+    {
+        typedef DynamicTypeOf< T > TType;
+        const typename TType::TStorage stored = TType::Store( value );
+        memcpy( m_oData.pBytes + m_pSignature->GetOffset(i), & stored, sizeof(stored) );
+        m_nSetMask |= 1u << i;
+    }
+
+    const DynamicSignature* m_pSignature;
+    unsigned m_nSetMask;
+
+    union
+    {
+        double fAlign;
+        const void* pAlign;
+        unsigned char pBytes[ DynamicSignature::eMaxBufferSize ];
+    } m_oData;
+};
+
+namespace DynamicSlot {
+
+    template< typename P >
+    DynamicType TypeOf() { return DynamicType( DynamicTypeOf< typename SignalArgumentStorage<P>::Type >::eType ); }
+
+    template< typename P >
+    typename SignalArgumentStorage<P>::Type Get( const DynamicArguments& oArguments, unsigned i )
+    {
+        return oArguments.Get< typename SignalArgumentStorage<P>::Type >( i );
+    }
+
+    // Unpacks a DynamicArguments into a call to a typed function
+    inline void Call( void (*fpFunction)(), const DynamicArguments& ) { fpFunction(); }
+
+    template< typename P1 >
+    void Call( void (*fpFunction)(P1), const DynamicArguments& a ) { fpFunction( Get<P1>(a, 0) ); }
+
+    template< typename P1, typename P2 >
+    void Call( void (*fpFunction)(P1, P2), const DynamicArguments& a ) { fpFunction( Get<P1>(a, 0), Get<P2>(a, 1) ); }
+
+    template< typename P1, typename P2, typename P3 >
+    void Call( void (*fpFunction)(P1, P2, P3), const DynamicArguments& a ) { fpFunction( Get<P1>(a, 0), Get<P2>(a, 1), Get<P3>(a, 2) ); }
+
+    template< typename P1, typename P2, typename P3, typename P4 >
+    void Call( void (*fpFunction)(P1, P2, P3, P4), const DynamicArguments& a ) { fpFunction( Get<P1>(a, 0), Get<P2>(a, 1), Get<P3>(a, 2), Get<P4>(a, 3) ); }
+
+    // ...and to a typed instance method
+    template< class Y, class X >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(), const DynamicArguments& ) { ( pObject->*fpMethod )(); }
+
+    template< class Y, class X >
+    void CallMethod( Y* pObject, void (X::*fpMethod)() const, const DynamicArguments& ) { ( pObject->*fpMethod )(); }
+
+    template< class Y, class X, typename P1 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1), const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0) ); }
+
+    template< class Y, class X, typename P1 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1) const, const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0) ); }
+
+    template< class Y, class X, typename P1, typename P2 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1, P2), const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0), Get<P2>(a, 1) ); }
+
+    template< class Y, class X, typename P1, typename P2 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1, P2) const, const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0), Get<P2>(a, 1) ); }
+
+    template< class Y, class X, typename P1, typename P2, typename P3 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1, P2, P3), const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0), Get<P2>(a, 1), Get<P3>(a, 2) ); }
+
+    template< class Y, class X, typename P1, typename P2, typename P3 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1, P2, P3) const, const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0), Get<P2>(a, 1), Get<P3>(a, 2) ); }
+
+    template< class Y, class X, typename P1, typename P2, typename P3, typename P4 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1, P2, P3, P4), const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0), Get<P2>(a, 1), Get<P3>(a, 2), Get<P4>(a, 3) ); }
+
+    template< class Y, class X, typename P1, typename P2, typename P3, typename P4 >
+    void CallMethod( Y* pObject, void (X::*fpMethod)(P1, P2, P3, P4) const, const DynamicArguments& a ) { ( pObject->*fpMethod )( Get<P1>(a, 0), Get<P2>(a, 1), Get<P3>(a, 2), Get<P4>(a, 3) ); }
+
+    // Functors that adapt typed slots to a DynamicSignal. They are plain data, so they can be
+    // stored in a signal's connection allocator.
+    template< class F >
+    struct FunctionSlot
+    {
+        F fpFunction;
+        void operator()( const DynamicArguments& oArguments ) const { Call( fpFunction, oArguments ); }
+    };
+
+    template< class Y, class TMethod >
+    struct MethodSlot
+    {
+        Y* pObject;
+        TMethod fpMethod;
+        void operator()( const DynamicArguments& oArguments ) const { CallMethod( pObject, fpMethod, oArguments ); }
+    };
+
+} // namespace DynamicSlot
+
+/**
+ * A signal whose argument types are only known at runtime, e.g. one declared by
+ * a script:
+ *
+ *   const DynamicType pTypes[] = { eDynamicType_Int, eDynamicType_Float };
+ *   DynamicSignal oDamaged( DynamicSignature(pTypes, 2) );
+ *
+ *   // Slots that read the arguments themselves, e.g. script bindings
+ *   oDamaged.Connect( pScriptHost, &ScriptHost::OnDynamicSignal );
+ *
+ *   // Typed C++ slots, whose parameters are checked against the signature
+ *   oDamaged.Connect( pHud, &Hud::OnDamaged ); // void OnDamaged( int, float )
+ *
+ *   oDamaged.Emit( 3, 0.5 ); // 0.5 is passed as a float
+ *
+ * Arguments are packed into a DynamicArgumentBuffer on the caller's stack, and
+ * every slot sees the same buffer, so emitting doesn't allocate. Typed slots
+ * are stored like function objects connected to a signal (see SignalN::Connect()),
+ * so each one uses two blocks from the connection allocator; instance method
+ * slots are removed when their observer is destroyed. Typed slots take up to
+ * four parameters.
+ */
+class DynamicSignal
+{
+public:
+    typedef Signal1< const DynamicArguments& > TSignal;
+
+    explicit DynamicSignal( const DynamicSignature& oSignature ) : m_oSignature(oSignature) {}
+    DynamicSignal( const DynamicSignature& oSignature, ScopedAllocator* pAllocator ) : m_oSignature(oSignature), m_oSignal(pAllocator) {}
+
+    const DynamicSignature& GetSignature() const { return m_oSignature; }
+
+    // The underlying signal, e.g. for setting an allocator or disconnecting untyped slots
+    TSignal& GetSignal() { return m_oSignal; }
+    const TSignal& GetSignal() const { return m_oSignal; }
+
+    unsigned CountConnections() const { return m_oSignal.CountConnections(); }
+    void Disconnect( SignalObserver* pObserver ) { m_oSignal.Disconnect( pObserver ); }
+    void DisconnectAll() { m_oSignal.DisconnectAll(); }
+
+    // Untyped slots, which receive the packed arguments
+    void Connect( void (*fpFunction)(const DynamicArguments&), unsigned nFlags = 0 )
+    {
+        m_oSignal.Connect( fpFunction, nFlags );
+    }
+
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(const DynamicArguments&), unsigned nFlags = 0 )
+    {
+        m_oSignal.Connect( pObject, fpMethod, nFlags );
+    }
+
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(const DynamicArguments&) const, unsigned nFlags = 0 )
+    {
+        m_oSignal.Connect( pObject, fpMethod, nFlags );
+    }
+
+    // Typed non-instance functions. Returns false, without connecting, if the function's
+    // parameters don't match the signature.
+    bool Connect( void (*fpFunction)(), unsigned nFlags = 0 )
+    {
+        return ConnectFunction( fpFunction, NULL, 0, nFlags );
+    }
+
+    template< typename P1 >
+    bool Connect( void (*fpFunction)(P1), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>() };
+        return ConnectFunction( fpFunction, pTypes, 1, nFlags );
+    }
+
+    template< typename P1, typename P2 >
+    bool Connect( void (*fpFunction)(P1, P2), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>() };
+        return ConnectFunction( fpFunction, pTypes, 2, nFlags );
+    }
+
+    template< typename P1, typename P2, typename P3 >
+    bool Connect( void (*fpFunction)(P1, P2, P3), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>(), DynamicSlot::TypeOf<P3>() };
+        return ConnectFunction( fpFunction, pTypes, 3, nFlags );
+    }
+
+    template< typename P1, typename P2, typename P3, typename P4 >
+    bool Connect( void (*fpFunction)(P1, P2, P3, P4), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>(), DynamicSlot::TypeOf<P3>(), DynamicSlot::TypeOf<P4>() };
+        return ConnectFunction( fpFunction, pTypes, 4, nFlags );
+    }
+
+    // Typed instance methods of observers. Returns false, without connecting, if the method's
+    // parameters don't match the signature.
+    template< class X, class Y >
+    bool Connect( Y* pObject, void (X::*fpMethod)(), unsigned nFlags = 0 )
+    {
+        return ConnectMethod( pObject, fpMethod, NULL, 0, nFlags );
+    }
+
+    template< class X, class Y >
+    bool Connect( Y* pObject, void (X::*fpMethod)() const, unsigned nFlags = 0 )
+    {
+        return ConnectMethod( pObject, fpMethod, NULL, 0, nFlags );
+    }
+
+    template< class X, class Y, typename P1 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 1, nFlags );
+    }
+
+    template< class X, class Y, typename P1 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1) const, unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 1, nFlags );
+    }
+
+    template< class X, class Y, typename P1, typename P2 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1, P2), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 2, nFlags );
+    }
+
+    template< class X, class Y, typename P1, typename P2 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1, P2) const, unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 2, nFlags );
+    }
+
+    template< class X, class Y, typename P1, typename P2, typename P3 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1, P2, P3), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>(), DynamicSlot::TypeOf<P3>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 3, nFlags );
+    }
+
+    template< class X, class Y, typename P1, typename P2, typename P3 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1, P2, P3) const, unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>(), DynamicSlot::TypeOf<P3>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 3, nFlags );
+    }
+
+    template< class X, class Y, typename P1, typename P2, typename P3, typename P4 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1, P2, P3, P4), unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>(), DynamicSlot::TypeOf<P3>(), DynamicSlot::TypeOf<P4>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 4, nFlags );
+    }
+
+    template< class X, class Y, typename P1, typename P2, typename P3, typename P4 >
+    bool Connect( Y* pObject, void (X::*fpMethod)(P1, P2, P3, P4) const, unsigned nFlags = 0 )
+    {
+        const DynamicType pTypes[] = { DynamicSlot::TypeOf<P1>(), DynamicSlot::TypeOf<P2>(), DynamicSlot::TypeOf<P3>(), DynamicSlot::TypeOf<P4>() };
+        return ConnectMethod( pObject, fpMethod, pTypes, 4, nFlags );
+    }
+
+    // Emits arguments that were packed by the caller, e.g. a script
+    void Emit( const DynamicArgumentBuffer& oArguments ) const
+    {
+        JL_ASSERT( oArguments.GetSignature() == m_oSignature && oArguments.IsComplete() );
+        m_oSignal.Emit( oArguments.GetArguments() );
+    }
+
+    // Packs and emits typed arguments, converted as by DynamicArgumentBuffer::Set()
+    void Emit() const
+    {
+        const DynamicArgumentBuffer oArguments( m_oSignature );
+        Emit( oArguments );
+    }
+
+    template< typename P1 >
+    void Emit( P1 p1 ) const
+    {
+        DynamicArgumentBuffer oArguments( m_oSignature );
+        oArguments.Set( 0, p1 );
+        Emit( oArguments );
+    }
+
+    template< typename P1, typename P2 >
+    void Emit( P1 p1, P2 p2 ) const
+    {
+        DynamicArgumentBuffer oArguments( m_oSignature );
+        oArguments.Set( 0, p1 );
+        oArguments.Set( 1, p2 );
+        Emit( oArguments );
+    }
+
+    template< typename P1, typename P2, typename P3 >
+    void Emit( P1 p1, P2 p2, P3 p3 ) const
+    {
+        DynamicArgumentBuffer oArguments( m_oSignature );
+        oArguments.Set( 0, p1 );
+        oArguments.Set( 1, p2 );
+        oArguments.Set( 2, p3 );
+        Emit( oArguments );
+    }
+
+    template< typename P1, typename P2, typename P3, typename P4 >
+    void Emit( P1 p1, P2 p2, P3 p3, P4 p4 ) const
+    {
+        DynamicArgumentBuffer oArguments( m_oSignature );
+        oArguments.Set( 0, p1 );
+        oArguments.Set( 1, p2 );
+        oArguments.Set( 2, p3 );
+        oArguments.Set( 3, p4 );
+        Emit( oArguments );
+    }
+
+private:
+    template< class F >
+    bool ConnectFunction( F fpFunction, const DynamicType* pTypes, unsigned nCount, unsigned nFlags )
+    {
+        if ( ! m_oSignature.Matches(pTypes, nCount) )
+        {
+            return false;
+        }
+
+        const DynamicSlot::FunctionSlot< F > oSlot = { fpFunction };
+        m_oSignal.Connect( oSlot, nFlags );
+        return true;
+    }
+
+    template< class Y, class TMethod >
+    bool ConnectMethod( Y* pObject, TMethod fpMethod, const DynamicType* pTypes, unsigned nCount, unsigned nFlags )
+    {
+        if ( ! m_oSignature.Matches(pTypes, nCount) )
+        {
+            return false;
+        }
+
+        // The observer owns the connection, as with any instance method
+        const DynamicSlot::MethodSlot< Y, TMethod > oSlot = { pObject, fpMethod };
+        m_oSignal.Connect( static_cast<SignalObserver*>( pObject ), oSlot, nFlags );
+        return true;
+    }
+
+    DynamicSignature m_oSignature;
+    TSignal m_oSignal;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_DYNAMIC_SIGNAL_H_ )
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "DynamicSignal.h"
+#include "StaticSignalConnectionAllocators.h"
+
+using namespace jl;
+
+namespace
+{
+    // Stands in for a script host, which reads arguments by their runtime type
+    class ScriptObserver : public SignalObserver
+    {
+    public:
+        ScriptObserver() : m_nCalls(0), m_fSum(0.0), m_pLastString(NULL) {}
+
+        void OnSignal( const DynamicArguments& oArguments )
+        {
+            ++m_nCalls;
+
+            for ( unsigned i = 0; i < oArguments.Count(); ++i )
+            {
+                switch ( oArguments.GetType(i) )
+                {
+                    case eDynamicType_Bool: m_fSum += oArguments.Get<bool>( i ) ? 1.0 : 0.0; break;
+                    case eDynamicType_Int: m_fSum += oArguments.Get<int>( i ); break;
+                    case eDynamicType_Float: m_fSum += oArguments.Get<float>( i ); break;
+                    case eDynamicType_Double: m_fSum += oArguments.Get<double>( i ); break;
+                    case eDynamicType_String: m_pLastString = oArguments.Get<const char*>( i ); break;
+                    default: break;
+                }
+            }
+        }
+
+        unsigned m_nCalls;
+        double m_fSum;
+        const char* m_pLastString;
+    };
+
+    struct Entity
+    {
+        int m_nHealth;
+    };
+
+    class TypedObserver : public SignalObserver
+    {
+    public:
+        TypedObserver() : m_nTotal(0), m_fScale(0.0f), m_pEntity(NULL) {}
+
+        void OnDamaged( Entity* pEntity, int nDamage, float fScale ) { m_pEntity = pEntity; m_nTotal += nDamage; m_fScale = fScale; }
+        void OnDamagedConst( const Entity* pEntity, const int& nDamage, float ) const { JL_UNUSED(pEntity); s_nConstTotal += nDamage; }
+        void OnWrongTypes( Entity* pEntity, float fDamage, float fScale ) { JL_UNUSED(pEntity); JL_UNUSED(fDamage); JL_UNUSED(fScale); }
+
+        int m_nTotal;
+        float m_fScale;
+        Entity* m_pEntity;
+        static int s_nConstTotal;
+    };
+
+    int TypedObserver::s_nConstTotal = 0;
+
+    int s_nFunctionTotal = 0;
+    void OnDamagedFunction( Entity* pEntity, int nDamage, float ) { pEntity->m_nHealth -= nDamage; s_nFunctionTotal += nDamage; }
+    void OnTooFewArguments( Entity*, int ) {}
+
+    float s_fLastScale = 0.0f;
+    void OnScaled( int, float fScale ) { s_fLastScale = fScale; }
+}
+
+void DynamicSignalTest()
+{
+    printf( "Testing dynamic signals...\n" );
+
+    // Layout
+    const DynamicType pTypes[] = { eDynamicType_Bool, eDynamicType_Int, eDynamicType_Double, eDynamicType_String };
+    DynamicSignature oSignature( pTypes, JL_ARRAY_SIZE(pTypes) );
+    assert( oSignature.Count() == 4 && oSignature.Matches(pTypes, 4) );
+    assert( oSignature.GetOffset(0) == 0 && oSignature.GetOffset(1) == 4 && oSignature.GetOffset(2) == 8 && oSignature.GetOffset(3) == 16 );
+    assert( oSignature.GetSize() == 16 + sizeof(const char*) );
+
+    const DynamicType pTooMany[ DynamicSignature::eMaxArguments + 1 ] = { eDynamicType_Int };
+    DynamicSignature oInvalid;
+    assert( ! oInvalid.Init(pTooMany, JL_ARRAY_SIZE(pTooMany)) && oInvalid.Count() == 0 );
+
+    // Packing and reading back
+    DynamicArgumentBuffer oBuffer( oSignature );
+    oBuffer.Set( 0, true );
+    oBuffer.Set( 1, -7 );
+    oBuffer.Set( 2, 2.5 );
+    assert( ! oBuffer.IsComplete() );
+    oBuffer.Set( 3, "hello" );
+    assert( oBuffer.IsComplete() );
+
+    const DynamicArguments oArguments = oBuffer.GetArguments();
+    assert( oArguments.Get<bool>(0) && oArguments.Get<int>(1) == -7 && oArguments.Get<double>(2) == 2.5 );
+    assert( strcmp(oArguments.Get<const char*>(3), "hello") == 0 );
+
+    // Untyped slots
+    StaticSignalConnectionAllocator< 16 > oConnectionAllocator;
+    StaticObserverConnectionAllocator< 16 > oObserverAllocator;
+    ScriptObserver oScript;
+    oScript.SetConnectionAllocator( & oObserverAllocator );
+
+    DynamicSignal oSignal( oSignature, & oConnectionAllocator );
+    oSignal.Connect( & oScript, & ScriptObserver::OnSignal );
+    oSignal.Emit( oBuffer );
+    oSignal.Emit( false, 3, 0.5, "world" );
+    assert( oScript.m_nCalls == 2 && oScript.m_fSum == 1.0 - 7.0 + 2.5 + 3.0 + 0.5 );
+    assert( strcmp(oScript.m_pLastString, "world") == 0 );
+
+    // Typed and untyped slots on the same signal
+    const DynamicType pDamageTypes[] = { eDynamicType_Pointer, eDynamicType_Int, eDynamicType_Float };
+    DynamicSignal oDamaged( DynamicSignature(pDamageTypes, 3), & oConnectionAllocator );
+
+    {
+        TypedObserver oTyped;
+        oTyped.SetConnectionAllocator( & oObserverAllocator );
+        ScriptObserver oDamageScript;
+        oDamageScript.SetConnectionAllocator( & oObserverAllocator );
+
+        assert( oDamaged.Connect(& oTyped, & TypedObserver::OnDamaged) );
+        assert( oDamaged.Connect(& oTyped, & TypedObserver::OnDamagedConst) );
+        assert( oDamaged.Connect(& OnDamagedFunction) );
+        oDamaged.Connect( & oDamageScript, & ScriptObserver::OnSignal );
+
+        // Mismatched parameters are rejected
+        assert( ! oDamaged.Connect(& oTyped, & TypedObserver::OnWrongTypes) );
+        assert( ! oDamaged.Connect(& OnTooFewArguments) );
+        assert( oDamaged.CountConnections() == 4 );
+
+        Entity oEntity = { 100 };
+        const unsigned nAllocations = oConnectionAllocator.CountAllocations();
+        oDamaged.Emit( & oEntity, 10, 0.25f );
+        assert( oConnectionAllocator.CountAllocations() == nAllocations );
+
+        assert( oTyped.m_pEntity == & oEntity && oTyped.m_nTotal == 10 && oTyped.m_fScale == 0.25f );
+        assert( TypedObserver::s_nConstTotal == 10 && s_nFunctionTotal == 10 && oEntity.m_nHealth == 90 );
+        assert( oDamageScript.m_nCalls == 1 && oDamageScript.m_fSum == 10.25 );
+
+        // Removing an observer removes its typed slots
+        oDamaged.Disconnect( & oTyped );
+        assert( oDamaged.CountConnections() == 2 );
+        assert( oTyped.CountSignalConnections() == 0 );
+        assert( oDamaged.Connect(& oTyped, & TypedObserver::OnDamaged) );
+    }
+
+    // Destroying observers removes their slots, typed or not
+    assert( oDamaged.CountConnections() == 1 );
+
+    // Numbers are converted to their argument's type
+    const DynamicType pScaleTypes[] = { eDynamicType_Int, eDynamicType_Float };
+    DynamicSignal oScaled( DynamicSignature(pScaleTypes, 2), & oConnectionAllocator );
+    assert( oScaled.Connect(& OnScaled) );
+    oScaled.Emit( 3, 0.5 );
+    assert( s_fLastScale == 0.5f );
+
+    DynamicArgumentBuffer oConverted( oSignature );
+    oConverted.Set( 0, 2 );
+    oConverted.Set( 1, 7.9f );
+    oConverted.Set( 2, 3u );
+    oConverted.Set( 3, "converted" );
+    assert( oConverted.IsComplete() );
+    assert( oConverted.GetArguments().Get<bool>(0) && oConverted.GetArguments().Get<int>(1) == 7 && oConverted.GetArguments().Get<double>(2) == 3.0 );
+
+    oScaled.DisconnectAll();
+    oDamaged.DisconnectAll();
+    oSignal.DisconnectAll();
+    assert( oConnectionAllocator.CountAllocations() == 0 );
+}
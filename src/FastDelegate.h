@@ -53,6 +53,10 @@
 
 #include <memory.h> // to allow <,> comparisons
 
+#if __cplusplus >= 201103L
+#include <type_traits> // for ParamTraits
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 //                        Configuration options
 //
@@ -608,6 +612,34 @@ namespace fastdelegate {
             return memcmp(&m_pFunction, &right.m_pFunction, sizeof(m_pFunction)) < 0;
             
         }
+        // An alternative ordering that sorts by the bound function first, so that
+        // delegates calling the same function sort next to each other. Delegates
+        // that share a function are ordered by their 'this' pointers.
+        // (Added for jl_signal's grouped dispatch.)
+        inline bool IsLessByFunction(const DelegateMemento &right) const {
+            const int nCompare = memcmp(&m_pFunction, &right.m_pFunction, sizeof(m_pFunction));
+            if (nCompare != 0) return nCompare < 0;
+#if !defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+            if (m_pStaticFunction != right.m_pStaticFunction)
+                return m_pStaticFunction < right.m_pStaticFunction;
+#endif
+            return m_pthis < right.m_pthis;
+        }
+        // A hash that agrees with IsEqual(): equal delegates have equal hashes.
+        // (Added for jl_signal's connection index.)
+        inline unsigned GetHash() const {
+#if !defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+            unsigned nHash = HashBytes(0, &m_pStaticFunction, sizeof(m_pStaticFunction));
+            if (m_pStaticFunction != 0) nHash = HashBytes(nHash, &m_pthis, sizeof(m_pthis));
+#else
+            unsigned nHash = HashBytes(0, &m_pthis, sizeof(m_pthis));
+#endif
+            nHash = HashBytes(nHash, &m_pFunction, sizeof(m_pFunction));
+            // Mix the high bits down, since pointers' low bits are mostly zero
+            nHash ^= nHash >> 16; nHash *= 0x85EBCA6Bu;
+            nHash ^= nHash >> 13; nHash *= 0xC2B2AE35u;
+            return nHash ^ (nHash >> 16);
+        }
         // BUGFIX (Mar 2005):
         // We can't just compare m_pFunction because on Metrowerks,
         // m_pFunction can be zero even if the delegate is not empty!
@@ -632,6 +664,20 @@ namespace fastdelegate {
         , m_pStaticFunction (right.m_pStaticFunction)
 #endif
         {}
+    private:
+        // Combines the bytes into the hash a word at a time
+        static unsigned HashBytes(unsigned nHash, const void *pBytes, size_t nBytes) {
+            const unsigned char *p = static_cast<const unsigned char *>(pBytes);
+            for (; nBytes >= sizeof(unsigned); p += sizeof(unsigned), nBytes -= sizeof(unsigned)) {
+                unsigned nWord;
+                memcpy(&nWord, p, sizeof(unsigned));
+                nHash = (nHash ^ nWord) * 0x9E3779B1u;
+            }
+            for (; nBytes > 0; ++p, --nBytes) {
+                nHash = (nHash ^ *p) * 0x9E3779B1u;
+            }
+            return nHash;
+        }
     protected:
         void SetMementoFrom(const DelegateMemento &right)  {
             m_pFunction = right.m_pFunction;
@@ -810,6 +856,74 @@ namespace fastdelegate {
         
     } // namespace detail
     
+    ////////////////////////////////////////////////////////////////////////////////
+    //                        Parameter passing
+    //
+    // ParamTraits<T>::type is the type operator() takes for a delegate parameter
+    // declared as T. By-reference arguments are passed by const reference, so
+    // that calling a delegate doesn't copy them. The bound function still
+    // receives the type it was declared with.
+    //
+    // With C++11, arguments larger than two pointers, or that aren't trivially
+    // copyable, are passed by reference, and the rest as declared. That needs T
+    // to be complete wherever a delegate taking it is declared. Before C++11,
+    // arguments are passed as declared unless their type opts in.
+    //
+    // FASTDELEGATE_PASS_BY_REFERENCE(T) and FASTDELEGATE_PASS_BY_VALUE(T) make
+    // the choice for T, and let T be incomplete. They specialize ParamTraits, so
+    // the one-definition rule applies: use them at global scope, in the header
+    // that declares T, so that every file using T sees the same choice before
+    // declaring a delegate that takes it.
+    //
+    ////////////////////////////////////////////////////////////////////////////////
+    
+    namespace detail {
+        template <class T, bool bByReference>
+        struct SelectParam { typedef T type; };
+        
+        template <class T>
+        struct SelectParam<T, true> { typedef const T & type; };
+    } // namespace detail
+    
+    template <class T>
+    struct ParamTraits {
+#if __cplusplus >= 201103L
+        static const bool by_reference = sizeof(T) > 2 * sizeof(void *) || !std::is_trivially_copyable<T>::value;
+#else
+        static const bool by_reference = false;
+#endif
+        typedef typename detail::SelectParam<T, by_reference>::type type;
+    };
+    
+    template <class T>
+    struct ParamTraits<T &> {
+        static const bool by_reference = false;
+        typedef T & type;
+    };
+    
+    // const T is passed the same way as T
+    template <class T>
+    struct ParamTraits<const T> {
+        static const bool by_reference = ParamTraits<T>::by_reference;
+        typedef typename detail::SelectParam<const T, by_reference>::type type;
+    };
+    
+#define FASTDELEGATE_PASS_BY_REFERENCE( T ) \
+    namespace fastdelegate { \
+        template <> struct ParamTraits< T > { \
+            static const bool by_reference = true; \
+            typedef const T & type; \
+        }; \
+    }
+    
+#define FASTDELEGATE_PASS_BY_VALUE( T ) \
+    namespace fastdelegate { \
+        template <> struct ParamTraits< T > { \
+            static const bool by_reference = false; \
+            typedef T type; \
+        }; \
+    }
+    
     ////////////////////////////////////////////////////////////////////////////////
     //                        Fast Delegates, part 3:
     //
@@ -987,7 +1101,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate1::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1072,7 +1186,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate2::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1157,7 +1271,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate3::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2, Param3 p3) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2, typename ParamTraits<Param3>::type p3) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2, p3); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1242,7 +1356,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate4::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2, typename ParamTraits<Param3>::type p3, typename ParamTraits<Param4>::type p4) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2, p3, p4); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1327,7 +1441,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate5::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2, typename ParamTraits<Param3>::type p3, typename ParamTraits<Param4>::type p4, typename ParamTraits<Param5>::type p5) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2, p3, p4, p5); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1412,7 +1526,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate6::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5, Param6 p6) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2, typename ParamTraits<Param3>::type p3, typename ParamTraits<Param4>::type p4, typename ParamTraits<Param5>::type p5, typename ParamTraits<Param6>::type p6) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2, p3, p4, p5, p6); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1497,7 +1611,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate7::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5, Param6 p6, Param7 p7) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2, typename ParamTraits<Param3>::type p3, typename ParamTraits<Param4>::type p4, typename ParamTraits<Param5>::type p5, typename ParamTraits<Param6>::type p6, typename ParamTraits<Param7>::type p7) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2, p3, p4, p5, p6, p7); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -1582,7 +1696,7 @@ namespace fastdelegate {
             m_Closure.bindstaticfunc(this, &FastDelegate8::InvokeStaticFunction, 
                                      function_to_bind); }
         // Invoke the delegate
-        RetType operator() (Param1 p1, Param2 p2, Param3 p3, Param4 p4, Param5 p5, Param6 p6, Param7 p7, Param8 p8) const {
+        RetType operator() (typename ParamTraits<Param1>::type p1, typename ParamTraits<Param2>::type p2, typename ParamTraits<Param3>::type p3, typename ParamTraits<Param4>::type p4, typename ParamTraits<Param5>::type p5, typename ParamTraits<Param6>::type p6, typename ParamTraits<Param7>::type p7, typename ParamTraits<Param8>::type p8) const {
             return (m_Closure.GetClosureThis()->*(m_Closure.GetClosureMemPtr()))(p1, p2, p3, p4, p5, p6, p7, p8); }
         // Implicit conversion to "bool" using the safe_bool idiom
     private:
@@ -0,0 +1,197 @@
+#ifndef _JL_HASH_INDEX_H_
+#define _JL_HASH_INDEX_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+
+namespace jl {
+
+/**
+ * A hash set of pointers to objects that are owned elsewhere, for finding
+ * objects by key in O(1), e.g.:
+ *
+ *   struct FooHash { unsigned operator()( const Foo& oFoo ) const { ... } };
+ *
+ *   Foo* pSlots[ 256 ];
+ *   HashIndex< Foo, FooHash > oIndex;
+ *   oIndex.Init( pSlots, JL_ARRAY_SIZE(pSlots) );
+ *
+ * _THash hashes an object's key. Several objects can share a key; Find()
+ * returns the first one that matches.
+ *
+ * The caller provides the slot array, whose size must be a power of two, so the
+ * index never allocates. Slots are probed linearly, and Remove() shifts later
+ * entries back instead of leaving tombstones, so probes stay short. Add() fails
+ * once eMaxLoadPercent of the slots are used.
+ */
+template<typename _T, typename _THash>
+class HashIndex
+{
+public:
+    typedef _T TObject;
+
+    enum { eMaxLoadPercent = 75 };
+
+    HashIndex()
+    {
+        m_ppSlots = NULL;
+        m_nMask = 0;
+        m_nCount = 0;
+    }
+
+    // Uses ppSlots as an empty index. Pass NULL to detach the index from its slots.
+    void Init( TObject** ppSlots, unsigned nSlotCount )
+    {
+        JL_ASSERT( ppSlots == NULL || (nSlotCount > 0 && (nSlotCount & (nSlotCount - 1)) == 0) );
+        m_ppSlots = ppSlots;
+        m_nMask = ppSlots ? nSlotCount - 1 : 0;
+        Clear();
+    }
+
+    bool IsInitialized() const
+    {
+        return m_ppSlots != NULL;
+    }
+
+    unsigned Count() const
+    {
+        return m_nCount;
+    }
+
+    TObject** GetSlots() const
+    {
+        return m_ppSlots;
+    }
+
+    unsigned GetSlotCount() const
+    {
+        return m_ppSlots ? m_nMask + 1 : 0;
+    }
+
+    // Returns false if the index is full, or not initialized.
+    bool Add( TObject* pObject )
+    {
+        JL_ASSERT( pObject );
+        if ( ! m_ppSlots || (m_nCount + 1) * 100 > (m_nMask + 1) * eMaxLoadPercent )
+        {
+            return false;
+        }
+
+        unsigned nSlot = _THash()( *pObject ) & m_nMask;
+
+        while ( m_ppSlots[nSlot] )
+        {
+            nSlot = ( nSlot + 1 ) & m_nMask;
+        }
+
+        m_ppSlots[nSlot] = pObject;
+        m_nCount += 1;
+
+        return true;
+    }
+
+    // Returns true if the object was in the index. The object's key must not
+    // have changed since it was added.
+    bool Remove( TObject* pObject )
+    {
+        if ( ! m_ppSlots )
+        {
+            return false;
+        }
+
+        unsigned nSlot = _THash()( *pObject ) & m_nMask;
+
+        while ( m_ppSlots[nSlot] != pObject )
+        {
+            if ( ! m_ppSlots[nSlot] )
+            {
+                return false;
+            }
+
+            nSlot = ( nSlot + 1 ) & m_nMask;
+        }
+
+        // Shift back any later entry in the same run that would no longer be
+        // reachable from its home slot
+        for ( unsigned nNext = ( nSlot + 1 ) & m_nMask; m_ppSlots[nNext]; nNext = ( nNext + 1 ) & m_nMask )
+        {
+            const unsigned nHome = _THash()( *m_ppSlots[nNext] ) & m_nMask;
+
+            // Distances from the entry's home slot, around the end of the array
+            if ( ( (nNext - nHome) & m_nMask ) >= ( (nNext - nSlot) & m_nMask ) )
+            {
+                m_ppSlots[nSlot] = m_ppSlots[nNext];
+                nSlot = nNext;
+            }
+        }
+
+        m_ppSlots[nSlot] = NULL;
+        m_nCount -= 1;
+
+        return true;
+    }
+
+    // Puts pNewObject in pOldObject's slot, e.g. after the object was moved. Both
+    // must have the same key. Returns true if pOldObject was in the index.
+    bool Replace( TObject* pOldObject, TObject* pNewObject )
+    {
+        JL_ASSERT( pNewObject );
+        if ( ! m_ppSlots )
+        {
+            return false;
+        }
+
+        for ( unsigned nSlot = _THash()( *pOldObject ) & m_nMask; m_ppSlots[nSlot]; nSlot = ( nSlot + 1 ) & m_nMask )
+        {
+            if ( m_ppSlots[nSlot] == pOldObject )
+            {
+                m_ppSlots[nSlot] = pNewObject;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Returns the first object with hash nHash for which oMatch( object ) is true,
+    // or NULL.
+    template<typename TMatch>
+    TObject* Find( unsigned nHash, const TMatch& oMatch ) const
+    {
+        if ( ! m_ppSlots )
+        {
+            return NULL;
+        }
+
+        for ( unsigned nSlot = nHash & m_nMask; m_ppSlots[nSlot]; nSlot = ( nSlot + 1 ) & m_nMask )
+        {
+            if ( oMatch(*m_ppSlots[nSlot]) )
+            {
+                return m_ppSlots[nSlot];
+            }
+        }
+
+        return NULL;
+    }
+
+    // Empties the index. No objects are touched.
+    void Clear()
+    {
+        for ( unsigned i = 0; m_ppSlots && i <= m_nMask; ++i )
+        {
+            m_ppSlots[i] = NULL;
+        }
+
+        m_nCount = 0;
+    }
+
+private:
+    TObject** m_ppSlots;
+    unsigned m_nMask;
+    unsigned m_nCount;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_HASH_INDEX_H_ )
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "HashIndex.h"
+
+using namespace jl;
+
+namespace
+{
+    struct TestObject
+    {
+        unsigned nKey;
+    };
+
+    // A poor hash, so that keys collide and runs wrap around the end of the slots
+    struct TestObjectHash
+    {
+        unsigned operator()( const TestObject& oObject ) const { return oObject.nKey % 8 + 12; }
+    };
+
+    struct KeyMatch
+    {
+        unsigned nKey;
+        bool operator()( const TestObject& oObject ) const { return oObject.nKey == nKey; }
+    };
+
+    typedef HashIndex< TestObject, TestObjectHash > TestIndex;
+
+    TestObject* Find( const TestIndex& oIndex, unsigned nKey )
+    {
+        const TestObject oKey = { nKey };
+        const KeyMatch oMatch = { nKey };
+        return oIndex.Find( TestObjectHash()(oKey), oMatch );
+    }
+}
+
+void HashIndexTest()
+{
+    enum { eSlotCount = 16, eObjectCount = eSlotCount * TestIndex::eMaxLoadPercent / 100 };
+
+    TestObject* pSlots[ eSlotCount ];
+    TestObject pObjects[ eObjectCount + 1 ];
+
+    for ( unsigned i = 0; i < JL_ARRAY_SIZE(pObjects); ++i )
+    {
+        pObjects[i].nKey = i;
+    }
+
+    TestIndex oIndex;
+    assert( ! oIndex.IsInitialized() );
+    assert( ! oIndex.Add(& pObjects[0]) );
+
+    oIndex.Init( pSlots, eSlotCount );
+    assert( oIndex.IsInitialized() && oIndex.GetSlotCount() == eSlotCount );
+
+    // Insertion, up to the load limit
+    printf( "Inserting into hash index...\n" );
+    for ( unsigned i = 0; i < eObjectCount; ++i )
+    {
+        assert( oIndex.Add(& pObjects[i]) );
+    }
+
+    assert( ! oIndex.Add(& pObjects[eObjectCount]) );
+    assert( oIndex.Count() == eObjectCount );
+
+    for ( unsigned i = 0; i < eObjectCount; ++i )
+    {
+        assert( Find(oIndex, i) == & pObjects[i] );
+    }
+
+    assert( Find(oIndex, eObjectCount) == NULL );
+
+    // Random removal, checking that everything left can still be found
+    enum { eRandomTrials = 16 };
+    printf( "Starting %d random hash index removal tests\n", eRandomTrials );
+
+    for ( unsigned nTrial = 0; nTrial < eRandomTrials; ++nTrial )
+    {
+        bool pIndexed[ eObjectCount ];
+        oIndex.Clear();
+
+        for ( unsigned i = 0; i < eObjectCount; ++i )
+        {
+            pIndexed[i] = oIndex.Add( & pObjects[i] );
+            assert( pIndexed[i] );
+        }
+
+        const unsigned nRemove = rand() % eObjectCount + 1;
+
+        for ( unsigned j = 0; j < nRemove; ++j )
+        {
+            const unsigned nObject = rand() % eObjectCount;
+            assert( oIndex.Remove(& pObjects[nObject]) == pIndexed[nObject] );
+            pIndexed[nObject] = false;
+
+            for ( unsigned i = 0; i < eObjectCount; ++i )
+            {
+                assert( Find(oIndex, i) == (pIndexed[i] ? & pObjects[i] : NULL) );
+            }
+        }
+    }
+
+    // Objects that share a key
+    oIndex.Clear();
+    TestObject oTwin = pObjects[3];
+    assert( oIndex.Add(& pObjects[3]) && oIndex.Add(& oTwin) );
+    assert( Find(oIndex, 3) == & pObjects[3] );
+    assert( oIndex.Remove(& pObjects[3]) );
+    assert( Find(oIndex, 3) == & oTwin );
+    assert( oIndex.Remove(& oTwin) && oIndex.Count() == 0 );
+
+    oIndex.Init( NULL, 0 );
+    assert( ! oIndex.IsInitialized() && Find(oIndex, 3) == NULL );
+}
@@ -0,0 +1,340 @@
+#ifndef _JL_INTRUSIVE_DOUBLY_LINKED_LIST_H_
+#define _JL_INTRUSIVE_DOUBLY_LINKED_LIST_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+
+namespace jl {
+
+/**
+ * Link pointers for an intrusive list. Embed one of these in every object that
+ * should be stored in an IntrusiveDoublyLinkedList. An object can belong to as
+ * many lists at once as it has hooks.
+ */
+template<typename _T>
+struct IntrusiveListHook
+{
+    IntrusiveListHook() : prev(NULL), next(NULL) {}
+
+    _T* prev;
+    _T* next;
+};
+
+/**
+ * A doubly-linked list whose link pointers live inside the contained objects,
+ * e.g.:
+ *
+ *   class Foo
+ *   {
+ *   public:
+ *       IntrusiveListHook<Foo> m_oHook;
+ *   };
+ *
+ *   IntrusiveDoublyLinkedList< Foo, &Foo::m_oHook > oList;
+ *
+ * The list never copies or allocates; it only links and unlinks objects that
+ * are owned elsewhere, so an object must stay alive for as long as it is in a
+ * list. Adding and removing are O(1), including removal by object pointer.
+ */
+template<typename _T, IntrusiveListHook<_T> _T::*_Hook>
+class IntrusiveDoublyLinkedList
+{
+public:
+
+    //////////////////
+    // Data structures
+    //////////////////
+
+    typedef _T TObject;
+    typedef IntrusiveListHook<_T> THook;
+
+    class iterator
+    {
+    public:
+        TObject& operator*()
+        {
+            return *m_pCurrent;
+        }
+
+        TObject* operator->()
+        {
+            return m_pCurrent;
+        }
+
+        iterator& operator--()
+        {
+            JL_ASSERT( m_pCurrent );
+
+            if ( m_pCurrent )
+            {
+                m_pCurrent = (m_pCurrent->*_Hook).prev;
+            }
+
+            return *this;
+        }
+
+        iterator& operator++()
+        {
+            JL_ASSERT( m_pCurrent );
+
+            if ( m_pCurrent )
+            {
+                m_pCurrent = (m_pCurrent->*_Hook).next;
+            }
+
+            return *this;
+        }
+
+        bool operator==( const iterator& other ) const
+        {
+            return m_pList == other.m_pList && m_pCurrent == other.m_pCurrent;
+        }
+
+        bool isValid() const
+        {
+            return m_pList != NULL && m_pCurrent != NULL;
+        }
+
+    private:
+        friend class IntrusiveDoublyLinkedList<_T, _Hook>;
+        IntrusiveDoublyLinkedList<_T, _Hook>* m_pList;
+        TObject* m_pCurrent;
+    };
+
+    class const_iterator
+    {
+    public:
+        const TObject& operator*()
+        {
+            return *m_pCurrent;
+        }
+
+        const TObject* operator->()
+        {
+            return m_pCurrent;
+        }
+
+        const_iterator& operator--()
+        {
+            JL_ASSERT( m_pCurrent );
+
+            if ( m_pCurrent )
+            {
+                m_pCurrent = (m_pCurrent->*_Hook).prev;
+            }
+
+            return *this;
+        }
+
+        const_iterator& operator++()
+        {
+            JL_ASSERT( m_pCurrent );
+
+            if ( m_pCurrent )
+            {
+                m_pCurrent = (m_pCurrent->*_Hook).next;
+            }
+
+            return *this;
+        }
+
+        bool operator==( const const_iterator& other ) const
+        {
+            return m_pList == other.m_pList && m_pCurrent == other.m_pCurrent;
+        }
+
+        bool isValid() const
+        {
+            return m_pList != NULL && m_pCurrent != NULL;
+        }
+
+    private:
+        friend class IntrusiveDoublyLinkedList<_T, _Hook>;
+        const IntrusiveDoublyLinkedList<_T, _Hook>* m_pList;
+        const TObject* m_pCurrent;
+    };
+
+    ///////////////////
+    // Public interface
+    ///////////////////
+
+public:
+
+    IntrusiveDoublyLinkedList()
+    {
+        m_pHead = NULL;
+        m_pTail = NULL;
+        m_nObjectCount = 0;
+    }
+
+    ~IntrusiveDoublyLinkedList()
+    {
+        Clear();
+    }
+
+    // Appends an object to the end of the list. The object must not already be
+    // linked into another list through the same hook.
+    bool Add( TObject* pObject )
+    {
+        JL_ASSERT( pObject );
+        if ( ! pObject )
+        {
+            return false;
+        }
+
+        THook& oHook = pObject->*_Hook;
+        JL_ASSERT( oHook.prev == NULL && oHook.next == NULL && m_pHead != pObject );
+
+        oHook.prev = m_pTail;
+        oHook.next = NULL;
+
+        // Add object to the end of the list.
+        if ( m_pTail )
+        {
+            (m_pTail->*_Hook).next = pObject;
+            m_pTail = pObject;
+        }
+        else
+        {
+            JL_ASSERT( ! m_pHead );
+            m_pHead = pObject;
+            m_pTail = pObject;
+        }
+
+        // Update object count
+        m_nObjectCount += 1;
+
+        return true;
+    }
+
+    // Returns true if the object was successfully removed. The object must be
+    // in this list.
+    bool Remove( TObject* pObject )
+    {
+        return RemoveObject( pObject );
+    }
+
+    // Returns true if the object at the iterator position was successfully removed
+    // This will advance the iterator if the removal was successful.
+    bool Remove( iterator& i )
+    {
+        JL_ASSERT( i.m_pList == this );
+        if ( i.m_pList != this )
+        {
+            return false;
+        }
+
+        TObject* pNext = (i.m_pCurrent->*_Hook).next;
+        if ( RemoveObject(i.m_pCurrent) )
+        {
+            i.m_pCurrent = pNext;
+            return true;
+        }
+
+        return false;
+    }
+
+    unsigned Count() const
+    {
+        return m_nObjectCount;
+    }
+
+    unsigned IsEmpty() const
+    {
+        return m_nObjectCount == 0;
+    }
+
+    // Unlinks every object. No objects are destroyed.
+    void Clear()
+    {
+        TObject* pCurrent = NULL;
+        TObject* pNext = m_pHead;
+
+        while ( pNext )
+        {
+            pCurrent = pNext;
+            pNext = (pCurrent->*_Hook).next;
+
+            (pCurrent->*_Hook).prev = NULL;
+            (pCurrent->*_Hook).next = NULL;
+        }
+
+        m_pHead = NULL;
+        m_pTail = NULL;
+        m_nObjectCount = 0;
+    }
+
+    TObject* GetHead() { return m_pHead; }
+    const TObject* GetHead() const { return m_pHead; }
+    TObject* GetTail() { return m_pTail; }
+    const TObject* GetTail() const { return m_pTail; }
+
+    // Iterator interface
+    iterator begin()
+    {
+        iterator i;
+        i.m_pList = this;
+        i.m_pCurrent = m_pHead;
+        return i;
+    }
+
+    const_iterator const_begin() const
+    {
+        const_iterator i;
+        i.m_pList = this;
+        i.m_pCurrent = m_pHead;
+        return i;
+    }
+
+private:
+    bool RemoveObject( TObject* pObject )
+    {
+        JL_ASSERT( m_nObjectCount );
+        if ( ! m_nObjectCount || ! pObject )
+        {
+            return false;
+        }
+
+        THook& oHook = pObject->*_Hook;
+        JL_ASSERT( oHook.prev || m_pHead == pObject );
+
+        // Re-assign head/tail pointers, if necessary
+        if ( m_pHead == pObject )
+        {
+            m_pHead = oHook.next;
+        }
+
+        if ( m_pTail == pObject )
+        {
+            m_pTail = oHook.prev;
+        }
+
+        // Reassign links between previous/next objects
+        if ( oHook.prev )
+        {
+            (oHook.prev->*_Hook).next = oHook.next;
+        }
+
+        if ( oHook.next )
+        {
+            (oHook.next->*_Hook).prev = oHook.prev;
+        }
+
+        oHook.prev = NULL;
+        oHook.next = NULL;
+
+        // Update object count
+        m_nObjectCount -= 1;
+
+        return true;
+    }
+
+    TObject* m_pHead;
+    TObject* m_pTail;
+    unsigned m_nObjectCount;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_INTRUSIVE_DOUBLY_LINKED_LIST_H_ )
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "IntrusiveDoublyLinkedList.h"
+
+using namespace jl;
+
+namespace
+{
+    // Objects that can be linked into two lists at once.
+    class TestObject
+    {
+    public:
+        TestObject() : m_pName(NULL) {}
+
+        const char* m_pName;
+        IntrusiveListHook<TestObject> m_oPrimaryHook;
+        IntrusiveListHook<TestObject> m_oSecondaryHook;
+    };
+
+    typedef IntrusiveDoublyLinkedList< TestObject, &TestObject::m_oPrimaryHook > PrimaryList;
+    typedef IntrusiveDoublyLinkedList< TestObject, &TestObject::m_oSecondaryHook > SecondaryList;
+}
+
+void IntrusiveDoublyLinkedListTest()
+{
+    const char* pTestStrings[] =
+    {
+        "Test 1",
+        "Test 2",
+        "Test 3",
+        "Test 4",
+        "Test 5",
+        "Test 6",
+        "Test 7",
+        "Test 8",
+        "Test 9",
+        "Test 10",
+        "Test 11",
+        "Test 12",
+        "Test 13",
+        "Test 14",
+        "Test 15",
+        "Test 16",
+    };
+
+    TestObject pObjects[ JL_ARRAY_SIZE(pTestStrings) ];
+
+    for ( unsigned i = 0; i < JL_ARRAY_SIZE(pTestStrings); ++i )
+    {
+        pObjects[i].m_pName = pTestStrings[i];
+    }
+
+    PrimaryList oList;
+    SecondaryList oOddList;
+
+    // Insertion test
+    printf( "Inserting intrusive objects...\n" );
+    for ( unsigned i = 0; i < JL_ARRAY_SIZE(pObjects); ++i )
+    {
+        assert( oList.Add(& pObjects[i]) );
+
+        if ( i % 2 == 1 )
+        {
+            assert( oOddList.Add(& pObjects[i]) );
+        }
+    }
+
+    // Test object count
+    assert( oList.Count() == JL_ARRAY_SIZE(pObjects) );
+    assert( oOddList.Count() == JL_ARRAY_SIZE(pObjects) / 2 );
+
+    // Iterator test
+    printf( "Iterating through intrusive list...\n" );
+    unsigned nIndex = 0;
+    for ( PrimaryList::iterator i = oList.begin(); i.isValid(); ++i, ++nIndex )
+    {
+        printf( "\tObject: %s\n", i->m_pName );
+        assert( & (*i) == & pObjects[nIndex] );
+    }
+
+    // Pointer-based removal
+    printf( "Pointer-based removal...\n" );
+
+    for ( unsigned i = 0; i < JL_ARRAY_SIZE(pObjects); i += 2 )
+    {
+        printf( "\tRemoving: %s\n", pObjects[i].m_pName );
+        assert( oList.Remove(& pObjects[i]) );
+    }
+
+    // Removal from one list must leave the other list alone
+    assert( oList.Count() == JL_ARRAY_SIZE(pObjects) / 2 );
+    assert( oOddList.Count() == JL_ARRAY_SIZE(pObjects) / 2 );
+
+    nIndex = 1;
+    for ( SecondaryList::const_iterator i = oOddList.const_begin(); i.isValid(); ++i, nIndex += 2 )
+    {
+        assert( & (*i) == & pObjects[nIndex] );
+    }
+
+    // Iterator-based removal
+    printf( "Iterator-based removal...\n" );
+
+    for ( PrimaryList::iterator i = oList.begin(); i.isValid(); )
+    {
+        printf( "\tRemoving: %s\n", i->m_pName );
+        assert( oList.Remove(i) );
+    }
+
+    assert( oList.Count() == 0 );
+    assert( oList.GetHead() == NULL && oList.GetTail() == NULL );
+
+    // Clearing unlinks objects so they can be added again
+    oOddList.Clear();
+    assert( oOddList.Count() == 0 );
+
+    // Random removal
+    enum { eRandomTrials = 16 };
+    printf( "\nStarting %d random intrusive removal tests\n", eRandomTrials );
+
+    for ( unsigned i = 0; i < eRandomTrials; ++i )
+    {
+        const unsigned nInsert = ( rand() % JL_ARRAY_SIZE(pObjects) ) + 1;
+        const unsigned nRemove = ( rand() % nInsert ) + 1;
+
+        printf( "\tTrial %d: inserting %d objects and removing %d objects\n", i + 1, nInsert, nRemove );
+
+        for ( unsigned j = 0; j < nInsert; ++j )
+        {
+            assert( oList.Add(& pObjects[j]) );
+        }
+
+        for ( unsigned j = 0; j < nRemove; ++j )
+        {
+            // Create iterator and seek to random position
+            const unsigned nSeek = rand() % oList.Count();
+            PrimaryList::iterator iter = oList.begin();
+
+            for ( unsigned k = 0; k < nSeek; ++k )
+            {
+                ++iter;
+            }
+
+            printf( "\t\tRemoving item ID%d: %s\n", nSeek, iter->m_pName );
+            assert( oList.Remove(iter) );
+        }
+
+        // Walk the list both ways to make sure the links are consistent
+        unsigned nForward = 0;
+        for ( const TestObject* p = oList.GetHead(); p; p = p->m_oPrimaryHook.next )
+        {
+            ++nForward;
+        }
+
+        unsigned nBackward = 0;
+        for ( const TestObject* p = oList.GetTail(); p; p = p->m_oPrimaryHook.prev )
+        {
+            ++nBackward;
+        }
+
+        const unsigned nCount = nInsert - nRemove;
+        assert( oList.Count() == nCount );
+        assert( nForward == nCount && nBackward == nCount );
+
+        oList.Clear();
+        assert( oList.Count() == 0 );
+    }
+}
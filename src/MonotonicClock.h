@@ -0,0 +1,65 @@
+#ifndef _JL_MONOTONIC_CLOCK_H_
+#define _JL_MONOTONIC_CLOCK_H_
+
+#include "Utils.h"
+
+#if __cplusplus >= 201103L
+#include <chrono>
+#endif
+
+namespace jl {
+
+/**
+ * A source of time for classes that act on intervals, such as ThrottledSignal.
+ * Times are in seconds, from an arbitrary starting point, and never decrease.
+ */
+class MonotonicClock
+{
+public:
+    virtual ~MonotonicClock() {}
+    virtual double GetSeconds() const = 0;
+};
+
+/**
+ * A clock that only moves when told to. Use this for deterministic tests, or to
+ * drive time-based signals from a game clock that can pause or scale.
+ */
+class ManualClock : public MonotonicClock
+{
+public:
+    explicit ManualClock( double fSeconds = 0.0 ) : m_fSeconds(fSeconds) {}
+    
+    virtual double GetSeconds() const { return m_fSeconds; }
+    
+    void SetSeconds( double fSeconds )
+    {
+        JL_ASSERT( fSeconds >= m_fSeconds );
+        m_fSeconds = fSeconds;
+    }
+    
+    void Advance( double fSeconds )
+    {
+        JL_ASSERT( fSeconds >= 0.0 );
+        m_fSeconds += fSeconds;
+    }
+    
+private:
+    double m_fSeconds;
+};
+
+#if __cplusplus >= 201103L
+// Wall-clock time from std::chrono::steady_clock
+class SteadyClock : public MonotonicClock
+{
+public:
+    virtual double GetSeconds() const
+    {
+        const std::chrono::duration<double> oSeconds = std::chrono::steady_clock::now().time_since_epoch();
+        return oSeconds.count();
+    }
+};
+#endif
+
+} // namespace jl
+
+#endif // ! defined( _JL_MONOTONIC_CLOCK_H_ )
@@ -1,6 +1,7 @@
 #include <stddef.h>
 
 #include "ObjectPool.h"
+#include "VirtualMemory.h"
 
 namespace jl {
     // Some helper routines
@@ -54,6 +55,38 @@ namespace jl {
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+unsigned jl::ObjectPool::AllocN( FreeNode*& pFreeListHead, void** ppObjects, unsigned nCount )
+{
+    FreeNode* pNode = pFreeListHead;
+    unsigned n = 0;
+
+    for ( ; n < nCount && pNode; ++n )
+    {
+        ppObjects[n] = pNode;
+        pNode = pNode->pNextFree;
+    }
+
+    pFreeListHead = pNode;
+    return n;
+}
+
+void jl::ObjectPool::FreeN( void** ppObjects, unsigned nCount, FreeNode*& pFreeListHead )
+{
+    if ( nCount == 0 )
+    {
+        return;
+    }
+
+    // Chain the batch together, then splice it in front of the free list
+    for ( unsigned i = 0; i + 1 < nCount; ++i )
+    {
+        FreeNode::Cast( ppObjects[i] )->pNextFree = FreeNode::Cast( ppObjects[i + 1] );
+    }
+
+    FreeNode::Cast( ppObjects[nCount - 1] )->pNextFree = pFreeListHead;
+    pFreeListHead = FreeNode::Cast( ppObjects[0] );
+}
+
 // Initializes an object buffer as a free list and returns the head of the list
 jl::ObjectPool::FreeNode* jl::ObjectPool::InitFreeList( unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride )
 {
@@ -106,6 +139,209 @@ bool jl::ObjectPool::IsFree( const void* pObject, const FreeNode* pFreeListHead
     return false;
 }
 
+void jl::ObjectPool::InitBitmap( unsigned* pBitmap, unsigned nCapacity )
+{
+    const unsigned nWords = GetBitmapWordCount( nCapacity );
+
+    for ( unsigned i = 0; i < nWords; ++i )
+    {
+        pBitmap[i] = 0;
+    }
+}
+
+unsigned jl::ObjectPool::FindNextAllocatedSlot( const unsigned* pBitmap, unsigned nCapacity, unsigned nFirstSlot )
+{
+    if ( nFirstSlot >= nCapacity )
+    {
+        return nCapacity;
+    }
+
+    const unsigned nWords = GetBitmapWordCount( nCapacity );
+    unsigned nWord = nFirstSlot / eBitmapWordBits;
+
+    // Mask off the bits below the starting slot in the first word
+    unsigned nBits = pBitmap[nWord] & ( ~0u << (nFirstSlot % eBitmapWordBits) );
+
+    for (;;)
+    {
+        if ( nBits )
+        {
+            const unsigned nSlot = nWord * eBitmapWordBits + CountTrailingZeros( nBits );
+            return nSlot < nCapacity ? nSlot : nCapacity;
+        }
+
+        if ( ++nWord >= nWords )
+        {
+            return nCapacity;
+        }
+
+        nBits = pBitmap[nWord];
+    }
+}
+
+bool jl::ObjectPool::IsAllocated( const void* pObject, const unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride, const unsigned* pBitmap )
+{
+    return IsBoundedAndAligned( pObject, pObjectBuffer, nCapacity, nStride )
+        && IsSlotAllocated( pBitmap, GetSlotIndex(pObject, pObjectBuffer, nStride) );
+}
+
+void* jl::ObjectPool::GetFirstAllocation( unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride, const unsigned* pBitmap )
+{
+    const unsigned nSlot = FindNextAllocatedSlot( pBitmap, nCapacity, 0 );
+    return nSlot < nCapacity ? pObjectBuffer + nSlot * nStride : NULL;
+}
+
+void* jl::ObjectPool::GetNextAllocation( const void* pPrevious, unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride, const unsigned* pBitmap )
+{
+    JL_ASSERT( IsBoundedAndAligned(pPrevious, pObjectBuffer, nCapacity, nStride) );
+    const unsigned nSlot = FindNextAllocatedSlot( pBitmap, nCapacity, GetSlotIndex(pPrevious, pObjectBuffer, nStride) + 1 );
+    return nSlot < nCapacity ? pObjectBuffer + nSlot * nStride : NULL;
+}
+
+unsigned jl::ObjectPool::AllocLowestSlot( unsigned* pBitmap, unsigned* pSummary, unsigned nCapacity, unsigned& nSummaryHint )
+{
+    const unsigned nWords = GetBitmapWordCount( nCapacity );
+    const unsigned nSummaryWords = GetBitmapWordCount( nWords );
+
+    // Skip summary words whose bitmap words are all full
+    while ( nSummaryHint < nSummaryWords && pSummary[nSummaryHint] == ~0u )
+    {
+        ++nSummaryHint;
+    }
+
+    if ( nSummaryHint >= nSummaryWords )
+    {
+        return nCapacity;
+    }
+
+    // Bits past the end of the bitmap are never set, so they look like free
+    // slots. They are always higher than any real slot, though, so finding one
+    // means the pool is full.
+    const unsigned nWord = nSummaryHint * eBitmapWordBits + CountTrailingZeros( ~pSummary[nSummaryHint] );
+    if ( nWord >= nWords )
+    {
+        return nCapacity;
+    }
+
+    const unsigned nSlot = nWord * eBitmapWordBits + CountTrailingZeros( ~pBitmap[nWord] );
+    if ( nSlot >= nCapacity )
+    {
+        return nCapacity;
+    }
+
+    pBitmap[nWord] |= ( 1u << (nSlot % eBitmapWordBits) );
+
+    if ( pBitmap[nWord] == ~0u )
+    {
+        MarkSlotAllocated( pSummary, nWord );
+    }
+
+    return nSlot;
+}
+
+void jl::ObjectPool::FreeOrderedSlot( unsigned* pBitmap, unsigned* pSummary, unsigned nSlot, unsigned& nSummaryHint )
+{
+    const unsigned nWord = nSlot / eBitmapWordBits;
+
+    MarkSlotFree( pBitmap, nSlot );
+    MarkSlotFree( pSummary, nWord );
+
+    const unsigned nSummaryWord = nWord / eBitmapWordBits;
+    if ( nSummaryWord < nSummaryHint )
+    {
+        nSummaryHint = nSummaryWord;
+    }
+}
+
+unsigned jl::ObjectPool::AllocLowestSlots( unsigned* pBitmap, unsigned* pSummary, unsigned nCapacity, unsigned& nSummaryHint,
+                                           unsigned char* pObjectBuffer, unsigned nStride, void** ppObjects, unsigned nCount )
+{
+    const unsigned nWords = GetBitmapWordCount( nCapacity );
+    const unsigned nSummaryWords = GetBitmapWordCount( nWords );
+    unsigned n = 0;
+
+    while ( n < nCount )
+    {
+        while ( nSummaryHint < nSummaryWords && pSummary[nSummaryHint] == ~0u )
+        {
+            ++nSummaryHint;
+        }
+
+        if ( nSummaryHint >= nSummaryWords )
+        {
+            break;
+        }
+
+        const unsigned nWord = nSummaryHint * eBitmapWordBits + CountTrailingZeros( ~pSummary[nSummaryHint] );
+        if ( nWord >= nWords )
+        {
+            break;
+        }
+
+        // Take as many of this word's free slots as we need, lowest first
+        unsigned nBits = pBitmap[nWord];
+        unsigned nFree = ~nBits;
+
+        while ( nFree && n < nCount )
+        {
+            const unsigned nBit = CountTrailingZeros( nFree );
+            const unsigned nSlot = nWord * eBitmapWordBits + nBit;
+
+            if ( nSlot >= nCapacity )
+            {
+                break;
+            }
+
+            nBits |= ( 1u << nBit );
+            nFree &= nFree - 1;
+            ppObjects[n++] = pObjectBuffer + nSlot * nStride;
+        }
+
+        pBitmap[nWord] = nBits;
+
+        if ( nBits == ~0u )
+        {
+            MarkSlotAllocated( pSummary, nWord );
+        }
+        else if ( n < nCount )
+        {
+            // Only the slots past the end of the pool are left
+            break;
+        }
+    }
+
+    return n;
+}
+
+void jl::ObjectPool::MarkSlotsAllocated( unsigned* pBitmap, void* const* ppObjects, unsigned nCount, const unsigned char* pObjectBuffer, unsigned nStride )
+{
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        MarkSlotAllocated( pBitmap, GetSlotIndex(ppObjects[i], pObjectBuffer, nStride) );
+    }
+}
+
+void jl::ObjectPool::MarkSlotsFree( unsigned* pBitmap, void* const* ppObjects, unsigned nCount, const unsigned char* pObjectBuffer, unsigned nStride )
+{
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        const unsigned nSlot = GetSlotIndex( ppObjects[i], pObjectBuffer, nStride );
+        JL_ASSERT( IsAligned(ppObjects[i], pObjectBuffer, nStride) && IsSlotAllocated(pBitmap, nSlot) );
+        MarkSlotFree( pBitmap, nSlot );
+    }
+}
+
+void jl::ObjectPool::FreeOrderedSlots( unsigned* pBitmap, unsigned* pSummary, unsigned& nSummaryHint,
+                                       void* const* ppObjects, unsigned nCount, const unsigned char* pObjectBuffer, unsigned nStride )
+{
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        const unsigned nSlot = GetSlotIndex( ppObjects[i], pObjectBuffer, nStride );
+        JL_ASSERT( IsAligned(ppObjects[i], pObjectBuffer, nStride) && IsSlotAllocated(pBitmap, nSlot) );
+        FreeOrderedSlot( pBitmap, pSummary, nSlot, nSummaryHint );
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -122,10 +358,7 @@ jl::PreallocatedObjectPool::PreallocatedObjectPool( void* pBuffer, unsigned nCap
 
 jl::PreallocatedObjectPool::~PreallocatedObjectPool()
 {
-    if ( m_nFlags & eFlag_ManageBuffer )
-    {
-        delete[] m_pObjectBuffer;
-    }
+    ReleaseBuffers();
 }
 
 void jl::PreallocatedObjectPool::Init( void* pBuffer, unsigned nCapacity, unsigned nStride, unsigned nFlags /*= eFlag_Default */ )
@@ -133,20 +366,79 @@ void jl::PreallocatedObjectPool::Init( void* pBuffer, unsigned nCapacity, unsign
     JL_ASSERT( m_pObjectBuffer == NULL );
 
     m_pObjectBuffer = (unsigned char*)pBuffer;
-    m_pFreeListHead = ObjectPool::InitFreeList( m_pObjectBuffer, nCapacity, nStride );
+    m_pFreeListHead = NULL;
+    m_pAllocationBitmap = NULL;
+    m_pSummaryBitmap = NULL;
+    m_nSummaryHint = 0;
+    m_nCarvedSlots = nCapacity;
+    m_nCommittedSlots = nCapacity;
+    m_nReservedBytes = 0;
+    m_nCommittedBytes = 0;
+    m_nCommitGranularity = 0;
+    m_bHugePages = false;
+
+    if ( nFlags & eFlag_VirtualMemory )
+    {
+        JL_ASSERT( pBuffer == NULL );
+        nFlags &= ~eFlag_ManageBuffer;
+
+        unsigned nVirtualMemoryFlags = 0;
+        if ( ( nFlags & eFlag_TransparentHugePages ) == eFlag_TransparentHugePages )
+        {
+            nVirtualMemoryFlags |= VirtualMemory::eFlag_TransparentHugePages;
+        }
+
+        if ( ( nFlags & eFlag_ExplicitHugePages ) == eFlag_ExplicitHugePages )
+        {
+            nVirtualMemoryFlags |= VirtualMemory::eFlag_ExplicitHugePages;
+        }
+
+        m_nReservedBytes = size_t(nCapacity) * nStride;
+        m_pObjectBuffer = (unsigned char*)VirtualMemory::Reserve( m_nReservedBytes, nVirtualMemoryFlags, m_nCommitGranularity, m_bHugePages );
+        JL_ASSERT( m_pObjectBuffer );
+
+        if ( ! m_pObjectBuffer )
+        {
+            Reset();
+            return;
+        }
+
+        m_nCarvedSlots = 0;
+        m_nCommittedSlots = 0;
+    }
+
+    if ( nFlags & eFlag_TrackAllocations )
+    {
+        // The summary, if any, shares an allocation with the bitmap.
+        const unsigned nBitmapWords = ObjectPool::GetBitmapWordCount( nCapacity );
+        const bool bAddressOrdered = ( nFlags & eFlag_AddressOrdered ) == eFlag_AddressOrdered;
+        const unsigned nSummaryWords = bAddressOrdered ? ObjectPool::GetSummaryWordCount( nCapacity ) : 0;
+
+        m_pAllocationBitmap = new unsigned[ nBitmapWords + nSummaryWords ];
+        ObjectPool::InitBitmap( m_pAllocationBitmap, nCapacity );
+
+        if ( bAddressOrdered )
+        {
+            m_pSummaryBitmap = m_pAllocationBitmap + nBitmapWords;
+            ObjectPool::InitBitmap( m_pSummaryBitmap, nBitmapWords );
+        }
+    }
+
+    // Virtual memory pools build their free list as they go
+    if ( ! m_pSummaryBitmap && m_nCarvedSlots == nCapacity )
+    {
+        m_pFreeListHead = ObjectPool::InitFreeList( m_pObjectBuffer, nCapacity, nStride );
+    }
 
     m_nCapacity = nCapacity;
     m_nStride = nStride;
+    m_nAllocations = 0;
     m_nFlags = nFlags;
 }
 
 void jl::PreallocatedObjectPool::Deinit()
 {
-    if ( m_nFlags & eFlag_ManageBuffer )
-    {
-        delete[] m_pObjectBuffer;
-    }
-
+    ReleaseBuffers();
     Reset();
 }
 
@@ -154,9 +446,158 @@ void jl::PreallocatedObjectPool::Reset()
 {
     m_pObjectBuffer = NULL;
     m_pFreeListHead = NULL;
+    m_pAllocationBitmap = NULL;
+    m_pSummaryBitmap = NULL;
+    m_nSummaryHint = 0;
 
     m_nCapacity = 0;
     m_nAllocations = 0;
     m_nStride = 0;
     m_nFlags = 0;
+
+    m_nCarvedSlots = 0;
+    m_nCommittedSlots = 0;
+    m_nReservedBytes = 0;
+    m_nCommittedBytes = 0;
+    m_nCommitGranularity = 0;
+    m_bHugePages = false;
+}
+
+void jl::PreallocatedObjectPool::ReleaseBuffers()
+{
+    if ( m_nFlags & eFlag_VirtualMemory )
+    {
+        VirtualMemory::Release( m_pObjectBuffer, m_nReservedBytes );
+    }
+    else if ( m_nFlags & eFlag_ManageBuffer )
+    {
+        delete[] m_pObjectBuffer;
+    }
+
+    delete[] m_pAllocationBitmap;
+}
+
+unsigned jl::PreallocatedObjectPool::AllocN( void** ppObjects, unsigned nCount )
+{
+    JL_ASSERT( m_pObjectBuffer );
+    unsigned n;
+
+    if ( m_pSummaryBitmap )
+    {
+        n = ObjectPool::AllocLowestSlots( m_pAllocationBitmap, m_pSummaryBitmap, m_nCapacity, m_nSummaryHint, m_pObjectBuffer, m_nStride, ppObjects, nCount );
+
+        // Slots are ascending, so only the last one can be past the committed range
+        if ( n > 0 )
+        {
+            const unsigned nLastSlot = ObjectPool::GetSlotIndex( ppObjects[n - 1], m_pObjectBuffer, m_nStride );
+
+            if ( nLastSlot >= m_nCommittedSlots && ! CommitSlot(nLastSlot) )
+            {
+                // Hand back whatever isn't backed by memory
+                unsigned nCommitted = n;
+                while ( nCommitted > 0 && ObjectPool::GetSlotIndex(ppObjects[nCommitted - 1], m_pObjectBuffer, m_nStride) >= m_nCommittedSlots )
+                {
+                    --nCommitted;
+                }
+
+                ObjectPool::FreeOrderedSlots( m_pAllocationBitmap, m_pSummaryBitmap, m_nSummaryHint, ppObjects + nCommitted, n - nCommitted, m_pObjectBuffer, m_nStride );
+                n = nCommitted;
+            }
+        }
+    }
+    else
+    {
+        n = ObjectPool::AllocN( m_pFreeListHead, ppObjects, nCount );
+
+        for ( ; n < nCount && m_nCarvedSlots < m_nCapacity; ++n )
+        {
+            ppObjects[n] = CarveSlot();
+
+            if ( ! ppObjects[n] )
+            {
+                break;
+            }
+        }
+
+        if ( m_pAllocationBitmap )
+        {
+            ObjectPool::MarkSlotsAllocated( m_pAllocationBitmap, ppObjects, n, m_pObjectBuffer, m_nStride );
+        }
+    }
+
+    m_nAllocations += n;
+    return n;
+}
+
+void jl::PreallocatedObjectPool::FreeN( void** ppObjects, unsigned nCount )
+{
+    JL_ASSERT( m_pObjectBuffer );
+    JL_ASSERT( nCount <= m_nAllocations );
+
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        JL_ASSERT( ObjectPool::IsBoundedAndAligned(ppObjects[i], m_pObjectBuffer, m_nCapacity, m_nStride) );
+#ifdef JL_OBJECT_POOL_ENABLE_FREELIST_CHECK
+        JL_ASSERT( m_pAllocationBitmap || ! ObjectPool::IsFree(ppObjects[i], m_pFreeListHead) );
+#endif
+    }
+
+    if ( m_pSummaryBitmap )
+    {
+        ObjectPool::FreeOrderedSlots( m_pAllocationBitmap, m_pSummaryBitmap, m_nSummaryHint, ppObjects, nCount, m_pObjectBuffer, m_nStride );
+    }
+    else
+    {
+        if ( m_pAllocationBitmap )
+        {
+            ObjectPool::MarkSlotsFree( m_pAllocationBitmap, ppObjects, nCount, m_pObjectBuffer, m_nStride );
+        }
+
+        ObjectPool::FreeN( ppObjects, nCount, m_pFreeListHead );
+    }
+
+    m_nAllocations -= nCount;
+}
+
+bool jl::PreallocatedObjectPool::CommitSlot( unsigned nSlot )
+{
+    JL_ASSERT( m_nFlags & eFlag_VirtualMemory );
+    JL_ASSERT( nSlot >= m_nCommittedSlots && nSlot < m_nCapacity );
+
+    // Commit at least eMinCommitBytes past the end of the slot
+    size_t nTarget = ( size_t(nSlot) + 1 ) * m_nStride;
+    if ( nTarget < m_nCommittedBytes + eMinCommitBytes )
+    {
+        nTarget = m_nCommittedBytes + eMinCommitBytes;
+    }
+
+    nTarget = ( nTarget + m_nCommitGranularity - 1 ) / m_nCommitGranularity * m_nCommitGranularity;
+    if ( nTarget > m_nReservedBytes )
+    {
+        nTarget = m_nReservedBytes;
+    }
+
+    if ( ! VirtualMemory::Commit(m_pObjectBuffer + m_nCommittedBytes, nTarget - m_nCommittedBytes) )
+    {
+        return false;
+    }
+
+    m_nCommittedBytes = nTarget;
+
+    const size_t nCommittedSlots = nTarget / m_nStride;
+    m_nCommittedSlots = nCommittedSlots < m_nCapacity ? (unsigned)nCommittedSlots : m_nCapacity;
+
+    return true;
+}
+
+void* jl::PreallocatedObjectPool::CarveSlot()
+{
+    JL_ASSERT( m_nCarvedSlots < m_nCapacity );
+
+    if ( m_nCarvedSlots >= m_nCommittedSlots && ! CommitSlot(m_nCarvedSlots) )
+    {
+        return NULL;
+    }
+
+    return m_pObjectBuffer + m_nCarvedSlots++ * m_nStride;
 }
@@ -1,6 +1,8 @@
 #ifndef _JL_OBJECTPOOL_H_
 #define _JL_OBJECTPOOL_H_
 
+#include <stddef.h>
+
 #include "Utils.h"
 
 //#define JL_OBJECT_POOL_ENABLE_FREELIST_CHECK
@@ -24,11 +26,61 @@ namespace jl {
  * CON:
  *    No support for array-new allocation
  *    Free()/Destroy() requires knowledge of which pool a pointer was allocated from
+ *
+ * Pools created with the eFlag_TrackAllocations flag also keep a bitmap with one
+ * bit per slot. This costs Capacity / 8 bytes, and buys O(1) double-free and
+ * foreign-pointer detection in Free(), as well as fast iteration over every live
+ * object via GetFirstAllocation()/GetNextAllocation().
+ *
+ * By default, the free list is LIFO, so after enough alloc/free churn, objects
+ * that were allocated together end up scattered across the buffer. Pools created
+ * with the eFlag_AddressOrdered flag ignore the free list and always hand out the
+ * lowest free slot instead, using the allocation bitmap plus a summary with one
+ * bit per full bitmap word. Allocation is still effectively constant time, and
+ * objects allocated together stay in ascending address order.
+ *
+ * When objects in neighbouring slots are written by different threads, they
+ * can share cache lines, and every write by one thread evicts the line from the
+ * other threads' caches. StaticObjectPool takes an _Alignment parameter, e.g.
+ * ObjectPool::eCacheLineSize, that aligns the start and end of its buffer, and
+ * the eFlag_PadStride flag, which also rounds the stride up so that no two
+ * slots share a line. For a PreallocatedObjectPool, align the buffer yourself
+ * and pad the stride with ObjectPool::GetPaddedStride().
+ *
+ * A PreallocatedObjectPool created with the eFlag_VirtualMemory flag reserves
+ * its own buffer as a range of address space, and only commits memory to it as
+ * allocations reach higher slots. The eFlag_TransparentHugePages and
+ * eFlag_ExplicitHugePages flags also ask for the buffer to be backed by huge
+ * pages, which reduces TLB misses when walking connections spread across a
+ * very large pool. See VirtualMemory.h for platform support.
  */
 
 // A common implementation for our object pools.
 namespace ObjectPool
 {
+    enum
+    {
+        // Maintain an allocation bitmap. Flag values are shared with PreallocatedObjectPool.
+        eFlag_TrackAllocations = 0x02,
+
+        // Always allocate the lowest free slot. Implies eFlag_TrackAllocations.
+        eFlag_AddressOrdered = 0x04 | eFlag_TrackAllocations,
+
+        // Round the stride up to a multiple of the pool's alignment, so that
+        // every slot starts on its own aligned boundary.
+        eFlag_PadStride = 0x40,
+    };
+
+    // The usual cache line size on x86-64 and ARM64.
+    enum { eCacheLineSize = 64 };
+
+    // Rounds a stride up to a multiple of nAlignment, which must be a power of two.
+    inline unsigned GetPaddedStride( unsigned nStride, unsigned nAlignment )
+    {
+        JL_ASSERT( nAlignment > 0 && ( nAlignment & (nAlignment - 1) ) == 0 );
+        return ( nStride + nAlignment - 1 ) & ~( nAlignment - 1 );
+    }
+
     struct FreeNode
     {
         FreeNode* pNextFree;
@@ -61,6 +113,12 @@ namespace ObjectPool
         pFreeListHead = pNode;
     }
 
+    // Batch versions of Alloc() and Free(). AllocN() returns the number of objects it
+    // took, and FreeN() links the whole batch in front of the free list, so the next
+    // AllocN() hands the objects back in the same order.
+    unsigned AllocN( FreeNode*& pFreeListHead, void** ppObjects, unsigned nCount );
+    void FreeN( void** ppObjects, unsigned nCount, FreeNode*& pFreeListHead );
+
     // Initializes an object buffer as a free list and returns the head of the list
     FreeNode* InitFreeList( unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride );
     unsigned FreeListSize( FreeNode* pFreeListHead );
@@ -68,6 +126,62 @@ namespace ObjectPool
     // Returns true if an object is allocated to the given object pool
     bool IsBoundedAndAligned( const void* pObject, const unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride );
     bool IsFree( const void* pObject, const FreeNode* pFreeListHead );
+
+    // Allocation bitmap helpers. Bit N is set while slot N is allocated.
+    enum { eBitmapWordBits = 32 };
+    JL_COMPILER_ASSERT( sizeof(unsigned) * 8 == eBitmapWordBits, Unsigned_Must_Be_32_Bits );
+
+    inline unsigned GetBitmapWordCount( unsigned nCapacity ) { return ( nCapacity + eBitmapWordBits - 1 ) / eBitmapWordBits; }
+    void InitBitmap( unsigned* pBitmap, unsigned nCapacity );
+
+    inline unsigned GetSlotIndex( const void* pObject, const unsigned char* pObjectBuffer, unsigned nStride )
+    {
+        return (unsigned)( reinterpret_cast<const unsigned char*>(pObject) - pObjectBuffer ) / nStride;
+    }
+
+    inline bool IsSlotAllocated( const unsigned* pBitmap, unsigned nSlot )
+    {
+        return ( pBitmap[nSlot / eBitmapWordBits] & ( 1u << (nSlot % eBitmapWordBits) ) ) != 0;
+    }
+
+    inline void MarkSlotAllocated( unsigned* pBitmap, unsigned nSlot )
+    {
+        pBitmap[nSlot / eBitmapWordBits] |= ( 1u << (nSlot % eBitmapWordBits) );
+    }
+
+    inline void MarkSlotFree( unsigned* pBitmap, unsigned nSlot )
+    {
+        pBitmap[nSlot / eBitmapWordBits] &= ~( 1u << (nSlot % eBitmapWordBits) );
+    }
+
+    // Returns the index of the first allocated slot at or after nFirstSlot, or nCapacity if there is none.
+    unsigned FindNextAllocatedSlot( const unsigned* pBitmap, unsigned nCapacity, unsigned nFirstSlot );
+
+    // Returns true if the pointer addresses a slot that is currently allocated.
+    bool IsAllocated( const void* pObject, const unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride, const unsigned* pBitmap );
+
+    // Live-object iteration helpers. These return NULL when there are no more allocations.
+    void* GetFirstAllocation( unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride, const unsigned* pBitmap );
+    void* GetNextAllocation( const void* pPrevious, unsigned char* pObjectBuffer, unsigned nCapacity, unsigned nStride, const unsigned* pBitmap );
+
+    // Address-ordered allocation helpers. The summary has one bit per bitmap word, set while that word
+    // is full, and the hint is the first summary word that may have a clear bit.
+    inline unsigned GetSummaryWordCount( unsigned nCapacity ) { return GetBitmapWordCount( GetBitmapWordCount(nCapacity) ); }
+
+    // Marks the lowest free slot as allocated and returns its index, or returns nCapacity if the pool is full.
+    unsigned AllocLowestSlot( unsigned* pBitmap, unsigned* pSummary, unsigned nCapacity, unsigned& nSummaryHint );
+    void FreeOrderedSlot( unsigned* pBitmap, unsigned* pSummary, unsigned nSlot, unsigned& nSummaryHint );
+
+    // Allocates the nCount lowest free slots a bitmap word at a time, writing their
+    // addresses to ppObjects in ascending order. Returns the number allocated.
+    unsigned AllocLowestSlots( unsigned* pBitmap, unsigned* pSummary, unsigned nCapacity, unsigned& nSummaryHint,
+                               unsigned char* pObjectBuffer, unsigned nStride, void** ppObjects, unsigned nCount );
+
+    // Marks each object's slot as allocated or free.
+    void MarkSlotsAllocated( unsigned* pBitmap, void* const* ppObjects, unsigned nCount, const unsigned char* pObjectBuffer, unsigned nStride );
+    void MarkSlotsFree( unsigned* pBitmap, void* const* ppObjects, unsigned nCount, const unsigned char* pObjectBuffer, unsigned nStride );
+    void FreeOrderedSlots( unsigned* pBitmap, unsigned* pSummary, unsigned& nSummaryHint,
+                           void* const* ppObjects, unsigned nCount, const unsigned char* pObjectBuffer, unsigned nStride );
 };
 
 /**
@@ -82,6 +196,14 @@ class PreallocatedObjectPool
 public:
     enum {
         eFlag_ManageBuffer = 0x01,
+        eFlag_TrackAllocations = ObjectPool::eFlag_TrackAllocations,
+        eFlag_AddressOrdered = ObjectPool::eFlag_AddressOrdered,
+
+        // Reserve and own the buffer instead of using a supplied one.
+        eFlag_VirtualMemory = 0x08,
+        eFlag_TransparentHugePages = 0x10 | eFlag_VirtualMemory,
+        eFlag_ExplicitHugePages = 0x20 | eFlag_VirtualMemory,
+
         eFlag_Defaults = eFlag_ManageBuffer,
     };
     
@@ -91,7 +213,9 @@ public:
     ~PreallocatedObjectPool();
 
     // Initialize object pool with preallocated buffer. If the _ManageBuffer template parameter is set,
-    // you should allocate this buffer using an array-new.
+    // you should allocate this buffer using an array-new. If eFlag_TrackAllocations is set, the pool
+    // array-news its own allocation bitmap, which is released by Deinit(). If eFlag_VirtualMemory is
+    // set, pBuffer must be NULL; the pool reserves its own buffer, which is released by Deinit().
     void Init( void* pBuffer, unsigned nCapacity, unsigned nStride, unsigned nFlags = eFlag_Defaults );
     void Deinit();
 
@@ -99,7 +223,35 @@ public:
     void* Alloc()
     {
         JL_ASSERT( m_pObjectBuffer );
-        void* p = ObjectPool::Alloc( m_pFreeListHead );
+        void* p;
+
+        if ( m_pSummaryBitmap )
+        {
+            const unsigned nSlot = ObjectPool::AllocLowestSlot( m_pAllocationBitmap, m_pSummaryBitmap, m_nCapacity, m_nSummaryHint );
+
+            if ( nSlot >= m_nCommittedSlots && nSlot < m_nCapacity && ! CommitSlot(nSlot) )
+            {
+                ObjectPool::FreeOrderedSlot( m_pAllocationBitmap, m_pSummaryBitmap, nSlot, m_nSummaryHint );
+                return NULL;
+            }
+
+            p = nSlot < m_nCapacity ? m_pObjectBuffer + nSlot * m_nStride : NULL;
+        }
+        else
+        {
+            p = ObjectPool::Alloc( m_pFreeListHead );
+
+            // Slots of a virtual memory pool join the free list as they are first used
+            if ( ! p && m_nCarvedSlots < m_nCapacity )
+            {
+                p = CarveSlot();
+            }
+
+            if ( p && m_pAllocationBitmap )
+            {
+                ObjectPool::MarkSlotAllocated( m_pAllocationBitmap, ObjectPool::GetSlotIndex(p, m_pObjectBuffer, m_nStride) );
+            }
+        }
 
         if ( p )
         {
@@ -114,14 +266,60 @@ public:
     {
         JL_ASSERT( m_pObjectBuffer );
         JL_ASSERT( ObjectPool::IsBoundedAndAligned(pObject, m_pObjectBuffer, m_nCapacity, m_nStride) );
+
+        if ( m_pAllocationBitmap )
+        {
+            const unsigned nSlot = ObjectPool::GetSlotIndex( pObject, m_pObjectBuffer, m_nStride );
+            JL_ASSERT( ObjectPool::IsSlotAllocated(m_pAllocationBitmap, nSlot) );
+
+            if ( m_pSummaryBitmap )
+            {
+                ObjectPool::FreeOrderedSlot( m_pAllocationBitmap, m_pSummaryBitmap, nSlot, m_nSummaryHint );
+                m_nAllocations--;
+                return;
+            }
+
+            ObjectPool::MarkSlotFree( m_pAllocationBitmap, nSlot );
+        }
 #ifdef JL_OBJECT_POOL_ENABLE_FREELIST_CHECK
-        JL_ASSERT( ! ObjectPool::IsFree(pObject, m_pFreeListHead) );
+        else
+        {
+            JL_ASSERT( ! ObjectPool::IsFree(pObject, m_pFreeListHead) );
+        }
 #endif
 
         ObjectPool::Free( pObject, m_pFreeListHead );
         m_nAllocations--;
     }
 
+    // Allocates up to nCount objects into ppObjects in one pass, and returns the number
+    // allocated. Address-ordered pools hand out ascending addresses.
+    unsigned AllocN( void** ppObjects, unsigned nCount );
+
+    // Frees a batch of objects, with the same error checking as Free().
+    void FreeN( void** ppObjects, unsigned nCount );
+
+    // Allocation tracking. These require the eFlag_TrackAllocations flag.
+    bool IsTrackingAllocations() const { return m_pAllocationBitmap != NULL; }
+
+    bool IsAllocated( const void* pObject ) const
+    {
+        JL_ASSERT( m_pAllocationBitmap );
+        return ObjectPool::IsAllocated( pObject, m_pObjectBuffer, m_nCapacity, m_nStride, m_pAllocationBitmap );
+    }
+
+    void* GetFirstAllocation()
+    {
+        JL_ASSERT( m_pAllocationBitmap );
+        return ObjectPool::GetFirstAllocation( m_pObjectBuffer, m_nCapacity, m_nStride, m_pAllocationBitmap );
+    }
+
+    void* GetNextAllocation( const void* pPrevious )
+    {
+        JL_ASSERT( m_pAllocationBitmap );
+        return ObjectPool::GetNextAllocation( pPrevious, m_pObjectBuffer, m_nCapacity, m_nStride, m_pAllocationBitmap );
+    }
+
     // Accessors
     unsigned char* GetObjectBuffer() { return m_pObjectBuffer; }
     const unsigned char* GetObjectBuffer() const { return m_pObjectBuffer; }
@@ -132,19 +330,47 @@ public:
 
     bool IsEmpty() const { return m_nAllocations == 0; }
     bool IsFull() const { return m_nAllocations == m_nCapacity; }
+    bool IsAddressOrdered() const { return m_pSummaryBitmap != NULL; }
+
+    // Virtual memory pools only. The committed size grows in steps of at least
+    // eMinCommitBytes, rounded up to the OS commit granularity.
+    enum { eMinCommitBytes = 64 * 1024 };
+    bool IsUsingVirtualMemory() const { return ( m_nFlags & eFlag_VirtualMemory ) != 0; }
+    bool IsUsingHugePages() const { return m_bHugePages; }
+    size_t GetReservedBytes() const { return m_nReservedBytes; }
+    size_t GetCommittedBytes() const { return m_nCommittedBytes; }
 
+    // The free list is unused (and NULL) in address-ordered pools.
     ObjectPool::FreeNode* GetFreeListHead() { return m_pFreeListHead; }
     const ObjectPool::FreeNode* GetFreeListHead() const { return m_pFreeListHead; }
 
 private:
     void Reset();
+    void ReleaseBuffers();
+
+    // Virtual memory helpers. CommitSlot() returns false if the OS is out of memory.
+    bool CommitSlot( unsigned nSlot );
+    void* CarveSlot();
 
     unsigned char* m_pObjectBuffer;
     ObjectPool::FreeNode* m_pFreeListHead;
+    unsigned* m_pAllocationBitmap;
+    unsigned* m_pSummaryBitmap;
+    unsigned m_nSummaryHint;
     unsigned m_nCapacity;
     unsigned m_nStride;
     unsigned m_nAllocations;
     unsigned m_nFlags;
+
+    // Slots below m_nCarvedSlots have been on the free list at least once, and
+    // slots below m_nCommittedSlots are backed by memory. Both equal the capacity
+    // unless the pool uses virtual memory.
+    unsigned m_nCarvedSlots;
+    unsigned m_nCommittedSlots;
+    size_t m_nReservedBytes;
+    size_t m_nCommittedBytes;
+    size_t m_nCommitGranularity;
+    bool m_bHugePages;
 };
 
 /**
@@ -152,27 +378,77 @@ private:
  * Useful for pools whose size are known at compile-time.
  *
  * Due to alignment issues, this is not implemented in terms of PreallocatedObjectPool.
+ *
+ * _Flags accepts ObjectPool::eFlag_TrackAllocations, ObjectPool::eFlag_AddressOrdered
+ * and ObjectPool::eFlag_PadStride. A non-zero _Alignment, which must be a power of two,
+ * aligns the buffer, and pads its size to a multiple of _Alignment.
  */
-template<unsigned _Stride, unsigned _Capacity>
+template<unsigned _Stride, unsigned _Capacity, unsigned _Flags = 0, unsigned _Alignment = 0>
 class StaticObjectPool
 {
 public:
     // For static object pools, the capacity and stride are type constants.
     enum {
-        eStride = _Stride,
+        eAlignment = _Alignment > 0 ? _Alignment : 1,
+        eStride = ( _Flags & ObjectPool::eFlag_PadStride ) ? ( _Stride + eAlignment - 1 ) / eAlignment * eAlignment : _Stride,
         eCapacity = _Capacity,
+        eBufferSize = ( eCapacity * eStride + eAlignment - 1 ) / eAlignment * eAlignment,
+        eFlags = _Flags,
+        eTrackAllocations = ( _Flags & ObjectPool::eFlag_TrackAllocations ) != 0,
+        eAddressOrdered = ( _Flags & ObjectPool::eFlag_AddressOrdered ) == ObjectPool::eFlag_AddressOrdered,
+        eBitmapWords = eTrackAllocations ? ( eCapacity + ObjectPool::eBitmapWordBits - 1 ) / ObjectPool::eBitmapWordBits : 1,
+        eSummaryWords = eAddressOrdered ? ( eBitmapWords + ObjectPool::eBitmapWordBits - 1 ) / ObjectPool::eBitmapWordBits : 1,
     };
     
+    JL_COMPILER_ASSERT( ( eAlignment & (eAlignment - 1) ) == 0, Alignment_Must_Be_A_Power_Of_Two );
+
     StaticObjectPool()
     {
-        m_pFreeListHead = ObjectPool::InitFreeList( m_pObjectBuffer, eCapacity, eStride );
+        // The buffer has room to slide up to the next aligned address
+        m_pObjectBuffer = m_pRawBuffer;
+        if ( eAlignment > 1 )
+        {
+            m_pObjectBuffer += ( eAlignment - (size_t)m_pRawBuffer % eAlignment ) % eAlignment;
+        }
+
         m_nAllocations = 0;
+
+        if ( eAddressOrdered )
+        {
+            m_pFreeListHead = NULL;
+            m_nSummaryHint = 0;
+            ObjectPool::InitBitmap( m_pSummaryBitmap, eBitmapWords );
+        }
+        else
+        {
+            m_pFreeListHead = ObjectPool::InitFreeList( m_pObjectBuffer, eCapacity, eStride );
+        }
+
+        if ( eTrackAllocations )
+        {
+            ObjectPool::InitBitmap( m_pAllocationBitmap, eCapacity );
+        }
     }
 
     // Allocates memory. Does not call constructor--you should do a placement new on the returned pointer.
     void* Alloc()
     {
-        void* p = ObjectPool::Alloc( m_pFreeListHead );
+        void* p;
+
+        if ( eAddressOrdered )
+        {
+            const unsigned nSlot = ObjectPool::AllocLowestSlot( m_pAllocationBitmap, m_pSummaryBitmap, eCapacity, m_nSummaryHint );
+            p = nSlot < eCapacity ? m_pObjectBuffer + nSlot * eStride : NULL;
+        }
+        else
+        {
+            p = ObjectPool::Alloc( m_pFreeListHead );
+
+            if ( p && eTrackAllocations )
+            {
+                ObjectPool::MarkSlotAllocated( m_pAllocationBitmap, ObjectPool::GetSlotIndex(p, m_pObjectBuffer, eStride) );
+            }
+        }
 
         if ( p )
         {
@@ -186,14 +462,107 @@ public:
     void Free( void* pObject )
     {
         JL_ASSERT( ObjectPool::IsBoundedAndAligned(pObject, m_pObjectBuffer, eCapacity, eStride) );
+
+        if ( eTrackAllocations )
+        {
+            const unsigned nSlot = ObjectPool::GetSlotIndex( pObject, m_pObjectBuffer, eStride );
+            JL_ASSERT( ObjectPool::IsSlotAllocated(m_pAllocationBitmap, nSlot) );
+
+            if ( eAddressOrdered )
+            {
+                ObjectPool::FreeOrderedSlot( m_pAllocationBitmap, m_pSummaryBitmap, nSlot, m_nSummaryHint );
+                m_nAllocations--;
+                return;
+            }
+
+            ObjectPool::MarkSlotFree( m_pAllocationBitmap, nSlot );
+        }
 #ifdef JL_OBJECT_POOL_ENABLE_FREELIST_CHECK
-        JL_ASSERT( ! ObjectPool::IsFree(pObject, m_pFreeListHead) );
+        else
+        {
+            JL_ASSERT( ! ObjectPool::IsFree(pObject, m_pFreeListHead) );
+        }
 #endif
 
         ObjectPool::Free( pObject, m_pFreeListHead );
         m_nAllocations--;
     }
 
+    // Allocates up to nCount objects into ppObjects in one pass, and returns the number
+    // allocated. Address-ordered pools hand out ascending addresses.
+    unsigned AllocN( void** ppObjects, unsigned nCount )
+    {
+        unsigned n;
+
+        if ( eAddressOrdered )
+        {
+            n = ObjectPool::AllocLowestSlots( m_pAllocationBitmap, m_pSummaryBitmap, eCapacity, m_nSummaryHint, m_pObjectBuffer, eStride, ppObjects, nCount );
+        }
+        else
+        {
+            n = ObjectPool::AllocN( m_pFreeListHead, ppObjects, nCount );
+
+            if ( eTrackAllocations )
+            {
+                ObjectPool::MarkSlotsAllocated( m_pAllocationBitmap, ppObjects, n, m_pObjectBuffer, eStride );
+            }
+        }
+
+        m_nAllocations += n;
+        return n;
+    }
+
+    // Frees a batch of objects, with the same error checking as Free().
+    void FreeN( void** ppObjects, unsigned nCount )
+    {
+        JL_ASSERT( nCount <= m_nAllocations );
+
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            JL_ASSERT( ObjectPool::IsBoundedAndAligned(ppObjects[i], m_pObjectBuffer, eCapacity, eStride) );
+#ifdef JL_OBJECT_POOL_ENABLE_FREELIST_CHECK
+            JL_ASSERT( eTrackAllocations || ! ObjectPool::IsFree(ppObjects[i], m_pFreeListHead) );
+#endif
+        }
+
+        if ( eAddressOrdered )
+        {
+            ObjectPool::FreeOrderedSlots( m_pAllocationBitmap, m_pSummaryBitmap, m_nSummaryHint, ppObjects, nCount, m_pObjectBuffer, eStride );
+        }
+        else
+        {
+            if ( eTrackAllocations )
+            {
+                ObjectPool::MarkSlotsFree( m_pAllocationBitmap, ppObjects, nCount, m_pObjectBuffer, eStride );
+            }
+
+            ObjectPool::FreeN( ppObjects, nCount, m_pFreeListHead );
+        }
+
+        m_nAllocations -= nCount;
+    }
+
+    // Allocation tracking. These require the ObjectPool::eFlag_TrackAllocations flag.
+    bool IsTrackingAllocations() const { return eTrackAllocations; }
+
+    bool IsAllocated( const void* pObject ) const
+    {
+        JL_COMPILER_ASSERT( eTrackAllocations, Pool_Does_Not_Track_Allocations );
+        return ObjectPool::IsAllocated( pObject, m_pObjectBuffer, eCapacity, eStride, m_pAllocationBitmap );
+    }
+
+    void* GetFirstAllocation()
+    {
+        JL_COMPILER_ASSERT( eTrackAllocations, Pool_Does_Not_Track_Allocations );
+        return ObjectPool::GetFirstAllocation( m_pObjectBuffer, eCapacity, eStride, m_pAllocationBitmap );
+    }
+
+    void* GetNextAllocation( const void* pPrevious )
+    {
+        JL_COMPILER_ASSERT( eTrackAllocations, Pool_Does_Not_Track_Allocations );
+        return ObjectPool::GetNextAllocation( pPrevious, m_pObjectBuffer, eCapacity, eStride, m_pAllocationBitmap );
+    }
+
     // Accessors
     unsigned char* GetObjectBuffer() { return m_pObjectBuffer; }
     const unsigned char* GetObjectBuffer() const { return m_pObjectBuffer; }
@@ -202,6 +571,7 @@ public:
     unsigned CountAllocations() const { return m_nAllocations; }
     unsigned GetStride() const { return eStride; }
 
+    // The free list is unused (and NULL) in address-ordered pools.
     ObjectPool::FreeNode* GetFreeListHead() { return m_pFreeListHead; }
     const ObjectPool::FreeNode* GetFreeListHead() const { return m_pFreeListHead; }
 
@@ -209,9 +579,17 @@ public:
     bool IsFull() const { return m_nAllocations == eCapacity; }
 
 private:
-    unsigned char m_pObjectBuffer[ eCapacity * eStride ];
+    // The buffer can't move, since it is addressed through m_pObjectBuffer.
+    StaticObjectPool( const StaticObjectPool& );
+    StaticObjectPool& operator=( const StaticObjectPool& );
+
+    unsigned char m_pRawBuffer[ eBufferSize + eAlignment - 1 ];
+    unsigned char* m_pObjectBuffer;
     ObjectPool::FreeNode* m_pFreeListHead;
     unsigned m_nAllocations;
+    unsigned m_nSummaryHint;
+    unsigned m_pAllocationBitmap[ eBitmapWords ];
+    unsigned m_pSummaryBitmap[ eSummaryWords ];
 };
 
 } // namespace jl    
@@ -3,6 +3,7 @@
 
 #include "ScopedAllocator.h"
 #include "ObjectPool.h"
+#include "SignalShard.h"
 
 namespace jl {
 
@@ -31,6 +32,10 @@ public:
         return m_oPool.CountAllocations();
     }
 
+    // Direct pool access, e.g. for walking live allocations
+    PreallocatedObjectPool& GetPool() { return m_oPool; }
+    const PreallocatedObjectPool& GetPool() const { return m_oPool; }
+
     // Virtual overrides
     void* Alloc( size_t nBytes )
     {
@@ -43,21 +48,47 @@ public:
         m_oPool.Free( pObject );
     }
 
+    unsigned AllocN( size_t nBytes, void** ppObjects, unsigned nCount )
+    {
+        JL_ASSERT( nBytes <= m_oPool.GetStride() );
+        return m_oPool.AllocN( ppObjects, nCount );
+    }
+
+    void FreeN( void** ppObjects, unsigned nCount )
+    {
+        m_oPool.FreeN( ppObjects, nCount );
+    }
+
+    bool IsAddressOrdered() const
+    {
+        return m_oPool.IsAddressOrdered();
+    }
+
+    // Only the summary bitmap finds a batch faster than popping a free list
+    bool PrefersBatches() const
+    {
+        return m_oPool.IsAddressOrdered();
+    }
+
 private:
     PreallocatedObjectPool m_oPool;
 };
 
-template<unsigned _Stride, unsigned _Capacity>
+template<unsigned _Stride, unsigned _Capacity, unsigned _Flags = 0, unsigned _Alignment = 0>
 class StaticObjectPoolAllocator : public ScopedAllocator
 {
 public:
-    typedef StaticObjectPool<_Stride, _Capacity> TObjectPool;
+    typedef StaticObjectPool<_Stride, _Capacity, _Flags, _Alignment> TObjectPool;
 
     unsigned CountAllocations() const
     {
         return m_oPool.CountAllocations();
     }
 
+    // Direct pool access, e.g. for walking live allocations
+    TObjectPool& GetPool() { return m_oPool; }
+    const TObjectPool& GetPool() const { return m_oPool; }
+
     // Virtual overrides
     void* Alloc( size_t nBytes )
     {
@@ -70,9 +101,123 @@ public:
         m_oPool.Free( pObject );
     }
 
+    unsigned AllocN( size_t nBytes, void** ppObjects, unsigned nCount )
+    {
+        JL_ASSERT( nBytes <= m_oPool.GetStride() );
+        return m_oPool.AllocN( ppObjects, nCount );
+    }
+
+    void FreeN( void** ppObjects, unsigned nCount )
+    {
+        m_oPool.FreeN( ppObjects, nCount );
+    }
+
+    bool IsAddressOrdered() const
+    {
+        return TObjectPool::eAddressOrdered;
+    }
+
+    bool PrefersBatches() const
+    {
+        return TObjectPool::eAddressOrdered;
+    }
+
 private:
     TObjectPool m_oPool;
 };
+
+/**
+ * One cache-line-aligned StaticObjectPool per shard, where the shard is the
+ * calling thread's SignalShard index modulo _MaxShards. Objects allocated by
+ * one thread are packed together, but never share a cache line with objects
+ * allocated by a thread with another shard.
+ *
+ * Like ShardedSignal, each shard's pool must only be used by threads with that
+ * shard, including frees. Free() finds the pool that owns an object from its
+ * address, so it doesn't depend on the calling thread.
+ */
+template<unsigned _Stride, unsigned _CapacityPerShard, unsigned _MaxShards, unsigned _Flags = 0>
+class ShardedObjectPoolAllocator : public ScopedAllocator
+{
+public:
+    typedef StaticObjectPool<_Stride, _CapacityPerShard, _Flags, ObjectPool::eCacheLineSize> TObjectPool;
+    enum { eMaxShards = _MaxShards };
+
+    unsigned CountAllocations() const
+    {
+        unsigned nAllocations = 0;
+
+        for ( unsigned i = 0; i < eMaxShards; ++i )
+        {
+            nAllocations += m_pPools[i].CountAllocations();
+        }
+
+        return nAllocations;
+    }
+
+    TObjectPool& GetPool( unsigned nShard ) { JL_ASSERT( nShard < eMaxShards ); return m_pPools[nShard]; }
+    const TObjectPool& GetPool( unsigned nShard ) const { JL_ASSERT( nShard < eMaxShards ); return m_pPools[nShard]; }
+
+    // The pool that the calling thread allocates from
+    TObjectPool& GetLocalPool() { return m_pPools[ SignalShard::GetCurrentThreadShard() % eMaxShards ]; }
+
+    // Virtual overrides
+    void* Alloc( size_t nBytes )
+    {
+        JL_ASSERT( nBytes <= TObjectPool::eStride );
+        return GetLocalPool().Alloc();
+    }
+
+    unsigned AllocN( size_t nBytes, void** ppObjects, unsigned nCount )
+    {
+        JL_ASSERT( nBytes <= TObjectPool::eStride );
+        return GetLocalPool().AllocN( ppObjects, nCount );
+    }
+
+    void Free( void* pObject )
+    {
+        m_pPools[ GetPoolIndex(pObject) ].Free( pObject );
+    }
+
+    // Each object goes back to the pool that owns it, as with Free()
+    void FreeN( void** ppObjects, unsigned nCount )
+    {
+        for ( unsigned i = 0; i < nCount; )
+        {
+            // Hand runs of objects from the same pool over in one call
+            const unsigned nPool = GetPoolIndex( ppObjects[i] );
+            unsigned nRun = 1;
+            while ( i + nRun < nCount && GetPoolIndex(ppObjects[i + nRun]) == nPool )
+            {
+                ++nRun;
+            }
+
+            m_pPools[nPool].FreeN( ppObjects + i, nRun );
+            i += nRun;
+        }
+    }
+
+    bool IsAddressOrdered() const
+    {
+        return TObjectPool::eAddressOrdered;
+    }
+
+    bool PrefersBatches() const
+    {
+        return TObjectPool::eAddressOrdered;
+    }
+
+private:
+    // The pool that owns an object. Each pool's buffer is inside the pool object.
+    unsigned GetPoolIndex( const void* pObject ) const
+    {
+        const size_t nOffset = static_cast<const unsigned char*>( pObject ) - reinterpret_cast<const unsigned char*>( m_pPools );
+        JL_ASSERT( nOffset < sizeof(m_pPools) );
+        return unsigned( nOffset / sizeof(TObjectPool) );
+    }
+
+    TObjectPool m_pPools[ eMaxShards ];
+};
     
 } // namespace jl
 
@@ -4,6 +4,7 @@
 #include <assert.h>
 
 #include "ObjectPool.h"
+#include "VirtualMemory.h"
 
 using namespace jl;
 
@@ -66,7 +67,7 @@ namespace
     };
 
     // Allocator for PreallocatedObjectPool
-    template<unsigned _Stride, unsigned _Capacity>
+    template<unsigned _Stride, unsigned _Capacity, unsigned _Flags = PreallocatedObjectPool::eFlag_ManageBuffer>
     class PreallocatedPoolFactory
     {
     public:
@@ -82,13 +83,32 @@ namespace
         {
             void* pBuffer = new unsigned char[ _Stride * _Capacity ];
             InternalObjectPool* pPool = new InternalObjectPool();
-            pPool->Init( pBuffer, _Capacity, _Stride, true );
+            pPool->Init( pBuffer, _Capacity, _Stride, _Flags );
             return pPool;
         }
     };
 
+    // Allocator for PreallocatedObjectPool with a reserved buffer
+    template<unsigned _Stride, unsigned _Capacity, unsigned _Flags = PreallocatedObjectPool::eFlag_VirtualMemory>
+    class VirtualPoolFactory
+    {
+    public:
+        enum
+        {
+            eStride = _Stride,
+            eCapacity = _Capacity
+        };
+
+        typedef PreallocatedObjectPool InternalObjectPool;
+
+        static InternalObjectPool* Create()
+        {
+            return new InternalObjectPool( NULL, _Capacity, _Stride, _Flags );
+        }
+    };
+
     // Allocator for StaticObjectPool
-    template<unsigned _Stride, unsigned _Capacity>
+    template<unsigned _Stride, unsigned _Capacity, unsigned _Flags = 0, unsigned _Alignment = 0>
     class StaticPoolFactory
     {
     public:
@@ -98,7 +118,7 @@ namespace
             eCapacity = _Capacity
         };        
         
-        typedef StaticObjectPool<_Stride, _Capacity> InternalObjectPool;
+        typedef StaticObjectPool<_Stride, _Capacity, _Flags, _Alignment> InternalObjectPool;
         
         static InternalObjectPool* Create()
         {
@@ -138,7 +158,7 @@ namespace
             for ( unsigned i = 0; i < nTrialSize; ++i )
             {
                 pTestState[i].SetObject(
-                    new( pPool->Alloc() ) TestObject( g_ppSampleContents[i] )
+                    new( pPool->Alloc() ) TestObject( g_ppSampleContents[i % JL_ARRAY_SIZE(g_ppSampleContents)] )
                 );
                 
                 // Validations
@@ -200,7 +220,7 @@ namespace
             for ( unsigned i = 0; i < nTrialSize; ++i )
             {
                 // Cache the old internal allocation count
-                const int nPreFreeAllocations = pPool->CountAllocations();
+                const unsigned nPreFreeAllocations = pPool->CountAllocations();
                 
                 // Free the object
                 pTestState[i].GetObject()->~TestObject();
@@ -232,6 +252,342 @@ namespace
                 assert( TestState::IsValidArray(pTestState) );            
             }
         } // Increment trial size
+
+        delete pPool;
+    }
+
+    // Counts live objects by walking the allocation bitmap.
+    template<typename _TPool>
+    unsigned CountTrackedAllocations( _TPool* pPool )
+    {
+        unsigned nCount = 0;
+
+        for ( void* p = pPool->GetFirstAllocation(); p != NULL; p = pPool->GetNextAllocation(p) )
+        {
+            assert( pPool->IsAllocated(p) );
+            ++nCount;
+        }
+
+        return nCount;
+    }
+
+    // Exercises the allocation bitmap of pools created with eFlag_TrackAllocations.
+    template<typename _TAllocatorFactory, unsigned _PoolSize>
+    void TrackingTest()
+    {
+        typedef typename _TAllocatorFactory::InternalObjectPool PoolType;
+        PoolType* pPool = _TAllocatorFactory::Create();
+        TestObject* pObjects[_PoolSize];
+
+        printf( "Testing allocation tracking on a pool with size %u\n", _PoolSize );
+        assert( pPool->IsTrackingAllocations() );
+        assert( pPool->GetFirstAllocation() == NULL );
+
+        // Fill the pool
+        for ( unsigned i = 0; i < _PoolSize; ++i )
+        {
+            pObjects[i] = new( pPool->Alloc() ) TestObject( g_ppSampleContents[i % JL_ARRAY_SIZE(g_ppSampleContents)] );
+            assert( pPool->IsAllocated(pObjects[i]) );
+        }
+
+        assert( pPool->Alloc() == NULL );
+        assert( CountTrackedAllocations(pPool) == _PoolSize );
+
+        // Pointers that don't address a slot are never reported as allocated
+        const unsigned char* pMisaligned = reinterpret_cast<const unsigned char*>( pObjects[0] ) + 1;
+        assert( ! pPool->IsAllocated(pMisaligned) );
+        assert( ! pPool->IsAllocated(& pObjects) );
+
+        // Free a random subset, and make sure iteration only visits live objects
+        for ( unsigned i = 0; i < _PoolSize; ++i )
+        {
+            if ( rand() % 3 == 0 )
+            {
+                pObjects[i]->~TestObject();
+                pPool->Free( pObjects[i] );
+                assert( ! pPool->IsAllocated(pObjects[i]) );
+                pObjects[i] = NULL;
+            }
+        }
+
+        assert( CountTrackedAllocations(pPool) == pPool->CountAllocations() );
+
+        for ( void* p = pPool->GetFirstAllocation(); p != NULL; p = pPool->GetNextAllocation(p) )
+        {
+            bool bFound = false;
+
+            for ( unsigned i = 0; i < _PoolSize && ! bFound; ++i )
+            {
+                bFound = ( pObjects[i] == p );
+            }
+
+            assert( bFound );
+        }
+
+        // Free everything else
+        for ( unsigned i = 0; i < _PoolSize; ++i )
+        {
+            if ( pObjects[i] )
+            {
+                pObjects[i]->~TestObject();
+                pPool->Free( pObjects[i] );
+            }
+        }
+
+        assert( pPool->CountAllocations() == 0 );
+        assert( pPool->GetFirstAllocation() == NULL );
+
+        delete pPool;
+    }
+
+    // Takes and returns objects in batches, mixed with single allocations.
+    template<typename _TAllocatorFactory, unsigned _PoolSize>
+    void BatchTest()
+    {
+        typedef typename _TAllocatorFactory::InternalObjectPool PoolType;
+        PoolType* pPool = _TAllocatorFactory::Create();
+        void* pObjects[_PoolSize + 1];
+
+        printf( "Testing batch allocation on a pool with size %u\n", _PoolSize );
+
+        // A batch larger than the pool takes everything
+        assert( pPool->AllocN(pObjects, _PoolSize + 1) == _PoolSize );
+        assert( pPool->IsFull() && pPool->Alloc() == NULL );
+        assert( pPool->AllocN(pObjects + _PoolSize, 1) == 0 );
+
+        for ( unsigned i = 0; i < _PoolSize; ++i )
+        {
+            for ( unsigned j = 0; j < i; ++j )
+            {
+                assert( pObjects[i] != pObjects[j] );
+            }
+        }
+
+        // Return the odd objects one batch, then take them back
+        const unsigned nHalf = _PoolSize / 2;
+        void* pOdd[_PoolSize / 2];
+
+        for ( unsigned i = 0; i < nHalf; ++i )
+        {
+            pOdd[i] = pObjects[2 * i + 1];
+        }
+
+        pPool->FreeN( pOdd, nHalf );
+        assert( pPool->CountAllocations() == _PoolSize - nHalf );
+
+        void* pTaken[_PoolSize / 2];
+        assert( pPool->AllocN(pTaken, nHalf) == nHalf );
+        assert( pPool->IsFull() );
+
+        for ( unsigned i = 0; i < nHalf; ++i )
+        {
+            bool bFound = false;
+
+            for ( unsigned j = 0; j < nHalf && ! bFound; ++j )
+            {
+                bFound = ( pTaken[i] == pOdd[j] );
+            }
+
+            assert( bFound );
+            pObjects[2 * i + 1] = pTaken[i];
+        }
+
+        // Single frees mix with batches
+        pPool->Free( pObjects[0] );
+        pPool->FreeN( pObjects + 1, _PoolSize - 1 );
+        assert( pPool->CountAllocations() == 0 );
+
+        assert( pPool->AllocN(pObjects, 3) == 3 );
+        pPool->FreeN( pObjects, 3 );
+        assert( pPool->IsEmpty() );
+
+        delete pPool;
+    }
+
+    // Makes sure that pools created with eFlag_AddressOrdered always hand out the lowest free slot.
+    template<typename _TAllocatorFactory, unsigned _PoolSize>
+    void AddressOrderTest()
+    {
+        typedef typename _TAllocatorFactory::InternalObjectPool PoolType;
+        PoolType* pPool = _TAllocatorFactory::Create();
+        bool pLive[_PoolSize] = { false };
+
+        printf( "Testing address-ordered allocation on a pool with size %u\n", _PoolSize );
+
+        const unsigned char* pBase = static_cast<const unsigned char*>( pPool->Alloc() );
+        assert( pBase );
+        pLive[0] = true;
+
+        // Fill the pool. Every allocation should follow the previous one.
+        for ( unsigned i = 1; i < _PoolSize; ++i )
+        {
+            const unsigned char* p = static_cast<const unsigned char*>( pPool->Alloc() );
+            assert( p == pBase + i * pPool->GetStride() );
+            pLive[i] = true;
+        }
+
+        assert( pPool->Alloc() == NULL );
+
+        // Churn: free random slots, then reallocate, checking against the lowest free slot each time
+        enum { eChurnRounds = 20 };
+        for ( unsigned nRound = 0; nRound < eChurnRounds; ++nRound )
+        {
+            const unsigned nFrees = ( rand() % _PoolSize ) + 1;
+            for ( unsigned i = 0; i < nFrees; ++i )
+            {
+                const unsigned nSlot = rand() % _PoolSize;
+                if ( pLive[nSlot] )
+                {
+                    pPool->Free( const_cast<unsigned char*>(pBase + nSlot * pPool->GetStride()) );
+                    pLive[nSlot] = false;
+                }
+            }
+
+            assert( CountTrackedAllocations(pPool) == pPool->CountAllocations() );
+
+            const unsigned nAllocs = rand() % ( _PoolSize - pPool->CountAllocations() + 1 );
+            for ( unsigned i = 0; i < nAllocs; ++i )
+            {
+                unsigned nLowest = 0;
+                while ( pLive[nLowest] )
+                {
+                    ++nLowest;
+                }
+
+                const unsigned char* p = static_cast<const unsigned char*>( pPool->Alloc() );
+                assert( p == pBase + nLowest * pPool->GetStride() );
+                pLive[nLowest] = true;
+            }
+        }
+
+        // Free everything, highest slot first, so that the summary hint has to move back down
+        for ( unsigned i = _PoolSize; i-- > 0; )
+        {
+            if ( pLive[i] )
+            {
+                pPool->Free( const_cast<unsigned char*>(pBase + i * pPool->GetStride()) );
+            }
+        }
+
+        assert( pPool->CountAllocations() == 0 );
+        assert( pPool->Alloc() == pBase );
+
+        delete pPool;
+    }
+}
+
+namespace
+{
+    // Address-ordered batches come out ascending, and fill the lowest free slots first
+    void OrderedBatchTest()
+    {
+        enum { eStride = 8, eCapacity = 100 };
+        StaticObjectPool< eStride, eCapacity, ObjectPool::eFlag_AddressOrdered >* pPool = new StaticObjectPool< eStride, eCapacity, ObjectPool::eFlag_AddressOrdered >();
+        void* pObjects[ eCapacity ];
+
+        assert( pPool->AllocN(pObjects, eCapacity) == eCapacity );
+
+        for ( unsigned i = 0; i < eCapacity; ++i )
+        {
+            assert( pObjects[i] == pPool->GetObjectBuffer() + i * eStride );
+        }
+
+        // Open holes in two different bitmap words
+        void* pHoles[] = { pObjects[70], pObjects[5], pObjects[40], pObjects[6] };
+        pPool->FreeN( pHoles, JL_ARRAY_SIZE(pHoles) );
+
+        void* pRefill[ JL_ARRAY_SIZE(pHoles) ];
+        assert( pPool->AllocN(pRefill, JL_ARRAY_SIZE(pRefill)) == JL_ARRAY_SIZE(pRefill) );
+        assert( pRefill[0] == pObjects[5] && pRefill[1] == pObjects[6] && pRefill[2] == pObjects[40] && pRefill[3] == pObjects[70] );
+
+        pPool->FreeN( pObjects, eCapacity );
+        assert( pPool->IsEmpty() );
+        delete pPool;
+    }
+
+    // Aligned pools start their buffer on an aligned address, and padded pools
+    // keep every slot on its own aligned boundary.
+    void AlignmentTest()
+    {
+        // A multiple of the free list's pointer alignment, but not of a cache line
+        enum { eUnpaddedStride = 24, eCapacity = 10 };
+
+        typedef StaticObjectPool< eUnpaddedStride, eCapacity, 0, ObjectPool::eCacheLineSize > AlignedPool;
+        typedef StaticObjectPool< eUnpaddedStride, eCapacity, ObjectPool::eFlag_PadStride, ObjectPool::eCacheLineSize > PaddedPool;
+
+        JL_COMPILER_ASSERT( unsigned(AlignedPool::eStride) == unsigned(eUnpaddedStride), Aligned_Pool_Must_Not_Pad );
+        JL_COMPILER_ASSERT( unsigned(PaddedPool::eStride) == unsigned(ObjectPool::eCacheLineSize), Padded_Pool_Must_Pad );
+        JL_COMPILER_ASSERT( unsigned(AlignedPool::eBufferSize) % unsigned(ObjectPool::eCacheLineSize) == 0, Aligned_Pool_Must_Pad_Buffer );
+        assert( ObjectPool::GetPaddedStride(eUnpaddedStride, ObjectPool::eCacheLineSize) == ObjectPool::eCacheLineSize );
+        assert( ObjectPool::GetPaddedStride(ObjectPool::eCacheLineSize, ObjectPool::eCacheLineSize) == ObjectPool::eCacheLineSize );
+
+        // Misalign the pools on purpose
+        struct Pools
+        {
+            char cPad1;
+            AlignedPool oAligned;
+            char cPad2;
+            PaddedPool oPadded;
+        };
+
+        Pools* pPools = new Pools;
+        assert( (size_t)pPools->oAligned.GetObjectBuffer() % ObjectPool::eCacheLineSize == 0 );
+        assert( (size_t)pPools->oPadded.GetObjectBuffer() % ObjectPool::eCacheLineSize == 0 );
+
+        for ( unsigned i = 0; i < eCapacity; ++i )
+        {
+            const size_t nAligned = (size_t)pPools->oAligned.Alloc();
+            const size_t nPadded = (size_t)pPools->oPadded.Alloc();
+            assert( nAligned == (size_t)pPools->oAligned.GetObjectBuffer() + i * eUnpaddedStride );
+            assert( nPadded % ObjectPool::eCacheLineSize == 0 );
+        }
+
+        assert( pPools->oAligned.Alloc() == NULL && pPools->oPadded.Alloc() == NULL );
+        delete pPools;
+    }
+
+    // A virtual memory pool only commits memory as allocations reach higher slots
+    void LazyCommitTest( unsigned nFlags )
+    {
+        enum { eStride = 64, eCapacity = 4 * 1024 * 1024 };
+
+        PreallocatedObjectPool oPool( NULL, eCapacity, eStride, nFlags );
+        assert( oPool.IsUsingVirtualMemory() );
+        assert( oPool.GetReservedBytes() >= size_t(eCapacity) * eStride );
+        assert( oPool.GetCommittedBytes() == 0 );
+
+        printf( "Reserved %u MB%s\n", unsigned(oPool.GetReservedBytes() >> 20), oPool.IsUsingHugePages() ? " with huge pages" : "" );
+
+        // A handful of allocations only commits the first step
+        unsigned char* pFirst = static_cast<unsigned char*>( oPool.Alloc() );
+        assert( pFirst == oPool.GetObjectBuffer() );
+        *pFirst = 1;
+
+        const size_t nFirstCommit = oPool.GetCommittedBytes();
+        assert( nFirstCommit >= PreallocatedObjectPool::eMinCommitBytes );
+        assert( nFirstCommit < oPool.GetReservedBytes() );
+
+        // Allocating past the committed range commits more
+        const unsigned nAllocs = unsigned( nFirstCommit / eStride ) + 1;
+        unsigned char* pLast = pFirst;
+
+        for ( unsigned i = 1; i < nAllocs; ++i )
+        {
+            pLast = static_cast<unsigned char*>( oPool.Alloc() );
+            assert( pLast == pFirst + size_t(i) * eStride );
+            *pLast = 1;
+        }
+
+        assert( oPool.GetCommittedBytes() > nFirstCommit );
+        assert( oPool.CountAllocations() == nAllocs );
+
+        // Freed slots are reused before new ones are carved
+        oPool.Free( pFirst );
+        assert( oPool.Alloc() == pFirst );
+        assert( oPool.Alloc() == pLast + eStride );
+
+        oPool.Deinit();
+        assert( oPool.GetObjectBuffer() == NULL && oPool.GetReservedBytes() == 0 );
     }
 }
 
@@ -246,4 +602,60 @@ void ObjectPoolTest()
     printf("\nTesting StaticObjectPool...\n");    
     typedef StaticPoolFactory<sizeof(TestObject), ePoolCapacity> StaticPoolTestFactory;
     PoolTest<StaticPoolTestFactory, StaticPoolTestFactory::eCapacity>();
+
+    enum { eTrackedPoolCapacity = 100 };
+
+    printf("\nTesting PreallocatedObjectPool with allocation tracking...\n");
+    typedef PreallocatedPoolFactory<sizeof(TestObject), eTrackedPoolCapacity, PreallocatedObjectPool::eFlag_ManageBuffer | PreallocatedObjectPool::eFlag_TrackAllocations> TrackedPreallocatedPoolTestFactory;
+    PoolTest<TrackedPreallocatedPoolTestFactory, TrackedPreallocatedPoolTestFactory::eCapacity>();
+    TrackingTest<TrackedPreallocatedPoolTestFactory, TrackedPreallocatedPoolTestFactory::eCapacity>();
+
+    printf("\nTesting StaticObjectPool with allocation tracking...\n");
+    typedef StaticPoolFactory<sizeof(TestObject), eTrackedPoolCapacity, ObjectPool::eFlag_TrackAllocations> TrackedStaticPoolTestFactory;
+    PoolTest<TrackedStaticPoolTestFactory, TrackedStaticPoolTestFactory::eCapacity>();
+    TrackingTest<TrackedStaticPoolTestFactory, TrackedStaticPoolTestFactory::eCapacity>();
+
+    // Large enough to span more than one summary word, and not a multiple of the bitmap word size
+    enum { eOrderedPoolCapacity = 1100 };
+
+    printf("\nTesting PreallocatedObjectPool with address-ordered allocation...\n");
+    typedef PreallocatedPoolFactory<sizeof(TestObject), eOrderedPoolCapacity, PreallocatedObjectPool::eFlag_ManageBuffer | PreallocatedObjectPool::eFlag_AddressOrdered> OrderedPreallocatedPoolTestFactory;
+    TrackingTest<OrderedPreallocatedPoolTestFactory, OrderedPreallocatedPoolTestFactory::eCapacity>();
+    AddressOrderTest<OrderedPreallocatedPoolTestFactory, OrderedPreallocatedPoolTestFactory::eCapacity>();
+
+    printf("\nTesting StaticObjectPool with address-ordered allocation...\n");
+    typedef StaticPoolFactory<sizeof(TestObject), eOrderedPoolCapacity, ObjectPool::eFlag_AddressOrdered> OrderedStaticPoolTestFactory;
+    TrackingTest<OrderedStaticPoolTestFactory, OrderedStaticPoolTestFactory::eCapacity>();
+    AddressOrderTest<OrderedStaticPoolTestFactory, OrderedStaticPoolTestFactory::eCapacity>();
+
+    printf("\nTesting batch allocation...\n");
+    BatchTest<PreallocatedPoolTestFactory, PreallocatedPoolTestFactory::eCapacity>();
+    BatchTest<StaticPoolTestFactory, StaticPoolTestFactory::eCapacity>();
+    BatchTest<TrackedPreallocatedPoolTestFactory, TrackedPreallocatedPoolTestFactory::eCapacity>();
+    BatchTest<TrackedStaticPoolTestFactory, TrackedStaticPoolTestFactory::eCapacity>();
+    BatchTest<OrderedPreallocatedPoolTestFactory, OrderedPreallocatedPoolTestFactory::eCapacity>();
+    BatchTest<OrderedStaticPoolTestFactory, OrderedStaticPoolTestFactory::eCapacity>();
+    OrderedBatchTest();
+
+    printf("\nTesting StaticObjectPool with cache line padding...\n");
+    typedef StaticPoolFactory<sizeof(TestObject), eTrackedPoolCapacity, ObjectPool::eFlag_PadStride, ObjectPool::eCacheLineSize> PaddedStaticPoolTestFactory;
+    PoolTest<PaddedStaticPoolTestFactory, PaddedStaticPoolTestFactory::eCapacity>();
+    AlignmentTest();
+
+#if JL_ENABLE_VIRTUAL_MEMORY
+    printf("\nTesting PreallocatedObjectPool with a reserved buffer...\n");
+    typedef VirtualPoolFactory<sizeof(TestObject), eTrackedPoolCapacity, PreallocatedObjectPool::eFlag_VirtualMemory | PreallocatedObjectPool::eFlag_TrackAllocations> VirtualPoolTestFactory;
+    TrackingTest<VirtualPoolTestFactory, VirtualPoolTestFactory::eCapacity>();
+
+    typedef VirtualPoolFactory<sizeof(TestObject), eOrderedPoolCapacity, PreallocatedObjectPool::eFlag_VirtualMemory | PreallocatedObjectPool::eFlag_AddressOrdered> OrderedVirtualPoolTestFactory;
+    TrackingTest<OrderedVirtualPoolTestFactory, OrderedVirtualPoolTestFactory::eCapacity>();
+    AddressOrderTest<OrderedVirtualPoolTestFactory, OrderedVirtualPoolTestFactory::eCapacity>();
+    BatchTest<VirtualPoolTestFactory, VirtualPoolTestFactory::eCapacity>();
+    BatchTest<OrderedVirtualPoolTestFactory, OrderedVirtualPoolTestFactory::eCapacity>();
+
+    LazyCommitTest( PreallocatedObjectPool::eFlag_VirtualMemory );
+    LazyCommitTest( PreallocatedObjectPool::eFlag_VirtualMemory | PreallocatedObjectPool::eFlag_TrackAllocations );
+    LazyCommitTest( PreallocatedObjectPool::eFlag_TransparentHugePages );
+    LazyCommitTest( PreallocatedObjectPool::eFlag_ExplicitHugePages );
+#endif
 }
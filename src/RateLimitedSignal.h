@@ -0,0 +1,246 @@
+#ifndef _JL_RATE_LIMITED_SIGNAL_H_
+#define _JL_RATE_LIMITED_SIGNAL_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+#include "MonotonicClock.h"
+
+namespace jl {
+
+/**
+ * Timing rules for ThrottledSignal: at most one delivery per interval. The
+ * first emission after a quiet interval opens a window, and is delivered at
+ * once if leading delivery is on. Later emissions in the window are held, and
+ * the latest one is delivered when the window closes if trailing delivery is
+ * on. A trailing delivery opens the next window.
+ */
+class ThrottleTiming
+{
+public:
+    ThrottleTiming() : m_fWindowStart(0.0), m_bOpen(false) {}
+    
+    // Returns true if the emission should be delivered immediately.
+    bool OnEmit( double fNow, bool bLeading )
+    {
+        if ( m_bOpen )
+        {
+            return false;
+        }
+        
+        m_bOpen = true;
+        m_fWindowStart = fNow;
+        return bLeading;
+    }
+    
+    // Returns true if the held emission should be delivered now.
+    bool OnUpdate( double fNow, double fInterval, bool bPending )
+    {
+        if ( ! m_bOpen || fNow - m_fWindowStart < fInterval )
+        {
+            return false;
+        }
+        
+        if ( bPending )
+        {
+            m_fWindowStart = fNow;
+            return true;
+        }
+        
+        m_bOpen = false;
+        return false;
+    }
+    
+private:
+    double m_fWindowStart;
+    bool m_bOpen;
+};
+
+/**
+ * Timing rules for DebouncedSignal: a burst of emissions is delivered once,
+ * when none have arrived for a full interval. With leading delivery, the first
+ * emission of a burst is delivered at once. With trailing delivery, the latest
+ * emission after the first is delivered when the burst ends.
+ */
+class DebounceTiming
+{
+public:
+    DebounceTiming() : m_fLastEmit(0.0), m_bOpen(false) {}
+    
+    // Returns true if the emission should be delivered immediately.
+    bool OnEmit( double fNow, bool bLeading )
+    {
+        const bool bFirst = ! m_bOpen;
+        m_bOpen = true;
+        m_fLastEmit = fNow;
+        return bFirst && bLeading;
+    }
+    
+    // Returns true if the held emission should be delivered now.
+    bool OnUpdate( double fNow, double fInterval, bool bPending )
+    {
+        if ( ! m_bOpen || fNow - m_fLastEmit < fInterval )
+        {
+            return false;
+        }
+        
+        m_bOpen = false;
+        return bPending;
+    }
+    
+private:
+    double m_fLastEmit;
+    bool m_bOpen;
+};
+
+/**
+ * Wraps a signal so that its connected functions are called at a limited rate.
+ * Emit() records an emission, and delivers it at once or holds on to it
+ * according to TTiming. Held emissions are delivered by Update(), which should
+ * be called regularly, e.g. once per frame. Only the latest held emission is
+ * kept, copied into TSignal::Arguments, so argument types must be
+ * default-constructible and copyable.
+ *
+ * Use ThrottledSignal or DebouncedSignal rather than this class directly.
+ */
+template< typename TSignal, typename TTiming >
+class RateLimitedSignal
+{
+public:
+    enum Flags
+    {
+        eFlag_Leading = 0x01,   // Deliver the first emission immediately
+        eFlag_Trailing = 0x02,  // Deliver the latest held emission when the interval ends
+    };
+    
+    typedef typename TSignal::Arguments Arguments;
+    
+    RateLimitedSignal( MonotonicClock* pClock, double fInterval, unsigned nFlags )
+        : m_pClock(pClock), m_fInterval(fInterval), m_nFlags(nFlags), m_bPending(false)
+    {
+        JL_ASSERT( pClock && fInterval >= 0.0 );
+        JL_ASSERT( nFlags & (eFlag_Leading | eFlag_Trailing) );
+    }
+    
+    // The signal that delivers emissions. Connect and disconnect through this.
+    TSignal& GetSignal() { return m_oSignal; }
+    const TSignal& GetSignal() const { return m_oSignal; }
+    
+    template< typename Y, typename TMethod >
+    void Connect( Y* pObject, TMethod fpMethod ) { m_oSignal.Connect( pObject, fpMethod ); }
+    
+    double GetInterval() const { return m_fInterval; }
+    void SetInterval( double fInterval ) { JL_ASSERT( fInterval >= 0.0 ); m_fInterval = fInterval; }
+    
+    bool HasPending() const { return m_bPending; }
+    
+    // Drops the held emission, if any.
+    void Cancel() { m_bPending = false; }
+    
+    // Delivers the held emission if it is due.
+    void Update()
+    {
+        if ( m_oTiming.OnUpdate(m_pClock->GetSeconds(), m_fInterval, m_bPending) )
+        {
+            // Copy first, since the connected functions may emit again
+            const Arguments oArguments = m_oPending;
+            m_bPending = false;
+            oArguments.EmitTo( m_oSignal );
+        }
+    }
+    
+    void Emit()
+    {
+        JL_COMPILER_ASSERT( Arguments::eCount == 0, Signal_Takes_Arguments );
+        Record( Arguments() );
+    }
+    
+    template< typename A1 >
+    void Emit( A1 a1 ) { Record( Arguments(a1) ); }
+    
+    template< typename A1, typename A2 >
+    void Emit( A1 a1, A2 a2 ) { Record( Arguments(a1, a2) ); }
+    
+    template< typename A1, typename A2, typename A3 >
+    void Emit( A1 a1, A2 a2, A3 a3 ) { Record( Arguments(a1, a2, a3) ); }
+    
+    template< typename A1, typename A2, typename A3, typename A4 >
+    void Emit( A1 a1, A2 a2, A3 a3, A4 a4 ) { Record( Arguments(a1, a2, a3, a4) ); }
+    
+    template< typename A1, typename A2, typename A3, typename A4, typename A5 >
+    void Emit( A1 a1, A2 a2, A3 a3, A4 a4, A5 a5 ) { Record( Arguments(a1, a2, a3, a4, a5) ); }
+    
+    template< typename A1, typename A2, typename A3, typename A4, typename A5, typename A6 >
+    void Emit( A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6 ) { Record( Arguments(a1, a2, a3, a4, a5, a6) ); }
+    
+    template< typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7 >
+    void Emit( A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7 ) { Record( Arguments(a1, a2, a3, a4, a5, a6, a7) ); }
+    
+    template< typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8 >
+    void Emit( A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8 ) { Record( Arguments(a1, a2, a3, a4, a5, a6, a7, a8) ); }
+    
+private:
+    void Record( const Arguments& oArguments )
+    {
+        // Deliver anything that came due since the last Update() first
+        Update();
+        
+        if ( m_oTiming.OnEmit(m_pClock->GetSeconds(), (m_nFlags & eFlag_Leading) != 0) )
+        {
+            oArguments.EmitTo( m_oSignal );
+        }
+        else if ( m_nFlags & eFlag_Trailing )
+        {
+            m_oPending = oArguments;
+            m_bPending = true;
+        }
+    }
+    
+    TSignal m_oSignal;
+    TTiming m_oTiming;
+    MonotonicClock* m_pClock;
+    double m_fInterval;
+    unsigned m_nFlags;
+    Arguments m_oPending;
+    bool m_bPending;
+};
+
+/**
+ * A signal that delivers at most one emission per interval, e.g.:
+ *
+ *   ThrottledSignal< Signal2<int, int> > oMouseMoved( & oClock, 1.0 / 30.0 );
+ *   oMouseMoved.Connect( & oLayout, & Layout::OnMouseMoved );
+ *
+ *   oMouseMoved.Emit( x, y ); // as often as the OS reports movement
+ *   oMouseMoved.Update();     // once per frame
+ *
+ * By default the first emission is delivered at once, and the latest of the
+ * rest at the end of each interval. See ThrottleTiming.
+ */
+template< typename TSignal >
+class ThrottledSignal : public RateLimitedSignal< TSignal, ThrottleTiming >
+{
+public:
+    typedef RateLimitedSignal< TSignal, ThrottleTiming > TBase;
+    
+    ThrottledSignal( MonotonicClock* pClock, double fInterval, unsigned nFlags = TBase::eFlag_Leading | TBase::eFlag_Trailing )
+        : TBase( pClock, fInterval, nFlags ) {}
+};
+
+/**
+ * A signal that waits until emissions have stopped for an interval, then
+ * delivers the latest one. See DebounceTiming.
+ */
+template< typename TSignal >
+class DebouncedSignal : public RateLimitedSignal< TSignal, DebounceTiming >
+{
+public:
+    typedef RateLimitedSignal< TSignal, DebounceTiming > TBase;
+    
+    DebouncedSignal( MonotonicClock* pClock, double fInterval, unsigned nFlags = TBase::eFlag_Trailing )
+        : TBase( pClock, fInterval, nFlags ) {}
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_RATE_LIMITED_SIGNAL_H_ )
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "RateLimitedSignal.h"
+#include "StaticSignalConnectionAllocators.h"
+
+using namespace jl;
+
+namespace
+{
+    struct Position
+    {
+        int x;
+        int y;
+    };
+
+    // Records every value it receives
+    class RateObserver : public SignalObserver
+    {
+    public:
+        RateObserver() : m_nCalls(0) {}
+
+        void OnValue( int n ) { m_pValues[ m_nCalls++ ] = n; }
+        void OnPosition( const Position& oPosition ) { m_pValues[ m_nCalls++ ] = oPosition.x + oPosition.y; }
+
+        int m_pValues[ 16 ];
+        unsigned m_nCalls;
+    };
+
+    typedef ThrottledSignal< Signal1<int> > TestThrottledSignal;
+    typedef DebouncedSignal< Signal1<int> > TestDebouncedSignal;
+}
+
+void RateLimitedSignalTest()
+{
+    StaticSignalConnectionAllocator< 8 > oSignalConnections;
+    StaticObserverConnectionAllocator< 8 > oObserverConnections;
+    SignalBase::SetCommonConnectionAllocator( & oSignalConnections );
+    SignalObserver::SetCommonConnectionAllocator( & oObserverConnections );
+
+    printf( "Testing throttled signals...\n" );
+    {
+        ManualClock oClock;
+        TestThrottledSignal oSignal( & oClock, 1.0 );
+        RateObserver oObserver;
+        oSignal.Connect( & oObserver, & RateObserver::OnValue );
+
+        // Leading emission goes out immediately, the rest are held
+        oSignal.Emit( 1 );
+        assert( oObserver.m_nCalls == 1 && oObserver.m_pValues[0] == 1 );
+
+        oClock.SetSeconds( 0.2 );
+        oSignal.Emit( 2 );
+        oClock.SetSeconds( 0.5 );
+        oSignal.Emit( 3 );
+        assert( oSignal.HasPending() );
+
+        oClock.SetSeconds( 0.9 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 1 );
+
+        // Only the latest held emission is delivered
+        oClock.SetSeconds( 1.0 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 2 && oObserver.m_pValues[1] == 3 );
+        assert( ! oSignal.HasPending() );
+
+        // The trailing delivery starts the next interval
+        oClock.SetSeconds( 1.5 );
+        oSignal.Emit( 4 );
+        assert( oObserver.m_nCalls == 2 );
+
+        oClock.SetSeconds( 2.0 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 3 && oObserver.m_pValues[2] == 4 );
+
+        // A quiet interval ends the window, so the next emission leads again
+        oClock.SetSeconds( 3.0 );
+        oSignal.Update();
+        oClock.SetSeconds( 3.1 );
+        oSignal.Emit( 5 );
+        assert( oObserver.m_nCalls == 4 && oObserver.m_pValues[3] == 5 );
+
+        // An emission after a missed Update() delivers the due emission first
+        oClock.SetSeconds( 3.2 );
+        oSignal.Emit( 6 );
+        oClock.SetSeconds( 4.5 );
+        oSignal.Emit( 7 );
+        assert( oObserver.m_nCalls == 5 && oObserver.m_pValues[4] == 6 );
+        assert( oSignal.HasPending() );
+
+        oSignal.Cancel();
+        oClock.SetSeconds( 10.0 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 5 );
+    }
+
+    {
+        ManualClock oClock;
+        TestThrottledSignal oLeading( & oClock, 1.0, TestThrottledSignal::eFlag_Leading );
+        TestThrottledSignal oTrailing( & oClock, 1.0, TestThrottledSignal::eFlag_Trailing );
+        RateObserver oLeadingObserver;
+        RateObserver oTrailingObserver;
+        oLeading.Connect( & oLeadingObserver, & RateObserver::OnValue );
+        oTrailing.Connect( & oTrailingObserver, & RateObserver::OnValue );
+
+        for ( int i = 0; i < 5; ++i )
+        {
+            oClock.SetSeconds( i * 0.1 );
+            oLeading.Emit( i );
+            oTrailing.Emit( i );
+        }
+
+        assert( oLeadingObserver.m_nCalls == 1 && oLeadingObserver.m_pValues[0] == 0 );
+        assert( ! oLeading.HasPending() );
+        assert( oTrailingObserver.m_nCalls == 0 );
+
+        oClock.SetSeconds( 1.0 );
+        oLeading.Update();
+        oTrailing.Update();
+        assert( oLeadingObserver.m_nCalls == 1 );
+        assert( oTrailingObserver.m_nCalls == 1 && oTrailingObserver.m_pValues[0] == 4 );
+    }
+
+    printf( "Testing debounced signals...\n" );
+    {
+        ManualClock oClock;
+        TestDebouncedSignal oSignal( & oClock, 1.0 );
+        RateObserver oObserver;
+        oSignal.Connect( & oObserver, & RateObserver::OnValue );
+
+        oSignal.Emit( 1 );
+        oClock.SetSeconds( 0.5 );
+        oSignal.Emit( 2 );
+        oClock.SetSeconds( 1.2 );
+        oSignal.Update();
+        oClock.SetSeconds( 1.4 );
+        oSignal.Emit( 3 );
+        oClock.SetSeconds( 2.3 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 0 );
+
+        // Delivered once the emissions have been quiet for a full interval
+        oClock.SetSeconds( 2.4 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 1 && oObserver.m_pValues[0] == 3 );
+
+        oClock.SetSeconds( 5.0 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 1 );
+    }
+
+    {
+        ManualClock oClock;
+        TestDebouncedSignal oSignal( & oClock, 1.0, TestDebouncedSignal::eFlag_Leading );
+        RateObserver oObserver;
+        oSignal.Connect( & oObserver, & RateObserver::OnValue );
+
+        oSignal.Emit( 1 );
+        oClock.SetSeconds( 0.5 );
+        oSignal.Emit( 2 );
+        oClock.SetSeconds( 1.4 );
+        oSignal.Emit( 3 );
+        assert( oObserver.m_nCalls == 1 && oObserver.m_pValues[0] == 1 );
+
+        oClock.SetSeconds( 2.4 );
+        oSignal.Update();
+        oClock.SetSeconds( 2.5 );
+        oSignal.Emit( 4 );
+        assert( oObserver.m_nCalls == 2 && oObserver.m_pValues[1] == 4 );
+    }
+
+    // Held reference arguments are copies
+    {
+        ManualClock oClock;
+        ThrottledSignal< Signal1<const Position&> > oSignal( & oClock, 1.0, TestThrottledSignal::eFlag_Trailing );
+        RateObserver oObserver;
+        oSignal.Connect( & oObserver, & RateObserver::OnPosition );
+
+        Position oPosition = { 1, 2 };
+        oSignal.Emit( oPosition );
+        oPosition.x = 100;
+
+        oClock.SetSeconds( 1.0 );
+        oSignal.Update();
+        assert( oObserver.m_nCalls == 1 && oObserver.m_pValues[0] == 3 );
+    }
+
+    SignalBase::SetCommonConnectionAllocator( NULL );
+    SignalObserver::SetCommonConnectionAllocator( NULL );
+}
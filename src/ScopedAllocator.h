@@ -5,6 +5,7 @@
 //   Foo* pFoo = new( pFooAllocator->Alloc(sizeof(Foo)) ) Foo();
 // To use placement new, we need to include the standard 'new' header.
 #include <new>
+#include <stddef.h>
 
 namespace jl {
 
@@ -17,6 +18,45 @@ public:
     virtual ~ScopedAllocator() {};
     virtual void* Alloc( size_t nBytes ) = 0;
     virtual void Free( void* pObject ) = 0;
+    
+    // Batch versions of Alloc() and Free(). AllocN() allocates up to nCount objects
+    // of nBytes each into ppObjects, and returns how many it allocated. Allocators
+    // that can take or return a batch in one pass, like the object pools, override
+    // these; the defaults just make one call per object.
+    virtual unsigned AllocN( size_t nBytes, void** ppObjects, unsigned nCount )
+    {
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            ppObjects[i] = Alloc( nBytes );
+            
+            if ( ! ppObjects[i] )
+            {
+                return i;
+            }
+        }
+        
+        return nCount;
+    }
+    
+    virtual void FreeN( void** ppObjects, unsigned nCount )
+    {
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Free( ppObjects[i] );
+        }
+    }
+    
+    // Returns true while everything allocated from this allocator is about to be
+    // released at once, e.g. during ArenaScopedAllocator::BeginReset(). Lists whose
+    // nodes come from such an allocator skip freeing and unlinking when destroyed.
+    virtual bool IsReleasingAll() const { return false; }
+    
+    // Returns true if AllocN() hands out ascending addresses.
+    virtual bool IsAddressOrdered() const { return false; }
+    
+    // Returns true if AllocN() costs less per object than Alloc(). Batch users like
+    // SignalN::ConnectMany() only pay for a batch when this is true.
+    virtual bool PrefersBatches() const { return false; }
 };
     
 } // namespace jl
@@ -0,0 +1,167 @@
+#ifndef _JL_SHARDED_SIGNAL_H_
+#define _JL_SHARDED_SIGNAL_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+#include "ScopedAllocator.h"
+#include "SignalShard.h"
+
+namespace jl {
+
+/**
+ * A signal split into per-thread shards, e.g.:
+ *
+ *   ShardedSignal< Signal1<float>, 8 > oFrameEnd;
+ *
+ * Each shard is an ordinary signal. Connect(), Disconnect() and IsConnected()
+ * only touch the calling thread's shard, so threads with different shards can
+ * connect and disconnect at the same time without locks, as long as each
+ * shard has its own connection allocator (see SetShardAllocator()). Observers
+ * should likewise use a connection allocator owned by their thread.
+ *
+ * Emit() calls every shard in shard index order, so it must not run while
+ * other threads are connecting or disconnecting. Arguments are passed to each
+ * shard's Emit() the way the shard signal takes them, e.g. by const reference
+ * for types that fastdelegate::ParamTraits passes by reference.
+ *
+ * Two threads whose shard indices are equal modulo _MaxShards share a shard,
+ * and must not connect at the same time.
+ */
+template< typename TSignal, unsigned _MaxShards >
+class ShardedSignal
+{
+public:
+    typedef TSignal TShard;
+    enum { eMaxShards = _MaxShards };
+    
+    ShardedSignal() {}
+    
+    // Sets the connection allocator for every shard.
+    explicit ShardedSignal( ScopedAllocator* pAllocator )
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i )
+        {
+            m_pShards[i].SetAllocator( pAllocator );
+        }
+    }
+    
+    void SetShardAllocator( unsigned nShard, ScopedAllocator* pAllocator )
+    {
+        JL_ASSERT( nShard < eMaxShards );
+        m_pShards[nShard].SetAllocator( pAllocator );
+    }
+    
+    TShard& GetShard( unsigned nShard ) { JL_ASSERT( nShard < eMaxShards ); return m_pShards[nShard]; }
+    const TShard& GetShard( unsigned nShard ) const { JL_ASSERT( nShard < eMaxShards ); return m_pShards[nShard]; }
+    
+    // The shard that the calling thread connects into
+    TShard& GetLocalShard() { return m_pShards[ SignalShard::GetCurrentThreadShard() % eMaxShards ]; }
+    const TShard& GetLocalShard() const { return m_pShards[ SignalShard::GetCurrentThreadShard() % eMaxShards ]; }
+    
+    unsigned CountConnections() const
+    {
+        unsigned nConnections = 0;
+        
+        for ( unsigned i = 0; i < eMaxShards; ++i )
+        {
+            nConnections += m_pShards[i].CountConnections();
+        }
+        
+        return nConnections;
+    }
+    
+    // Connection management for the calling thread's shard. To pass connection
+    // flags to a non-instance function, use GetLocalShard().Connect().
+    template< typename TFunction >
+    void Connect( TFunction fpFunction ) { GetLocalShard().Connect( fpFunction ); }
+    
+    template< typename Y, typename TMethod >
+    void Connect( Y* pObject, TMethod fpMethod ) { GetLocalShard().Connect( pObject, fpMethod ); }
+    
+    template< typename Y, typename TMethod >
+    void Connect( Y* pObject, TMethod fpMethod, unsigned nFlags ) { GetLocalShard().Connect( pObject, fpMethod, nFlags ); }
+    
+    template< typename TFunction >
+    bool IsConnected( TFunction fpFunction ) const { return GetLocalShard().IsConnected( fpFunction ); }
+    
+    template< typename Y, typename TMethod >
+    bool IsConnected( Y* pObject, TMethod fpMethod ) const { return GetLocalShard().IsConnected( pObject, fpMethod ); }
+    
+    template< typename Y, typename TMethod >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags = 0 ) { return GetLocalShard().ConnectMany( pObjects, nCount, fpMethod, nFlags ); }
+    
+    // Accepts a non-instance function or a SignalObserver*, like SignalN::Disconnect().
+    template< typename T >
+    void Disconnect( T p ) { GetLocalShard().Disconnect( p ); }
+    
+    template< typename Y, typename TMethod >
+    void Disconnect( Y* pObject, TMethod fpMethod ) { GetLocalShard().Disconnect( pObject, fpMethod ); }
+    
+    // Disconnects every shard. Must not run concurrently with other connection changes.
+    void DisconnectAll()
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i )
+        {
+            m_pShards[i].DisconnectAll();
+        }
+    }
+    
+    // Emits every shard, in shard index order. Only the overload with the shard signal's
+    // arity can be called.
+    void Emit() const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit();
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2, typename TSignal::EmitParam3 a3 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2, a3 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2, typename TSignal::EmitParam3 a3, typename TSignal::EmitParam4 a4 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2, a3, a4 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2, typename TSignal::EmitParam3 a3, typename TSignal::EmitParam4 a4, typename TSignal::EmitParam5 a5 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2, a3, a4, a5 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2, typename TSignal::EmitParam3 a3, typename TSignal::EmitParam4 a4, typename TSignal::EmitParam5 a5, typename TSignal::EmitParam6 a6 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2, a3, a4, a5, a6 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2, typename TSignal::EmitParam3 a3, typename TSignal::EmitParam4 a4, typename TSignal::EmitParam5 a5, typename TSignal::EmitParam6 a6, typename TSignal::EmitParam7 a7 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2, a3, a4, a5, a6, a7 );
+    }
+    
+    void Emit( typename TSignal::EmitParam1 a1, typename TSignal::EmitParam2 a2, typename TSignal::EmitParam3 a3, typename TSignal::EmitParam4 a4, typename TSignal::EmitParam5 a5, typename TSignal::EmitParam6 a6, typename TSignal::EmitParam7 a7, typename TSignal::EmitParam8 a8 ) const
+    {
+        for ( unsigned i = 0; i < eMaxShards; ++i ) m_pShards[i].Emit( a1, a2, a3, a4, a5, a6, a7, a8 );
+    }
+    
+private:
+    // Shards are signals, which can't be copied safely
+    ShardedSignal( const ShardedSignal& );
+    ShardedSignal& operator=( const ShardedSignal& );
+    
+    TShard m_pShards[ eMaxShards ];
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_SHARDED_SIGNAL_H_ )
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "ShardedSignal.h"
+#include "StaticSignalConnectionAllocators.h"
+
+#if __cplusplus >= 201103L
+#include <thread>
+#include <vector>
+#endif
+
+using namespace jl;
+
+namespace
+{
+    enum { eShards = 4, eObserversPerShard = 64, eMaxConnections = 256 };
+
+    typedef ShardedSignal< Signal1<int>, eShards > TestSignal;
+
+    // Records the order in which observers were called
+    class OrderObserver : public SignalObserver
+    {
+    public:
+        OrderObserver() : m_nId(0), m_nTotal(0) {}
+
+        void OnEmit( int n )
+        {
+            m_nTotal += n;
+            s_pOrder[ s_nOrderCount++ ] = m_nId;
+        }
+
+        unsigned m_nId;
+        int m_nTotal;
+
+        static unsigned s_pOrder[ eShards * eObserversPerShard ];
+        static unsigned s_nOrderCount;
+    };
+
+    unsigned OrderObserver::s_pOrder[ eShards * eObserversPerShard ];
+    unsigned OrderObserver::s_nOrderCount = 0;
+
+#if __cplusplus >= 201103L
+    // Each worker connects observers into its own shard, with its own allocators, and
+    // churns them concurrently with the other workers.
+    void ShardWorker( TestSignal* pSignal, unsigned nShard, OrderObserver* pObservers, ScopedAllocator* pObserverAllocator )
+    {
+        SignalShard::SetCurrentThreadShard( nShard );
+
+        for ( unsigned nRound = 0; nRound < 50; ++nRound )
+        {
+            for ( unsigned i = 0; i < eObserversPerShard; ++i )
+            {
+                pObservers[i].SetConnectionAllocator( pObserverAllocator );
+                pSignal->Connect( & pObservers[i], & OrderObserver::OnEmit );
+                assert( pSignal->IsConnected(& pObservers[i], & OrderObserver::OnEmit) );
+            }
+
+            if ( nRound + 1 < 50 )
+            {
+                for ( unsigned i = 0; i < eObserversPerShard; ++i )
+                {
+                    pSignal->Disconnect( & pObservers[i], & OrderObserver::OnEmit );
+                }
+            }
+        }
+
+        assert( pSignal->GetLocalShard().CountConnections() == eObserversPerShard );
+    }
+#endif
+}
+
+void ShardedSignalTest()
+{
+    StaticSignalConnectionAllocator< eMaxConnections > pSignalAllocators[ eShards ];
+    StaticObserverConnectionAllocator< eMaxConnections > pObserverAllocators[ eShards ];
+    OrderObserver pObservers[ eShards ][ eObserversPerShard ];
+
+    for ( unsigned i = 0; i < eShards; ++i )
+    {
+        for ( unsigned j = 0; j < eObserversPerShard; ++j )
+        {
+            pObservers[i][j].m_nId = i * eObserversPerShard + j;
+            pObservers[i][j].SetConnectionAllocator( & pObserverAllocators[i] );
+        }
+    }
+
+    printf( "Testing ShardedSignal...\n" );
+
+    {
+        TestSignal oSignal;
+
+        for ( unsigned i = 0; i < eShards; ++i )
+        {
+            oSignal.SetShardAllocator( i, & pSignalAllocators[i] );
+        }
+
+        // Connect shards in reverse order; emission must still follow shard order
+        for ( unsigned i = eShards; i-- > 0; )
+        {
+            SignalShard::SetCurrentThreadShard( i );
+
+            for ( unsigned j = 0; j < eObserversPerShard; ++j )
+            {
+                oSignal.Connect( & pObservers[i][j], & OrderObserver::OnEmit );
+            }
+
+            assert( oSignal.GetLocalShard().CountConnections() == eObserversPerShard );
+            assert( pSignalAllocators[i].CountAllocations() == eObserversPerShard );
+        }
+
+        assert( oSignal.CountConnections() == eShards * eObserversPerShard );
+
+        OrderObserver::s_nOrderCount = 0;
+        oSignal.Emit( 1 );
+        assert( OrderObserver::s_nOrderCount == eShards * eObserversPerShard );
+
+        for ( unsigned i = 0; i < OrderObserver::s_nOrderCount; ++i )
+        {
+            assert( OrderObserver::s_pOrder[i] == i );
+        }
+
+        // Disconnection only affects the local shard
+        SignalShard::SetCurrentThreadShard( 1 );
+        assert( ! oSignal.IsConnected(& pObservers[0][0], & OrderObserver::OnEmit) );
+        oSignal.Disconnect( & pObservers[1][0] );
+        assert( oSignal.CountConnections() == eShards * eObserversPerShard - 1 );
+
+        // Observer destruction disconnects from whichever shard it was connected to
+        pObservers[2][0].DisconnectAllSignals();
+        assert( oSignal.GetShard(2).CountConnections() == eObserversPerShard - 1 );
+
+        oSignal.DisconnectAll();
+        assert( oSignal.CountConnections() == 0 );
+    }
+
+#if __cplusplus >= 201103L
+    printf( "Testing concurrent ShardedSignal connections...\n" );
+
+    {
+        TestSignal oSignal;
+        std::vector<std::thread> oThreads;
+
+        for ( unsigned i = 0; i < eShards; ++i )
+        {
+            oSignal.SetShardAllocator( i, & pSignalAllocators[i] );
+        }
+
+        for ( unsigned i = 0; i < eShards; ++i )
+        {
+            oThreads.push_back( std::thread(ShardWorker, & oSignal, i, pObservers[i], & pObserverAllocators[i]) );
+        }
+
+        for ( unsigned i = 0; i < eShards; ++i )
+        {
+            oThreads[i].join();
+        }
+
+        assert( oSignal.CountConnections() == eShards * eObserversPerShard );
+
+        OrderObserver::s_nOrderCount = 0;
+        oSignal.Emit( 1 );
+
+        for ( unsigned i = 0; i < OrderObserver::s_nOrderCount; ++i )
+        {
+            assert( OrderObserver::s_pOrder[i] == i );
+        }
+
+        oSignal.DisconnectAll();
+    }
+#endif
+
+    for ( unsigned i = 0; i < eShards; ++i )
+    {
+        assert( pSignalAllocators[i].CountAllocations() == 0 );
+        assert( pObserverAllocators[i].CountAllocations() == 0 );
+    }
+
+    printf( "Testing ShardedSignalConnectionAllocator...\n" );
+
+    // Every shard allocates connections from its own cache lines
+    ShardedSignalConnectionAllocator< eObserversPerShard, eShards >* pAllocator = new ShardedSignalConnectionAllocator< eObserversPerShard, eShards >();
+
+    {
+        TestSignal oSignal( pAllocator );
+
+        for ( unsigned i = 0; i < eShards; ++i )
+        {
+            SignalShard::SetCurrentThreadShard( i );
+
+            for ( unsigned j = 0; j < eObserversPerShard; ++j )
+            {
+                oSignal.Connect( & pObservers[i][j], & OrderObserver::OnEmit );
+            }
+
+            assert( pAllocator->GetPool(i).CountAllocations() == eObserversPerShard );
+            assert( (size_t)pAllocator->GetPool(i).GetObjectBuffer() % ObjectPool::eCacheLineSize == 0 );
+        }
+
+        for ( unsigned i = 0; i + 1 < eShards; ++i )
+        {
+            const size_t nLastLine = ( (size_t)pAllocator->GetPool(i).GetObjectBuffer() + eObserversPerShard * pAllocator->GetPool(i).GetStride() - 1 ) / ObjectPool::eCacheLineSize;
+            const size_t nNextLine = (size_t)pAllocator->GetPool(i + 1).GetObjectBuffer() / ObjectPool::eCacheLineSize;
+            assert( nLastLine < nNextLine );
+        }
+
+        // Disconnecting from another shard frees into the owning pool
+        SignalShard::SetCurrentThreadShard( 0 );
+        pObservers[3][0].DisconnectAllSignals();
+        assert( pAllocator->GetPool(3).CountAllocations() == eObserversPerShard - 1 );
+
+        oSignal.DisconnectAll();
+        assert( pAllocator->CountAllocations() == 0 );
+    }
+
+    delete pAllocator;
+}
@@ -8,7 +8,8 @@
 //#define JL_SIGNAL_ENABLE_LOGSPAM
 
 // Uncomment this to force assertion failures when a SignalObserver tries
-// to connect the same slot to the same signal twice. Recommended for debug only.
+// to connect the same slot to the same signal twice. Recommended for debug only,
+// except on signals with a connection index (see SignalN::SetConnectionIndex()).
 //#define JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT
 
 /**
@@ -5,9 +5,17 @@ using namespace jl;
 ScopedAllocator* jl::SignalObserver::s_pCommonAllocator = NULL;
 ScopedAllocator* SignalBase::s_pCommonAllocator = NULL;
 
+#if JL_SIGNAL_ENABLE_COROUTINES
+ScopedAllocator* jl::SignalTask::s_pFrameAllocator = NULL;
+#endif
+
 jl::SignalObserver::~SignalObserver()
 {
-    DisconnectAllSignals();
+    // If our connections are being released in bulk, so is every signal connected to us
+    if ( ! m_oSignals.IsAllocatorReleasingAll() )
+    {
+        DisconnectAllSignals();
+    }
 }
 
 void jl::SignalObserver::DisconnectSignal( SignalBase* pSignal )
@@ -39,6 +47,59 @@ void jl::SignalObserver::DisconnectAllSignals()
     m_oSignals.Clear();
 }
 
+void jl::SignalObserver::DisconnectObservers( SignalObserver* const* ppObservers, unsigned nCount )
+{
+    JL_SIGNAL_LOG( "Disconnecting %u observers from all signals\n", nCount );
+    
+    // Mark the set, so that signals can test membership in constant time
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        if ( ppObservers[i] )
+        {
+            ppObservers[i]->m_nDisconnectMarks |= eDisconnectMark_Observer;
+        }
+    }
+    
+    // Sweep every affected signal once
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        if ( ! ppObservers[i] )
+        {
+            continue;
+        }
+        
+        for ( SignalList::iterator j = ppObservers[i]->m_oSignals.begin(); j.isValid(); ++j )
+        {
+            SignalBase* pSignal = *j;
+            
+            if ( ! pSignal->m_bSwept )
+            {
+                pSignal->OnMarkedObserversDisconnect();
+                pSignal->m_bSwept = true;
+            }
+        }
+    }
+    
+    // Clear the marks and the observers' side of the connections
+    for ( unsigned i = 0; i < nCount; ++i )
+    {
+        SignalObserver* pObserver = ppObservers[i];
+        
+        if ( ! pObserver )
+        {
+            continue;
+        }
+        
+        for ( SignalList::iterator j = pObserver->m_oSignals.begin(); j.isValid(); ++j )
+        {
+            (*j)->m_bSwept = false;
+        }
+        
+        pObserver->m_oSignals.Clear();
+        pObserver->m_nDisconnectMarks &= ~eDisconnectMark_Observer;
+    }
+}
+
 void jl::SignalObserver::OnSignalConnect( SignalBase* pSignal )
 {
     JL_SIGNAL_LOG( "\tObserver %p received connection message from signal %p\n", this, pSignal );
@@ -46,6 +107,12 @@ void jl::SignalObserver::OnSignalConnect( SignalBase* pSignal )
     JL_ASSERT( bAdded );
 }
 
+void jl::SignalObserver::OnSignalConnect( SignalBase* pSignal, void* pNode )
+{
+    JL_SIGNAL_LOG( "\tObserver %p received connection message from signal %p\n", this, pSignal );
+    m_oSignals.AddAllocated( pNode, pSignal );
+}
+
 void jl::SignalObserver::OnSignalDisconnect( SignalBase* pSignal )
 {
     JL_SIGNAL_LOG( "\tObserver %p received disconnect message from signal %p\n", this, pSignal );
@@ -65,3 +132,34 @@ void jl::SignalObserver::OnSignalDisconnect( SignalBase* pSignal )
         }
     }
 }
+
+void jl::SignalObserver::OnSignalDisconnect( SignalBase* pSignal, unsigned nConnections )
+{
+    JL_SIGNAL_LOG( "\tObserver %p received disconnect message for %u connections from signal %p\n", this, nConnections, pSignal );
+    
+    // There is one entry per connection
+    bool bConnected = false;
+    
+    for ( SignalList::iterator i = m_oSignals.begin(); i.isValid(); )
+    {
+        if ( *i != pSignal )
+        {
+            ++i;
+        }
+        else if ( nConnections > 0 )
+        {
+            m_oSignals.Remove( i );
+            --nConnections;
+        }
+        else
+        {
+            bConnected = true;
+            break;
+        }
+    }
+    
+    if ( ! bConnected )
+    {
+        OnSignalDisconnectInternal( pSignal );
+    }
+}
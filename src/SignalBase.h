@@ -1,14 +1,53 @@
 #ifndef _JL_SIGNAL_BASE_H_
 #define _JL_SIGNAL_BASE_H_
 
+#include <new>
+
 #include "Utils.h"
 #include "DoublyLinkedList.h"
+#include "HashIndex.h"
+#include "WeakHandle.h"
+
+#if __cplusplus >= 201103L
+#include <memory>
+#include <type_traits>
+#endif
 
 namespace jl {
 
 // Forward declarations
 class SignalBase;
 
+// The type used to keep a copy of a signal argument, e.g. in SignalN::Arguments.
+// References are stored as the referenced type.
+template< typename T > struct SignalArgumentStorage { typedef T Type; };
+template< typename T > struct SignalArgumentStorage< T& > { typedef T Type; };
+template< typename T > struct SignalArgumentStorage< const T& > { typedef T Type; };
+
+// Stands in for the parameters past a signal's arity, e.g. in SignalN::EmitParam8.
+struct SignalNoParam {};
+
+// Returned by SignalN::Connect() for a function object, so that the connection can be removed
+// on its own with SignalN::Disconnect(). Empty if the connection couldn't be made. Only
+// meaningful to the signal that returned it. Once the connection is removed, Disconnect()
+// ignores it, even if a later functor connection reuses its block.
+class FunctorConnection
+{
+public:
+    FunctorConnection() : m_pSlot(NULL), m_nSerial(0), m_nHash(0) {}
+    FunctorConnection( const void* pSlot, unsigned nSerial, unsigned nHash ) : m_pSlot(pSlot), m_nSerial(nSerial), m_nHash(nHash) {}
+    
+    bool IsValid() const { return m_pSlot != NULL; }
+    const void* GetSlot() const { return m_pSlot; }
+    unsigned GetSerial() const { return m_nSerial; } // tells apart functors given the same block
+    unsigned GetHash() const { return m_nHash; } // the connection's key in a connection index
+    
+private:
+    const void* m_pSlot;
+    unsigned m_nSerial;
+    unsigned m_nHash;
+};
+
 // Derive from this class to receive signals
 class SignalObserver
 {
@@ -19,14 +58,23 @@ public:
     void DisconnectAllSignals();
     void DisconnectSignal( SignalBase* pSignal );
     
+    // Disconnects every observer in the array from all of its signals, e.g. before unloading
+    // a zone. Same as calling DisconnectAllSignals() on each observer, but each signal they are
+    // connected to is swept only once, so the cost is linear in the number of connections
+    // touched rather than in observers times connections.
+    static void DisconnectObservers( SignalObserver* const* ppObservers, unsigned nCount );
+    
     void SetConnectionAllocator( ScopedAllocator* pAllocator ) { m_oSignals.Init( pAllocator ); }
     unsigned CountSignalConnections() const { return m_oSignals.Count(); }
     
+    // Moves this observer's connection nodes to lower addresses. See DoublyLinkedList::Compact().
+    bool CompactSignalConnections( unsigned nMaxNodes = 0 ) { return m_oSignals.Compact( nMaxNodes ); }
+    
     // Interface for child classes
 protected:
     // Disallow instances of this class
-    SignalObserver() { SetConnectionAllocator( s_pCommonAllocator ); }
-    SignalObserver( ScopedAllocator* pAllocator ) { SetConnectionAllocator( pAllocator ); }
+    SignalObserver() : m_nDisconnectMarks(0) { SetConnectionAllocator( s_pCommonAllocator ); }
+    SignalObserver( ScopedAllocator* pAllocator ) : m_nDisconnectMarks(0) { SetConnectionAllocator( pAllocator ); }
     
     // Hmm, a bit of a hack, but if a derived type caches pointers to signals,
     // we may need this
@@ -37,7 +85,9 @@ private:
     friend class SignalBase;
     
     void OnSignalConnect( SignalBase* pSignal );
+    void OnSignalConnect( SignalBase* pSignal, void* pNode );
     void OnSignalDisconnect( SignalBase* pSignal );
+    void OnSignalDisconnect( SignalBase* pSignal, unsigned nConnections );
     
     // Signal list
 public:
@@ -47,6 +97,14 @@ public:
 private:
     SignalList m_oSignals;
     
+    // Set only during DisconnectObservers()
+    enum DisconnectMarks
+    {
+        eDisconnectMark_Observer = 0x01, // in the set being disconnected
+    };
+    
+    unsigned m_nDisconnectMarks;
+    
     // Global allocator
 public:
     static void SetCommonConnectionAllocator( ScopedAllocator* pAllocator ) { s_pCommonAllocator = pAllocator; }
@@ -58,6 +116,32 @@ private:
 class SignalBase
 {
 public:
+    // Flags for SignalN::Connect()
+    enum ConnectionFlags
+    {
+        // The connected function may be called from any thread, concurrently with
+        // other parallel-safe functions. See SignalN::EmitParallel().
+        eConnectionFlag_ParallelSafe = 0x01,
+        
+        // The connection is called before those made without this flag, and the latest
+        // one made with it is called first, e.g. so that a modal input handler sees
+        // events before the ones under it. See SignalN::EmitUntilConsumed().
+        eConnectionFlag_First = 0x02,
+        
+        // Set by SignalN::Forward(). Don't pass this.
+        eConnectionFlag_Forward = 0x10,
+        
+        // Set on connections removed during an Emit(), which stay in the list until the
+        // outermost Emit() returns. Don't pass this.
+        eConnectionFlag_Removed = 0x20,
+        
+        // Set by SignalN::ConnectWeak(), along with eConnectionFlag_Functor. Don't pass this.
+        eConnectionFlag_Weak = 0x40,
+        
+        // Set by SignalN::Connect() on connections that call a functor. Don't pass this.
+        eConnectionFlag_Functor = 0x80,
+    };
+    
     virtual ~SignalBase() {};
     
     virtual unsigned CountConnections() const = 0;
@@ -65,19 +149,38 @@ public:
     // Interface for derived signal classes
 protected:
     // Disallow instances of this class
-    SignalBase() {}
+    SignalBase() : m_bSwept(false) {}
     
     // Called on any connection to the observer.
     void NotifyObserverConnect( SignalObserver* pObserver ) { pObserver->OnSignalConnect(this); }
     
+    // Batch support for ConnectMany(). Nodes for an observer's side of a connection can be
+    // taken from GetObserverAllocator() ahead of time, and handed to NotifyObserverConnect().
+    enum { eMaxObserverConnectBatch = 64 };
+    ScopedAllocator* GetObserverAllocator( const SignalObserver* pObserver ) const { return pObserver->m_oSignals.GetAllocator(); }
+    void NotifyObserverConnect( SignalObserver* pObserver, void* pNode ) { pObserver->OnSignalConnect(this, pNode); }
+    
     // Called when no more connections exist to the observer.
     void NotifyObserverDisconnect( SignalObserver* pObserver ) { pObserver->OnSignalDisconnect(this); }
     
+    // Called when nConnections of the observer's connections were removed, for signals that
+    // don't know whether any are left. Only touches the observer's own connection list.
+    void NotifyObserverDisconnect( SignalObserver* pObserver, unsigned nConnections ) { pObserver->OnSignalDisconnect(this, nConnections); }
+    
+    // True if the observer is in the set passed to SignalObserver::DisconnectObservers().
+    static bool IsMarkedForDisconnect( const SignalObserver* pObserver ) { return ( pObserver->m_nDisconnectMarks & SignalObserver::eDisconnectMark_Observer ) != 0; }
+    
     // Private interface (for SignalObserver)
 private:
     friend class SignalObserver;
     virtual void OnObserverDisconnect( SignalObserver* pObserver ) = 0;
     
+    // Removes every connection to an observer for which IsMarkedForDisconnect() is true. Unlike
+    // OnObserverDisconnect(), this doesn't notify the observers.
+    virtual void OnMarkedObserversDisconnect() = 0;
+    
+    bool m_bSwept; // set only during SignalObserver::DisconnectObservers(), once swept
+    
     // Global allocator
 public:
     static void SetCommonConnectionAllocator( ScopedAllocator* pAllocator ) { s_pCommonAllocator = pAllocator; }
@@ -0,0 +1,1341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "Signal.h"
+#include "DynamicSignal.h"
+#include "SignalLog.h"
+#include "StaticSignalConnectionAllocators.h"
+#include "WorkStealingTaskScheduler.h"
+
+using namespace jl;
+
+// Benchmarks are not run by default; pass -benchmark to the test executable.
+namespace
+{
+    enum
+    {
+        eSignalCount = 16,
+        eObserverCount = 4096,
+        eConnectionCount = eSignalCount * eObserverCount,
+        eChurnRounds = 32,
+        eChurnPerRound = 2048,
+        eEmitsPerSample = 50,
+    };
+
+    class BenchmarkObserver : public SignalObserver
+    {
+    public:
+        BenchmarkObserver() : m_nTotal(0) {}
+
+        void OnEmit( int n ) { m_nTotal += n; }
+
+        int m_nTotal;
+    };
+
+    typedef Signal1< int > BenchmarkSignal;
+
+    // Returns the average time per slot call, in nanoseconds.
+    double TimeEmits( BenchmarkSignal* pSignals )
+    {
+        unsigned nCalls = 0;
+        const clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eEmitsPerSample; ++i )
+        {
+            for ( unsigned j = 0; j < eSignalCount; ++j )
+            {
+                pSignals[j].Emit( 1 );
+                nCalls += pSignals[j].CountConnections();
+            }
+        }
+
+        const clock_t nEnd = clock();
+        return nCalls ? ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / nCalls : 0.0;
+    }
+
+    // Connects every observer to every signal, then repeatedly disconnects random
+    // connections and reconnects them, timing emission after each round. Signals
+    // either share one connection pool, which is larger than a typical L2 cache, or
+    // each have their own. The random seed is fixed, so every allocation policy sees
+    // the same churn. With bCompact, every signal's connections are compacted after
+    // each round.
+    template< typename _TConnectionAllocator >
+    void ChurnBenchmark( double* pTimes, bool bPoolPerSignal, bool bCompact )
+    {
+        _TConnectionAllocator* pConnectionAllocators = new _TConnectionAllocator[ bPoolPerSignal ? eSignalCount : 1 ];
+        StaticObserverConnectionAllocator< eConnectionCount >* pObserverAllocator = new StaticObserverConnectionAllocator< eConnectionCount >();
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ eObserverCount ];
+        BenchmarkSignal* pSignals = new BenchmarkSignal[ eSignalCount ];
+
+        for ( unsigned i = 0; i < eObserverCount; ++i )
+        {
+            pObservers[i].SetConnectionAllocator( pObserverAllocator );
+        }
+
+        for ( unsigned i = 0; i < eSignalCount; ++i )
+        {
+            pSignals[i].SetAllocator( & pConnectionAllocators[ bPoolPerSignal ? i : 0 ] );
+
+            for ( unsigned j = 0; j < eObserverCount; ++j )
+            {
+                pSignals[i].Connect( & pObservers[j], & BenchmarkObserver::OnEmit );
+            }
+        }
+
+        srand( 1 );
+        pTimes[0] = TimeEmits( pSignals );
+
+        for ( unsigned nRound = 1; nRound <= eChurnRounds; ++nRound )
+        {
+            unsigned pSignalIndices[ eChurnPerRound ];
+            unsigned pObserverIndices[ eChurnPerRound ];
+            unsigned nDisconnections = 0;
+
+            for ( unsigned i = 0; i < eChurnPerRound; ++i )
+            {
+                const unsigned nSignal = rand() % eSignalCount;
+                const unsigned nObserver = rand() % eObserverCount;
+
+                if ( pSignals[nSignal].IsConnected(& pObservers[nObserver], & BenchmarkObserver::OnEmit) )
+                {
+                    pSignals[nSignal].Disconnect( & pObservers[nObserver], & BenchmarkObserver::OnEmit );
+                    pSignalIndices[nDisconnections] = nSignal;
+                    pObserverIndices[nDisconnections] = nObserver;
+                    ++nDisconnections;
+                }
+            }
+
+            for ( unsigned i = 0; i < nDisconnections; ++i )
+            {
+                pSignals[ pSignalIndices[i] ].Connect( & pObservers[ pObserverIndices[i] ], & BenchmarkObserver::OnEmit );
+            }
+
+            for ( unsigned i = 0; bCompact && i < eSignalCount; ++i )
+            {
+                pSignals[i].CompactConnections();
+            }
+
+            pTimes[nRound] = TimeEmits( pSignals );
+        }
+
+        delete[] pSignals;
+        delete[] pObservers;
+        delete pObserverAllocator;
+        delete[] pConnectionAllocators;
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eMixedObserverCount = 4096,
+        eMixedClassCount = 8,
+        eMixedEmits = 200,
+    };
+
+    // Observer classes that each connect a different method
+    template< int _N >
+    class MixedObserver : public SignalObserver
+    {
+    public:
+        MixedObserver() : m_nTotal(0) {}
+
+        void OnEmit( int n ) { m_nTotal += n * _N; }
+
+        int m_nTotal;
+    };
+
+    // Returns the average time per slot call, in nanoseconds.
+    double TimeMixedEmits( BenchmarkSignal& oSignal )
+    {
+        const clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eMixedEmits; ++i )
+        {
+            oSignal.Emit( 1 );
+        }
+
+        const clock_t nEnd = clock();
+        return ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / ( eMixedEmits * oSignal.CountConnections() );
+    }
+
+    template< int _N >
+    void ConnectMixed( BenchmarkSignal& oSignal, SignalObserver* pObservers, unsigned nIndex )
+    {
+        oSignal.Connect( static_cast< MixedObserver<_N>* >(pObservers) + nIndex, & MixedObserver<_N>::OnEmit );
+    }
+
+    // Connects objects of several classes to one signal, in random class order, and
+    // compares connection-order dispatch with grouped dispatch.
+    void GroupedDispatchBenchmark()
+    {
+        typedef void (*ConnectFunction)( BenchmarkSignal&, SignalObserver*, unsigned );
+        const ConnectFunction pConnectFunctions[ eMixedClassCount ] =
+        {
+            & ConnectMixed<1>, & ConnectMixed<2>, & ConnectMixed<3>, & ConnectMixed<4>,
+            & ConnectMixed<5>, & ConnectMixed<6>, & ConnectMixed<7>, & ConnectMixed<8>,
+        };
+
+        StaticSignalConnectionAllocator< eMixedObserverCount >* pConnectionAllocator = new StaticSignalConnectionAllocator< eMixedObserverCount >();
+        StaticObserverConnectionAllocator< eMixedObserverCount >* pObserverAllocator = new StaticObserverConnectionAllocator< eMixedObserverCount >();
+        SignalObserver::SetCommonConnectionAllocator( pObserverAllocator ); // before the observers are created
+
+        SignalObserver* pObservers[ eMixedClassCount ] =
+        {
+            new MixedObserver<1>[ eMixedObserverCount ], new MixedObserver<2>[ eMixedObserverCount ],
+            new MixedObserver<3>[ eMixedObserverCount ], new MixedObserver<4>[ eMixedObserverCount ],
+            new MixedObserver<5>[ eMixedObserverCount ], new MixedObserver<6>[ eMixedObserverCount ],
+            new MixedObserver<7>[ eMixedObserverCount ], new MixedObserver<8>[ eMixedObserverCount ],
+        };
+
+        printf( "\nGrouped dispatch benchmark: %d slots, %d emits\n", eMixedObserverCount, eMixedEmits );
+        printf( "Classes\tConnection order (ns/slot)\tGrouped (ns/slot)\n" );
+
+        for ( unsigned nClasses = 1; nClasses <= eMixedClassCount; nClasses *= 2 )
+        {
+            BenchmarkSignal oSignal( pConnectionAllocator );
+            unsigned pNextIndex[ eMixedClassCount ] = { 0 };
+            srand( 1 );
+
+            for ( unsigned i = 0; i < eMixedObserverCount; ++i )
+            {
+                const unsigned nClass = rand() % nClasses;
+                pConnectFunctions[nClass]( oSignal, pObservers[nClass], pNextIndex[nClass]++ );
+            }
+
+            TimeMixedEmits( oSignal ); // warm up
+            const double fOrdered = TimeMixedEmits( oSignal );
+
+            oSignal.SetGroupedDispatch( true );
+            TimeMixedEmits( oSignal );
+            const double fGrouped = TimeMixedEmits( oSignal );
+
+            printf( "%u\t%.2f\t\t\t\t%.2f\n", nClasses, fOrdered, fGrouped );
+        }
+
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+
+        delete[] static_cast< MixedObserver<1>* >( pObservers[0] );
+        delete[] static_cast< MixedObserver<2>* >( pObservers[1] );
+        delete[] static_cast< MixedObserver<3>* >( pObservers[2] );
+        delete[] static_cast< MixedObserver<4>* >( pObservers[3] );
+        delete[] static_cast< MixedObserver<5>* >( pObservers[4] );
+        delete[] static_cast< MixedObserver<6>* >( pObservers[5] );
+        delete[] static_cast< MixedObserver<7>* >( pObservers[6] );
+        delete[] static_cast< MixedObserver<8>* >( pObservers[7] );
+        delete pObserverAllocator;
+        delete pConnectionAllocator;
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eScatteredConnectionCount = 512 * 1024,
+        eScatteredEmits = 10,
+    };
+
+    // Connects one observer per slot of a large signal connection pool, in random
+    // slot order, so that each Emit() touches the pool's pages in random order.
+    // Returns the average time per slot call, in nanoseconds.
+    double TimeScatteredEmits( unsigned nPoolFlags, ScopedAllocator* pObserverAllocator, bool& bHugePages )
+    {
+        PreallocatedObjectPoolAllocator oConnectionAllocator;
+        void* pBuffer = ( nPoolFlags & PreallocatedObjectPool::eFlag_VirtualMemory ) ? NULL : new unsigned char[ size_t(eScatteredConnectionCount) * BenchmarkSignal::eAllocationSize ];
+        oConnectionAllocator.Init( pBuffer, eScatteredConnectionCount, BenchmarkSignal::eAllocationSize, nPoolFlags );
+        bHugePages = oConnectionAllocator.GetPool().IsUsingHugePages();
+
+        // Shuffle the free list
+        void** ppSlots = new void*[ eScatteredConnectionCount ];
+        for ( unsigned i = 0; i < eScatteredConnectionCount; ++i )
+        {
+            ppSlots[i] = oConnectionAllocator.GetPool().Alloc();
+        }
+
+        srand( 1 );
+        for ( unsigned i = eScatteredConnectionCount - 1; i > 0; --i )
+        {
+            const unsigned j = unsigned( ( (double)rand() / ( (double)RAND_MAX + 1.0 ) ) * ( i + 1 ) );
+            void* p = ppSlots[i];
+            ppSlots[i] = ppSlots[j];
+            ppSlots[j] = p;
+        }
+
+        for ( unsigned i = 0; i < eScatteredConnectionCount; ++i )
+        {
+            oConnectionAllocator.GetPool().Free( ppSlots[i] );
+        }
+
+        delete[] ppSlots;
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ eScatteredConnectionCount ];
+        double fTime;
+
+        {
+            BenchmarkSignal oSignal( & oConnectionAllocator );
+
+            for ( unsigned i = 0; i < eScatteredConnectionCount; ++i )
+            {
+                pObservers[i].SetConnectionAllocator( pObserverAllocator );
+                oSignal.Connect( & pObservers[i], & BenchmarkObserver::OnEmit );
+            }
+
+            oSignal.Emit( 1 ); // warm up
+
+            const clock_t nStart = clock();
+
+            for ( unsigned i = 0; i < eScatteredEmits; ++i )
+            {
+                oSignal.Emit( 1 );
+            }
+
+            const clock_t nEnd = clock();
+            fTime = ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / ( double(eScatteredEmits) * double(eScatteredConnectionCount) );
+        }
+
+        delete[] pObservers;
+        oConnectionAllocator.Deinit();
+
+        return fTime;
+    }
+
+    // Compares a large, scattered connection pool in an array-new buffer with the
+    // same pool in reserved virtual memory, with and without huge pages.
+    void HugePageBenchmark()
+    {
+        StaticObserverConnectionAllocator< eScatteredConnectionCount >* pObserverAllocator = new StaticObserverConnectionAllocator< eScatteredConnectionCount >();
+        bool bHugePages = false;
+
+        printf( "\nHuge page benchmark: %d slots in random pool order, %d emits\n", eScatteredConnectionCount, eScatteredEmits );
+        printf( "Buffer\t\t\t\tns/slot\n" );
+
+        const double fArrayNew = TimeScatteredEmits( PreallocatedObjectPool::eFlag_ManageBuffer, pObserverAllocator, bHugePages );
+        printf( "array-new\t\t\t%.2f\n", fArrayNew );
+
+        const double fVirtual = TimeScatteredEmits( PreallocatedObjectPool::eFlag_VirtualMemory, pObserverAllocator, bHugePages );
+        printf( "virtual memory\t\t\t%.2f\n", fVirtual );
+
+        const double fHuge = TimeScatteredEmits( PreallocatedObjectPool::eFlag_TransparentHugePages, pObserverAllocator, bHugePages );
+        printf( "transparent huge pages%s\t%.2f\n", bHugePages ? "" : "*", fHuge );
+
+        if ( ! bHugePages )
+        {
+            printf( "* huge pages unavailable, so regular pages were used\n" );
+        }
+
+        delete pObserverAllocator;
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eBatchObjectCount = 64 * 1024,
+        eBatchSize = 256,
+        eBatchRounds = 100,
+    };
+
+    // Returns the average time per object to allocate and free eBatchObjectCount
+    // objects through the ScopedAllocator interface, in nanoseconds.
+    double TimeAllocations( ScopedAllocator* pAllocator, void** ppObjects, bool bBatched )
+    {
+        const clock_t nStart = clock();
+
+        for ( unsigned nRound = 0; nRound < eBatchRounds; ++nRound )
+        {
+            for ( unsigned i = 0; i < eBatchObjectCount; i += eBatchSize )
+            {
+                if ( bBatched )
+                {
+                    pAllocator->AllocN( BenchmarkSignal::eAllocationSize, ppObjects + i, eBatchSize );
+                }
+                else
+                {
+                    for ( unsigned j = i; j < i + eBatchSize; ++j )
+                    {
+                        ppObjects[j] = pAllocator->Alloc( BenchmarkSignal::eAllocationSize );
+                    }
+                }
+            }
+
+            for ( unsigned i = 0; i < eBatchObjectCount; i += eBatchSize )
+            {
+                if ( bBatched )
+                {
+                    pAllocator->FreeN( ppObjects + i, eBatchSize );
+                }
+                else
+                {
+                    for ( unsigned j = i; j < i + eBatchSize; ++j )
+                    {
+                        pAllocator->Free( ppObjects[j] );
+                    }
+                }
+            }
+        }
+
+        const clock_t nEnd = clock();
+        return ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / ( double(eBatchRounds) * double(eBatchObjectCount) );
+    }
+
+    template< typename TAllocator >
+    void PrintBatchRow( const char* pName, void** ppObjects )
+    {
+        TAllocator* pAllocator = new TAllocator();
+        const double fSingle = TimeAllocations( pAllocator, ppObjects, false );
+        const double fBatched = TimeAllocations( pAllocator, ppObjects, true );
+        printf( "%s\t%.2f\t\t\t%.2f\n", pName, fSingle, fBatched );
+        delete pAllocator;
+    }
+
+    // Compares Alloc()/Free() per object with AllocN()/FreeN(), e.g. for level loads
+    void BatchAllocationBenchmark()
+    {
+        void** ppObjects = new void*[ eBatchObjectCount ];
+
+        printf( "\nBatch allocation benchmark: %d objects in batches of %d\n", eBatchObjectCount, eBatchSize );
+        printf( "Pool\t\tAlloc/Free (ns/object)\tAllocN/FreeN (ns/object)\n" );
+        PrintBatchRow< StaticSignalConnectionAllocator<eBatchObjectCount> >( "Free list", ppObjects );
+        PrintBatchRow< StaticSignalConnectionAllocator<eBatchObjectCount, ObjectPool::eFlag_AddressOrdered> >( "Address-ordered", ppObjects );
+
+        delete[] ppObjects;
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eWiringObserverCount = 20000,
+        eWiringGroupedObserverCount = 2000, // sorted insertion is O(n) per Connect()
+        eWiringSignalCount = 8,
+        eWiringRounds = 20,
+    };
+
+    // Returns the average time per connection to wire nObservers observers to every signal
+    // and then disconnect everything, in nanoseconds.
+    double TimeWiring( BenchmarkSignal* pSignals, BenchmarkObserver* pObservers, unsigned nObservers, bool bConnectMany )
+    {
+        const clock_t nStart = clock();
+
+        for ( unsigned nRound = 0; nRound < eWiringRounds; ++nRound )
+        {
+            for ( unsigned i = 0; i < eWiringSignalCount; ++i )
+            {
+                if ( bConnectMany )
+                {
+                    pSignals[i].ConnectMany( pObservers, nObservers, & BenchmarkObserver::OnEmit );
+                }
+                else
+                {
+                    for ( unsigned j = 0; j < nObservers; ++j )
+                    {
+                        pSignals[i].Connect( & pObservers[j], & BenchmarkObserver::OnEmit );
+                    }
+                }
+            }
+
+            for ( unsigned i = 0; i < eWiringSignalCount; ++i )
+            {
+                pSignals[i].DisconnectAll();
+            }
+        }
+
+        const clock_t nEnd = clock();
+        return ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / ( double(eWiringRounds) * double(eWiringSignalCount) * double(nObservers) );
+    }
+
+    template< unsigned _PoolFlags >
+    void TimeWiring( const char* pDescription, unsigned nObservers, bool bGroupedDispatch )
+    {
+        typedef StaticSignalConnectionAllocator< eWiringObserverCount * eWiringSignalCount, _PoolFlags > TConnectionAllocator;
+        typedef StaticObserverConnectionAllocator< eWiringObserverCount * eWiringSignalCount, _PoolFlags > TObserverAllocator;
+        TConnectionAllocator* pConnectionAllocator = new TConnectionAllocator();
+        TObserverAllocator* pObserverAllocator = new TObserverAllocator();
+        SignalObserver::SetCommonConnectionAllocator( pObserverAllocator ); // before the observers are created
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ nObservers ];
+        BenchmarkSignal* pSignals = new BenchmarkSignal[ eWiringSignalCount ];
+
+        for ( unsigned i = 0; i < eWiringSignalCount; ++i )
+        {
+            pSignals[i].SetAllocator( pConnectionAllocator );
+            pSignals[i].SetGroupedDispatch( bGroupedDispatch );
+        }
+
+        TimeWiring( pSignals, pObservers, nObservers, false ); // warm up
+        const double fSingle = TimeWiring( pSignals, pObservers, nObservers, false );
+        const double fMany = TimeWiring( pSignals, pObservers, nObservers, true );
+        printf( "%s\t%d\t\t%.2f\t\t%.2f\n", pDescription, nObservers, fSingle, fMany );
+
+        delete[] pSignals;
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+        delete pObserverAllocator;
+        delete pConnectionAllocator;
+    }
+
+    // Compares a Connect() per observer with ConnectMany(), e.g. for level loads
+    void ConnectManyBenchmark()
+    {
+        printf( "\nConnectMany benchmark: observers x %d signals, connect and disconnect all\n", eWiringSignalCount );
+        printf( "Pools\t\tObservers\tConnect() (ns)\tConnectMany() (ns)\n" );
+
+        TimeWiring< 0 >( "free list", eWiringObserverCount, false );
+        TimeWiring< ObjectPool::eFlag_AddressOrdered >( "ordered", eWiringObserverCount, false );
+        TimeWiring< 0 >( "grouped", eWiringGroupedObserverCount, true );
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eUnloadObserverCount = 4000,
+        eUnloadSignalCount = 8,
+    };
+
+    // Wires every observer to every signal, then returns the time per connection to
+    // disconnect all the observers, in nanoseconds.
+    double TimeUnload( BenchmarkSignal* pSignals, BenchmarkObserver* pObservers, SignalObserver** ppObservers, bool bBulk )
+    {
+        for ( unsigned i = 0; i < eUnloadSignalCount; ++i )
+        {
+            pSignals[i].ConnectMany( pObservers, eUnloadObserverCount, & BenchmarkObserver::OnEmit );
+        }
+
+        const clock_t nStart = clock();
+
+        if ( bBulk )
+        {
+            SignalObserver::DisconnectObservers( ppObservers, eUnloadObserverCount );
+        }
+        else
+        {
+            for ( unsigned i = 0; i < eUnloadObserverCount; ++i )
+            {
+                ppObservers[i]->DisconnectAllSignals();
+            }
+        }
+
+        const clock_t nEnd = clock();
+
+        for ( unsigned i = 0; i < eUnloadSignalCount; ++i )
+        {
+            JL_ASSERT( pSignals[i].CountConnections() == 0 );
+        }
+
+        return ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / ( double(eUnloadSignalCount) * double(eUnloadObserverCount) );
+    }
+
+    // Compares DisconnectAllSignals() per observer with SignalObserver::DisconnectObservers(),
+    // e.g. for zone unloads
+    void DisconnectObserversBenchmark()
+    {
+        typedef StaticSignalConnectionAllocator< eUnloadObserverCount * eUnloadSignalCount > TConnectionAllocator;
+        typedef StaticObserverConnectionAllocator< eUnloadObserverCount * eUnloadSignalCount > TObserverAllocator;
+        TConnectionAllocator* pConnectionAllocator = new TConnectionAllocator();
+        TObserverAllocator* pObserverAllocator = new TObserverAllocator();
+        SignalObserver::SetCommonConnectionAllocator( pObserverAllocator ); // before the observers are created
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ eUnloadObserverCount ];
+        SignalObserver** ppObservers = new SignalObserver*[ eUnloadObserverCount ];
+        BenchmarkSignal* pSignals = new BenchmarkSignal[ eUnloadSignalCount ];
+
+        for ( unsigned i = 0; i < eUnloadObserverCount; ++i )
+        {
+            ppObservers[i] = & pObservers[i];
+        }
+
+        for ( unsigned i = 0; i < eUnloadSignalCount; ++i )
+        {
+            pSignals[i].SetAllocator( pConnectionAllocator );
+        }
+
+        printf( "\nDisconnectObservers benchmark: %d observers x %d signals\n", eUnloadObserverCount, eUnloadSignalCount );
+        printf( "DisconnectAllSignals() (ns/connection)\tDisconnectObservers() (ns/connection)\n" );
+
+        const double fSingle = TimeUnload( pSignals, pObservers, ppObservers, false );
+        const double fBulk = TimeUnload( pSignals, pObservers, ppObservers, true );
+        printf( "%.2f\t\t\t\t\t%.2f\n", fSingle, fBulk );
+
+        delete[] pSignals;
+        delete[] ppObservers;
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+        delete pObserverAllocator;
+        delete pConnectionAllocator;
+    }
+}
+
+namespace
+{
+    // Does the same as BenchmarkObserver::OnEmit()
+    struct BenchmarkFunctor
+    {
+        BenchmarkObserver* pObserver;
+
+        void operator()( int n ) const { pObserver->m_nTotal += n; }
+    };
+
+    // Compares calls through instance method connections with calls through functor
+    // connections that do the same work.
+    void FunctorBenchmark()
+    {
+        // Half the slots are functors, which use a second block for the functor copy
+        typedef StaticSignalConnectionAllocator< eConnectionCount / 2 * 3 > TConnectionAllocator;
+        typedef StaticObserverConnectionAllocator< eConnectionCount / 2 > TObserverAllocator;
+        TConnectionAllocator* pConnectionAllocator = new TConnectionAllocator();
+        TObserverAllocator* pObserverAllocator = new TObserverAllocator();
+        SignalObserver::SetCommonConnectionAllocator( pObserverAllocator ); // before the observers are created
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ eObserverCount ];
+        BenchmarkSignal* pMethodSignals = new BenchmarkSignal[ eSignalCount ];
+        BenchmarkSignal* pFunctorSignals = new BenchmarkSignal[ eSignalCount ];
+
+        // Connect both sets in the same interleaved order, so their nodes are laid out alike
+        for ( unsigned i = 0; i < eSignalCount; ++i )
+        {
+            pMethodSignals[i].SetAllocator( pConnectionAllocator );
+            pFunctorSignals[i].SetAllocator( pConnectionAllocator );
+
+            for ( unsigned j = 0; j < eObserverCount / 2; ++j )
+            {
+                BenchmarkFunctor oFunctor = { & pObservers[j] };
+                pMethodSignals[i].Connect( & pObservers[j], & BenchmarkObserver::OnEmit );
+                pFunctorSignals[i].Connect( oFunctor );
+            }
+        }
+
+        printf( "\nFunctor benchmark: %d signals x %d slots\n", eSignalCount, eObserverCount / 2 );
+        printf( "Instance method (ns/slot)\tFunctor (ns/slot)\n" );
+
+        TimeEmits( pMethodSignals ); // warm up
+        const double fMethod = TimeEmits( pMethodSignals );
+        const double fFunctor = TimeEmits( pFunctorSignals );
+        printf( "%.2f\t\t\t\t%.2f\n", fMethod, fFunctor );
+
+        delete[] pFunctorSignals;
+        delete[] pMethodSignals;
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+        delete pObserverAllocator;
+        delete pConnectionAllocator;
+    }
+}
+
+namespace
+{
+    // Returns the time per call, in nanoseconds, to check each observer with IsConnected(),
+    // then to disconnect each observer's slot, both in random order.
+    void TimeLookups( BenchmarkSignal& oSignal, BenchmarkObserver* pObservers, double* pTimes )
+    {
+        BenchmarkObserver** ppOrder = new BenchmarkObserver*[ eObserverCount ];
+        for ( unsigned i = 0; i < eObserverCount; ++i )
+        {
+            ppOrder[i] = & pObservers[i];
+        }
+
+        srand( 1 );
+        for ( unsigned i = eObserverCount - 1; i > 0; --i )
+        {
+            const unsigned j = unsigned( ( (double)rand() / ( (double)RAND_MAX + 1.0 ) ) * ( i + 1 ) );
+            BenchmarkObserver* p = ppOrder[i];
+            ppOrder[i] = ppOrder[j];
+            ppOrder[j] = p;
+        }
+
+        oSignal.ConnectMany( pObservers, eObserverCount, & BenchmarkObserver::OnEmit );
+
+        unsigned nConnected = 0;
+        const clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eObserverCount; ++i )
+        {
+            nConnected += oSignal.IsConnected( ppOrder[i], & BenchmarkObserver::OnEmit ) ? 1 : 0;
+        }
+
+        const clock_t nMiddle = clock();
+
+        for ( unsigned i = 0; i < eObserverCount; ++i )
+        {
+            oSignal.Disconnect( ppOrder[i], & BenchmarkObserver::OnEmit );
+        }
+
+        const clock_t nEnd = clock();
+
+        // Also keeps the IsConnected() calls from being optimized out
+        if ( nConnected != eObserverCount || oSignal.CountConnections() != 0 )
+        {
+            printf( "Lookup mismatch!\n" );
+        }
+
+        pTimes[0] = ( double(nMiddle - nStart) * 1e9 / CLOCKS_PER_SEC ) / double(eObserverCount);
+        pTimes[1] = ( double(nEnd - nMiddle) * 1e9 / CLOCKS_PER_SEC ) / double(eObserverCount);
+
+        delete[] ppOrder;
+    }
+
+    // Compares IsConnected() and Disconnect() of single slots on a large signal, with and
+    // without a connection index
+    void ConnectionIndexBenchmark()
+    {
+        typedef StaticSignalConnectionAllocator< eObserverCount > TConnectionAllocator;
+        typedef StaticObserverConnectionAllocator< eObserverCount > TObserverAllocator;
+        TConnectionAllocator* pConnectionAllocator = new TConnectionAllocator();
+        TObserverAllocator* pObserverAllocator = new TObserverAllocator();
+        SignalObserver::SetCommonConnectionAllocator( pObserverAllocator ); // before the observers are created
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ eObserverCount ];
+        BenchmarkSignal* pSignal = new BenchmarkSignal( pConnectionAllocator );
+        BenchmarkSignal::ConnectionIndexSlot* pSlots = new BenchmarkSignal::ConnectionIndexSlot[ eObserverCount * 2 ];
+
+        printf( "\nConnection index benchmark: %d slots\n", eObserverCount );
+        printf( "Index\tIsConnected() (ns)\tDisconnect() (ns)\n" );
+
+        double pTimes[2];
+        TimeLookups( *pSignal, pObservers, pTimes );
+        printf( "None\t%.2f\t\t\t%.2f\n", pTimes[0], pTimes[1] );
+
+        pSignal->SetConnectionIndex( pSlots, eObserverCount * 2 );
+        TimeLookups( *pSignal, pObservers, pTimes );
+        printf( "Hash\t%.2f\t\t\t%.2f\n", pTimes[0], pTimes[1] );
+
+        delete pSignal;
+        delete[] pSlots;
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+        delete pObserverAllocator;
+        delete pConnectionAllocator;
+    }
+}
+
+namespace
+{
+    // Does the same as BenchmarkObserver, without deriving from SignalObserver
+    class BenchmarkPlainTarget
+    {
+    public:
+        BenchmarkPlainTarget() : m_nTotal(0) {}
+
+        void OnEmit( int n ) { m_nTotal += n; }
+
+        int m_nTotal;
+        WeakHandleOwner m_oLifetime;
+    };
+
+    // Compares calls to observers with weak connections to objects that don't derive from
+    // SignalObserver
+    void WeakConnectionBenchmark()
+    {
+        typedef StaticSignalConnectionAllocator< eConnectionCount * 2 > TConnectionAllocator; // weak slots take a second block
+        typedef StaticObserverConnectionAllocator< eConnectionCount / 2 > TObserverAllocator;
+        enum { eTargetCount = eObserverCount / 4, eSignalTargetCount = eSignalCount * eTargetCount };
+        TConnectionAllocator* pConnectionAllocator = new TConnectionAllocator();
+        TObserverAllocator* pObserverAllocator = new TObserverAllocator();
+        StaticWeakHandleTable< eTargetCount * 2 >* pHandleTable = new StaticWeakHandleTable< eTargetCount * 2 >(); // the std::weak_ptr targets own handles too
+        SignalObserver::SetCommonConnectionAllocator( pObserverAllocator ); // before the observers are created
+        WeakHandleTable::SetCommonTable( pHandleTable ); // before the targets are created
+
+        BenchmarkObserver* pObservers = new BenchmarkObserver[ eTargetCount ];
+        BenchmarkPlainTarget* pTargets = new BenchmarkPlainTarget[ eTargetCount ];
+        BenchmarkSignal* pObserverSignals = new BenchmarkSignal[ eSignalCount ];
+        BenchmarkSignal* pWeakSignals = new BenchmarkSignal[ eSignalCount ];
+
+        for ( unsigned i = 0; i < eSignalCount; ++i )
+        {
+            pObserverSignals[i].SetAllocator( pConnectionAllocator );
+            pWeakSignals[i].SetAllocator( pConnectionAllocator );
+
+            for ( unsigned j = 0; j < eTargetCount; ++j )
+            {
+                pObserverSignals[i].Connect( & pObservers[j], & BenchmarkObserver::OnEmit );
+                pWeakSignals[i].ConnectWeak( pTargets[j].m_oLifetime.GetHandle(), & pTargets[j], & BenchmarkPlainTarget::OnEmit );
+            }
+        }
+
+        printf( "\nWeak connection benchmark: %d signals x %d slots\n", eSignalCount, eTargetCount );
+        printf( "Target bytes: SignalObserver %d, WeakHandleOwner %d\n", (int)sizeof(BenchmarkObserver), (int)sizeof(BenchmarkPlainTarget) );
+        printf( "Observer (ns/slot)\tWeak handle (ns/slot)" );
+
+        TimeEmits( pObserverSignals ); // warm up
+        const double fObserver = TimeEmits( pObserverSignals );
+        const double fWeak = TimeEmits( pWeakSignals );
+
+#if __cplusplus >= 201103L
+        printf( "\tstd::weak_ptr (ns/slot)\n" );
+
+        std::shared_ptr<BenchmarkPlainTarget>* pSharedTargets = new std::shared_ptr<BenchmarkPlainTarget>[ eTargetCount ];
+        BenchmarkSignal* pWeakPtrSignals = new BenchmarkSignal[ eSignalCount ];
+
+        for ( unsigned j = 0; j < eTargetCount; ++j )
+        {
+            pSharedTargets[j] = std::make_shared<BenchmarkPlainTarget>();
+        }
+
+        for ( unsigned i = 0; i < eSignalCount; ++i )
+        {
+            pWeakPtrSignals[i].SetAllocator( pConnectionAllocator );
+
+            for ( unsigned j = 0; j < eTargetCount; ++j )
+            {
+                pWeakPtrSignals[i].ConnectWeak( pSharedTargets[j], & BenchmarkPlainTarget::OnEmit );
+            }
+        }
+
+        const double fWeakPtr = TimeEmits( pWeakPtrSignals );
+        printf( "%.2f\t\t\t%.2f\t\t\t%.2f\n", fObserver, fWeak, fWeakPtr );
+
+        delete[] pWeakPtrSignals;
+        delete[] pSharedTargets;
+#else
+        printf( "\n%.2f\t\t\t%.2f\n", fObserver, fWeak );
+#endif
+
+        delete[] pWeakSignals;
+        delete[] pObserverSignals;
+        delete[] pTargets;
+        delete[] pObservers;
+        WeakHandleTable::SetCommonTable( NULL );
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+        delete pHandleTable;
+        delete pObserverAllocator;
+        delete pConnectionAllocator;
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eHitResultSlots = 100,
+        eHitResultEmits = 100000,
+    };
+
+    // 200 bytes of plain data
+    struct HitResult
+    {
+        float pPosition[3];
+        float pNormal[3];
+        float fDistance;
+        unsigned pMaterialIds[43];
+    };
+}
+
+FASTDELEGATE_PASS_BY_REFERENCE( HitResult )
+
+namespace
+{
+    class HitObserver : public SignalObserver
+    {
+    public:
+        HitObserver() : m_fTotal(0.0f) {}
+
+        void OnHit( HitResult oHit ) { m_fTotal += oHit.fDistance; }
+        void OnHitReference( const HitResult& oHit ) { m_fTotal += oHit.fDistance; }
+
+        float m_fTotal;
+    };
+
+    // Returns the average time per emission, in nanoseconds.
+    template< class TSignal >
+    double TimeHitEmits( const TSignal& oSignal, HitResult& oHit )
+    {
+        const clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eHitResultEmits; ++i )
+        {
+            oHit.fDistance = float( i & 1 );
+            oSignal.Emit( oHit );
+        }
+
+        const clock_t nEnd = clock();
+        return ( double(nEnd - nStart) * 1e9 / CLOCKS_PER_SEC ) / double( eHitResultEmits );
+    }
+
+    // Emits a large struct to slots that take it by value, and to slots that take it by
+    // reference.
+    void LargeArgumentBenchmark()
+    {
+        JL_COMPILER_ASSERT( sizeof(HitResult) == 200, Hit_Result_Must_Be_200_Bytes );
+
+        StaticSignalConnectionAllocator< eHitResultSlots * 2 > oConnectionAllocator;
+        StaticObserverConnectionAllocator< eHitResultSlots * 2 > oObserverAllocator;
+        SignalObserver::SetCommonConnectionAllocator( & oObserverAllocator ); // before the observers are created
+
+        HitObserver* pObservers = new HitObserver[ eHitResultSlots ];
+        Signal1< HitResult > oValueSignal( & oConnectionAllocator );
+        Signal1< const HitResult& > oReferenceSignal( & oConnectionAllocator );
+        oValueSignal.ConnectMany( pObservers, eHitResultSlots, & HitObserver::OnHit );
+        oReferenceSignal.ConnectMany( pObservers, eHitResultSlots, & HitObserver::OnHitReference );
+
+        HitResult oHit = HitResult();
+        TimeHitEmits( oValueSignal, oHit ); // warm up
+        const double fValue = TimeHitEmits( oValueSignal, oHit );
+        const double fReference = TimeHitEmits( oReferenceSignal, oHit );
+
+        printf( "\nLarge argument benchmark: %d-byte argument, %d slots\n", (int)sizeof(HitResult), eHitResultSlots );
+        printf( "By-value slots (ns/emit)\tBy-reference slots (ns/emit)\n" );
+        printf( "%.1f\t\t\t\t%.1f\n", fValue, fReference );
+
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eDynamicSlots = 4,
+        eDynamicEmits = 1000000,
+    };
+
+    // How arguments were passed to script slots before DynamicSignal: one heap-allocated
+    // variant per argument, through a Signal1< void* >
+    struct BenchmarkVariant
+    {
+        DynamicType eType;
+        union { int n; float f; } oValue;
+    };
+
+    class DynamicBenchmarkObserver : public SignalObserver
+    {
+    public:
+        DynamicBenchmarkObserver() : m_fTotal(0.0f) {}
+
+        void OnTyped( int n, float f ) { m_fTotal += float(n) * f; }
+        void OnDynamic( const DynamicArguments& oArguments ) { m_fTotal += float( oArguments.Get<int>(0) ) * oArguments.Get<float>( 1 ); }
+
+        void OnVariants( void* pArguments )
+        {
+            const BenchmarkVariant* pVariants = static_cast<const BenchmarkVariant*>( pArguments );
+            m_fTotal += float( pVariants[0].oValue.n ) * pVariants[1].oValue.f;
+        }
+
+        float m_fTotal;
+    };
+
+    double GetEmitTime( clock_t nStart )
+    {
+        return ( double(clock() - nStart) * 1e9 / CLOCKS_PER_SEC ) / double( eDynamicEmits );
+    }
+
+    // Emits an ( int, float ) pair through a static signal, through heap-allocated variants,
+    // and through a DynamicSignal to untyped and typed slots.
+    void DynamicSignalBenchmark()
+    {
+        StaticSignalConnectionAllocator< eDynamicSlots * 6 > oConnectionAllocator;
+        StaticObserverConnectionAllocator< eDynamicSlots * 4 > oObserverAllocator;
+        SignalObserver::SetCommonConnectionAllocator( & oObserverAllocator ); // before the observers are created
+
+        const DynamicType pTypes[] = { eDynamicType_Int, eDynamicType_Float };
+        DynamicBenchmarkObserver* pObservers = new DynamicBenchmarkObserver[ eDynamicSlots ];
+        Signal2< int, float > oStaticSignal( & oConnectionAllocator );
+        Signal1< void* > oVariantSignal( & oConnectionAllocator );
+        DynamicSignal oUntypedSignal( DynamicSignature(pTypes, 2), & oConnectionAllocator );
+        DynamicSignal oTypedSignal( DynamicSignature(pTypes, 2), & oConnectionAllocator );
+
+        for ( unsigned i = 0; i < eDynamicSlots; ++i )
+        {
+            oStaticSignal.Connect( & pObservers[i], & DynamicBenchmarkObserver::OnTyped );
+            oVariantSignal.Connect( & pObservers[i], & DynamicBenchmarkObserver::OnVariants );
+            oUntypedSignal.Connect( & pObservers[i], & DynamicBenchmarkObserver::OnDynamic );
+            oTypedSignal.Connect( & pObservers[i], & DynamicBenchmarkObserver::OnTyped );
+        }
+
+        double pTimes[4];
+        clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eDynamicEmits; ++i )
+        {
+            oStaticSignal.Emit( int(i), 0.5f );
+        }
+
+        pTimes[0] = GetEmitTime( nStart );
+        nStart = clock();
+
+        for ( unsigned i = 0; i < eDynamicEmits; ++i )
+        {
+            BenchmarkVariant* pVariants = new BenchmarkVariant[2];
+            pVariants[0].eType = eDynamicType_Int;
+            pVariants[0].oValue.n = int(i);
+            pVariants[1].eType = eDynamicType_Float;
+            pVariants[1].oValue.f = 0.5f;
+            oVariantSignal.Emit( pVariants );
+            delete[] pVariants;
+        }
+
+        pTimes[1] = GetEmitTime( nStart );
+        nStart = clock();
+
+        for ( unsigned i = 0; i < eDynamicEmits; ++i )
+        {
+            oUntypedSignal.Emit( int(i), 0.5f );
+        }
+
+        pTimes[2] = GetEmitTime( nStart );
+        nStart = clock();
+
+        for ( unsigned i = 0; i < eDynamicEmits; ++i )
+        {
+            oTypedSignal.Emit( int(i), 0.5f );
+        }
+
+        pTimes[3] = GetEmitTime( nStart );
+
+        printf( "\nDynamic signal benchmark: ( int, float ) to %d slots\n", eDynamicSlots );
+        printf( "Signal2 (ns/emit)\tHeap variants (ns/emit)\tDynamic, untyped slots (ns/emit)\tDynamic, typed slots (ns/emit)\n" );
+        printf( "%.1f\t\t\t%.1f\t\t\t%.1f\t\t\t\t\t%.1f\n", pTimes[0], pTimes[1], pTimes[2], pTimes[3] );
+
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eLogSlots = 4,
+        eLogEmits = 1000000,
+    };
+
+    class LogBenchmarkObserver : public SignalObserver
+    {
+    public:
+        LogBenchmarkObserver() : m_fTotal(0.0f) {}
+
+        void OnDamaged( int n, float f ) { m_fTotal += float(n) * f; }
+
+        float m_fTotal;
+    };
+
+    double GetRecordTime( clock_t nStart )
+    {
+        return ( double(clock() - nStart) * 1e9 / CLOCKS_PER_SEC ) / double( eLogEmits );
+    }
+
+    // Returns the time per emission of oSignal while oRecorder logs it
+    double TimeRecordedEmits( Signal2< int, float >& oSignal, SignalRecorder& oRecorder )
+    {
+        if ( ! oRecorder.Reserve(eLogEmits * 32) )
+        {
+            return 0.0;
+        }
+
+        oRecorder.Record( oSignal, 0 );
+        const clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eLogEmits; ++i )
+        {
+            oSignal.Emit( int(i), 0.5f );
+        }
+
+        const double fTime = GetRecordTime( nStart );
+        oRecorder.StopRecording( oSignal );
+        JL_ASSERT( oRecorder.CountRecords() == eLogEmits );
+
+        return fTime;
+    }
+
+    // Emits an ( int, float ) pair with and without a recorder attached, then replays the
+    // log through the same slots.
+    void SignalLogBenchmark()
+    {
+        StaticSignalConnectionAllocator< eLogSlots + 2 > oConnectionAllocator; // the recorder's slot takes two blocks
+        StaticObserverConnectionAllocator< eLogSlots + 2 > oObserverAllocator;
+        SignalObserver::SetCommonConnectionAllocator( & oObserverAllocator ); // before the observers are created
+
+        LogBenchmarkObserver* pObservers = new LogBenchmarkObserver[ eLogSlots ];
+        Signal2< int, float > oSignal( & oConnectionAllocator );
+
+        for ( unsigned i = 0; i < eLogSlots; ++i )
+        {
+            oSignal.Connect( & pObservers[i], & LogBenchmarkObserver::OnDamaged );
+        }
+
+        double pTimes[4];
+        clock_t nStart = clock();
+
+        for ( unsigned i = 0; i < eLogEmits; ++i )
+        {
+            oSignal.Emit( int(i), 0.5f );
+        }
+
+        pTimes[0] = GetRecordTime( nStart );
+
+        SignalRecorder oRecorder;
+        pTimes[1] = TimeRecordedEmits( oSignal, oRecorder );
+
+        SignalReplayer oReplayer;
+        oReplayer.Register( 0, & oSignal );
+        nStart = clock();
+        oReplayer.Replay( oRecorder.GetData(), oRecorder.GetSize() );
+        pTimes[2] = GetRecordTime( nStart );
+
+        printf( "\nSignal log benchmark: ( int, float ) to %d slots, %u bytes per record\n", eLogSlots, unsigned( (oRecorder.GetSize() - sizeof(SignalLog::Header)) / eLogEmits ) );
+        printf( "Not recorded (ns/emit)\tRecorded (ns/emit)\tReplayed (ns/record)" );
+
+#if __cplusplus >= 201103L
+        SteadyClock oClock;
+        SignalRecorder oTimedRecorder( & oClock );
+        pTimes[3] = TimeRecordedEmits( oSignal, oTimedRecorder );
+
+        printf( "\tRecorded with SteadyClock (ns/emit)\n" );
+        printf( "%.1f\t\t\t%.1f\t\t\t%.1f\t\t\t%.1f\n", pTimes[0], pTimes[1], pTimes[2], pTimes[3] );
+#else
+        printf( "\n%.1f\t\t\t%.1f\t\t\t%.1f\n", pTimes[0], pTimes[1], pTimes[2] );
+#endif
+
+        delete[] pObservers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+    }
+}
+
+namespace
+{
+    enum
+    {
+        eInputHandlers = 256,
+        eInputEvents = 100000,
+    };
+    
+    // Handles the events for one key. Checks a shared flag, the way handlers stopped
+    // propagation before EmitUntilConsumed(), or consumes the emission.
+    class InputBenchmarkHandler : public SignalObserver
+    {
+    public:
+        InputBenchmarkHandler() : m_nKey(0), m_pHandled(NULL), m_pSignal(NULL), m_nHandled(0) {}
+        
+        void OnKeyFlag( int nKey )
+        {
+            if ( *m_pHandled || nKey != m_nKey )
+            {
+                return;
+            }
+            
+            *m_pHandled = true;
+            ++m_nHandled;
+        }
+        
+        void OnKeyConsume( int nKey )
+        {
+            if ( nKey == m_nKey )
+            {
+                m_pSignal->Consume();
+                ++m_nHandled;
+            }
+        }
+        
+        int m_nKey;
+        bool* m_pHandled;
+        const Signal1< int >* m_pSignal;
+        unsigned m_nHandled;
+    };
+    
+    double GetInputTime( clock_t nStart )
+    {
+        return ( double(clock() - nStart) * 1e9 / CLOCKS_PER_SEC ) / double( eInputEvents );
+    }
+    
+    // Delivers key events to a stack of handlers, where the handler at a given depth takes
+    // each event
+    void ConsumableEmitBenchmark()
+    {
+        StaticSignalConnectionAllocator< eInputHandlers * 2 > oConnectionAllocator;
+        StaticObserverConnectionAllocator< eInputHandlers * 2 > oObserverAllocator;
+        SignalObserver::SetCommonConnectionAllocator( & oObserverAllocator ); // before the observers are created
+        
+        bool bHandled = false;
+        InputBenchmarkHandler* pHandlers = new InputBenchmarkHandler[ eInputHandlers ];
+        Signal1< int > oFlagSignal( & oConnectionAllocator );
+        Signal1< int > oConsumeSignal( & oConnectionAllocator );
+        
+        for ( unsigned i = 0; i < eInputHandlers; ++i )
+        {
+            pHandlers[i].m_nKey = int( i );
+            pHandlers[i].m_pHandled = & bHandled;
+            pHandlers[i].m_pSignal = & oConsumeSignal;
+            oFlagSignal.Connect( & pHandlers[i], & InputBenchmarkHandler::OnKeyFlag );
+            oConsumeSignal.Connect( & pHandlers[i], & InputBenchmarkHandler::OnKeyConsume );
+        }
+        
+        printf( "\nConsumable emission benchmark: %d handlers\n", eInputHandlers );
+        printf( "Depth\tShared flag (ns/event)\tEmitUntilConsumed (ns/event)\n" );
+        
+        const int pDepths[] = { 0, 8, 64, eInputHandlers - 1 };
+        
+        for ( unsigned d = 0; d < JL_ARRAY_SIZE(pDepths); ++d )
+        {
+            clock_t nStart = clock();
+            
+            for ( unsigned i = 0; i < eInputEvents; ++i )
+            {
+                bHandled = false;
+                oFlagSignal.Emit( pDepths[d] );
+            }
+            
+            const double fFlag = GetInputTime( nStart );
+            nStart = clock();
+            
+            for ( unsigned i = 0; i < eInputEvents; ++i )
+            {
+                oConsumeSignal.EmitUntilConsumed( pDepths[d] );
+            }
+            
+            const double fConsume = GetInputTime( nStart );
+            printf( "%d\t%.1f\t\t\t%.1f\n", pDepths[d], fFlag, fConsume );
+        }
+        
+        delete[] pHandlers;
+        SignalObserver::SetCommonConnectionAllocator( NULL );
+    }
+}
+
+#if JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+#include <chrono>
+
+namespace
+{
+    enum
+    {
+        eHeavyObserverCount = 4096,
+        eHeavyEmits = 20,
+        eHeavySlotIterations = 2000,
+    };
+
+    // A slot that does a fixed amount of independent work, like a per-agent update
+    class HeavyObserver : public SignalObserver
+    {
+    public:
+        HeavyObserver() : m_fState(1.0f) {}
+
+        void OnTick( float fDeltaTime )
+        {
+            float f = m_fState;
+
+            for ( unsigned i = 0; i < eHeavySlotIterations; ++i )
+            {
+                f = f * 0.999f + fDeltaTime;
+            }
+
+            m_fState = f;
+        }
+
+        float m_fState;
+    };
+
+    // Returns the average time per emission, in milliseconds.
+    double TimeHeavyEmits( Signal1< float >& oSignal, TaskScheduler* pScheduler )
+    {
+        const std::chrono::steady_clock::time_point oStart = std::chrono::steady_clock::now();
+
+        for ( unsigned i = 0; i < eHeavyEmits; ++i )
+        {
+            if ( pScheduler )
+            {
+                oSignal.EmitParallel( pScheduler, 0.016f );
+            }
+            else
+            {
+                oSignal.Emit( 0.016f );
+            }
+        }
+
+        const std::chrono::duration<double, std::milli> oElapsed = std::chrono::steady_clock::now() - oStart;
+        return oElapsed.count() / double( eHeavyEmits );
+    }
+
+    void ParallelEmitBenchmark()
+    {
+        StaticSignalConnectionAllocator< eHeavyObserverCount > oConnectionAllocator;
+        StaticObserverConnectionAllocator< eHeavyObserverCount > oObserverAllocator;
+        HeavyObserver* pObservers = new HeavyObserver[ eHeavyObserverCount ];
+        Signal1< float > oSignal( & oConnectionAllocator );
+
+        for ( unsigned i = 0; i < eHeavyObserverCount; ++i )
+        {
+            pObservers[i].SetConnectionAllocator( & oObserverAllocator );
+            oSignal.Connect( & pObservers[i], & HeavyObserver::OnTick, SignalBase::eConnectionFlag_ParallelSafe );
+        }
+
+        printf( "\nParallel emit benchmark: %d slots, %d iterations per slot\n", eHeavyObserverCount, eHeavySlotIterations );
+        printf( "Threads\tms/emit\tSpeedup\n" );
+
+        const double fSerial = TimeHeavyEmits( oSignal, NULL );
+        printf( "Emit()\t%.3f\t1.00\n", fSerial );
+
+        const unsigned nHardwareThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        // Powers of two, then all hardware threads
+        for ( unsigned nThreads = 1; ; nThreads = nThreads * 2 < nHardwareThreads ? nThreads * 2 : nHardwareThreads )
+        {
+            WorkStealingTaskScheduler oScheduler( nThreads - 1 );
+            const double fParallel = TimeHeavyEmits( oSignal, & oScheduler );
+            printf( "%u\t%.3f\t%.2f\n", oScheduler.CountThreads(), fParallel, fSerial / fParallel );
+
+            if ( nThreads == nHardwareThreads )
+            {
+                break;
+            }
+        }
+
+        oSignal.DisconnectAll();
+        delete[] pObservers;
+    }
+}
+#endif // JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+
+namespace
+{
+    // Compaction needs free slots to move nodes into, so its pools have some headroom.
+    template< unsigned _Capacity >
+    void PrintChurnTable( bool bPoolPerSignal )
+    {
+        enum { eCompactedCapacity = _Capacity * 5 / 4 };
+        double pFreeListTimes[ eChurnRounds + 1 ];
+        double pAddressOrderedTimes[ eChurnRounds + 1 ];
+        double pCompactedTimes[ eChurnRounds + 1 ];
+
+        ChurnBenchmark< StaticSignalConnectionAllocator<_Capacity> >( pFreeListTimes, bPoolPerSignal, false );
+        ChurnBenchmark< StaticSignalConnectionAllocator<_Capacity, ObjectPool::eFlag_AddressOrdered> >( pAddressOrderedTimes, bPoolPerSignal, false );
+        ChurnBenchmark< StaticSignalConnectionAllocator<eCompactedCapacity, ObjectPool::eFlag_AddressOrdered> >( pCompactedTimes, bPoolPerSignal, true );
+
+        printf( "%s\n", bPoolPerSignal ? "One pool per signal:" : "One pool shared by every signal:" );
+        printf( "Round\tFree list (ns/slot)\tAddress-ordered (ns/slot)\tCompacted (ns/slot)\n" );
+        for ( unsigned i = 0; i <= eChurnRounds; ++i )
+        {
+            printf( "%u\t%.2f\t\t\t%.2f\t\t\t\t%.2f\n", i, pFreeListTimes[i], pAddressOrderedTimes[i], pCompactedTimes[i] );
+        }
+    }
+}
+
+void SignalBenchmark()
+{
+    printf( "\nChurn benchmark: %d signals x %d observers, %d churn rounds of %d reconnections\n",
+            eSignalCount, eObserverCount, eChurnRounds, eChurnPerRound );
+
+    PrintChurnTable< eConnectionCount >( false );
+    PrintChurnTable< eObserverCount >( true );
+    GroupedDispatchBenchmark();
+    HugePageBenchmark();
+    BatchAllocationBenchmark();
+    ConnectManyBenchmark();
+    DisconnectObserversBenchmark();
+    FunctorBenchmark();
+    ConnectionIndexBenchmark();
+    WeakConnectionBenchmark();
+    LargeArgumentBenchmark();
+    DynamicSignalBenchmark();
+    SignalLogBenchmark();
+    ConsumableEmitBenchmark();
+
+#if JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+    ParallelEmitBenchmark();
+#endif
+}
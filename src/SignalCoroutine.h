@@ -0,0 +1,145 @@
+#ifndef _JL_SIGNAL_COROUTINE_H_
+#define _JL_SIGNAL_COROUTINE_H_
+
+#include "Utils.h"
+#include "ScopedAllocator.h"
+#include "SignalBase.h"
+
+// Coroutine support requires C++20. Define JL_SIGNAL_ENABLE_COROUTINES to 0 to
+// disable it explicitly.
+#ifndef JL_SIGNAL_ENABLE_COROUTINES
+#if defined( __cpp_impl_coroutine ) && __cplusplus >= 202002L
+#define JL_SIGNAL_ENABLE_COROUTINES 1
+#else
+#define JL_SIGNAL_ENABLE_COROUTINES 0
+#endif
+#endif
+
+#if JL_SIGNAL_ENABLE_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+namespace jl {
+
+/**
+ * The awaitable returned by SignalN::Next(), e.g.:
+ *
+ *   SignalTask WaitForDamage( Signal2<Entity*, int>& oDamaged )
+ *   {
+ *       auto [pEntity, nAmount] = co_await oDamaged.Next();
+ *       ...
+ *   }
+ *
+ * The awaiter lives in the coroutine frame. While the coroutine is suspended,
+ * the awaiter is an ordinary observer connected to the signal, so waiting only
+ * uses one node from the signal's connection allocator and one from the
+ * observer connection allocator.
+ *
+ * The next Emit() copies its arguments into the awaiter, disconnects it, and
+ * resumes the coroutine from inside Emit(). An awaiter that is connected during
+ * an Emit(), e.g. by a resumed coroutine that awaits the same signal again,
+ * waits for the following emission.
+ *
+ * If the signal is destroyed first, the coroutine is never resumed. Destroying
+ * a suspended coroutine disconnects its awaiter.
+ */
+template< typename TSignal, typename... TArgs >
+class SignalAwaiter : public SignalObserver
+{
+public:
+    typedef std::tuple< typename std::decay<TArgs>::type... > TArguments;
+
+    explicit SignalAwaiter( TSignal* pSignal ) : m_pSignal(pSignal), m_nConnectEmission(0) {}
+    SignalAwaiter( const SignalAwaiter& ) = delete;
+    SignalAwaiter& operator=( const SignalAwaiter& ) = delete;
+
+    bool await_ready() const { return false; }
+
+    void await_suspend( std::coroutine_handle<> hCoroutine )
+    {
+        m_hCoroutine = hCoroutine;
+        m_nConnectEmission = m_pSignal->CountEmissions();
+        m_pSignal->Connect( this, & SignalAwaiter::OnEmit );
+    }
+
+    TArguments await_resume()
+    {
+        JL_ASSERT( m_oArguments.has_value() );
+        return std::move( *m_oArguments );
+    }
+
+private:
+    void OnEmit( TArgs... args )
+    {
+        // Ignore the emission that was in progress when we connected
+        if ( m_pSignal->CountEmissions() == m_nConnectEmission )
+        {
+            return;
+        }
+
+        m_oArguments.emplace( args... );
+        m_pSignal->Disconnect( static_cast<SignalObserver*>(this) );
+
+        // This may finish the coroutine and destroy the awaiter, so it must be
+        // the last thing we do.
+        m_hCoroutine.resume();
+    }
+
+    TSignal* m_pSignal;
+    unsigned m_nConnectEmission;
+    std::coroutine_handle<> m_hCoroutine;
+    std::optional< TArguments > m_oArguments;
+};
+
+/**
+ * A minimal fire-and-forget coroutine type for code that awaits signals. The
+ * coroutine starts running immediately, and its frame is freed when it
+ * finishes.
+ *
+ * Frames are allocated from the allocator passed to SetFrameAllocator(), never
+ * from the heap. With an object pool allocator, the stride must cover the
+ * largest coroutine frame; frame sizes are compiler-dependent, and the pool
+ * asserts on oversized requests. If the allocator runs out, the coroutine does
+ * not run at all.
+ */
+class SignalTask
+{
+public:
+    struct promise_type
+    {
+        SignalTask get_return_object() { return SignalTask(); }
+        static SignalTask get_return_object_on_allocation_failure() { return SignalTask(); }
+
+        std::suspend_never initial_suspend() { return std::suspend_never(); }
+        std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new( size_t nBytes ) noexcept
+        {
+            JL_ASSERT( s_pFrameAllocator );
+            return s_pFrameAllocator ? s_pFrameAllocator->Alloc( nBytes ) : NULL;
+        }
+
+        static void operator delete( void* pFrame )
+        {
+            s_pFrameAllocator->Free( pFrame );
+        }
+    };
+
+    // Don't change the allocator while any SignalTask coroutines are alive.
+    static void SetFrameAllocator( ScopedAllocator* pAllocator ) { s_pFrameAllocator = pAllocator; }
+
+private:
+    static ScopedAllocator* s_pFrameAllocator;
+};
+
+} // namespace jl
+
+#endif // JL_SIGNAL_ENABLE_COROUTINES
+
+#endif // ! defined( _JL_SIGNAL_COROUTINE_H_ )
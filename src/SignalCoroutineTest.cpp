@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "StaticSignalConnectionAllocators.h"
+
+using namespace jl;
+
+#if JL_SIGNAL_ENABLE_COROUTINES
+
+namespace
+{
+    // Coroutine frame sizes are compiler-dependent, so be generous
+    enum { eFrameSize = 1024, eMaxFrames = 8, eMaxConnections = 64 };
+
+    typedef StaticObjectPoolAllocator< eFrameSize, eMaxFrames > FrameAllocator;
+
+    struct WaitState
+    {
+        WaitState() : nResumes(0), nTotal(0), bDone(false) { pLastName[0] = '\0'; }
+
+        unsigned nResumes;
+        int nTotal;
+        char pLastName[16];
+        bool bDone;
+    };
+
+    // Accumulates values until it receives a negative one
+    SignalTask Accumulate( Signal2< int, const char* >& oSignal, WaitState& oState )
+    {
+        for ( ;; )
+        {
+            auto [nValue, pName] = co_await oSignal.Next();
+            ++oState.nResumes;
+            strncpy( oState.pLastName, pName, sizeof(oState.pLastName) - 1 );
+
+            if ( nValue < 0 )
+            {
+                break;
+            }
+
+            oState.nTotal += nValue;
+        }
+
+        oState.bDone = true;
+    }
+
+    SignalTask WaitOnce( Signal0<>& oSignal, WaitState& oState )
+    {
+        co_await oSignal.Next();
+        ++oState.nResumes;
+        oState.bDone = true;
+    }
+
+    class CountingObserver : public SignalObserver
+    {
+    public:
+        CountingObserver() : m_nCalls(0) {}
+        void OnEmit() { ++m_nCalls; }
+
+        unsigned m_nCalls;
+    };
+}
+
+void SignalCoroutineTest()
+{
+    StaticSignalConnectionAllocator< eMaxConnections > oSignalConnectionAllocator;
+    StaticObserverConnectionAllocator< eMaxConnections > oObserverConnectionAllocator;
+    FrameAllocator oFrameAllocator;
+
+    SignalBase::SetCommonConnectionAllocator( & oSignalConnectionAllocator );
+    SignalObserver::SetCommonConnectionAllocator( & oObserverConnectionAllocator );
+    SignalTask::SetFrameAllocator( & oFrameAllocator );
+
+    printf( "Testing coroutine awaiters...\n" );
+
+    // Repeated awaits on the same signal
+    {
+        Signal2< int, const char* > oSignal;
+        WaitState oState;
+
+        Accumulate( oSignal, oState );
+        assert( oFrameAllocator.CountAllocations() == 1 );
+        assert( oSignal.CountConnections() == 1 );
+        assert( oState.nResumes == 0 );
+
+        // Each emission resumes the coroutine exactly once, even though it
+        // reconnects to the signal while the emission is in progress.
+        oSignal.Emit( 1, "one" );
+        assert( oState.nResumes == 1 && oState.nTotal == 1 );
+        assert( oSignal.CountConnections() == 1 );
+
+        oSignal.Emit( 2, "two" );
+        assert( oState.nResumes == 2 && oState.nTotal == 3 );
+        assert( strcmp(oState.pLastName, "two") == 0 );
+
+        oSignal.Emit( -1, "stop" );
+        assert( oState.nResumes == 3 && oState.bDone );
+        assert( oSignal.CountConnections() == 0 );
+        assert( oFrameAllocator.CountAllocations() == 0 );
+    }
+
+    // Several coroutines waiting on one signal, alongside regular slots
+    {
+        Signal0<> oSignal;
+        CountingObserver oBefore;
+        CountingObserver oAfter;
+        WaitState pStates[3];
+
+        oSignal.Connect( & oBefore, & CountingObserver::OnEmit );
+
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(pStates); ++i )
+        {
+            WaitOnce( oSignal, pStates[i] );
+        }
+
+        oSignal.Connect( & oAfter, & CountingObserver::OnEmit );
+        assert( oSignal.CountConnections() == 2 + JL_ARRAY_SIZE(pStates) );
+        assert( oFrameAllocator.CountAllocations() == JL_ARRAY_SIZE(pStates) );
+
+        // Awaiters disconnect themselves mid-emission; the remaining slots must still be called
+        oSignal.Emit();
+
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(pStates); ++i )
+        {
+            assert( pStates[i].bDone && pStates[i].nResumes == 1 );
+        }
+
+        assert( oBefore.m_nCalls == 1 && oAfter.m_nCalls == 1 );
+        assert( oSignal.CountConnections() == 2 );
+        assert( oFrameAllocator.CountAllocations() == 0 );
+    }
+
+    assert( oSignalConnectionAllocator.CountAllocations() == 0 );
+    assert( oObserverConnectionAllocator.CountAllocations() == 0 );
+
+    SignalTask::SetFrameAllocator( NULL );
+    SignalBase::SetCommonConnectionAllocator( NULL );
+    SignalObserver::SetCommonConnectionAllocator( NULL );
+}
+
+#else
+
+void SignalCoroutineTest()
+{
+    printf( "Coroutine awaiters require C++20, skipping test\n" );
+}
+
+#endif // JL_SIGNAL_ENABLE_COROUTINES
@@ -4,6 +4,8 @@
 #include "FastDelegate.h"
 #include "Utils.h"
 #include "SignalBase.h"
+#include "SignalCoroutine.h"
+#include "TaskScheduler.h"
 
 /**
  * The content of the following classes (Signal0 -> Signal8) is identical,
@@ -47,45 +49,165 @@ public:
     {
         Delegate d;
         SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
     };
     
     typedef DoublyLinkedList<Connection> ConnectionList;
     
     enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
     
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef SignalNoParam EmitParam1;
+    typedef SignalNoParam EmitParam2;
+    typedef SignalNoParam EmitParam3;
+    typedef SignalNoParam EmitParam4;
+    typedef SignalNoParam EmitParam5;
+    typedef SignalNoParam EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
 private:
     typedef typename ConnectionList::iterator ConnectionIter;
     typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
     
     ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( void ) const { pSignal->Emit(); }
+        
+        const Signal0* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
     
 public:
-    Signal0() { SetAllocator( s_pCommonAllocator ); }
-    Signal0( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
+    Signal0() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal0( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
     
     virtual ~Signal0()
     {
         JL_SIGNAL_LOG( "Destroying Signal0 %p\n", this );
-        DisconnectAll();
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
     }
     
     void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
     
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(void) )
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(void), unsigned nFlags = 0 )
     {
         JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
         JL_SIGNAL_LOG( "Signal0 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
         
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
     }    
     
     // Connects instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(void) )
+    void Connect( Y* pObject, void (X::*fpMethod)(void), unsigned nFlags = 0 )
     {
         if ( ! pObject )
         {
@@ -96,15 +218,21 @@ public:
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
         JL_SIGNAL_LOG( "Signal0 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
         NotifyObserverConnect( pObserver );
     }
     
     // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(void) const )
+    void Connect( Y* pObject, void (X::*fpMethod)(void) const, unsigned nFlags = 0 )
     {
         if ( ! pObject )
         {
@@ -115,12 +243,129 @@ public:
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
         JL_SIGNAL_LOG( "Signal0 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
         NotifyObserverConnect( pObserver );
     }
     
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(void), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(void) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(void), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(void) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(void), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(void) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal0* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal0* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal0* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
     // Returns true if the given observer and non-instance function are connected to this signal.
     bool IsConnected( void (*fpFunction)(void) ) const
     {
@@ -141,29 +386,187 @@ public:
         return IsConnected( Delegate(pObject, fpMethod) );
     }
     
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
     void Emit( void ) const
     {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
         for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
         {
-            (*i).d();
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d();
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i );
+            }
         }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
     }
     
     void operator()( void ) const { Emit(); } 
     
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( void ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d();
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 0 };
+        
+        void EmitTo( const Signal0& oSignal ) const { oSignal.Emit(); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d();
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal0 > Next()
+    {
+        return SignalAwaiter< Signal0 >( this );
+    }
+#endif
+    
     // Disconnects a non-instance method.
     void Disconnect( void (*fpFunction)(void) )
     {
         JL_SIGNAL_LOG( "Signal0 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
         const Delegate d(fpFunction);
         
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).d == d )
+            if ( (*i).d == d && ! IsRemoved(*i) )
             {
                 JL_ASSERT( (*i).pObserver == NULL );
                 JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
+                RemoveConnection( i );
             }
             else
             {
@@ -200,6 +603,48 @@ public:
         DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
     }
     
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal0 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
     // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
     // if any disconnections are made.
     void Disconnect( SignalObserver* pObserver )
@@ -214,10 +659,10 @@ public:
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
             {
                 JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
+                RemoveConnection( i ); // advances iterator
                 ++nDisconnections;
             }
             else
@@ -238,6 +683,11 @@ public:
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
         {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
             SignalObserver* pObserver = (*i).pObserver;
             
             //HACK - call this each time we encounter a valid observer pointer. This means
@@ -247,623 +697,8791 @@ public:
             {
                 NotifyObserverDisconnect( pObserver );
             }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
         }
         
-        m_oConnections.Clear();
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
     }
     
 private:
-    bool IsConnected( const Delegate& d ) const
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c )
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            if ( (*i).d == d )
-            {
-                return true;
-            }
-        }
-        
-        return false;        
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit();
     }
     
-    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
-    // the observer is completely disconnected from this signal.
-    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
     {
-        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
-        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        static void RunChunk( void* pContext, unsigned nChunk )
         {
-            if ( (*i).d == d )
-            {
-                JL_ASSERT( (*i).pObserver == pObserver );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
-            }
-            else
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
             {
-                if ( (*i).pObserver == pObserver )
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
                 {
-                    ++nObserverConnectionCount;
+                    (*i).d();
+                    ++nCalls;
                 }
-
-                ++i;
             }
         }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
         
-        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
-        {
-            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
-            NotifyObserverDisconnect( pObserver );
-        }    
-    }
+        F fFunctor;
+        
+        void Invoke( void ) { fFunctor(); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
     
-    void OnObserverDisconnect( SignalObserver* pObserver )
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal0 %p received disconnect message from observer %p\n", this, pObserver );
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal0 %p connecting to functor (observer %p)\n", this, pObserver );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
         {
-            if ( (*i).pObserver == pObserver )
-            {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
-            }
-            else
-            {
-                ++i;
-            }
+            return FunctorConnection();
         }
-    }
-};
-
-#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
-
-/**
- * Signal<[0 arguments]>: wrapper class for Signal0
- * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
- */
-template< typename TUnused >
-class Signal< TUnused(void) > : public Signal0< void >
-{
-public:
-    typedef Signal0< void > TParent;
-    Signal() {}
-    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
-    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
-};
-
-#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
-
-/**
- * Signal1: signals with 1 argument
- */
-template< typename _P1 >
-class Signal1 : public SignalBase
-{
-public:
-    typedef fastdelegate::FastDelegate1< _P1 > Delegate;
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
     
-    struct Connection
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
     {
-        Delegate d;
-        SignalObserver* pObserver;
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
     };
     
-    typedef DoublyLinkedList<Connection> ConnectionList;
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( void )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )();
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
     
-    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal0 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
+    }
     
-private:
-    typedef typename ConnectionList::iterator ConnectionIter;
-    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
+    {
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
+        {
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
+        }
+        
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
+        
+        void Invoke( void )
+        {
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
+            {
+                ( spObject.get()->*fpMethod )();
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+        
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
     
-    ConnectionList m_oConnections;
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal0 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
+    }
+#endif
     
-public:
-    Signal1() { SetAllocator( s_pCommonAllocator ); }
-    Signal1( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return;
+        }
+        
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
+    }
     
-    virtual ~Signal1()
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
     {
-        JL_SIGNAL_LOG( "Destroying Signal1 %p\n", this );
-        DisconnectAll();
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal0* >( this )->PurgeDeadConnections();
+        }
     }
     
-    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
+    void PurgeDeadConnections()
+    {
+        JL_SIGNAL_LOG( "Signal0 %p removing %u dead connections\n", this, m_nDeadConnections );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
+        {
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
+            {
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
+    }
     
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1) )
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
     {
-        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal1 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        bool operator()( const Connection& a, const Connection& b ) const
+        {
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
+            {
+                return bFirstA;
+            }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
+        }
+    };
+    
+    // Puts a connection ahead of every other one
+    struct FrontOrder
+    {
+        bool operator()( const Connection&, const Connection& ) const { return true; }
+    };
+    
+    bool AddConnection( const Connection& c )
+    {
+        ConnectionNode* pNode;
         
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-    }    
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
+    }
     
-    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1) )
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
     {
-        if ( ! pObject )
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
+    
+    void RemoveConnection( ConnectionNode* pNode )
+    {
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
         {
+            MarkRemoved( pNode->object );
             return;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal1 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
+    }
+    
+    void MarkRemoved( Connection& c )
+    {
+        JL_ASSERT( ! IsRemoved(c) );
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
+        {
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
+        }
+        
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
     }
     
-    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1) const )
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
+    
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
     {
-        if ( ! pObject )
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
         {
             return;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal1 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
     }
     
-    // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1) ) const
+    static unsigned HashDelegate( const Delegate& d )
     {
-        return IsConnected( Delegate(fpFunction) );
-    }    
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
+    }
     
-    // Returns true if the given observer and instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1) ) const
+    struct DelegateMatch
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
-    }
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
     
-    // Returns true if the given observer and const instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1) const ) const
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        const FunctorConnection* pConnection;
+        
+        bool operator()( const ConnectionNode& oNode ) const
+        {
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
+            {
+                return false;
+            }
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
+        }
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
     }
     
-    void Emit( _P1 p1 ) const
+    bool IsIndexedDuplicate( const Delegate& d ) const
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
         {
-            (*i).d( p1 );
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
         }
+        
+        return false;
     }
     
-    void operator()( _P1 p1 ) const { Emit( p1 ); } 
-    
-    // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1) )
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal1 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
-        const Delegate d(fpFunction);
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
+        {
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
+        }
+        
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
+        
+        while ( nConnected < nCount )
         {
-            if ( (*i).d == d )
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
             {
-                JL_ASSERT( (*i).pObserver == NULL );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
+                break;
             }
-            else
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
             {
-                ++i;
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal0 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
             }
-        }         
-    }    
-
-    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1) )
-    {
-        if ( ! pObject )
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
+        }
+        
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
         {
-            return;
+            m_oConnections.Sort( GroupedOrder() );
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal1 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        return nConnected - nDuplicates;
     }
     
-    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1) const )
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        unsigned nConnected = 0;
+        
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal0 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+            
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
+            {
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
+            }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
+        }
+        
+        return nConnected;
+    }
+    
+    bool IsConnected( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                return true;
+            }
+        }
+        
+        return false;        
+    }
+    
+    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
+    // the observer is completely disconnected from this signal.
+    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    {
+        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
+        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
+            {
+                JL_ASSERT( (*i).pObserver == pObserver );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                if ( (*i).pObserver == pObserver )
+                {
+                    ++nObserverConnectionCount;
+                }
+
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        {
+            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
+            NotifyObserverDisconnect( pObserver );
+        }    
+    }
+    
+    void OnObserverDisconnect( SignalObserver* pObserver )
+    {
+        JL_SIGNAL_LOG( "Signal0 %p received disconnect message from observer %p\n", this, pObserver );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal0 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+};
+
+#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
+
+/**
+ * Signal<[0 arguments]>: wrapper class for Signal0
+ * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
+ */
+template< typename TUnused >
+class Signal< TUnused(void) > : public Signal0< void >
+{
+public:
+    typedef Signal0< void > TParent;
+    Signal() {}
+    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
+    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
+};
+
+#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
+
+/**
+ * Signal1: signals with 1 argument
+ */
+template< typename _P1 >
+class Signal1 : public SignalBase
+{
+public:
+    typedef fastdelegate::FastDelegate1< _P1 > Delegate;
+    
+    struct Connection
+    {
+        Delegate d;
+        SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
+    };
+    
+    typedef DoublyLinkedList<Connection> ConnectionList;
+    
+    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef SignalNoParam EmitParam2;
+    typedef SignalNoParam EmitParam3;
+    typedef SignalNoParam EmitParam4;
+    typedef SignalNoParam EmitParam5;
+    typedef SignalNoParam EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
+private:
+    typedef typename ConnectionList::iterator ConnectionIter;
+    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
+    
+    ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1 ) const { pSignal->Emit( p1 ); }
+        
+        const Signal1* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
+    
+public:
+    Signal1() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal1( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
+    
+    virtual ~Signal1()
+    {
+        JL_SIGNAL_LOG( "Destroying Signal1 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
+    }
+    
+    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1), unsigned nFlags = 0 )
+    {
+        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
+        JL_SIGNAL_LOG( "Signal1 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+    }    
+    
+    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1), unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal1 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1) const, unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal1 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal1* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal1* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal1* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
+    // Returns true if the given observer and non-instance function are connected to this signal.
+    bool IsConnected( void (*fpFunction)(_P1) ) const
+    {
+        return IsConnected( Delegate(fpFunction) );
+    }    
+    
+    // Returns true if the given observer and instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1) ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Returns true if the given observer and const instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1) const ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1 ) const { Emit( p1 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 1 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1 ) : a1(p1) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        
+        void EmitTo( const Signal1& oSignal ) const { oSignal.Emit( a1 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1 ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal1, _P1 > Next()
+    {
+        return SignalAwaiter< Signal1, _P1 >( this );
+    }
+#endif
+    
+    // Disconnects a non-instance method.
+    void Disconnect( void (*fpFunction)(_P1) )
+    {
+        JL_SIGNAL_LOG( "Signal1 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        const Delegate d(fpFunction);
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                JL_ASSERT( (*i).pObserver == NULL );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }         
+    }    
+
+    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1) )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal1 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1) const )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal1 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal1 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
+    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
+    // if any disconnections are made.
+    void Disconnect( SignalObserver* pObserver )
+    {
+        if ( ! pObserver )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal1 %p removing all connections to Observer %p\n", this, pObserver );
+        unsigned nDisconnections = 0;
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 )
+        {
+            NotifyObserverDisconnect( pObserver );        
+        }
+    }
+    
+    void DisconnectAll()
+    {
+        JL_SIGNAL_LOG( "Signal1 %p disconnecting all observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
+            SignalObserver* pObserver = (*i).pObserver;
+            
+            //HACK - call this each time we encounter a valid observer pointer. This means
+            // this will be called repeatedly for observers that are connected multiple times
+            // to this signal.
+            if ( pObserver )
+            {
+                NotifyObserverDisconnect( pObserver );
+            }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
+        }
+        
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
+    }
+    
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1 )
+    {
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
+        {
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1 );
+                    ++nCalls;
+                }
+            }
+        }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
+        
+        F fFunctor;
+        
+        void Invoke( _P1 p1 ) { fFunctor( p1 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
+    
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal1 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return FunctorConnection();
+        }
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
+    
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
+    {
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1 )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )( p1 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal1 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
+    {
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
+        {
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
+        }
+        
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1 )
+        {
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
+            {
+                ( spObject.get()->*fpMethod )( p1 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+        
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal1 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
+    }
+#endif
+    
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return;
+        }
+        
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
+    }
+    
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
+    {
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal1* >( this )->PurgeDeadConnections();
+        }
+    }
+    
+    void PurgeDeadConnections()
+    {
+        JL_SIGNAL_LOG( "Signal1 %p removing %u dead connections\n", this, m_nDeadConnections );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
+        {
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
+            {
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
+    }
+    
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
+    {
+        bool operator()( const Connection& a, const Connection& b ) const
+        {
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
+            {
+                return bFirstA;
+            }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
+        }
+    };
+    
+    // Puts a connection ahead of every other one
+    struct FrontOrder
+    {
+        bool operator()( const Connection&, const Connection& ) const { return true; }
+    };
+    
+    bool AddConnection( const Connection& c )
+    {
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
+    }
+    
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
+    {
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
+    
+    void RemoveConnection( ConnectionNode* pNode )
+    {
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
+        {
+            MarkRemoved( pNode->object );
+            return;
+        }
+        
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
+    }
+    
+    void MarkRemoved( Connection& c )
+    {
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
+        {
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
+        }
+        
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
+    }
+    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
+    
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
+    {
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
+    }
+    
+    static unsigned HashDelegate( const Delegate& d )
+    {
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
+    }
+    
+    struct DelegateMatch
+    {
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
+    
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
+    {
+        const FunctorConnection* pConnection;
+        
+        bool operator()( const ConnectionNode& oNode ) const
+        {
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
+            {
+                return false;
+            }
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
+        }
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
+    }
+    
+    bool IsIndexedDuplicate( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
+        {
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
+        }
+        
+        return false;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
+        {
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
+        }
+        
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
+        
+        while ( nConnected < nCount )
+        {
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
+            {
+                break;
+            }
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
+            {
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal1 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
+            }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
+        }
+        
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+        
+        return nConnected - nDuplicates;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        unsigned nConnected = 0;
+        
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal1 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+            
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
+            {
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
+            }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
+        }
+        
+        return nConnected;
+    }
+    
+    bool IsConnected( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                return true;
+            }
+        }
+        
+        return false;        
+    }
+    
+    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
+    // the observer is completely disconnected from this signal.
+    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    {
+        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
+        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
+            {
+                JL_ASSERT( (*i).pObserver == pObserver );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                if ( (*i).pObserver == pObserver )
+                {
+                    ++nObserverConnectionCount;
+                }
+
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        {
+            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
+            NotifyObserverDisconnect( pObserver );
+        }    
+    }
+    
+    void OnObserverDisconnect( SignalObserver* pObserver )
+    {
+        JL_SIGNAL_LOG( "Signal1 %p received disconnect message from observer %p\n", this, pObserver );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal1 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+};
+
+#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
+
+/**
+ * Signal<[1 argument]>: wrapper class for Signal1
+ * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
+ */
+template< typename TUnused, typename _P1 >
+class Signal< TUnused(_P1) > : public Signal1< _P1 >
+{
+public:
+    typedef Signal1< _P1 > TParent;
+    Signal() {}
+    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
+    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
+};
+
+#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
+
+/**
+ * Signal2: signals with 2 arguments
+ */
+template< typename _P1, typename _P2 >
+class Signal2 : public SignalBase
+{
+public:
+    typedef fastdelegate::FastDelegate2< _P1, _P2 > Delegate;
+    
+    struct Connection
+    {
+        Delegate d;
+        SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
+    };
+    
+    typedef DoublyLinkedList<Connection> ConnectionList;
+    
+    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef SignalNoParam EmitParam3;
+    typedef SignalNoParam EmitParam4;
+    typedef SignalNoParam EmitParam5;
+    typedef SignalNoParam EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
+private:
+    typedef typename ConnectionList::iterator ConnectionIter;
+    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
+    
+    ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2 ) const { pSignal->Emit( p1, p2 ); }
+        
+        const Signal2* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
+    
+public:
+    Signal2() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal2( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
+    
+    virtual ~Signal2()
+    {
+        JL_SIGNAL_LOG( "Destroying Signal2 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
+    }
+    
+    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2), unsigned nFlags = 0 )
+    {
+        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
+        JL_SIGNAL_LOG( "Signal2 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+    }    
+    
+    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2), unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal2 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2) const, unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal2 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal2* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal2* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal2* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
+    // Returns true if the given observer and non-instance function are connected to this signal.
+    bool IsConnected( void (*fpFunction)(_P1, _P2) ) const
+    {
+        return IsConnected( Delegate(fpFunction) );
+    }    
+    
+    // Returns true if the given observer and instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2) ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Returns true if the given observer and const instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2) const ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2 ) const { Emit( p1, p2 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 2 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2 ) : a1(p1), a2(p2) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        
+        void EmitTo( const Signal2& oSignal ) const { oSignal.Emit( a1, a2 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2 ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal2, _P1, _P2 > Next()
+    {
+        return SignalAwaiter< Signal2, _P1, _P2 >( this );
+    }
+#endif
+    
+    // Disconnects a non-instance method.
+    void Disconnect( void (*fpFunction)(_P1, _P2) )
+    {
+        JL_SIGNAL_LOG( "Signal2 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        const Delegate d(fpFunction);
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                JL_ASSERT( (*i).pObserver == NULL );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }         
+    }    
+
+    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2) )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal2 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2) const )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal2 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal2 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
+    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
+    // if any disconnections are made.
+    void Disconnect( SignalObserver* pObserver )
+    {
+        if ( ! pObserver )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal2 %p removing all connections to Observer %p\n", this, pObserver );
+        unsigned nDisconnections = 0;
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 )
+        {
+            NotifyObserverDisconnect( pObserver );        
+        }
+    }
+    
+    void DisconnectAll()
+    {
+        JL_SIGNAL_LOG( "Signal2 %p disconnecting all observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
+            SignalObserver* pObserver = (*i).pObserver;
+            
+            //HACK - call this each time we encounter a valid observer pointer. This means
+            // this will be called repeatedly for observers that are connected multiple times
+            // to this signal.
+            if ( pObserver )
+            {
+                NotifyObserverDisconnect( pObserver );
+            }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
+        }
+        
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
+    }
+    
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2 )
+    {
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
+        {
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2 );
+                    ++nCalls;
+                }
+            }
+        }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
+        
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2 ) { fFunctor( p1, p2 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
+    
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal2 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return FunctorConnection();
+        }
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
+    
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
+    {
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2 )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )( p1, p2 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal2 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
+    {
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
+        {
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
+        }
+        
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2 )
+        {
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
+            {
+                ( spObject.get()->*fpMethod )( p1, p2 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+        
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal2 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
+    }
+#endif
+    
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return;
+        }
+        
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
+    }
+    
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
+    {
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal2* >( this )->PurgeDeadConnections();
+        }
+    }
+    
+    void PurgeDeadConnections()
+    {
+        JL_SIGNAL_LOG( "Signal2 %p removing %u dead connections\n", this, m_nDeadConnections );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
+        {
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
+            {
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
+    }
+    
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
+    {
+        bool operator()( const Connection& a, const Connection& b ) const
+        {
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
+            {
+                return bFirstA;
+            }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
+        }
+    };
+    
+    // Puts a connection ahead of every other one
+    struct FrontOrder
+    {
+        bool operator()( const Connection&, const Connection& ) const { return true; }
+    };
+    
+    bool AddConnection( const Connection& c )
+    {
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
+    }
+    
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
+    {
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
+    
+    void RemoveConnection( ConnectionNode* pNode )
+    {
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
+        {
+            MarkRemoved( pNode->object );
+            return;
+        }
+        
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
+    }
+    
+    void MarkRemoved( Connection& c )
+    {
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
+        {
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
+        }
+        
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
+    }
+    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
+    
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
+    {
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
+    }
+    
+    static unsigned HashDelegate( const Delegate& d )
+    {
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
+    }
+    
+    struct DelegateMatch
+    {
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
+    
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
+    {
+        const FunctorConnection* pConnection;
+        
+        bool operator()( const ConnectionNode& oNode ) const
+        {
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
+            {
+                return false;
+            }
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
+        }
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
+    }
+    
+    bool IsIndexedDuplicate( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
+        {
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
+        }
+        
+        return false;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
+        {
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
+        }
+        
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
+        
+        while ( nConnected < nCount )
+        {
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
+            {
+                break;
+            }
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
+            {
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal2 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
+            }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
+        }
+        
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+        
+        return nConnected - nDuplicates;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        unsigned nConnected = 0;
+        
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal2 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+            
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
+            {
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
+            }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
+        }
+        
+        return nConnected;
+    }
+    
+    bool IsConnected( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                return true;
+            }
+        }
+        
+        return false;        
+    }
+    
+    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
+    // the observer is completely disconnected from this signal.
+    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    {
+        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
+        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
+            {
+                JL_ASSERT( (*i).pObserver == pObserver );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                if ( (*i).pObserver == pObserver )
+                {
+                    ++nObserverConnectionCount;
+                }
+
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        {
+            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
+            NotifyObserverDisconnect( pObserver );
+        }    
+    }
+    
+    void OnObserverDisconnect( SignalObserver* pObserver )
+    {
+        JL_SIGNAL_LOG( "Signal2 %p received disconnect message from observer %p\n", this, pObserver );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal2 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+};
+
+#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
+
+/**
+ * Signal<[2 arguments]>: wrapper class for Signal2
+ * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
+ */
+template< typename TUnused, typename _P1, typename _P2 >
+class Signal< TUnused(_P1, _P2) > : public Signal2< _P1, _P2 >
+{
+public:
+    typedef Signal2< _P1, _P2 > TParent;
+    Signal() {}
+    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
+    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
+};
+
+#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
+
+/**
+ * Signal3: signals with 3 arguments
+ */
+template< typename _P1, typename _P2, typename _P3 >
+class Signal3 : public SignalBase
+{
+public:
+    typedef fastdelegate::FastDelegate3< _P1, _P2, _P3 > Delegate;
+    
+    struct Connection
+    {
+        Delegate d;
+        SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
+    };
+    
+    typedef DoublyLinkedList<Connection> ConnectionList;
+    
+    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef typename fastdelegate::ParamTraits< _P3 >::type EmitParam3;
+    typedef SignalNoParam EmitParam4;
+    typedef SignalNoParam EmitParam5;
+    typedef SignalNoParam EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
+private:
+    typedef typename ConnectionList::iterator ConnectionIter;
+    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
+    
+    ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2, _P3 p3 ) const { pSignal->Emit( p1, p2, p3 ); }
+        
+        const Signal3* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
+    
+public:
+    Signal3() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal3( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
+    
+    virtual ~Signal3()
+    {
+        JL_SIGNAL_LOG( "Destroying Signal3 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
+    }
+    
+    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2, _P3), unsigned nFlags = 0 )
+    {
+        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
+        JL_SIGNAL_LOG( "Signal3 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+    }    
+    
+    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3), unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal3 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const, unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal3 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal3* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal3* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal3* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
+    // Returns true if the given observer and non-instance function are connected to this signal.
+    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3) ) const
+    {
+        return IsConnected( Delegate(fpFunction) );
+    }    
+    
+    // Returns true if the given observer and instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Returns true if the given observer and const instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3 ) const { Emit( p1, p2, p3 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 3 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3 ) : a1(p1), a2(p2), a3(p3) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        typename SignalArgumentStorage< _P3 >::Type a3;
+        
+        void EmitTo( const Signal3& oSignal ) const { oSignal.Emit( a1, a2, a3 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3 ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2, p3 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2, p3 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal3, _P1, _P2, _P3 > Next()
+    {
+        return SignalAwaiter< Signal3, _P1, _P2, _P3 >( this );
+    }
+#endif
+    
+    // Disconnects a non-instance method.
+    void Disconnect( void (*fpFunction)(_P1, _P2, _P3) )
+    {
+        JL_SIGNAL_LOG( "Signal3 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        const Delegate d(fpFunction);
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                JL_ASSERT( (*i).pObserver == NULL );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }         
+    }    
+
+    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal3 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal3 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal3 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
+    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
+    // if any disconnections are made.
+    void Disconnect( SignalObserver* pObserver )
+    {
+        if ( ! pObserver )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal3 %p removing all connections to Observer %p\n", this, pObserver );
+        unsigned nDisconnections = 0;
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 )
+        {
+            NotifyObserverDisconnect( pObserver );        
+        }
+    }
+    
+    void DisconnectAll()
+    {
+        JL_SIGNAL_LOG( "Signal3 %p disconnecting all observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
+            SignalObserver* pObserver = (*i).pObserver;
+            
+            //HACK - call this each time we encounter a valid observer pointer. This means
+            // this will be called repeatedly for observers that are connected multiple times
+            // to this signal.
+            if ( pObserver )
+            {
+                NotifyObserverDisconnect( pObserver );
+            }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
+        }
+        
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
+    }
+    
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3 )
+    {
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2, p3 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        typename fastdelegate::ParamTraits< _P3 >::type p3;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
+        {
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2, e.p3 );
+                    ++nCalls;
+                }
+            }
+        }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
+        
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3 ) { fFunctor( p1, p2, p3 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
+    
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal3 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return FunctorConnection();
+        }
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
+    
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
+    {
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3 )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )( p1, p2, p3 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal3 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
+    {
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
+        {
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
+        }
+        
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3 )
+        {
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
+            {
+                ( spObject.get()->*fpMethod )( p1, p2, p3 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+        
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal3 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
+    }
+#endif
+    
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return;
+        }
+        
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
+    }
+    
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
+    {
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal3* >( this )->PurgeDeadConnections();
+        }
+    }
+    
+    void PurgeDeadConnections()
+    {
+        JL_SIGNAL_LOG( "Signal3 %p removing %u dead connections\n", this, m_nDeadConnections );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
+        {
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
+            {
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
+    }
+    
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
+    {
+        bool operator()( const Connection& a, const Connection& b ) const
+        {
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
+            {
+                return bFirstA;
+            }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
+        }
+    };
+    
+    // Puts a connection ahead of every other one
+    struct FrontOrder
+    {
+        bool operator()( const Connection&, const Connection& ) const { return true; }
+    };
+    
+    bool AddConnection( const Connection& c )
+    {
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
+    }
+    
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
+    {
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
+    
+    void RemoveConnection( ConnectionNode* pNode )
+    {
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
+        {
+            MarkRemoved( pNode->object );
+            return;
+        }
+        
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
+    }
+    
+    void MarkRemoved( Connection& c )
+    {
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
+        {
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
+        }
+        
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
+    }
+    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
+    
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
+    {
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
+    }
+    
+    static unsigned HashDelegate( const Delegate& d )
+    {
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
+    }
+    
+    struct DelegateMatch
+    {
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
+    
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
+    {
+        const FunctorConnection* pConnection;
+        
+        bool operator()( const ConnectionNode& oNode ) const
+        {
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
+            {
+                return false;
+            }
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
+        }
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
+    }
+    
+    bool IsIndexedDuplicate( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
+        {
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
+        }
+        
+        return false;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
+        {
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
+        }
+        
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
+        
+        while ( nConnected < nCount )
+        {
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
+            {
+                break;
+            }
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
+            {
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal3 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
+            }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
+        }
+        
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+        
+        return nConnected - nDuplicates;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        unsigned nConnected = 0;
+        
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal3 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+            
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
+            {
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
+            }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
+        }
+        
+        return nConnected;
+    }
+    
+    bool IsConnected( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                return true;
+            }
+        }
+        
+        return false;        
+    }
+    
+    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
+    // the observer is completely disconnected from this signal.
+    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    {
+        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
+        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
+            {
+                JL_ASSERT( (*i).pObserver == pObserver );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                if ( (*i).pObserver == pObserver )
+                {
+                    ++nObserverConnectionCount;
+                }
+
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        {
+            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
+            NotifyObserverDisconnect( pObserver );
+        }    
+    }
+    
+    void OnObserverDisconnect( SignalObserver* pObserver )
+    {
+        JL_SIGNAL_LOG( "Signal3 %p received disconnect message from observer %p\n", this, pObserver );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal3 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+};
+
+#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
+
+/**
+ * Signal<[3 arguments]>: wrapper class for Signal3
+ * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
+ */
+template< typename TUnused, typename _P1, typename _P2, typename _P3 >
+class Signal< TUnused(_P1, _P2, _P3) > : public Signal3< _P1, _P2, _P3 >
+{
+public:
+    typedef Signal3< _P1, _P2, _P3 > TParent;
+    Signal() {}
+    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
+    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
+};
+
+#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
+
+/**
+ * Signal4: signals with 4 arguments
+ */
+template< typename _P1, typename _P2, typename _P3, typename _P4 >
+class Signal4 : public SignalBase
+{
+public:
+    typedef fastdelegate::FastDelegate4< _P1, _P2, _P3, _P4 > Delegate;
+    
+    struct Connection
+    {
+        Delegate d;
+        SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
+    };
+    
+    typedef DoublyLinkedList<Connection> ConnectionList;
+    
+    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef typename fastdelegate::ParamTraits< _P3 >::type EmitParam3;
+    typedef typename fastdelegate::ParamTraits< _P4 >::type EmitParam4;
+    typedef SignalNoParam EmitParam5;
+    typedef SignalNoParam EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
+private:
+    typedef typename ConnectionList::iterator ConnectionIter;
+    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
+    
+    ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2, _P3 p3, _P4 p4 ) const { pSignal->Emit( p1, p2, p3, p4 ); }
+        
+        const Signal4* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
+    
+public:
+    Signal4() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal4( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
+    
+    virtual ~Signal4()
+    {
+        JL_SIGNAL_LOG( "Destroying Signal4 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
+    }
+    
+    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4), unsigned nFlags = 0 )
+    {
+        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
+        JL_SIGNAL_LOG( "Signal4 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+    }    
+    
+    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4), unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal4 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const, unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal4 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal4* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal4* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal4* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
+    // Returns true if the given observer and non-instance function are connected to this signal.
+    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4) ) const
+    {
+        return IsConnected( Delegate(fpFunction) );
+    }    
+    
+    // Returns true if the given observer and instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Returns true if the given observer and const instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4 ) const { Emit( p1, p2, p3, p4 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 4 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4 ) : a1(p1), a2(p2), a3(p3), a4(p4) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        typename SignalArgumentStorage< _P3 >::Type a3;
+        typename SignalArgumentStorage< _P4 >::Type a4;
+        
+        void EmitTo( const Signal4& oSignal ) const { oSignal.Emit( a1, a2, a3, a4 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4 ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2, p3, p4 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal4, _P1, _P2, _P3, _P4 > Next()
+    {
+        return SignalAwaiter< Signal4, _P1, _P2, _P3, _P4 >( this );
+    }
+#endif
+    
+    // Disconnects a non-instance method.
+    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4) )
+    {
+        JL_SIGNAL_LOG( "Signal4 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        const Delegate d(fpFunction);
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                JL_ASSERT( (*i).pObserver == NULL );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }         
+    }    
+
+    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal4 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal4 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal4 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
+    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
+    // if any disconnections are made.
+    void Disconnect( SignalObserver* pObserver )
+    {
+        if ( ! pObserver )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal4 %p removing all connections to Observer %p\n", this, pObserver );
+        unsigned nDisconnections = 0;
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 )
+        {
+            NotifyObserverDisconnect( pObserver );        
+        }
+    }
+    
+    void DisconnectAll()
+    {
+        JL_SIGNAL_LOG( "Signal4 %p disconnecting all observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
+            SignalObserver* pObserver = (*i).pObserver;
+            
+            //HACK - call this each time we encounter a valid observer pointer. This means
+            // this will be called repeatedly for observers that are connected multiple times
+            // to this signal.
+            if ( pObserver )
+            {
+                NotifyObserverDisconnect( pObserver );
+            }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
+        }
+        
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
+    }
+    
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4 )
+    {
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2, p3, p4 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        typename fastdelegate::ParamTraits< _P3 >::type p3;
+        typename fastdelegate::ParamTraits< _P4 >::type p4;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
+        {
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2, e.p3, e.p4 );
+                    ++nCalls;
+                }
+            }
+        }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
+        
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4 ) { fFunctor( p1, p2, p3, p4 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
+    
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal4 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return FunctorConnection();
+        }
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
+    
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
+    {
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4 )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )( p1, p2, p3, p4 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal4 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
+    {
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
+        {
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
+        }
+        
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4 )
+        {
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
+            {
+                ( spObject.get()->*fpMethod )( p1, p2, p3, p4 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+        
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal4 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
+    }
+#endif
+    
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return;
+        }
+        
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
+    }
+    
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
+    {
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal4* >( this )->PurgeDeadConnections();
+        }
+    }
+    
+    void PurgeDeadConnections()
+    {
+        JL_SIGNAL_LOG( "Signal4 %p removing %u dead connections\n", this, m_nDeadConnections );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
+        {
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
+            {
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
+    }
+    
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
+    {
+        bool operator()( const Connection& a, const Connection& b ) const
+        {
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
+            {
+                return bFirstA;
+            }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
+        }
+    };
+    
+    // Puts a connection ahead of every other one
+    struct FrontOrder
+    {
+        bool operator()( const Connection&, const Connection& ) const { return true; }
+    };
+    
+    bool AddConnection( const Connection& c )
+    {
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
+    }
+    
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
+    {
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
+    
+    void RemoveConnection( ConnectionNode* pNode )
+    {
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
+        {
+            MarkRemoved( pNode->object );
+            return;
+        }
+        
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
+    }
+    
+    void MarkRemoved( Connection& c )
+    {
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
+        {
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
+        }
+        
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
+    }
+    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
+    
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
+    {
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
+    }
+    
+    static unsigned HashDelegate( const Delegate& d )
+    {
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
+    }
+    
+    struct DelegateMatch
+    {
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
+    
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
+    {
+        const FunctorConnection* pConnection;
+        
+        bool operator()( const ConnectionNode& oNode ) const
+        {
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
+            {
+                return false;
+            }
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
+        }
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
+    }
+    
+    bool IsIndexedDuplicate( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
+        {
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
+        }
+        
+        return false;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
+        {
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
+        }
+        
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
+        
+        while ( nConnected < nCount )
+        {
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
+            {
+                break;
+            }
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
+            {
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal4 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
+            }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
+        }
+        
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+        
+        return nConnected - nDuplicates;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        unsigned nConnected = 0;
+        
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal4 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+            
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
+            {
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
+            }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
+        }
+        
+        return nConnected;
+    }
+    
+    bool IsConnected( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                return true;
+            }
+        }
+        
+        return false;        
+    }
+    
+    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
+    // the observer is completely disconnected from this signal.
+    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    {
+        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
+        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
+            {
+                JL_ASSERT( (*i).pObserver == pObserver );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                if ( (*i).pObserver == pObserver )
+                {
+                    ++nObserverConnectionCount;
+                }
+
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        {
+            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
+            NotifyObserverDisconnect( pObserver );
+        }    
+    }
+    
+    void OnObserverDisconnect( SignalObserver* pObserver )
+    {
+        JL_SIGNAL_LOG( "Signal4 %p received disconnect message from observer %p\n", this, pObserver );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal4 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+};
+
+#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
+
+/**
+ * Signal<[4 arguments]>: wrapper class for Signal4
+ * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
+ */
+template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4 >
+class Signal< TUnused(_P1, _P2, _P3, _P4) > : public Signal4< _P1, _P2, _P3, _P4 >
+{
+public:
+    typedef Signal4< _P1, _P2, _P3, _P4 > TParent;
+    Signal() {}
+    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
+    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
+};
+
+#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
+
+/**
+ * Signal5: signals with 5 arguments
+ */
+template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5 >
+class Signal5 : public SignalBase
+{
+public:
+    typedef fastdelegate::FastDelegate5< _P1, _P2, _P3, _P4, _P5 > Delegate;
+    
+    struct Connection
+    {
+        Delegate d;
+        SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
+    };
+    
+    typedef DoublyLinkedList<Connection> ConnectionList;
+    
+    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef typename fastdelegate::ParamTraits< _P3 >::type EmitParam3;
+    typedef typename fastdelegate::ParamTraits< _P4 >::type EmitParam4;
+    typedef typename fastdelegate::ParamTraits< _P5 >::type EmitParam5;
+    typedef SignalNoParam EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
+private:
+    typedef typename ConnectionList::iterator ConnectionIter;
+    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
+    
+    ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5 ) const { pSignal->Emit( p1, p2, p3, p4, p5 ); }
+        
+        const Signal5* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
+    
+public:
+    Signal5() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal5( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
+    
+    virtual ~Signal5()
+    {
+        JL_SIGNAL_LOG( "Destroying Signal5 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
+    }
+    
+    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5), unsigned nFlags = 0 )
+    {
+        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
+        JL_SIGNAL_LOG( "Signal5 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+    }    
+    
+    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5), unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal5 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const, unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal5 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal5* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal5* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal5* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
+    // Returns true if the given observer and non-instance function are connected to this signal.
+    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5) ) const
+    {
+        return IsConnected( Delegate(fpFunction) );
+    }    
+    
+    // Returns true if the given observer and instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Returns true if the given observer and const instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5 ) const { Emit( p1, p2, p3, p4, p5 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 5 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5 ) : a1(p1), a2(p2), a3(p3), a4(p4), a5(p5) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        typename SignalArgumentStorage< _P3 >::Type a3;
+        typename SignalArgumentStorage< _P4 >::Type a4;
+        typename SignalArgumentStorage< _P5 >::Type a5;
+        
+        void EmitTo( const Signal5& oSignal ) const { oSignal.Emit( a1, a2, a3, a4, a5 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5 ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2, p3, p4, p5 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal5, _P1, _P2, _P3, _P4, _P5 > Next()
+    {
+        return SignalAwaiter< Signal5, _P1, _P2, _P3, _P4, _P5 >( this );
+    }
+#endif
+    
+    // Disconnects a non-instance method.
+    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5) )
+    {
+        JL_SIGNAL_LOG( "Signal5 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        const Delegate d(fpFunction);
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                JL_ASSERT( (*i).pObserver == NULL );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }         
+    }    
+
+    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal5 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal5 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal5 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
+    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
+    // if any disconnections are made.
+    void Disconnect( SignalObserver* pObserver )
+    {
+        if ( ! pObserver )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal5 %p removing all connections to Observer %p\n", this, pObserver );
+        unsigned nDisconnections = 0;
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 )
+        {
+            NotifyObserverDisconnect( pObserver );        
+        }
+    }
+    
+    void DisconnectAll()
+    {
+        JL_SIGNAL_LOG( "Signal5 %p disconnecting all observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
+            SignalObserver* pObserver = (*i).pObserver;
+            
+            //HACK - call this each time we encounter a valid observer pointer. This means
+            // this will be called repeatedly for observers that are connected multiple times
+            // to this signal.
+            if ( pObserver )
+            {
+                NotifyObserverDisconnect( pObserver );
+            }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
+        }
+        
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
+    }
+    
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5 )
+    {
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2, p3, p4, p5 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        typename fastdelegate::ParamTraits< _P3 >::type p3;
+        typename fastdelegate::ParamTraits< _P4 >::type p4;
+        typename fastdelegate::ParamTraits< _P5 >::type p5;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
+        {
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2, e.p3, e.p4, e.p5 );
+                    ++nCalls;
+                }
+            }
+        }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
+        
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5 ) { fFunctor( p1, p2, p3, p4, p5 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
+    
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal5 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return FunctorConnection();
+        }
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
+    
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
+    {
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5 )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )( p1, p2, p3, p4, p5 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal5 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
+    {
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
+        {
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
+        }
+        
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5 )
+        {
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
+            {
+                ( spObject.get()->*fpMethod )( p1, p2, p3, p4, p5 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+        
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal5 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
+    }
+#endif
+    
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return;
+        }
+        
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
+    }
+    
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
+    {
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal5* >( this )->PurgeDeadConnections();
+        }
+    }
+    
+    void PurgeDeadConnections()
+    {
+        JL_SIGNAL_LOG( "Signal5 %p removing %u dead connections\n", this, m_nDeadConnections );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
+        {
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
+            {
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
+    }
+    
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
+    {
+        bool operator()( const Connection& a, const Connection& b ) const
+        {
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
+            {
+                return bFirstA;
+            }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
+        }
+    };
+    
+    // Puts a connection ahead of every other one
+    struct FrontOrder
+    {
+        bool operator()( const Connection&, const Connection& ) const { return true; }
+    };
+    
+    bool AddConnection( const Connection& c )
+    {
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
+    }
+    
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
+    {
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
+    
+    void RemoveConnection( ConnectionNode* pNode )
+    {
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
+        {
+            MarkRemoved( pNode->object );
+            return;
+        }
+        
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
+    }
+    
+    void MarkRemoved( Connection& c )
+    {
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
+        {
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
+        }
+        
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
+    }
+    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
+    
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
+    {
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
+    }
+    
+    static unsigned HashDelegate( const Delegate& d )
+    {
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
+    }
+    
+    struct DelegateMatch
+    {
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
+    
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
+    {
+        const FunctorConnection* pConnection;
+        
+        bool operator()( const ConnectionNode& oNode ) const
+        {
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
+            {
+                return false;
+            }
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
+        }
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
+    }
+    
+    bool IsIndexedDuplicate( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
+        {
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
+        }
+        
+        return false;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
+        {
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
+        }
+        
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
+        
+        while ( nConnected < nCount )
+        {
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
+            {
+                break;
+            }
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
+            {
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal5 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
+            }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
+        }
+        
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+        
+        return nConnected - nDuplicates;
+    }
+    
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
+    {
+        unsigned nConnected = 0;
+        
+        for ( unsigned i = 0; i < nCount; ++i )
+        {
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal5 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+            
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
+            {
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
+            }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
+        }
+        
+        return nConnected;
+    }
+    
+    bool IsConnected( const Delegate& d ) const
+    {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                return true;
+            }
+        }
+        
+        return false;        
+    }
+    
+    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
+    // the observer is completely disconnected from this signal.
+    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    {
+        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
+        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
+            {
+                JL_ASSERT( (*i).pObserver == pObserver );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                if ( (*i).pObserver == pObserver )
+                {
+                    ++nObserverConnectionCount;
+                }
+
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        {
+            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
+            NotifyObserverDisconnect( pObserver );
+        }    
+    }
+    
+    void OnObserverDisconnect( SignalObserver* pObserver )
+    {
+        JL_SIGNAL_LOG( "Signal5 %p received disconnect message from observer %p\n", this, pObserver );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal5 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+};
+
+#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
+
+/**
+ * Signal<[5 arguments]>: wrapper class for Signal5
+ * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
+ */
+template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4, typename _P5 >
+class Signal< TUnused(_P1, _P2, _P3, _P4, _P5) > : public Signal5< _P1, _P2, _P3, _P4, _P5 >
+{
+public:
+    typedef Signal5< _P1, _P2, _P3, _P4, _P5 > TParent;
+    Signal() {}
+    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
+    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
+};
+
+#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
+
+/**
+ * Signal6: signals with 6 arguments
+ */
+template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6 >
+class Signal6 : public SignalBase
+{
+public:
+    typedef fastdelegate::FastDelegate6< _P1, _P2, _P3, _P4, _P5, _P6 > Delegate;
+    
+    struct Connection
+    {
+        Delegate d;
+        SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
+    };
+    
+    typedef DoublyLinkedList<Connection> ConnectionList;
+    
+    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
+    
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef typename fastdelegate::ParamTraits< _P3 >::type EmitParam3;
+    typedef typename fastdelegate::ParamTraits< _P4 >::type EmitParam4;
+    typedef typename fastdelegate::ParamTraits< _P5 >::type EmitParam5;
+    typedef typename fastdelegate::ParamTraits< _P6 >::type EmitParam6;
+    typedef SignalNoParam EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
+private:
+    typedef typename ConnectionList::iterator ConnectionIter;
+    typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
+    
+    ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6 ) const { pSignal->Emit( p1, p2, p3, p4, p5, p6 ); }
+        
+        const Signal6* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
+    
+public:
+    Signal6() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal6( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
+    
+    virtual ~Signal6()
+    {
+        JL_SIGNAL_LOG( "Destroying Signal6 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
+    }
+    
+    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6), unsigned nFlags = 0 )
+    {
+        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
+        JL_SIGNAL_LOG( "Signal6 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+    }    
+    
+    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6), unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal6 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const, unsigned nFlags = 0 )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal6 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
+        
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        NotifyObserverConnect( pObserver );
+    }
+    
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal6* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal6* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal6* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
+    // Returns true if the given observer and non-instance function are connected to this signal.
+    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6) ) const
+    {
+        return IsConnected( Delegate(fpFunction) );
+    }    
+    
+    // Returns true if the given observer and instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Returns true if the given observer and const instance method are connected to this signal.
+    template< class X, class Y >
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const ) const
+    {
+        return IsConnected( Delegate(pObject, fpMethod) );
+    }
+    
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6 ) const { Emit( p1, p2, p3, p4, p5, p6 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 6 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6 ) : a1(p1), a2(p2), a3(p3), a4(p4), a5(p5), a6(p6) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        typename SignalArgumentStorage< _P3 >::Type a3;
+        typename SignalArgumentStorage< _P4 >::Type a4;
+        typename SignalArgumentStorage< _P5 >::Type a5;
+        typename SignalArgumentStorage< _P6 >::Type a6;
+        
+        void EmitTo( const Signal6& oSignal ) const { oSignal.Emit( a1, a2, a3, a4, a5, a6 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6 ) const
+    {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2, p3, p4, p5, p6 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal6, _P1, _P2, _P3, _P4, _P5, _P6 > Next()
+    {
+        return SignalAwaiter< Signal6, _P1, _P2, _P3, _P4, _P5, _P6 >( this );
+    }
+#endif
+    
+    // Disconnects a non-instance method.
+    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6) )
+    {
+        JL_SIGNAL_LOG( "Signal6 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        const Delegate d(fpFunction);
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).d == d && ! IsRemoved(*i) )
+            {
+                JL_ASSERT( (*i).pObserver == NULL );
+                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }         
+    }    
+
+    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal6 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
+    template< class X, class Y >
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const )
+    {
+        if ( ! pObject )
+        {
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal6 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal6 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
+    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
+    // if any disconnections are made.
+    void Disconnect( SignalObserver* pObserver )
+    {
+        if ( ! pObserver )
+        {
+            return;
+        }
+        
+        JL_SIGNAL_LOG( "Signal6 %p removing all connections to Observer %p\n", this, pObserver );
+        unsigned nDisconnections = 0;
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
+            {
+                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
+                RemoveConnection( i ); // advances iterator
+                ++nDisconnections;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if ( nDisconnections > 0 )
+        {
+            NotifyObserverDisconnect( pObserver );        
+        }
+    }
+    
+    void DisconnectAll()
+    {
+        JL_SIGNAL_LOG( "Signal6 %p disconnecting all observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
+            SignalObserver* pObserver = (*i).pObserver;
+            
+            //HACK - call this each time we encounter a valid observer pointer. This means
+            // this will be called repeatedly for observers that are connected multiple times
+            // to this signal.
+            if ( pObserver )
+            {
+                NotifyObserverDisconnect( pObserver );
+            }
+            
+            if ( m_nEmitDepth > 0 )
+            {
+                MarkRemoved( *i );
+            }
+            else
+            {
+                ReleaseFunctor( *i );
+            }
+        }
+        
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
+        {
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
+    }
+    
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6 )
+    {
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2, p3, p4, p5, p6 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        typename fastdelegate::ParamTraits< _P3 >::type p3;
+        typename fastdelegate::ParamTraits< _P4 >::type p4;
+        typename fastdelegate::ParamTraits< _P5 >::type p5;
+        typename fastdelegate::ParamTraits< _P6 >::type p6;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
+        {
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2, e.p3, e.p4, e.p5, e.p6 );
+                    ++nCalls;
+                }
+            }
+        }
+    };
+    
+    // The start of every functor connection's block
+    struct FunctorSlot
+    {
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
+    };
+    
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
+    {
+        unsigned nSerial; // see FunctorConnection
+    };
+    
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
+    {
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
+        
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6 ) { fFunctor( p1, p2, p3, p4, p5, p6 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
+    
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
+    {
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal6 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
+        {
+            return FunctorConnection();
+        }
+        
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
+        
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+            return FunctorConnection();
+        }
+        
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
+        
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
+    }
+    
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
+    {
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
+    }
+    
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
+    {
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
+    }
+    
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
+    {
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
+        {
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
+    {
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6 )
+        {
+            if ( hObject.IsAlive() )
+            {
+                ( pObject->*fpMethod )( p1, p2, p3, p4, p5, p6 );
+            }
+            else
+            {
+                this->OnTargetDead();
+            }
+        }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
     {
-        if ( ! pObject )
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
         {
             return;
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal1 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        JL_SIGNAL_LOG( "Signal6 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
     }
     
-    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
-    // if any disconnections are made.
-    void Disconnect( SignalObserver* pObserver )
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
     {
-        if ( ! pObserver )
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
         {
-            return;
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
         }
         
-        JL_SIGNAL_LOG( "Signal1 %p removing all connections to Observer %p\n", this, pObserver );
-        unsigned nDisconnections = 0;
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6 )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
             {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                ( spObject.get()->*fpMethod )( p1, p2, p3, p4, p5, p6 );
             }
             else
             {
-                ++i;
+                this->OnTargetDead();
             }
         }
         
-        if ( nDisconnections > 0 )
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
         {
-            NotifyObserverDisconnect( pObserver );        
+            return;
         }
+        
+        JL_SIGNAL_LOG( "Signal6 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
     }
+#endif
     
-    void DisconnectAll()
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal1 %p disconnecting all observers\n", this );
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
         {
-            SignalObserver* pObserver = (*i).pObserver;
-            
-            //HACK - call this each time we encounter a valid observer pointer. This means
-            // this will be called repeatedly for observers that are connected multiple times
-            // to this signal.
-            if ( pObserver )
-            {
-                NotifyObserverDisconnect( pObserver );
-            }
+            return;
         }
         
-        m_oConnections.Clear();
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
     }
     
-private:
-    bool IsConnected( const Delegate& d ) const
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
         {
-            if ( (*i).d == d )
-            {
-                return true;
-            }
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal6* >( this )->PurgeDeadConnections();
         }
-        
-        return false;        
     }
     
-    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
-    // the observer is completely disconnected from this signal.
-    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    void PurgeDeadConnections()
     {
-        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
-        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        JL_SIGNAL_LOG( "Signal6 %p removing %u dead connections\n", this, m_nDeadConnections );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
         {
-            if ( (*i).d == d )
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
             {
-                JL_ASSERT( (*i).pObserver == pObserver );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
             }
             else
             {
-                if ( (*i).pObserver == pObserver )
-                {
-                    ++nObserverConnectionCount;
-                }
-
                 ++i;
             }
         }
         
-        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
-        {
-            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
-            NotifyObserverDisconnect( pObserver );
-        }    
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
     }
     
-    void OnObserverDisconnect( SignalObserver* pObserver )
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
     {
-        JL_SIGNAL_LOG( "Signal1 %p received disconnect message from observer %p\n", this, pObserver );
-        
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        bool operator()( const Connection& a, const Connection& b ) const
         {
-            if ( (*i).pObserver == pObserver )
-            {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
             {
-                ++i;
+                return bFirstA;
             }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
         }
-    }
-};
-
-#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
-
-/**
- * Signal<[1 argument]>: wrapper class for Signal1
- * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
- */
-template< typename TUnused, typename _P1 >
-class Signal< TUnused(_P1) > : public Signal1< _P1 >
-{
-public:
-    typedef Signal1< _P1 > TParent;
-    Signal() {}
-    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
-    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
-};
-
-#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
-
-/**
- * Signal2: signals with 2 arguments
- */
-template< typename _P1, typename _P2 >
-class Signal2 : public SignalBase
-{
-public:
-    typedef fastdelegate::FastDelegate2< _P1, _P2 > Delegate;
+    };
     
-    struct Connection
+    // Puts a connection ahead of every other one
+    struct FrontOrder
     {
-        Delegate d;
-        SignalObserver* pObserver;
+        bool operator()( const Connection&, const Connection& ) const { return true; }
     };
     
-    typedef DoublyLinkedList<Connection> ConnectionList;
-    
-    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
-    
-private:
-    typedef typename ConnectionList::iterator ConnectionIter;
-    typedef typename ConnectionList::const_iterator ConnectionConstIter;
-    
-    ConnectionList m_oConnections;
-    
-public:
-    Signal2() { SetAllocator( s_pCommonAllocator ); }
-    Signal2( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
-    
-    virtual ~Signal2()
+    bool AddConnection( const Connection& c )
     {
-        JL_SIGNAL_LOG( "Destroying Signal2 %p\n", this );
-        DisconnectAll();
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
     }
     
-    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
-    
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2) )
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
     {
-        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal2 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
-        
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-    }    
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
     
-    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2) )
+    void RemoveConnection( ConnectionNode* pNode )
     {
-        if ( ! pObject )
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
         {
+            MarkRemoved( pNode->object );
             return;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal2 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
     }
     
-    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2) const )
+    void MarkRemoved( Connection& c )
     {
-        if ( ! pObject )
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
         {
-            return;
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal2 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
     }
     
-    // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2) ) const
-    {
-        return IsConnected( Delegate(fpFunction) );
-    }    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
     
-    // Returns true if the given observer and instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2) ) const
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
     }
     
-    // Returns true if the given observer and const instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2) const ) const
+    static unsigned HashDelegate( const Delegate& d )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
     }
     
-    void Emit( _P1 p1, _P2 p2 ) const
+    struct DelegateMatch
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            (*i).d( p1, p2 );
-        }
-    }
-    
-    void operator()( _P1 p1, _P2 p2 ) const { Emit( p1, p2 ); } 
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
     
-    // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2) )
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
     {
-        JL_SIGNAL_LOG( "Signal2 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
-        const Delegate d(fpFunction);
+        const FunctorConnection* pConnection;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        bool operator()( const ConnectionNode& oNode ) const
         {
-            if ( (*i).d == d )
-            {
-                JL_ASSERT( (*i).pObserver == NULL );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
             {
-                ++i;
+                return false;
             }
-        }         
-    }    
-
-    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2) )
-    {
-        if ( ! pObject )
-        {
-            return;
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
         }
-        
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal2 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
     }
     
-    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2) const )
+    bool IsIndexedDuplicate( const Delegate& d ) const
     {
-        if ( ! pObject )
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
         {
-            return;
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal2 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        return false;
     }
     
-    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
-    // if any disconnections are made.
-    void Disconnect( SignalObserver* pObserver )
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        if ( ! pObserver )
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
         {
-            return;
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
         }
         
-        JL_SIGNAL_LOG( "Signal2 %p removing all connections to Observer %p\n", this, pObserver );
-        unsigned nDisconnections = 0;
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        while ( nConnected < nCount )
         {
-            if ( (*i).pObserver == pObserver )
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
             {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                break;
+            }
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
+            {
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal6 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
             }
-            else
+            
+            if ( nUsedObserverNodes < nObserverNodes )
             {
-                ++i;
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
             }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
         }
         
-        if ( nDisconnections > 0 )
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
         {
-            NotifyObserverDisconnect( pObserver );        
+            m_oConnections.Sort( GroupedOrder() );
         }
+        
+        return nConnected - nDuplicates;
     }
     
-    void DisconnectAll()
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal2 %p disconnecting all observers\n", this );
+        unsigned nConnected = 0;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        for ( unsigned i = 0; i < nCount; ++i )
         {
-            SignalObserver* pObserver = (*i).pObserver;
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal6 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
             
-            //HACK - call this each time we encounter a valid observer pointer. This means
-            // this will be called repeatedly for observers that are connected multiple times
-            // to this signal.
-            if ( pObserver )
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
             {
-                NotifyObserverDisconnect( pObserver );
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
             }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
         }
         
-        m_oConnections.Clear();
+        return nConnected;
     }
     
-private:
     bool IsConnected( const Delegate& d ) const
     {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
         for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
         {
-            if ( (*i).d == d )
+            if ( (*i).d == d && ! IsRemoved(*i) )
             {
                 return true;
             }
@@ -879,13 +9497,35 @@ private:
         unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
         unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
         
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).d == d )
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
             {
                 JL_ASSERT( (*i).pObserver == pObserver );
                 JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
+                RemoveConnection( i ); // advances iterator
                 ++nDisconnections;
             }
             else
@@ -908,14 +9548,32 @@ private:
     
     void OnObserverDisconnect( SignalObserver* pObserver )
     {
-        JL_SIGNAL_LOG( "Signal2 %p received disconnect message from observer %p\n", this, pObserver );
+        JL_SIGNAL_LOG( "Signal6 %p received disconnect message from observer %p\n", this, pObserver );
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
             {
                 JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal6 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
             }
             else
             {
@@ -928,14 +9586,14 @@ private:
 #ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
 
 /**
- * Signal<[2 arguments]>: wrapper class for Signal2
+ * Signal<[6 arguments]>: wrapper class for Signal6
  * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
  */
-template< typename TUnused, typename _P1, typename _P2 >
-class Signal< TUnused(_P1, _P2) > : public Signal2< _P1, _P2 >
+template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6 >
+class Signal< TUnused(_P1, _P2, _P3, _P4, _P5, _P6) > : public Signal6< _P1, _P2, _P3, _P4, _P5, _P6 >
 {
 public:
-    typedef Signal2< _P1, _P2 > TParent;
+    typedef Signal6< _P1, _P2, _P3, _P4, _P5, _P6 > TParent;
     Signal() {}
     Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
     void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
@@ -944,57 +9602,177 @@ public:
 #endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
 
 /**
- * Signal3: signals with 3 arguments
+ * Signal7: signals with 7 arguments
  */
-template< typename _P1, typename _P2, typename _P3 >
-class Signal3 : public SignalBase
+template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6, typename _P7 >
+class Signal7 : public SignalBase
 {
 public:
-    typedef fastdelegate::FastDelegate3< _P1, _P2, _P3 > Delegate;
+    typedef fastdelegate::FastDelegate7< _P1, _P2, _P3, _P4, _P5, _P6, _P7 > Delegate;
     
     struct Connection
     {
         Delegate d;
         SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
     };
     
     typedef DoublyLinkedList<Connection> ConnectionList;
     
     enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
     
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef typename fastdelegate::ParamTraits< _P3 >::type EmitParam3;
+    typedef typename fastdelegate::ParamTraits< _P4 >::type EmitParam4;
+    typedef typename fastdelegate::ParamTraits< _P5 >::type EmitParam5;
+    typedef typename fastdelegate::ParamTraits< _P6 >::type EmitParam6;
+    typedef typename fastdelegate::ParamTraits< _P7 >::type EmitParam7;
+    typedef SignalNoParam EmitParam8;
+    
 private:
     typedef typename ConnectionList::iterator ConnectionIter;
     typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
     
     ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7 ) const { pSignal->Emit( p1, p2, p3, p4, p5, p6, p7 ); }
+        
+        const Signal7* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
     
 public:
-    Signal3() { SetAllocator( s_pCommonAllocator ); }
-    Signal3( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
+    Signal7() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal7( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
     
-    virtual ~Signal3()
+    virtual ~Signal7()
     {
-        JL_SIGNAL_LOG( "Destroying Signal3 %p\n", this );
-        DisconnectAll();
+        JL_SIGNAL_LOG( "Destroying Signal7 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
     }
     
     void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
     
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2, _P3) )
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
+    
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7), unsigned nFlags = 0 )
     {
         JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal3 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        JL_SIGNAL_LOG( "Signal7 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
         
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
     }    
     
     // Connects instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) )
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7), unsigned nFlags = 0 )
     {
         if ( ! pObject )
         {
@@ -1003,17 +9781,23 @@ public:
         
         JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal3 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        JL_SIGNAL_LOG( "Signal7 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
         NotifyObserverConnect( pObserver );
     }
     
     // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const )
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const, unsigned nFlags = 0 )
     {
         if ( ! pObject )
         {
@@ -1022,57 +9806,343 @@ public:
         
         JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal3 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        JL_SIGNAL_LOG( "Signal7 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
         NotifyObserverConnect( pObserver );
     }
     
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal7* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal7* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal7* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
     // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3) ) const
+    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) ) const
     {
         return IsConnected( Delegate(fpFunction) );
     }    
     
     // Returns true if the given observer and instance method are connected to this signal.
     template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) ) const
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) ) const
     {
         return IsConnected( Delegate(pObject, fpMethod) );
     }
     
     // Returns true if the given observer and const instance method are connected to this signal.
     template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const ) const
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const ) const
     {
         return IsConnected( Delegate(pObject, fpMethod) );
     }
     
-    void Emit( _P1 p1, _P2 p2, _P3 p3 ) const
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6, p7 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6, p7 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7 ) const { Emit( p1, p2, p3, p4, p5, p6, p7 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6, p7 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6, p7 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 7 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7 ) : a1(p1), a2(p2), a3(p3), a4(p4), a5(p5), a6(p6), a7(p7) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        typename SignalArgumentStorage< _P3 >::Type a3;
+        typename SignalArgumentStorage< _P4 >::Type a4;
+        typename SignalArgumentStorage< _P5 >::Type a5;
+        typename SignalArgumentStorage< _P6 >::Type a6;
+        typename SignalArgumentStorage< _P7 >::Type a7;
+        
+        void EmitTo( const Signal7& oSignal ) const { oSignal.Emit( a1, a2, a3, a4, a5, a6, a7 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7 ) const
     {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2, p3, p4, p5, p6, p7 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
         for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
         {
-            (*i).d( p1, p2, p3 );
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6, p7 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6, p7 );
+            }
         }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
     }
     
-    void operator()( _P1 p1, _P2 p2, _P3 p3 ) const { Emit( p1, p2, p3 ); } 
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal7, _P1, _P2, _P3, _P4, _P5, _P6, _P7 > Next()
+    {
+        return SignalAwaiter< Signal7, _P1, _P2, _P3, _P4, _P5, _P6, _P7 >( this );
+    }
+#endif
     
     // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2, _P3) )
+    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) )
     {
-        JL_SIGNAL_LOG( "Signal3 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        JL_SIGNAL_LOG( "Signal7 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
         const Delegate d(fpFunction);
         
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).d == d )
+            if ( (*i).d == d && ! IsRemoved(*i) )
             {
                 JL_ASSERT( (*i).pObserver == NULL );
                 JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
+                RemoveConnection( i );
             }
             else
             {
@@ -1083,7 +10153,7 @@ public:
 
     // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) )
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) )
     {
         if ( ! pObject )
         {
@@ -1091,13 +10161,13 @@ public:
         }
         
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal3 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        JL_SIGNAL_LOG( "Signal7 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
         DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
     }
     
     // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3) const )
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const )
     {
         if ( ! pObject )
         {
@@ -1105,10 +10175,52 @@ public:
         }
         
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal3 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        JL_SIGNAL_LOG( "Signal7 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
         DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
     }
     
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal7 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
+        }
+        
+        return true;
+    }
+    
     // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
     // if any disconnections are made.
     void Disconnect( SignalObserver* pObserver )
@@ -1118,15 +10230,15 @@ public:
             return;
         }
         
-        JL_SIGNAL_LOG( "Signal3 %p removing all connections to Observer %p\n", this, pObserver );
+        JL_SIGNAL_LOG( "Signal7 %p removing all connections to Observer %p\n", this, pObserver );
         unsigned nDisconnections = 0;
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
             {
                 JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
+                RemoveConnection( i ); // advances iterator
                 ++nDisconnections;
             }
             else
@@ -1143,10 +10255,15 @@ public:
     
     void DisconnectAll()
     {
-        JL_SIGNAL_LOG( "Signal3 %p disconnecting all observers\n", this );
+        JL_SIGNAL_LOG( "Signal7 %p disconnecting all observers\n", this );
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
         {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
             SignalObserver* pObserver = (*i).pObserver;
             
             //HACK - call this each time we encounter a valid observer pointer. This means
@@ -1156,623 +10273,590 @@ public:
             {
                 NotifyObserverDisconnect( pObserver );
             }
-        }
-        
-        m_oConnections.Clear();
-    }
-    
-private:
-    bool IsConnected( const Delegate& d ) const
-    {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            if ( (*i).d == d )
-            {
-                return true;
-            }
-        }
-        
-        return false;        
-    }
-    
-    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
-    // the observer is completely disconnected from this signal.
-    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
-    {
-        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
-        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
-        
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
-        {
-            if ( (*i).d == d )
+            
+            if ( m_nEmitDepth > 0 )
             {
-                JL_ASSERT( (*i).pObserver == pObserver );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                MarkRemoved( *i );
             }
             else
             {
-                if ( (*i).pObserver == pObserver )
-                {
-                    ++nObserverConnectionCount;
-                }
-
-                ++i;
+                ReleaseFunctor( *i );
             }
         }
         
-        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
         {
-            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
-            NotifyObserverDisconnect( pObserver );
-        }    
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
     }
     
-    void OnObserverDisconnect( SignalObserver* pObserver )
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7 )
     {
-        JL_SIGNAL_LOG( "Signal3 %p received disconnect message from observer %p\n", this, pObserver );
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2, p3, p4, p5, p6, p7 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        typename fastdelegate::ParamTraits< _P3 >::type p3;
+        typename fastdelegate::ParamTraits< _P4 >::type p4;
+        typename fastdelegate::ParamTraits< _P5 >::type p5;
+        typename fastdelegate::ParamTraits< _P6 >::type p6;
+        typename fastdelegate::ParamTraits< _P7 >::type p7;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        static void RunChunk( void* pContext, unsigned nChunk )
         {
-            if ( (*i).pObserver == pObserver )
-            {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
             {
-                ++i;
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2, e.p3, e.p4, e.p5, e.p6, e.p7 );
+                    ++nCalls;
+                }
             }
         }
-    }
-};
-
-#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
-
-/**
- * Signal<[3 arguments]>: wrapper class for Signal3
- * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
- */
-template< typename TUnused, typename _P1, typename _P2, typename _P3 >
-class Signal< TUnused(_P1, _P2, _P3) > : public Signal3< _P1, _P2, _P3 >
-{
-public:
-    typedef Signal3< _P1, _P2, _P3 > TParent;
-    Signal() {}
-    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
-    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
-};
-
-#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
-
-/**
- * Signal4: signals with 4 arguments
- */
-template< typename _P1, typename _P2, typename _P3, typename _P4 >
-class Signal4 : public SignalBase
-{
-public:
-    typedef fastdelegate::FastDelegate4< _P1, _P2, _P3, _P4 > Delegate;
+    };
     
-    struct Connection
+    // The start of every functor connection's block
+    struct FunctorSlot
     {
-        Delegate d;
-        SignalObserver* pObserver;
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
     };
     
-    typedef DoublyLinkedList<Connection> ConnectionList;
-    
-    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
-    
-private:
-    typedef typename ConnectionList::iterator ConnectionIter;
-    typedef typename ConnectionList::const_iterator ConnectionConstIter;
-    
-    ConnectionList m_oConnections;
-    
-public:
-    Signal4() { SetAllocator( s_pCommonAllocator ); }
-    Signal4( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
-    
-    virtual ~Signal4()
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
     {
-        JL_SIGNAL_LOG( "Destroying Signal4 %p\n", this );
-        DisconnectAll();
-    }
-    
-    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
+        unsigned nSerial; // see FunctorConnection
+    };
     
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4) )
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
     {
-        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal4 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
         
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-    }    
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7 ) { fFunctor( p1, p2, p3, p4, p5, p6, p7 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
     
-    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) )
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
     {
-        if ( ! pObject )
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal7 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
         {
-            return;
+            return FunctorConnection();
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal4 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
-    }
-    
-    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const )
-    {
-        if ( ! pObject )
+        
+        if ( ! bAdded )
         {
-            return;
+            ReleaseFunctor( c );
+            return FunctorConnection();
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal4 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
     }
     
-    // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4) ) const
-    {
-        return IsConnected( Delegate(fpFunction) );
-    }    
-    
-    // Returns true if the given observer and instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) ) const
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
     }
     
-    // Returns true if the given observer and const instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const ) const
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
     }
     
-    void Emit( _P1 p1, _P2 p2, _P3 p3, _P4 p4 ) const
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
         {
-            (*i).d( p1, p2, p3, p4 );
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
         }
-    }
-    
-    void operator()( _P1 p1, _P2 p2, _P3 p3, _P4 p4 ) const { Emit( p1, p2, p3, p4 ); } 
+    };
     
-    // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4) )
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
     {
-        JL_SIGNAL_LOG( "Signal4 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
-        const Delegate d(fpFunction);
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7 )
         {
-            if ( (*i).d == d )
+            if ( hObject.IsAlive() )
             {
-                JL_ASSERT( (*i).pObserver == NULL );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
+                ( pObject->*fpMethod )( p1, p2, p3, p4, p5, p6, p7 );
             }
             else
             {
-                ++i;
+                this->OnTargetDead();
             }
-        }         
-    }    
-
-    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) )
-    {
-        if ( ! pObject )
-        {
-            return;
         }
-        
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal4 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
-    }
+    };
     
-    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4) const )
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
     {
-        if ( ! pObject )
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
         {
             return;
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal4 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        JL_SIGNAL_LOG( "Signal7 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
     }
     
-    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
-    // if any disconnections are made.
-    void Disconnect( SignalObserver* pObserver )
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
     {
-        if ( ! pObserver )
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
         {
-            return;
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
         }
         
-        JL_SIGNAL_LOG( "Signal4 %p removing all connections to Observer %p\n", this, pObserver );
-        unsigned nDisconnections = 0;
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7 )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
             {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                ( spObject.get()->*fpMethod )( p1, p2, p3, p4, p5, p6, p7 );
             }
             else
             {
-                ++i;
+                this->OnTargetDead();
             }
         }
         
-        if ( nDisconnections > 0 )
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
         {
-            NotifyObserverDisconnect( pObserver );        
+            return;
         }
+        
+        JL_SIGNAL_LOG( "Signal7 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
     }
+#endif
     
-    void DisconnectAll()
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal4 %p disconnecting all observers\n", this );
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
         {
-            SignalObserver* pObserver = (*i).pObserver;
-            
-            //HACK - call this each time we encounter a valid observer pointer. This means
-            // this will be called repeatedly for observers that are connected multiple times
-            // to this signal.
-            if ( pObserver )
-            {
-                NotifyObserverDisconnect( pObserver );
-            }
+            return;
         }
         
-        m_oConnections.Clear();
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
     }
     
-private:
-    bool IsConnected( const Delegate& d ) const
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
         {
-            if ( (*i).d == d )
-            {
-                return true;
-            }
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal7* >( this )->PurgeDeadConnections();
         }
-        
-        return false;        
     }
     
-    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
-    // the observer is completely disconnected from this signal.
-    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    void PurgeDeadConnections()
     {
-        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
-        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        JL_SIGNAL_LOG( "Signal7 %p removing %u dead connections\n", this, m_nDeadConnections );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
         {
-            if ( (*i).d == d )
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
             {
-                JL_ASSERT( (*i).pObserver == pObserver );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
             }
             else
             {
-                if ( (*i).pObserver == pObserver )
-                {
-                    ++nObserverConnectionCount;
-                }
-
                 ++i;
             }
         }
         
-        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
-        {
-            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
-            NotifyObserverDisconnect( pObserver );
-        }    
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
     }
     
-    void OnObserverDisconnect( SignalObserver* pObserver )
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
     {
-        JL_SIGNAL_LOG( "Signal4 %p received disconnect message from observer %p\n", this, pObserver );
-        
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        bool operator()( const Connection& a, const Connection& b ) const
         {
-            if ( (*i).pObserver == pObserver )
-            {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
             {
-                ++i;
+                return bFirstA;
             }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
         }
-    }
-};
-
-#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
-
-/**
- * Signal<[4 arguments]>: wrapper class for Signal4
- * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
- */
-template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4 >
-class Signal< TUnused(_P1, _P2, _P3, _P4) > : public Signal4< _P1, _P2, _P3, _P4 >
-{
-public:
-    typedef Signal4< _P1, _P2, _P3, _P4 > TParent;
-    Signal() {}
-    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
-    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
-};
-
-#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
-
-/**
- * Signal5: signals with 5 arguments
- */
-template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5 >
-class Signal5 : public SignalBase
-{
-public:
-    typedef fastdelegate::FastDelegate5< _P1, _P2, _P3, _P4, _P5 > Delegate;
+    };
     
-    struct Connection
+    // Puts a connection ahead of every other one
+    struct FrontOrder
     {
-        Delegate d;
-        SignalObserver* pObserver;
+        bool operator()( const Connection&, const Connection& ) const { return true; }
     };
     
-    typedef DoublyLinkedList<Connection> ConnectionList;
-    
-    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
-    
-private:
-    typedef typename ConnectionList::iterator ConnectionIter;
-    typedef typename ConnectionList::const_iterator ConnectionConstIter;
-    
-    ConnectionList m_oConnections;
-    
-public:
-    Signal5() { SetAllocator( s_pCommonAllocator ); }
-    Signal5( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
-    
-    virtual ~Signal5()
+    bool AddConnection( const Connection& c )
     {
-        JL_SIGNAL_LOG( "Destroying Signal5 %p\n", this );
-        DisconnectAll();
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
     }
     
-    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
-    
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5) )
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
     {
-        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal5 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
-        
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-    }    
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
     
-    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) )
+    void RemoveConnection( ConnectionNode* pNode )
     {
-        if ( ! pObject )
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
         {
+            MarkRemoved( pNode->object );
             return;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal5 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
     }
     
-    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const )
+    void MarkRemoved( Connection& c )
     {
-        if ( ! pObject )
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
         {
-            return;
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal5 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
     }
     
-    // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5) ) const
-    {
-        return IsConnected( Delegate(fpFunction) );
-    }    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
     
-    // Returns true if the given observer and instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) ) const
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
     }
     
-    // Returns true if the given observer and const instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const ) const
+    static unsigned HashDelegate( const Delegate& d )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
     }
     
-    void Emit( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5 ) const
+    struct DelegateMatch
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            (*i).d( p1, p2, p3, p4, p5 );
-        }
-    }
-    
-    void operator()( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5 ) const { Emit( p1, p2, p3, p4, p5 ); } 
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
     
-    // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5) )
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
     {
-        JL_SIGNAL_LOG( "Signal5 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
-        const Delegate d(fpFunction);
+        const FunctorConnection* pConnection;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        bool operator()( const ConnectionNode& oNode ) const
         {
-            if ( (*i).d == d )
-            {
-                JL_ASSERT( (*i).pObserver == NULL );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
             {
-                ++i;
+                return false;
             }
-        }         
-    }    
-
-    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) )
-    {
-        if ( ! pObject )
-        {
-            return;
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
         }
-        
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal5 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
     }
     
-    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5) const )
+    bool IsIndexedDuplicate( const Delegate& d ) const
     {
-        if ( ! pObject )
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
         {
-            return;
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal5 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        return false;
     }
     
-    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
-    // if any disconnections are made.
-    void Disconnect( SignalObserver* pObserver )
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        if ( ! pObserver )
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
         {
-            return;
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
         }
         
-        JL_SIGNAL_LOG( "Signal5 %p removing all connections to Observer %p\n", this, pObserver );
-        unsigned nDisconnections = 0;
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        while ( nConnected < nCount )
         {
-            if ( (*i).pObserver == pObserver )
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
             {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                break;
             }
-            else
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
             {
-                ++i;
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal7 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
+            }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
             }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
         }
         
-        if ( nDisconnections > 0 )
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
         {
-            NotifyObserverDisconnect( pObserver );        
+            m_oConnections.Sort( GroupedOrder() );
         }
+        
+        return nConnected - nDuplicates;
     }
     
-    void DisconnectAll()
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal5 %p disconnecting all observers\n", this );
+        unsigned nConnected = 0;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        for ( unsigned i = 0; i < nCount; ++i )
         {
-            SignalObserver* pObserver = (*i).pObserver;
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal7 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
             
-            //HACK - call this each time we encounter a valid observer pointer. This means
-            // this will be called repeatedly for observers that are connected multiple times
-            // to this signal.
-            if ( pObserver )
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
             {
-                NotifyObserverDisconnect( pObserver );
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
             }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
         }
         
-        m_oConnections.Clear();
+        return nConnected;
     }
     
-private:
     bool IsConnected( const Delegate& d ) const
     {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
         for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
         {
-            if ( (*i).d == d )
+            if ( (*i).d == d && ! IsRemoved(*i) )
             {
                 return true;
             }
@@ -1788,13 +10872,35 @@ private:
         unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
         unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
         
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).d == d )
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
             {
                 JL_ASSERT( (*i).pObserver == pObserver );
                 JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
+                RemoveConnection( i ); // advances iterator
                 ++nDisconnections;
             }
             else
@@ -1817,14 +10923,32 @@ private:
     
     void OnObserverDisconnect( SignalObserver* pObserver )
     {
-        JL_SIGNAL_LOG( "Signal5 %p received disconnect message from observer %p\n", this, pObserver );
+        JL_SIGNAL_LOG( "Signal7 %p received disconnect message from observer %p\n", this, pObserver );
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
             {
                 JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal7 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
             }
             else
             {
@@ -1837,14 +10961,14 @@ private:
 #ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
 
 /**
- * Signal<[5 arguments]>: wrapper class for Signal5
+ * Signal<[7 arguments]>: wrapper class for Signal7
  * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
  */
-template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4, typename _P5 >
-class Signal< TUnused(_P1, _P2, _P3, _P4, _P5) > : public Signal5< _P1, _P2, _P3, _P4, _P5 >
+template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6, typename _P7 >
+class Signal< TUnused(_P1, _P2, _P3, _P4, _P5, _P6, _P7) > : public Signal7< _P1, _P2, _P3, _P4, _P5, _P6, _P7 >
 {
 public:
-    typedef Signal5< _P1, _P2, _P3, _P4, _P5 > TParent;
+    typedef Signal7< _P1, _P2, _P3, _P4, _P5, _P6, _P7 > TParent;
     Signal() {}
     Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
     void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
@@ -1853,57 +10977,177 @@ public:
 #endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
 
 /**
- * Signal6: signals with 6 arguments
+ * Signal8: signals with 8 arguments
  */
-template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6 >
-class Signal6 : public SignalBase
+template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6, typename _P7, typename _P8 >
+class Signal8 : public SignalBase
 {
 public:
-    typedef fastdelegate::FastDelegate6< _P1, _P2, _P3, _P4, _P5, _P6 > Delegate;
+    typedef fastdelegate::FastDelegate8< _P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8 > Delegate;
     
     struct Connection
     {
         Delegate d;
         SignalObserver* pObserver;
+        unsigned nFlags; // SignalBase::ConnectionFlags
     };
     
     typedef DoublyLinkedList<Connection> ConnectionList;
     
     enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
     
+    // See SetConnectionIndex()
+    typedef typename ConnectionList::Node* ConnectionIndexSlot;
+    
+    // The parameter types of Emit(), for wrappers like ShardedSignal. Parameters past this
+    // signal's arity are SignalNoParam.
+    typedef typename fastdelegate::ParamTraits< _P1 >::type EmitParam1;
+    typedef typename fastdelegate::ParamTraits< _P2 >::type EmitParam2;
+    typedef typename fastdelegate::ParamTraits< _P3 >::type EmitParam3;
+    typedef typename fastdelegate::ParamTraits< _P4 >::type EmitParam4;
+    typedef typename fastdelegate::ParamTraits< _P5 >::type EmitParam5;
+    typedef typename fastdelegate::ParamTraits< _P6 >::type EmitParam6;
+    typedef typename fastdelegate::ParamTraits< _P7 >::type EmitParam7;
+    typedef typename fastdelegate::ParamTraits< _P8 >::type EmitParam8;
+    
 private:
     typedef typename ConnectionList::iterator ConnectionIter;
     typedef typename ConnectionList::const_iterator ConnectionConstIter;
+    typedef typename ConnectionList::Node ConnectionNode;
+    
+    // Indexes connections by their delegates
+    struct ConnectionHash
+    {
+        unsigned operator()( const ConnectionNode& oNode ) const { return HashDelegate( oNode.object.d ); }
+    };
+    
+    typedef HashIndex< ConnectionNode, ConnectionHash > ConnectionIndex;
+    
+    // Repoints the index at connection nodes moved by CompactConnections()
+    struct IndexMover
+    {
+        ConnectionIndex* pIndex;
+        void operator()( ConnectionNode* pOldNode, ConnectionNode* pNewNode ) const { pIndex->Replace( pOldNode, pNewNode ); }
+    };
     
     ConnectionList m_oConnections;
+    ConnectionIndex m_oIndex;
+    mutable unsigned m_nEmissions;
+    mutable unsigned m_nEmitDepth; // number of Emit() calls of this signal in progress
+    mutable unsigned m_nDeadConnections; // connections to unlink when the outermost Emit() returns
+    unsigned m_nRemovedConnections; // the dead connections that were removed, rather than found dead
+    unsigned m_nFunctorSerial; // serial number of the last functor connection
+    mutable bool m_bConsumed; // set by Consume() during the innermost Emit()
+    bool m_bGroupedDispatch;
+    
+    // The target side of Forward() links. Each link into this signal is a connection to this
+    // observer, so the observer bookkeeping removes the link when either signal is destroyed.
+    class ForwardingLink : public SignalObserver
+    {
+    public:
+        ForwardingLink() : pSignal(NULL) {}
+        
+        // Names the link in the source's delegate, for IsForwarding() and the connection
+        // index. Emit() calls pSignal directly instead of going through it.
+        void Call( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7, _P8 p8 ) const { pSignal->Emit( p1, p2, p3, p4, p5, p6, p7, p8 ); }
+        
+        const Signal8* pSignal;
+    };
+    
+    ForwardingLink m_oForwardingLink;
     
 public:
-    Signal6() { SetAllocator( s_pCommonAllocator ); }
-    Signal6( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
+    Signal8() : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( s_pCommonAllocator ); m_oForwardingLink.pSignal = this; }
+    Signal8( ScopedAllocator* pAllocator ) : m_nEmissions(0), m_nEmitDepth(0), m_nDeadConnections(0), m_nRemovedConnections(0), m_nFunctorSerial(0), m_bConsumed(false), m_bGroupedDispatch(false) { SetAllocator( pAllocator ); m_oForwardingLink.pSignal = this; }
     
-    virtual ~Signal6()
+    virtual ~Signal8()
     {
-        JL_SIGNAL_LOG( "Destroying Signal6 %p\n", this );
-        DisconnectAll();
+        JL_SIGNAL_LOG( "Destroying Signal8 %p\n", this );
+        
+        // If our connections are being released in bulk, so is everything connected to us
+        if ( ! m_oConnections.IsAllocatorReleasingAll() )
+        {
+            DisconnectAll();
+        }
     }
     
     void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
+    unsigned CountConnections() const { return m_oConnections.Count() - m_nRemovedConnections; }
+    
+    // Moves connection nodes to lower addresses, in emission order. See
+    // DoublyLinkedList::Compact(). Must not be called during an Emit() of this signal.
+    // Keeps the connection index, if there is one, pointing at the moved nodes.
+    bool CompactConnections( unsigned nMaxNodes = 0 )
+    {
+        JL_ASSERT( m_nEmitDepth == 0 );
+        
+        const IndexMover fnMoved = { & m_oIndex };
+        return m_oConnections.Compact( nMaxNodes, fnMoved );
+    }
+    
+    // Keeps a hash index of the connections in pSlots, so that IsConnected(), and Disconnect()
+    // of a function or an observer's method, take O(1) instead of a pass over every connection.
+    // While a signal has an index, connecting a function or method that is already connected
+    // does nothing, even without JL_SIGNAL_ASSERT_ON_DOUBLE_CONNECT.
+    //
+    // nSlotCount must be a power of two, and should be at least a third larger than the most
+    // connections the signal will have. If the index fills up, the signal asserts and goes back
+    // to passes over its connections. The slots must outlive the index. Pass NULL to drop the
+    // index. O(N), and must not be called during an Emit() of this signal.
+    void SetConnectionIndex( ConnectionIndexSlot* pSlots, unsigned nSlotCount )
+    {
+        m_oIndex.Init( pSlots, nSlotCount );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_oIndex.IsInitialized(); ++i )
+        {
+            IndexConnection( i.GetNode() );
+        }
+    }
+    
+    bool HasConnectionIndex() const { return m_oIndex.IsInitialized(); }
+    
+    // Connections are normally called in the order they were made, except that connections
+    // made with eConnectionFlag_First come before the others. With grouped dispatch, they
+    // are kept sorted by the function they call, and by object address for each function,
+    // so Emit() makes runs of calls to the same function. This helps the CPU predict the
+    // calls when many objects of a few classes are connected. Connections made with
+    // eConnectionFlag_First are still called first, in the same sorted order. Connecting
+    // costs O(N) while grouped dispatch is on. Must not be changed during an Emit().
+    void SetGroupedDispatch( bool bGrouped )
+    {
+        m_bGroupedDispatch = bGrouped;
+        
+        if ( bGrouped )
+        {
+            m_oConnections.Sort( GroupedOrder() );
+        }
+    }
+    
+    bool IsGroupedDispatch() const { return m_bGroupedDispatch; }
+    
+    // Number of times Emit() has been called. Wraps around on overflow.
+    unsigned CountEmissions() const { return m_nEmissions; }
     
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6) )
+    // Connects non-instance functions. See SignalBase::ConnectionFlags for nFlags.
+    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8), unsigned nFlags = 0 )
     {
         JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal6 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        JL_SIGNAL_LOG( "Signal8 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        
+        Connection c = { Delegate(fpFunction), NULL, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
         
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
     }    
     
     // Connects instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) )
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8), unsigned nFlags = 0 )
     {
         if ( ! pObject )
         {
@@ -1912,17 +11156,23 @@ public:
         
         JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal6 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        JL_SIGNAL_LOG( "Signal8 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
         NotifyObserverConnect( pObserver );
     }
     
     // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const )
+    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const, unsigned nFlags = 0 )
     {
         if ( ! pObject )
         {
@@ -1931,57 +11181,344 @@ public:
         
         JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal6 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        JL_SIGNAL_LOG( "Signal8 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        
+        Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+        
+        if ( IsIndexedDuplicate(c.d) )
+        {
+            return;
+        }
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
         NotifyObserverConnect( pObserver );
     }
     
+    // Connects a function object or lambda, e.g.:
+    //
+    //   oSignal.Connect( [pScore]( int nPoints ) { *pScore += nPoints; } );
+    //
+    // The functor is copied into a block from the signal's connection allocator, so it must
+    // fit in eAllocationSize bytes along with a destructor pointer, and the connection takes
+    // two allocations instead of one. The copy is destroyed when the connection is removed:
+    // by Disconnect() with the returned FunctorConnection, by DisconnectAll(), or, if an
+    // observer is given, with the observer's other connections, e.g. when the observer is
+    // destroyed. If that happens during an Emit() of this signal, the copy lives until the
+    // outermost Emit() returns, so a functor may disconnect itself and keep using its state.
+    template< class F >
+    FunctorConnection Connect( const F& fFunctor, unsigned nFlags = 0 )
+    {
+        return ConnectFunctor( NULL, fFunctor, nFlags );
+    }
+    
+    template< class F >
+    FunctorConnection Connect( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags = 0 )
+    {
+        if ( ! pObserver )
+        {
+            return FunctorConnection();
+        }
+        
+        return ConnectFunctor( pObserver, fFunctor, nFlags );
+    }
+    
+    // Connects an instance method of an object that doesn't derive from SignalObserver. Before
+    // each call, the signal checks hObject, e.g. the handle of a WeakHandleOwner member of the
+    // object, and skips the call once the handle is dead. Connections to dead objects are
+    // removed when the outermost Emit() of the signal returns. Otherwise, only DisconnectAll()
+    // removes them. Like a functor connection, this takes two allocations. Weak connections
+    // can't be parallel-safe.
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8), unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const WeakHandle& hObject, Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const, unsigned nFlags = 0 )
+    {
+        ConnectHandleSlot( hObject, pObject, fpMethod, nFlags );
+    }
+    
+#if __cplusplus >= 201103L
+    // The same, for an object owned by std::shared_ptr. The signal keeps a std::weak_ptr, and
+    // holds a reference to the object for the duration of each call. If the signal's allocator
+    // is released in bulk (see ScopedAllocator::IsReleasingAll()), the weak_ptr is never
+    // destroyed, and the object's control block leaks.
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8), unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    void ConnectWeak( const std::shared_ptr<Y>& spObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const, unsigned nFlags = 0 )
+    {
+        ConnectWeakPtrSlot( spObject, fpMethod, nFlags );
+    }
+#endif
+    
+    // Connects the same method of every object in an array, e.g. every entity in a level.
+    // Equivalent to calling Connect() for each object, but grouped dispatch sorts once at the
+    // end, and the nodes for both sides of the connections are allocated in batches when that
+    // pays off, i.e. with grouped dispatch or an address-ordered connection pool.
+    // Returns the number of objects connected, which is less than nCount only if the
+    // signal's allocator runs out, or if the signal has a connection index and some of the
+    // objects were already connected. eConnectionFlag_First isn't supported.
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8), unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    template< class X, class Y >
+    unsigned ConnectMany( Y* pObjects, unsigned nCount, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const, unsigned nFlags = 0 )
+    {
+        return ConnectManyMethods( pObjects, nCount, fpMethod, nFlags );
+    }
+    
+    // Calls pTarget->Emit() with the arguments of every emission of this signal. The link is a
+    // connection that Emit() recognizes, and it calls pTarget->Emit() directly rather than
+    // through a delegate. The link is removed when either signal is destroyed. Links are always
+    // called serially, so eConnectionFlag_ParallelSafe is ignored. Don't create forwarding cycles.
+    void Forward( Signal8* pTarget, unsigned nFlags = 0 )
+    {
+        JL_ASSERT( pTarget != this );
+        if ( pTarget == this )
+        {
+            return;
+        }
+        
+        Connect( & pTarget->m_oForwardingLink, & ForwardingLink::Call, ( nFlags & ~eConnectionFlag_ParallelSafe ) | eConnectionFlag_Forward );
+    }
+    
+    void StopForwarding( Signal8* pTarget )
+    {
+        Disconnect( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    bool IsForwarding( Signal8* pTarget ) const
+    {
+        return IsConnected( & pTarget->m_oForwardingLink, & ForwardingLink::Call );
+    }
+    
+    // Number of Forward() links into this signal
+    unsigned CountForwardingSignals() const { return m_oForwardingLink.CountSignalConnections(); }
+    
     // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6) ) const
+    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) ) const
     {
         return IsConnected( Delegate(fpFunction) );
     }    
     
     // Returns true if the given observer and instance method are connected to this signal.
     template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) ) const
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) ) const
     {
         return IsConnected( Delegate(pObject, fpMethod) );
     }
     
     // Returns true if the given observer and const instance method are connected to this signal.
     template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const ) const
+    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const ) const
     {
         return IsConnected( Delegate(pObject, fpMethod) );
     }
     
-    void Emit( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6 ) const
+    // Arguments of types that opt in with FASTDELEGATE_PASS_BY_REFERENCE() are passed by
+    // const reference all the way to the slots, whatever the signal's declared parameter
+    // types. See fastdelegate::ParamTraits.
+    void Emit( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7, typename fastdelegate::ParamTraits< _P8 >::type p8 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // Slots may call Consume(), which Emit() ignores, even when nested in an
+        // EmitUntilConsumed() of this signal
+        const bool bOuterConsumed = m_bConsumed;
+        
+        // Slots may disconnect any connection, including their own: removed connections
+        // stay in the list until EndEmit()
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6, p7, p8 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6, p7, p8 );
+            }
+        }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+    }
+    
+    void operator()( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7, typename fastdelegate::ParamTraits< _P8 >::type p8 ) const { Emit( p1, p2, p3, p4, p5, p6, p7, p8 ); } 
+    
+    // Calls connected functions in order, like Emit(), but stops as soon as one of them calls
+    // Consume(), e.g. for input events that only one handler should see. Returns true if the
+    // emission was consumed.
+    bool EmitUntilConsumed( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7, typename fastdelegate::ParamTraits< _P8 >::type p8 ) const
+    {
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        // A nested emission of this signal has its own consumed state
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid() && ! m_bConsumed; ++i )
+        {
+            if ( ! ((*i).nFlags & (eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6, p7, p8 );
+            }
+            else if ( ! ((*i).nFlags & eConnectionFlag_Removed) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6, p7, p8 );
+            }
+        }
+        
+        const bool bConsumed = m_bConsumed;
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
+        
+        return bConsumed;
+    }
+    
+    // Called by a connected function to stop the EmitUntilConsumed() that called it. Has no
+    // effect on Emit(), or outside of an emission. Not thread-safe, so functions connected
+    // with eConnectionFlag_ParallelSafe must not call it.
+    void Consume() const
+    {
+        JL_ASSERT( m_nEmitDepth > 0 );
+        m_bConsumed = true;
+    }
+    
+    // A copy of one emission's arguments, for delivering it again after Emit() has returned.
+    // Reference arguments are copied by value.
+    struct Arguments
+    {
+        enum { eCount = 8 };
+        
+        Arguments() {}
+        Arguments( typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7, typename fastdelegate::ParamTraits< _P8 >::type p8 ) : a1(p1), a2(p2), a3(p3), a4(p4), a5(p5), a6(p6), a7(p7), a8(p8) {}
+        
+        typename SignalArgumentStorage< _P1 >::Type a1;
+        typename SignalArgumentStorage< _P2 >::Type a2;
+        typename SignalArgumentStorage< _P3 >::Type a3;
+        typename SignalArgumentStorage< _P4 >::Type a4;
+        typename SignalArgumentStorage< _P5 >::Type a5;
+        typename SignalArgumentStorage< _P6 >::Type a6;
+        typename SignalArgumentStorage< _P7 >::Type a7;
+        typename SignalArgumentStorage< _P8 >::Type a8;
+        
+        void EmitTo( const Signal8& oSignal ) const { oSignal.Emit( a1, a2, a3, a4, a5, a6, a7, a8 ); }
+    };
+    
+    // Calls every connected function. Functions connected with eConnectionFlag_ParallelSafe are
+    // spread across the scheduler's threads first, then the remaining functions are called in
+    // connection order on the calling thread. Returns once every call has finished. Nothing may
+    // connect to or disconnect from this signal until the parallel calls are done, and the
+    // parallel-safe functions must not call Consume(). Like Emit(), it ignores Consume().
+    void EmitParallel( TaskScheduler* pScheduler, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7, typename fastdelegate::ParamTraits< _P8 >::type p8 ) const
     {
+        JL_ASSERT( pScheduler );
+        ++m_nEmissions;
+        ++m_nEmitDepth;
+        
+        const bool bOuterConsumed = m_bConsumed;
+        m_bConsumed = false;
+        
+        unsigned nParallel = 0;
+        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        {
+            if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+            {
+                ++nParallel;
+            }
+        }
+        
+        if ( nParallel > 0 )
+        {
+            // Split the parallel-safe connections into contiguous chunks, one task each
+            ConnectionConstIter pChunkStarts[ TaskScheduler::eMaxTasks ];
+            const unsigned nChunkSize = ( nParallel + TaskScheduler::eMaxTasks - 1 ) / TaskScheduler::eMaxTasks;
+            unsigned nChunks = 0;
+            unsigned nChunkCount = 0;
+            
+            for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+            {
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    if ( nChunkCount == 0 )
+                    {
+                        pChunkStarts[nChunks++] = i;
+                    }
+                    
+                    nChunkCount = ( nChunkCount + 1 ) % nChunkSize;
+                }
+            }
+            
+            ParallelEmission oEmission = { pChunkStarts, nChunkSize, p1, p2, p3, p4, p5, p6, p7, p8 };
+            pScheduler->Run( & ParallelEmission::RunChunk, & oEmission, nChunks );
+            
+            // Consume() from a worker thread would be a data race
+            JL_ASSERT( ! m_bConsumed );
+        }
+        
+        // Removed connections and Forward() links are never parallel-safe
         for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
         {
-            (*i).d( p1, p2, p3, p4, p5, p6 );
+            if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed | eConnectionFlag_Forward)) )
+            {
+                (*i).d( p1, p2, p3, p4, p5, p6, p7, p8 );
+            }
+            else if ( ! ((*i).nFlags & (eConnectionFlag_ParallelSafe | eConnectionFlag_Removed)) )
+            {
+                EmitForwarded( *i, p1, p2, p3, p4, p5, p6, p7, p8 );
+            }
         }
+        
+        m_bConsumed = bOuterConsumed;
+        EndEmit();
     }
     
-    void operator()( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6 ) const { Emit( p1, p2, p3, p4, p5, p6 ); } 
+#if JL_SIGNAL_ENABLE_COROUTINES
+    // Suspends a coroutine until the next Emit(). See SignalAwaiter.
+    SignalAwaiter< Signal8, _P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8 > Next()
+    {
+        return SignalAwaiter< Signal8, _P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8 >( this );
+    }
+#endif
     
     // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6) )
+    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) )
     {
-        JL_SIGNAL_LOG( "Signal6 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
+        JL_SIGNAL_LOG( "Signal8 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
         const Delegate d(fpFunction);
         
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == NULL );
+                RemoveConnection( pNode );
+            }
+            
+            return;
+        }
+        
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).d == d )
+            if ( (*i).d == d && ! IsRemoved(*i) )
             {
                 JL_ASSERT( (*i).pObserver == NULL );
                 JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
+                RemoveConnection( i );
             }
             else
             {
@@ -1992,7 +11529,7 @@ public:
 
     // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) )
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) )
     {
         if ( ! pObject )
         {
@@ -2000,22 +11537,64 @@ public:
         }
         
         SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal6 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
+        JL_SIGNAL_LOG( "Signal8 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
         DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
     }
     
     // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
     template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6) const )
+    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const )
     {
         if ( ! pObject )
         {
-            return;
+            return;
+        }
+        
+        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+        JL_SIGNAL_LOG( "Signal8 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    }
+    
+    // Disconnects a functor returned by Connect(). Returns false if the connection was already
+    // removed. O(1) with a connection index, otherwise a pass over the connections.
+    bool Disconnect( const FunctorConnection& oConnection )
+    {
+        if ( ! oConnection.IsValid() )
+        {
+            return false;
+        }
+        
+        JL_SIGNAL_LOG( "Signal8 %p removing functor connection %p\n", this, oConnection.GetSlot() );
+        
+        const FunctorMatch oMatch = { & oConnection };
+        ConnectionNode* pNode = NULL;
+        
+        if ( m_oIndex.IsInitialized() )
+        {
+            pNode = m_oIndex.Find( oConnection.GetHash(), oMatch );
+        }
+        else
+        {
+            for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && ! pNode; ++i )
+            {
+                pNode = oMatch( *i.GetNode() ) ? i.GetNode() : NULL;
+            }
+        }
+        
+        if ( ! pNode )
+        {
+            return false;
+        }
+        
+        SignalObserver* pObserver = pNode->object.pObserver;
+        RemoveConnection( pNode );
+        
+        if ( pObserver )
+        {
+            NotifyObserverDisconnect( pObserver, 1 );
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal6 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        return true;
     }
     
     // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
@@ -2027,15 +11606,15 @@ public:
             return;
         }
         
-        JL_SIGNAL_LOG( "Signal6 %p removing all connections to Observer %p\n", this, pObserver );
+        JL_SIGNAL_LOG( "Signal8 %p removing all connections to Observer %p\n", this, pObserver );
         unsigned nDisconnections = 0;
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
             {
                 JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
+                RemoveConnection( i ); // advances iterator
                 ++nDisconnections;
             }
             else
@@ -2052,10 +11631,15 @@ public:
     
     void DisconnectAll()
     {
-        JL_SIGNAL_LOG( "Signal6 %p disconnecting all observers\n", this );
+        JL_SIGNAL_LOG( "Signal8 %p disconnecting all observers\n", this );
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
         {
+            if ( IsRemoved(*i) )
+            {
+                continue;
+            }
+            
             SignalObserver* pObserver = (*i).pObserver;
             
             //HACK - call this each time we encounter a valid observer pointer. This means
@@ -2065,623 +11649,591 @@ public:
             {
                 NotifyObserverDisconnect( pObserver );
             }
-        }
-        
-        m_oConnections.Clear();
-    }
-    
-private:
-    bool IsConnected( const Delegate& d ) const
-    {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            if ( (*i).d == d )
-            {
-                return true;
-            }
-        }
-        
-        return false;        
-    }
-    
-    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
-    // the observer is completely disconnected from this signal.
-    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
-    {
-        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
-        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
-        
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
-        {
-            if ( (*i).d == d )
+            
+            if ( m_nEmitDepth > 0 )
             {
-                JL_ASSERT( (*i).pObserver == pObserver );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                MarkRemoved( *i );
             }
             else
             {
-                if ( (*i).pObserver == pObserver )
-                {
-                    ++nObserverConnectionCount;
-                }
-
-                ++i;
+                ReleaseFunctor( *i );
             }
         }
         
-        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
+        m_oIndex.Clear();
+        
+        // During an Emit(), the connections are unlinked by EndEmit()
+        if ( m_nEmitDepth == 0 )
         {
-            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
-            NotifyObserverDisconnect( pObserver );
-        }    
+            m_oConnections.Clear();
+            m_nDeadConnections = 0;
+        }
     }
     
-    void OnObserverDisconnect( SignalObserver* pObserver )
+private:
+    // Calls the target of a Forward() link
+    static void EmitForwarded( const Connection& c, typename fastdelegate::ParamTraits< _P1 >::type p1, typename fastdelegate::ParamTraits< _P2 >::type p2, typename fastdelegate::ParamTraits< _P3 >::type p3, typename fastdelegate::ParamTraits< _P4 >::type p4, typename fastdelegate::ParamTraits< _P5 >::type p5, typename fastdelegate::ParamTraits< _P6 >::type p6, typename fastdelegate::ParamTraits< _P7 >::type p7, typename fastdelegate::ParamTraits< _P8 >::type p8 )
     {
-        JL_SIGNAL_LOG( "Signal6 %p received disconnect message from observer %p\n", this, pObserver );
-        
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        static_cast<const ForwardingLink*>( c.pObserver )->pSignal->Emit( p1, p2, p3, p4, p5, p6, p7, p8 );
+    }
+    
+    // Arguments and partitioning for a single EmitParallel() call
+    struct ParallelEmission
+    {
+        const ConnectionConstIter* pChunkStarts;
+        unsigned nChunkSize;
+        typename fastdelegate::ParamTraits< _P1 >::type p1;
+        typename fastdelegate::ParamTraits< _P2 >::type p2;
+        typename fastdelegate::ParamTraits< _P3 >::type p3;
+        typename fastdelegate::ParamTraits< _P4 >::type p4;
+        typename fastdelegate::ParamTraits< _P5 >::type p5;
+        typename fastdelegate::ParamTraits< _P6 >::type p6;
+        typename fastdelegate::ParamTraits< _P7 >::type p7;
+        typename fastdelegate::ParamTraits< _P8 >::type p8;
+        
+        static void RunChunk( void* pContext, unsigned nChunk )
         {
-            if ( (*i).pObserver == pObserver )
-            {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const ParallelEmission& e = *static_cast<const ParallelEmission*>( pContext );
+            unsigned nCalls = 0;
+            
+            for ( ConnectionConstIter i = e.pChunkStarts[nChunk]; i.isValid() && nCalls < e.nChunkSize; ++i )
             {
-                ++i;
+                if ( (*i).nFlags & eConnectionFlag_ParallelSafe )
+                {
+                    (*i).d( e.p1, e.p2, e.p3, e.p4, e.p5, e.p6, e.p7, e.p8 );
+                    ++nCalls;
+                }
             }
         }
-    }
-};
-
-#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
-
-/**
- * Signal<[6 arguments]>: wrapper class for Signal6
- * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
- */
-template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6 >
-class Signal< TUnused(_P1, _P2, _P3, _P4, _P5, _P6) > : public Signal6< _P1, _P2, _P3, _P4, _P5, _P6 >
-{
-public:
-    typedef Signal6< _P1, _P2, _P3, _P4, _P5, _P6 > TParent;
-    Signal() {}
-    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
-    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
-};
-
-#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
-
-/**
- * Signal7: signals with 7 arguments
- */
-template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6, typename _P7 >
-class Signal7 : public SignalBase
-{
-public:
-    typedef fastdelegate::FastDelegate7< _P1, _P2, _P3, _P4, _P5, _P6, _P7 > Delegate;
+    };
     
-    struct Connection
+    // The start of every functor connection's block
+    struct FunctorSlot
     {
-        Delegate d;
-        SignalObserver* pObserver;
+        void (*fpDestroy)( FunctorSlot* pSlot ); // NULL if there is nothing to destroy
     };
     
-    typedef DoublyLinkedList<Connection> ConnectionList;
-    
-    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
-    
-private:
-    typedef typename ConnectionList::iterator ConnectionIter;
-    typedef typename ConnectionList::const_iterator ConnectionConstIter;
-    
-    ConnectionList m_oConnections;
-    
-public:
-    Signal7() { SetAllocator( s_pCommonAllocator ); }
-    Signal7( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
-    
-    virtual ~Signal7()
+    // The start of every block that a FunctorConnection can refer to
+    struct SerialSlot : public FunctorSlot
     {
-        JL_SIGNAL_LOG( "Destroying Signal7 %p\n", this );
-        DisconnectAll();
-    }
-    
-    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
+        unsigned nSerial; // see FunctorConnection
+    };
     
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) )
+    // Delegates to a functor point at one of these, which holds the functor's copy
+    template< class F >
+    struct FunctorCopy : public SerialSlot
     {
-        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal7 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
+        FunctorCopy( const F& fFunctor ) : fFunctor(fFunctor) { this->fpDestroy = & Destroy; }
         
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-    }    
+        F fFunctor;
+        
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7, _P8 p8 ) { fFunctor( p1, p2, p3, p4, p5, p6, p7, p8 ); }
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<FunctorCopy*>( pSlot )->~FunctorCopy(); }
+    };
     
-    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) )
+    template< class F >
+    FunctorConnection ConnectFunctor( SignalObserver* pObserver, const F& fFunctor, unsigned nFlags )
     {
-        if ( ! pObject )
+        JL_COMPILER_ASSERT( sizeof(FunctorCopy<F>) <= eAllocationSize, Functor_Must_Fit_In_A_Connection_Allocation );
+        JL_SIGNAL_LOG( "Signal8 %p connecting to functor (observer %p)\n", this, pObserver );
+        
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
         {
-            return;
+            return FunctorConnection();
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal7 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        FunctorCopy<F>* pCopy = new ( pBlock ) FunctorCopy<F>( fFunctor );
+        pCopy->nSerial = ++m_nFunctorSerial;
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
+        Connection c = { Delegate(pCopy, & FunctorCopy<F>::Invoke), pObserver, nFlags | eConnectionFlag_Functor };
+        const bool bAdded = AddConnection( c );
         JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
-    }
-    
-    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const )
-    {
-        if ( ! pObject )
+        
+        if ( ! bAdded )
         {
-            return;
+            ReleaseFunctor( c );
+            return FunctorConnection();
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal7 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+        if ( pObserver )
+        {
+            NotifyObserverConnect( pObserver );
+        }
         
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        return FunctorConnection( pBlock, pCopy->nSerial, HashDelegate(c.d) );
     }
     
-    // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) ) const
-    {
-        return IsConnected( Delegate(fpFunction) );
-    }    
-    
-    // Returns true if the given observer and instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) ) const
+    // Destroys and frees the functor copy of a connection that is about to be removed, if it
+    // has one
+    void ReleaseFunctor( const Connection& c )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        if ( c.nFlags & eConnectionFlag_Functor )
+        {
+            FunctorSlot* pSlot = static_cast<FunctorSlot*>( GetFunctorBlock(c) );
+            
+            if ( pSlot->fpDestroy )
+            {
+                pSlot->fpDestroy( pSlot );
+            }
+            
+            m_oConnections.GetAllocator()->Free( pSlot );
+        }
     }
     
-    // Returns true if the given observer and const instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const ) const
+    // The block that a functor connection's delegate points at
+    static void* GetFunctorBlock( const Connection& c )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        // The memento's object pointer is only visible to derived classes
+        struct Memento : public fastdelegate::DelegateMemento
+        {
+            Memento( const fastdelegate::DelegateMemento& m ) : fastdelegate::DelegateMemento( m ) {}
+            void* GetThis() const { return m_pthis; }
+        };
+        
+        Delegate d = c.d; // GetMemento() isn't const
+        return Memento( d.GetMemento() ).GetThis();
     }
     
-    void Emit( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7 ) const
+    // The start of every weak connection's block
+    struct WeakSlot : public FunctorSlot
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
+        unsigned* pDeadCount; // the signal's m_nDeadConnections, or NULL once the target was found dead
+        
+        void OnTargetDead()
         {
-            (*i).d( p1, p2, p3, p4, p5, p6, p7 );
+            if ( pDeadCount )
+            {
+                *pDeadCount += 1;
+                pDeadCount = NULL;
+            }
         }
-    }
-    
-    void operator()( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7 ) const { Emit( p1, p2, p3, p4, p5, p6, p7 ); } 
+    };
     
-    // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) )
+    template< class Y, typename TMethod >
+    struct HandleSlot : public WeakSlot
     {
-        JL_SIGNAL_LOG( "Signal7 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
-        const Delegate d(fpFunction);
+        WeakHandle hObject;
+        Y* pObject;
+        TMethod fpMethod;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7, _P8 p8 )
         {
-            if ( (*i).d == d )
+            if ( hObject.IsAlive() )
             {
-                JL_ASSERT( (*i).pObserver == NULL );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
+                ( pObject->*fpMethod )( p1, p2, p3, p4, p5, p6, p7, p8 );
             }
             else
             {
-                ++i;
+                this->OnTargetDead();
             }
-        }         
-    }    
-
-    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) )
-    {
-        if ( ! pObject )
-        {
-            return;
         }
-        
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal7 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
-    }
+    };
     
-    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7) const )
+    template< class Y, typename TMethod >
+    void ConnectHandleSlot( const WeakHandle& hObject, Y* pObject, TMethod fpMethod, unsigned nFlags )
     {
-        if ( ! pObject )
+        JL_ASSERT( hObject.IsValid() && pObject );
+        if ( ! hObject.IsValid() || ! pObject )
         {
             return;
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal7 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        JL_SIGNAL_LOG( "Signal8 %p connecting weakly to object %p (method %p)\n", this, pObject, BruteForceCast<void*>(fpMethod) );
+        HandleSlot<Y, TMethod> oSlot;
+        oSlot.pDeadCount = NULL;
+        oSlot.fpDestroy = NULL;
+        oSlot.hObject = hObject;
+        oSlot.pObject = pObject;
+        oSlot.fpMethod = fpMethod;
+        ConnectWeakSlot( oSlot, nFlags );
     }
     
-    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
-    // if any disconnections are made.
-    void Disconnect( SignalObserver* pObserver )
+#if __cplusplus >= 201103L
+    template< class Y, typename TMethod >
+    struct WeakPtrSlot : public WeakSlot
     {
-        if ( ! pObserver )
+        WeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod ) : wpObject(spObject), fpMethod(fpMethod)
         {
-            return;
+            this->pDeadCount = NULL;
+            this->fpDestroy = & Destroy;
         }
         
-        JL_SIGNAL_LOG( "Signal7 %p removing all connections to Observer %p\n", this, pObserver );
-        unsigned nDisconnections = 0;
+        std::weak_ptr<Y> wpObject;
+        TMethod fpMethod;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        void Invoke( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7, _P8 p8 )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( const std::shared_ptr<Y> spObject = wpObject.lock() )
             {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                ( spObject.get()->*fpMethod )( p1, p2, p3, p4, p5, p6, p7, p8 );
             }
             else
             {
-                ++i;
+                this->OnTargetDead();
             }
         }
         
-        if ( nDisconnections > 0 )
+        static void Destroy( FunctorSlot* pSlot ) { static_cast<WeakPtrSlot*>( pSlot )->~WeakPtrSlot(); }
+    };
+    
+    template< class Y, typename TMethod >
+    void ConnectWeakPtrSlot( const std::shared_ptr<Y>& spObject, TMethod fpMethod, unsigned nFlags )
+    {
+        JL_ASSERT( spObject );
+        if ( ! spObject )
         {
-            NotifyObserverDisconnect( pObserver );        
+            return;
         }
+        
+        JL_SIGNAL_LOG( "Signal8 %p connecting weakly to shared object %p (method %p)\n", this, spObject.get(), BruteForceCast<void*>(fpMethod) );
+        ConnectWeakSlot( WeakPtrSlot<Y, TMethod>(spObject, fpMethod), nFlags );
     }
+#endif
     
-    void DisconnectAll()
+    template< class TSlot >
+    void ConnectWeakSlot( const TSlot& oSlot, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal7 %p disconnecting all observers\n", this );
+        JL_COMPILER_ASSERT( sizeof(TSlot) <= eAllocationSize, Weak_Connection_Must_Fit_In_A_Connection_Allocation );
+        JL_ASSERT( ! (nFlags & eConnectionFlag_ParallelSafe) );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        void* pBlock = m_oConnections.GetAllocator()->Alloc( eAllocationSize );
+        JL_ASSERT( pBlock );
+        
+        if ( ! pBlock )
         {
-            SignalObserver* pObserver = (*i).pObserver;
-            
-            //HACK - call this each time we encounter a valid observer pointer. This means
-            // this will be called repeatedly for observers that are connected multiple times
-            // to this signal.
-            if ( pObserver )
-            {
-                NotifyObserverDisconnect( pObserver );
-            }
+            return;
         }
         
-        m_oConnections.Clear();
+        TSlot* pSlot = new ( pBlock ) TSlot( oSlot );
+        pSlot->pDeadCount = & m_nDeadConnections;
+        
+        Connection c = { Delegate(pSlot, & TSlot::Invoke), NULL, nFlags | eConnectionFlag_Functor | eConnectionFlag_Weak };
+        const bool bAdded = AddConnection( c );
+        JL_ASSERT( bAdded );
+        
+        if ( ! bAdded )
+        {
+            ReleaseFunctor( c );
+        }
     }
     
-private:
-    bool IsConnected( const Delegate& d ) const
-    {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            if ( (*i).d == d )
-            {
-                return true;
-            }
+    // Called at the end of every Emit(). Dead connections, i.e. removed ones and weak ones
+    // whose target is gone, can't be unlinked while any Emit() of this signal is iterating
+    // over the connections.
+    void EndEmit() const
+    {
+        if ( --m_nEmitDepth == 0 && m_nDeadConnections > 0 )
+        {
+            // Callers see Emit() as const. Removing connections that can no longer be called
+            // doesn't change what the signal does.
+            const_cast< Signal8* >( this )->PurgeDeadConnections();
         }
-        
-        return false;        
     }
     
-    // Disconnects a specific slot on an observer. Calls NotifyObserverDisconnect() if
-    // the observer is completely disconnected from this signal.
-    void DisconnectObserverDelegate( SignalObserver* pObserver, const Delegate& d )
+    void PurgeDeadConnections()
     {
-        unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
-        unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
+        JL_SIGNAL_LOG( "Signal8 %p removing %u dead connections\n", this, m_nDeadConnections );
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid() && m_nDeadConnections > 0; )
         {
-            if ( (*i).d == d )
+            // Removed weak connections count as found dead, see MarkRemoved()
+            if ( IsRemoved(*i) || ( ((*i).nFlags & eConnectionFlag_Weak) && static_cast<WeakSlot*>( GetFunctorBlock(*i) )->pDeadCount == NULL ) )
             {
-                JL_ASSERT( (*i).pObserver == pObserver );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                RemoveConnection( i );
+                m_nDeadConnections -= 1;
             }
             else
             {
-                if ( (*i).pObserver == pObserver )
-                {
-                    ++nObserverConnectionCount;
-                }
-
                 ++i;
             }
         }
         
-        if ( nDisconnections > 0 && nObserverConnectionCount == 0 )
-        {
-            JL_SIGNAL_LOG( "\tCompletely disconnected observer %p!", pObserver );
-            NotifyObserverDisconnect( pObserver );
-        }    
+        JL_ASSERT( m_nDeadConnections == 0 );
+        m_nDeadConnections = 0;
+        m_nRemovedConnections = 0;
     }
     
-    void OnObserverDisconnect( SignalObserver* pObserver )
+    // Orders connections for grouped dispatch
+    struct GroupedOrder
     {
-        JL_SIGNAL_LOG( "Signal7 %p received disconnect message from observer %p\n", this, pObserver );
-        
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        bool operator()( const Connection& a, const Connection& b ) const
         {
-            if ( (*i).pObserver == pObserver )
-            {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const bool bFirstA = ( a.nFlags & eConnectionFlag_First ) != 0;
+            const bool bFirstB = ( b.nFlags & eConnectionFlag_First ) != 0;
+            
+            if ( bFirstA != bFirstB )
             {
-                ++i;
+                return bFirstA;
             }
+            
+            // GetMemento() isn't const
+            Delegate da = a.d;
+            Delegate db = b.d;
+            return da.GetMemento().IsLessByFunction( db.GetMemento() );
         }
-    }
-};
-
-#ifdef FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX
-
-/**
- * Signal<[7 arguments]>: wrapper class for Signal7
- * This wrapper template, in conjunction with the "JL_SIGNAL()" macro, will allow you to ignore the argument count in the signal typename.
- */
-template< typename TUnused, typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6, typename _P7 >
-class Signal< TUnused(_P1, _P2, _P3, _P4, _P5, _P6, _P7) > : public Signal7< _P1, _P2, _P3, _P4, _P5, _P6, _P7 >
-{
-public:
-    typedef Signal7< _P1, _P2, _P3, _P4, _P5, _P6, _P7 > TParent;
-    Signal() {}
-    Signal( ScopedAllocator* pNodeAllocator ) : TParent(pNodeAllocator) {}
-    void operator=( const TParent& other ) { *static_cast<TParent*>(this) = other; }
-};
-
-#endif // defined( FASTDELEGATE_ALLOW_FUNCTION_TYPE_SYNTAX )
-
-/**
- * Signal8: signals with 8 arguments
- */
-template< typename _P1, typename _P2, typename _P3, typename _P4, typename _P5, typename _P6, typename _P7, typename _P8 >
-class Signal8 : public SignalBase
-{
-public:
-    typedef fastdelegate::FastDelegate8< _P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8 > Delegate;
+    };
     
-    struct Connection
+    // Puts a connection ahead of every other one
+    struct FrontOrder
     {
-        Delegate d;
-        SignalObserver* pObserver;
+        bool operator()( const Connection&, const Connection& ) const { return true; }
     };
     
-    typedef DoublyLinkedList<Connection> ConnectionList;
-    
-    enum { eAllocationSize = sizeof(typename ConnectionList::Node) };
-    
-private:
-    typedef typename ConnectionList::iterator ConnectionIter;
-    typedef typename ConnectionList::const_iterator ConnectionConstIter;
-    
-    ConnectionList m_oConnections;
-    
-public:
-    Signal8() { SetAllocator( s_pCommonAllocator ); }
-    Signal8( ScopedAllocator* pAllocator ) { SetAllocator( pAllocator ); }
-    
-    virtual ~Signal8()
+    bool AddConnection( const Connection& c )
     {
-        JL_SIGNAL_LOG( "Destroying Signal8 %p\n", this );
-        DisconnectAll();
+        ConnectionNode* pNode;
+        
+        if ( m_bGroupedDispatch )
+        {
+            pNode = m_oConnections.AddSorted( c, GroupedOrder() );
+        }
+        else
+        {
+            pNode = ( c.nFlags & eConnectionFlag_First ) ? m_oConnections.AddSorted( c, FrontOrder() ) : m_oConnections.Add( c );
+        }
+        
+        IndexConnection( pNode );
+        return pNode != NULL;
     }
     
-    void SetAllocator( ScopedAllocator* pAllocator ) { m_oConnections.Init( pAllocator ); }    
-    unsigned CountConnections() const { return m_oConnections.Count(); }
-    
-    // Connects non-instance functions.
-    void Connect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) )
+    // Removes a connection from the index, and from the list. During an Emit(), the node
+    // and any functor copy stay alive until EndEmit(), so the slots being called can
+    // disconnect any connection.
+    void RemoveConnection( ConnectionIter& i )
     {
-        JL_SIGNAL_DOUBLE_CONNECTED_FUNCTION_ASSERT( fpFunction );
-        JL_SIGNAL_LOG( "Signal8 %p connection to non-instance function %p", this, BruteForceCast<void*>(fpFunction) );
-        
-        Connection c = { Delegate(fpFunction), NULL };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-    }    
+        ConnectionNode* pNode = i.GetNode();
+        ++i;
+        RemoveConnection( pNode );
+    }
     
-    // Connects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) )
+    void RemoveConnection( ConnectionNode* pNode )
     {
-        if ( ! pObject )
+        m_oIndex.Remove( pNode );
+        
+        if ( m_nEmitDepth > 0 )
         {
+            MarkRemoved( pNode->object );
             return;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal8 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        ReleaseFunctor( pNode->object );
+        m_oConnections.Remove( pNode );
     }
     
-    // Connects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Connect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const )
+    void MarkRemoved( Connection& c )
     {
-        if ( ! pObject )
+        JL_ASSERT( ! IsRemoved(c) );
+        
+        // A weak connection is only counted once, whether it's removed or found dead
+        if ( c.nFlags & eConnectionFlag_Weak )
         {
-            return;
+            static_cast<WeakSlot*>( GetFunctorBlock(c) )->OnTargetDead();
+        }
+        else
+        {
+            m_nDeadConnections += 1;
         }
         
-        JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal8 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        
-        Connection c = { Delegate(pObject, fpMethod), pObserver };
-        const bool bAdded = m_oConnections.Add( c );
-        JL_ASSERT( bAdded );
-        NotifyObserverConnect( pObserver );
+        c.nFlags = ( c.nFlags | eConnectionFlag_Removed ) & ~eConnectionFlag_ParallelSafe;
+        m_nRemovedConnections += 1;
     }
     
-    // Returns true if the given observer and non-instance function are connected to this signal.
-    bool IsConnected( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) ) const
-    {
-        return IsConnected( Delegate(fpFunction) );
-    }    
+    static bool IsRemoved( const Connection& c ) { return ( c.nFlags & eConnectionFlag_Removed ) != 0; }
     
-    // Returns true if the given observer and instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) ) const
+    // Adds a new connection to the index, if there is one. Drops the index if it's full.
+    void IndexConnection( ConnectionNode* pNode )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        if ( ! pNode || ! m_oIndex.IsInitialized() )
+        {
+            return;
+        }
+        
+        const bool bIndexed = m_oIndex.Add( pNode );
+        JL_ASSERT( bIndexed ); // the index is full
+        
+        if ( ! bIndexed )
+        {
+            m_oIndex.Init( NULL, 0 );
+        }
     }
     
-    // Returns true if the given observer and const instance method are connected to this signal.
-    template< class X, class Y >
-    bool IsConnected( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const ) const
+    static unsigned HashDelegate( const Delegate& d )
     {
-        return IsConnected( Delegate(pObject, fpMethod) );
+        Delegate dCopy = d; // GetMemento() isn't const
+        return dCopy.GetMemento().GetHash();
     }
     
-    void Emit( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7, _P8 p8 ) const
+    struct DelegateMatch
     {
-        for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
-        {
-            (*i).d( p1, p2, p3, p4, p5, p6, p7, p8 );
-        }
-    }
-    
-    void operator()( _P1 p1, _P2 p2, _P3 p3, _P4 p4, _P5 p5, _P6 p6, _P7 p7, _P8 p8 ) const { Emit( p1, p2, p3, p4, p5, p6, p7, p8 ); } 
+        const Delegate* pDelegate;
+        bool operator()( const ConnectionNode& oNode ) const { return oNode.object.d == *pDelegate; }
+    };
     
-    // Disconnects a non-instance method.
-    void Disconnect( void (*fpFunction)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) )
+    // Matches the functor connection that a FunctorConnection was returned for. The serial
+    // number is only read from blocks that belong to a connection.
+    struct FunctorMatch
     {
-        JL_SIGNAL_LOG( "Signal8 %p removing connections to non-instance method %p\n", this, BruteForceCast<void*>(fpFunction) );        
-        const Delegate d(fpFunction);
+        const FunctorConnection* pConnection;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        bool operator()( const ConnectionNode& oNode ) const
         {
-            if ( (*i).d == d )
-            {
-                JL_ASSERT( (*i).pObserver == NULL );
-                JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i );
-            }
-            else
+            const unsigned nFlags = oNode.object.nFlags;
+            
+            if ( (nFlags & (eConnectionFlag_Functor | eConnectionFlag_Weak | eConnectionFlag_Removed)) != eConnectionFlag_Functor || GetFunctorBlock(oNode.object) != pConnection->GetSlot() )
             {
-                ++i;
+                return false;
             }
-        }         
-    }    
-
-    // Disconnects instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) )
-    {
-        if ( ! pObject )
-        {
-            return;
+            
+            return static_cast<const SerialSlot*>( GetFunctorBlock(oNode.object) )->nSerial == pConnection->GetSerial();
         }
-        
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal8 %p removing connections to Observer %p, instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );        
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+    };
+    
+    // Only for signals with a connection index
+    ConnectionNode* FindConnection( const Delegate& d ) const
+    {
+        const DelegateMatch oMatch = { & d };
+        return m_oIndex.Find( HashDelegate(d), oMatch );
     }
     
-    // Disconnects const instance methods. Class X should be equal to Y, or an ancestor type.
-    template< class X, class Y >
-    void Disconnect( Y* pObject, void (X::*fpMethod)(_P1, _P2, _P3, _P4, _P5, _P6, _P7, _P8) const )
+    bool IsIndexedDuplicate( const Delegate& d ) const
     {
-        if ( ! pObject )
+        if ( m_oIndex.IsInitialized() && FindConnection(d) )
         {
-            return;
+            JL_SIGNAL_LOG( "\tAlready connected\n" );
+            return true;
         }
         
-        SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
-        JL_SIGNAL_LOG( "Signal8 %p removing connections to Observer %p, const instance method (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
-        DisconnectObserverDelegate( pObserver, Delegate(pObject, fpMethod) );
+        return false;
     }
     
-    // Disconnects all connected instance methods from a single observer. Calls NotifyObserverDisconnect()
-    // if any disconnections are made.
-    void Disconnect( SignalObserver* pObserver )
+    template< class Y, typename TMethod >
+    unsigned ConnectManyMethods( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        if ( ! pObserver )
+        JL_ASSERT( ! (nFlags & eConnectionFlag_First) );
+        
+        // Popping a batch off a free list costs the same as popping nodes one at a time,
+        // but the nodes are touched twice. Without a sort to save, only allocators that
+        // prefer batches are worth batching.
+        if ( ! m_bGroupedDispatch && ! m_oConnections.GetAllocator()->PrefersBatches() )
         {
-            return;
+            return ConnectEachMethod( pObjects, nCount, fpMethod, nFlags );
         }
         
-        JL_SIGNAL_LOG( "Signal8 %p removing all connections to Observer %p\n", this, pObserver );
-        unsigned nDisconnections = 0;
+        enum { eBatchSize = SignalBase::eMaxObserverConnectBatch };
+        void* ppNodes[ eBatchSize ];
+        void* ppObserverNodes[ eBatchSize ];
+        unsigned nConnected = 0;
+        unsigned nDuplicates = 0;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        while ( nConnected < nCount )
         {
-            if ( (*i).pObserver == pObserver )
+            Y* pBatch = pObjects + nConnected;
+            const unsigned nBatch = nCount - nConnected < unsigned(eBatchSize) ? nCount - nConnected : unsigned(eBatchSize);
+            const unsigned nAllocated = m_oConnections.AllocNodes( ppNodes, nBatch );
+            
+            if ( nAllocated == 0 )
             {
-                JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i ); // advances iterator
-                ++nDisconnections;
+                break;
             }
-            else
+            
+            // Observer nodes come from the first object's allocator. Objects that use another
+            // allocator, if any, get theirs one at a time.
+            ScopedAllocator* pObserverAllocator = GetObserverAllocator( pBatch );
+            const unsigned nObserverNodes = pObserverAllocator->AllocN( SignalObserver::eAllocationSize, ppObserverNodes, nAllocated );
+            unsigned nUsedObserverNodes = 0;
+            
+            // Link both sides of each connection together, so that the observers are only
+            // touched once.
+            for ( unsigned i = 0; i < nAllocated; ++i )
             {
-                ++i;
+                Y* pObject = pBatch + i;
+                JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+                SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+                JL_SIGNAL_LOG( "Signal8 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
+                
+                Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+                
+                if ( IsIndexedDuplicate(c.d) )
+                {
+                    m_oConnections.GetAllocator()->Free( ppNodes[i] );
+                    ++nDuplicates;
+                    continue;
+                }
+                
+                IndexConnection( m_oConnections.AddAllocated(ppNodes[i], c) );
+                
+                if ( nUsedObserverNodes < nObserverNodes && GetObserverAllocator(pObserver) == pObserverAllocator )
+                {
+                    NotifyObserverConnect( pObserver, ppObserverNodes[nUsedObserverNodes++] );
+                }
+                else
+                {
+                    NotifyObserverConnect( pObserver );
+                }
             }
+            
+            if ( nUsedObserverNodes < nObserverNodes )
+            {
+                pObserverAllocator->FreeN( ppObserverNodes + nUsedObserverNodes, nObserverNodes - nUsedObserverNodes );
+            }
+            
+            // A short batch is allowed, so keep asking until the allocator runs dry
+            nConnected += nAllocated;
         }
         
-        if ( nDisconnections > 0 )
+        // One sort instead of a sorted insertion per connection
+        if ( m_bGroupedDispatch )
         {
-            NotifyObserverDisconnect( pObserver );        
+            m_oConnections.Sort( GroupedOrder() );
         }
+        
+        return nConnected - nDuplicates;
     }
     
-    void DisconnectAll()
+    template< class Y, typename TMethod >
+    unsigned ConnectEachMethod( Y* pObjects, unsigned nCount, TMethod fpMethod, unsigned nFlags )
     {
-        JL_SIGNAL_LOG( "Signal8 %p disconnecting all observers\n", this );
+        unsigned nConnected = 0;
         
-        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); ++i )
+        for ( unsigned i = 0; i < nCount; ++i )
         {
-            SignalObserver* pObserver = (*i).pObserver;
+            Y* pObject = pObjects + i;
+            JL_SIGNAL_DOUBLE_CONNECTED_INSTANCE_METHOD_ASSERT( pObject, fpMethod );
+            SignalObserver* pObserver = static_cast<SignalObserver*>( pObject );
+            JL_SIGNAL_LOG( "Signal8 %p connecting to Observer %p (object %p, method %p)\n", this, pObserver, pObject, BruteForceCast<void*>(fpMethod) );
             
-            //HACK - call this each time we encounter a valid observer pointer. This means
-            // this will be called repeatedly for observers that are connected multiple times
-            // to this signal.
-            if ( pObserver )
+            Connection c = { Delegate(pObject, fpMethod), pObserver, nFlags };
+            
+            if ( IsIndexedDuplicate(c.d) )
             {
-                NotifyObserverDisconnect( pObserver );
+                continue;
+            }
+            
+            if ( ! AddConnection(c) )
+            {
+                break;
             }
+            
+            NotifyObserverConnect( pObserver );
+            ++nConnected;
         }
         
-        m_oConnections.Clear();
+        return nConnected;
     }
     
-private:
     bool IsConnected( const Delegate& d ) const
     {
+        if ( m_oIndex.IsInitialized() )
+        {
+            return FindConnection( d ) != NULL;
+        }
+        
         for ( ConnectionConstIter i = m_oConnections.const_begin(); i.isValid(); ++i )
         {
-            if ( (*i).d == d )
+            if ( (*i).d == d && ! IsRemoved(*i) )
             {
                 return true;
             }
@@ -2697,13 +12249,35 @@ private:
         unsigned nDisconnections = 0; // number of disconnections. This is 0 or 1 unless you connected the same slot twice.
         unsigned nObserverConnectionCount = 0; // number of times the observer is connected to this signal
         
+        // Without a pass over the connections, the observer finds out whether it has others
+        if ( m_oIndex.IsInitialized() )
+        {
+            while ( ConnectionNode* pNode = FindConnection(d) )
+            {
+                JL_ASSERT( pNode->object.pObserver == pObserver );
+                RemoveConnection( pNode );
+                ++nDisconnections;
+            }
+            
+            if ( nDisconnections > 0 )
+            {
+                NotifyObserverDisconnect( pObserver, nDisconnections );
+            }
+            
+            return;
+        }
+        
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).d == d )
+            if ( IsRemoved(*i) )
+            {
+                ++i;
+            }
+            else if ( (*i).d == d )
             {
                 JL_ASSERT( (*i).pObserver == pObserver );
                 JL_SIGNAL_LOG( "\tRemoving connection...\n" );
-                m_oConnections.Remove( i ); // advances iterator
+                RemoveConnection( i ); // advances iterator
                 ++nDisconnections;
             }
             else
@@ -2730,10 +12304,28 @@ private:
         
         for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
         {
-            if ( (*i).pObserver == pObserver )
+            if ( (*i).pObserver == pObserver && ! IsRemoved(*i) )
             {
                 JL_SIGNAL_LOG( "\tRemoving connection to observer\n" );
-                m_oConnections.Remove( i );
+                RemoveConnection( i );
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+    void OnMarkedObserversDisconnect()
+    {
+        JL_SIGNAL_LOG( "Signal8 %p removing connections to marked observers\n", this );
+        
+        for ( ConnectionIter i = m_oConnections.begin(); i.isValid(); )
+        {
+            // A removed connection's observer may be gone
+            if ( (*i).pObserver && ! IsRemoved(*i) && IsMarkedForDisconnect((*i).pObserver) )
+            {
+                RemoveConnection( i );
             }
             else
             {
@@ -0,0 +1,224 @@
+#include <math.h>
+
+#include "SignalLog.h"
+#include "VirtualMemory.h"
+
+namespace jl {
+    namespace
+    {
+        // Commit at least this much at a time, so that a growing log rarely calls the OS
+        enum { eMinCommitBytes = 64 * 1024 };
+    } // anon namespace
+} // namespace jl
+
+jl::SignalRecorder::SignalRecorder( const MonotonicClock* pClock )
+{
+    m_pClock = pClock;
+    m_pBuffer = NULL;
+    m_nSize = 0;
+    m_nCapacity = 0;
+    m_nReservedBytes = 0;
+    m_nCommitGranularity = 0;
+    Clear();
+}
+
+jl::SignalRecorder::~SignalRecorder()
+{
+    // Stop recording before the log goes away
+    DisconnectAllSignals();
+    ReleaseBuffer();
+}
+
+bool jl::SignalRecorder::Reserve( size_t nMaxBytes )
+{
+    ReleaseBuffer();
+
+    bool bHugePages;
+    size_t nReservedBytes = nMaxBytes;
+    m_pBuffer = (unsigned char*)VirtualMemory::Reserve( nReservedBytes, 0, m_nCommitGranularity, bHugePages );
+
+    if ( ! m_pBuffer )
+    {
+        return false;
+    }
+
+    m_nReservedBytes = nReservedBytes;
+    Clear();
+    return true;
+}
+
+void jl::SignalRecorder::SetBuffer( void* pBuffer, size_t nBytes )
+{
+    ReleaseBuffer();
+    m_pBuffer = (unsigned char*)pBuffer;
+    m_nCapacity = nBytes;
+    Clear();
+}
+
+void jl::SignalRecorder::Clear()
+{
+    m_nRecords = 0;
+    m_nDroppedRecords = 0;
+    m_fStartSeconds = m_pClock ? m_pClock->GetSeconds() : 0.0;
+    m_fLastMicroseconds = 0.0;
+    m_nSize = 0;
+
+    if ( m_pBuffer && Grow(sizeof(SignalLog::Header)) )
+    {
+        const SignalLog::Header oHeader = { SignalLog::eMagic, SignalLog::eVersion };
+        memcpy( m_pBuffer, & oHeader, sizeof(oHeader) );
+        m_nSize = sizeof( oHeader );
+    }
+}
+
+void jl::SignalRecorder::WriteRecord( unsigned nSignalId, const void* pArguments, unsigned nArgumentBytes )
+{
+    const size_t nRecordBytes = sizeof( SignalLog::RecordHeader ) + nArgumentBytes;
+
+    if ( m_nSize == 0 || ! Grow(m_nSize + nRecordBytes) )
+    {
+        ++m_nDroppedRecords;
+        return;
+    }
+
+    // Timestamps are kept in whole microseconds, so that rounding doesn't accumulate
+    double fTimeDelta = 0.0;
+
+    if ( m_pClock )
+    {
+        // floor() rather than an integer cast, which would wrap after about 71 minutes where
+        // long is 32 bits
+        const double fMicroseconds = floor( ( m_pClock->GetSeconds() - m_fStartSeconds ) * 1e6 );
+        fTimeDelta = fMicroseconds - m_fLastMicroseconds;
+        fTimeDelta = fTimeDelta > 0.0 ? fTimeDelta : 0.0;
+        fTimeDelta = fTimeDelta < double( SignalLog::eMaxTimeDelta ) ? fTimeDelta : double( SignalLog::eMaxTimeDelta );
+        m_fLastMicroseconds += fTimeDelta;
+    }
+
+    SignalLog::RecordHeader oHeader;
+    oHeader.nSignalId = (unsigned short)nSignalId;
+    oHeader.nArgumentBytes = (unsigned short)nArgumentBytes;
+    oHeader.nTimeDelta = (unsigned)fTimeDelta;
+
+    memcpy( m_pBuffer + m_nSize, & oHeader, sizeof(oHeader) );
+    if ( nArgumentBytes > 0 )
+    {
+        memcpy( m_pBuffer + m_nSize + sizeof(oHeader), pArguments, nArgumentBytes );
+    }
+
+    m_nSize += nRecordBytes;
+    ++m_nRecords;
+}
+
+bool jl::SignalRecorder::Grow( size_t nSize )
+{
+    if ( nSize <= m_nCapacity )
+    {
+        return true;
+    }
+
+    if ( m_nReservedBytes == 0 || nSize > m_nReservedBytes )
+    {
+        return false;
+    }
+
+    size_t nTarget = nSize > m_nCapacity + eMinCommitBytes ? nSize : m_nCapacity + eMinCommitBytes;
+    nTarget = ( nTarget + m_nCommitGranularity - 1 ) / m_nCommitGranularity * m_nCommitGranularity;
+    nTarget = nTarget < m_nReservedBytes ? nTarget : m_nReservedBytes;
+
+    if ( ! VirtualMemory::Commit(m_pBuffer + m_nCapacity, nTarget - m_nCapacity) )
+    {
+        return false;
+    }
+
+    m_nCapacity = nTarget;
+    return true;
+}
+
+void jl::SignalRecorder::ReleaseBuffer()
+{
+    if ( m_nReservedBytes > 0 )
+    {
+        VirtualMemory::Release( m_pBuffer, m_nReservedBytes );
+    }
+
+    m_pBuffer = NULL;
+    m_nSize = 0;
+    m_nCapacity = 0;
+    m_nReservedBytes = 0;
+}
+
+jl::SignalReplayer::SignalReplayer()
+{
+    for ( unsigned i = 0; i < SignalLog::eMaxSignals; ++i )
+    {
+        Unregister( i );
+    }
+
+    m_pClock = NULL;
+    m_nSkippedRecords = 0;
+}
+
+void jl::SignalReplayer::Unregister( unsigned nSignalId )
+{
+    JL_ASSERT( nSignalId < SignalLog::eMaxSignals );
+    m_pTargets[ nSignalId ].pSignal = NULL;
+    m_pTargets[ nSignalId ].fpEmit = NULL;
+    m_pTargets[ nSignalId ].nArgumentBytes = 0;
+}
+
+unsigned jl::SignalReplayer::Replay( const void* pLog, size_t nBytes )
+{
+    const unsigned char* p = static_cast<const unsigned char*>( pLog );
+    const unsigned char* const pEnd = p + nBytes;
+
+    SignalLog::Header oHeader;
+    if ( nBytes < sizeof(oHeader) )
+    {
+        return 0;
+    }
+
+    memcpy( & oHeader, p, sizeof(oHeader) );
+    if ( oHeader.nMagic != SignalLog::eMagic || oHeader.nVersion != SignalLog::eVersion )
+    {
+        return 0;
+    }
+
+    p += sizeof( oHeader );
+    unsigned nEmissions = 0;
+
+    while ( size_t(pEnd - p) >= sizeof(SignalLog::RecordHeader) )
+    {
+        SignalLog::RecordHeader oRecord;
+        memcpy( & oRecord, p, sizeof(oRecord) );
+
+        const unsigned char* pArguments = p + sizeof( oRecord );
+        if ( size_t(pEnd - pArguments) < oRecord.nArgumentBytes )
+        {
+            break;
+        }
+
+        p = pArguments + oRecord.nArgumentBytes;
+
+        if ( m_pClock )
+        {
+            m_pClock->Advance( oRecord.nTimeDelta * 1e-6 );
+        }
+
+        const Target* pTarget = oRecord.nSignalId < SignalLog::eMaxSignals ? & m_pTargets[ oRecord.nSignalId ] : NULL;
+
+        // A registered signal whose arguments have a different size isn't the one that was
+        // recorded
+        if ( ! pTarget || ! pTarget->pSignal || pTarget->nArgumentBytes != oRecord.nArgumentBytes )
+        {
+            JL_ASSERT( ! pTarget || ! pTarget->pSignal );
+            ++m_nSkippedRecords;
+            continue;
+        }
+
+        pTarget->fpEmit( pTarget->pSignal, pArguments );
+        ++nEmissions;
+    }
+
+    return nEmissions;
+}
@@ -0,0 +1,239 @@
+#ifndef _JL_SIGNAL_LOG_H_
+#define _JL_SIGNAL_LOG_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <new>
+
+#include "Utils.h"
+#include "SignalDefinitions.h"
+#include "MonotonicClock.h"
+
+namespace jl {
+
+/**
+ * The binary format shared by SignalRecorder and SignalReplayer. A log is a
+ * Header, followed by one record per emission: a RecordHeader, then the bytes
+ * of the signal's SignalN::Arguments. Nothing is aligned, and everything is in
+ * the recording machine's byte order.
+ */
+namespace SignalLog {
+
+    enum
+    {
+        eMagic = 0x4C53434A, // "JCSL"
+        eVersion = 1,
+        eMaxSignals = 256,
+        eMaxArgumentBytes = 0xFFFF,
+        eMaxTimeDelta = 0xFFFFFFFF
+    };
+
+    struct Header
+    {
+        unsigned nMagic;
+        unsigned nVersion;
+    };
+
+    struct RecordHeader
+    {
+        unsigned short nSignalId;
+        unsigned short nArgumentBytes;
+        unsigned nTimeDelta; // Microseconds since the previous record, up to eMaxTimeDelta
+    };
+
+    // Bytes recorded for each emission of TSignal
+    template< class TSignal >
+    unsigned GetArgumentBytes() { return TSignal::Arguments::eCount > 0 ? sizeof( typename TSignal::Arguments ) : 0; }
+
+} // namespace SignalLog
+
+/**
+ * Records emissions of selected signals into a binary log, e.g. to replay real
+ * traffic against a local build with SignalReplayer:
+ *
+ *   SignalRecorder oRecorder( & oClock );
+ *   oRecorder.Reserve( 256 * 1024 * 1024 );
+ *   oRecorder.Record( oDamaged, eSignal_Damaged );
+ *   oRecorder.Record( oSpawned, eSignal_Spawned );
+ *   ...
+ *   fwrite( oRecorder.GetData(), 1, oRecorder.GetSize(), pFile );
+ *
+ * Each recorded signal gets one more slot, so emissions are logged in the order
+ * their signals' other slots see them. Arguments are copied bytewise, so they
+ * must be trivially copyable, and pointers in them are only useful if they
+ * mean something at replay time. Once the log is full, further records are
+ * dropped and counted.
+ */
+class SignalRecorder : public SignalObserver
+{
+public:
+    explicit SignalRecorder( const MonotonicClock* pClock = NULL );
+    virtual ~SignalRecorder();
+
+    // Reserves address space for a log of up to nMaxBytes, which is committed as the log grows.
+    // Returns false if virtual memory isn't available.
+    bool Reserve( size_t nMaxBytes );
+
+    // Logs into a buffer owned by the caller instead
+    void SetBuffer( void* pBuffer, size_t nBytes );
+
+    // Logs every emission of oSignal under nSignalId, until StopRecording() or until either
+    // object is destroyed.
+    template< class TSignal >
+    void Record( TSignal& oSignal, unsigned nSignalId )
+    {
+        typedef typename TSignal::Arguments TArguments;
+        JL_COMPILER_ASSERT( sizeof(TArguments) <= SignalLog::eMaxArgumentBytes, Recorded_Arguments_Are_Too_Large );
+#if __cplusplus >= 201103L
+        static_assert( std::is_trivially_copyable<TArguments>::value, "Recorded signal arguments must be trivially copyable" );
+#endif
+        JL_ASSERT( nSignalId < SignalLog::eMaxSignals );
+
+        const RecordingSlot< TArguments > oSlot = { this, nSignalId };
+        oSignal.Connect( this, oSlot );
+    }
+
+    template< class TSignal >
+    void StopRecording( TSignal& oSignal ) { oSignal.Disconnect( this ); }
+
+    // The whole log, including its header
+    const void* GetData() const { return m_pBuffer; }
+    size_t GetSize() const { return m_nSize; }
+
+    unsigned CountRecords() const { return m_nRecords; }
+    unsigned CountDroppedRecords() const { return m_nDroppedRecords; }
+
+    // Empties the log, and restarts its timestamps
+    void Clear();
+
+private:
+    // Zeroed storage for building one emission's arguments, so that padding bytes are
+    // deterministic in the log
+    template< class T >
+    struct ZeroedStorage
+    {
+        ZeroedStorage() { memset( pBytes, 0, sizeof(pBytes) ); }
+
+        union
+        {
+            double fAlign;
+            void* pAlign;
+            unsigned char pBytes[ sizeof(T) ];
+        };
+    };
+
+    // The slot connected to each recorded signal
+    template< class TArguments >
+    struct RecordingSlot
+    {
+        SignalRecorder* pRecorder;
+        unsigned nSignalId;
+
+        void operator()() const { pRecorder->WriteRecord( nSignalId, NULL, 0 ); }
+
+        template< typename P1 >
+        void operator()( P1 p1 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1) ); }
+
+        template< typename P1, typename P2 >
+        void operator()( P1 p1, P2 p2 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2) ); }
+
+        template< typename P1, typename P2, typename P3 >
+        void operator()( P1 p1, P2 p2, P3 p3 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2, p3) ); }
+
+        template< typename P1, typename P2, typename P3, typename P4 >
+        void operator()( P1 p1, P2 p2, P3 p3, P4 p4 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2, p3, p4) ); }
+
+        template< typename P1, typename P2, typename P3, typename P4, typename P5 >
+        void operator()( P1 p1, P2 p2, P3 p3, P4 p4, P5 p5 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2, p3, p4, p5) ); }
+
+        template< typename P1, typename P2, typename P3, typename P4, typename P5, typename P6 >
+        void operator()( P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2, p3, p4, p5, p6) ); }
+
+        template< typename P1, typename P2, typename P3, typename P4, typename P5, typename P6, typename P7 >
+        void operator()( P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2, p3, p4, p5, p6, p7) ); }
+
+        template< typename P1, typename P2, typename P3, typename P4, typename P5, typename P6, typename P7, typename P8 >
+        void operator()( P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7, P8 p8 ) const { ZeroedStorage<TArguments> o; Write( new (o.pBytes) TArguments(p1, p2, p3, p4, p5, p6, p7, p8) ); }
+
+        void Write( const TArguments* pArguments ) const { pRecorder->WriteRecord( nSignalId, pArguments, sizeof(TArguments) ); }
+    };
+
+    void WriteRecord( unsigned nSignalId, const void* pArguments, unsigned nArgumentBytes );
+    bool Grow( size_t nSize );
+    void ReleaseBuffer();
+
+    const MonotonicClock* m_pClock;
+    double m_fStartSeconds;
+    double m_fLastMicroseconds;
+
+    unsigned char* m_pBuffer;
+    size_t m_nSize;
+    size_t m_nCapacity; // Usable bytes: committed, or the whole caller buffer
+    size_t m_nReservedBytes; // Zero unless the buffer is a reservation
+    size_t m_nCommitGranularity;
+
+    unsigned m_nRecords;
+    unsigned m_nDroppedRecords;
+};
+
+/**
+ * Emits the records of a SignalRecorder log through live signals, as fast as
+ * possible:
+ *
+ *   SignalReplayer oReplayer;
+ *   oReplayer.Register( eSignal_Damaged, & oDamaged );
+ *   oReplayer.Register( eSignal_Spawned, & oSpawned );
+ *   oReplayer.Replay( pLogData, nLogBytes );
+ *
+ * Records for signals that aren't registered are skipped. With SetClock(), a
+ * ManualClock is advanced to each record's timestamp before it is emitted, so
+ * time-based signals see the recorded timing.
+ */
+class SignalReplayer
+{
+public:
+    SignalReplayer();
+
+    template< class TSignal >
+    void Register( unsigned nSignalId, const TSignal* pSignal )
+    {
+        JL_ASSERT( nSignalId < SignalLog::eMaxSignals );
+        Target& oTarget = m_pTargets[ nSignalId ];
+        oTarget.pSignal = pSignal;
+        oTarget.fpEmit = & EmitRecord< TSignal >;
+        oTarget.nArgumentBytes = SignalLog::GetArgumentBytes< TSignal >();
+    }
+
+    void Unregister( unsigned nSignalId );
+    void SetClock( ManualClock* pClock ) { m_pClock = pClock; }
+
+    // Emits every record of the log, in order. Returns the number of emissions, or stops early
+    // and returns 0 if the log's header isn't valid. A truncated last record is ignored.
+    unsigned Replay( const void* pLog, size_t nBytes );
+
+    unsigned CountSkippedRecords() const { return m_nSkippedRecords; }
+
+private:
+    template< class TSignal >
+    static void EmitRecord( const void* pSignal, const unsigned char* pBytes )
+    {
+        typename TSignal::Arguments oArguments;
+        memcpy( & oArguments, pBytes, SignalLog::GetArgumentBytes< TSignal >() );
+        oArguments.EmitTo( *static_cast<const TSignal*>( pSignal ) );
+    }
+
+    struct Target
+    {
+        const void* pSignal;
+        void (*fpEmit)( const void* pSignal, const unsigned char* pBytes );
+        unsigned nArgumentBytes;
+    };
+
+    Target m_pTargets[ SignalLog::eMaxSignals ];
+    ManualClock* m_pClock;
+    unsigned m_nSkippedRecords;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_SIGNAL_LOG_H_ )
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "SignalLog.h"
+#include "StaticSignalConnectionAllocators.h"
+
+using namespace jl;
+
+namespace
+{
+    enum
+    {
+        eSignal_Tick,
+        eSignal_Damaged,
+        eSignal_Moved,
+        eSignal_Unregistered
+    };
+
+    struct Position
+    {
+        float x, y, z;
+    };
+
+    class Listener : public SignalObserver
+    {
+    public:
+        Listener() : m_nTicks(0), m_nDamage(0), m_nLastTarget(0), m_fLastSeconds(0.0), m_pClock(NULL) { m_oLastPosition.x = m_oLastPosition.y = m_oLastPosition.z = 0.0f; }
+
+        void OnTick() { ++m_nTicks; }
+        void OnDamaged( int nTarget, short nDamage ) { m_nLastTarget = nTarget; m_nDamage += nDamage; m_fLastSeconds = m_pClock ? m_pClock->GetSeconds() : 0.0; }
+        void OnMoved( Position oPosition ) { m_oLastPosition = oPosition; }
+
+        unsigned m_nTicks;
+        int m_nDamage;
+        int m_nLastTarget;
+        double m_fLastSeconds;
+        Position m_oLastPosition;
+        const MonotonicClock* m_pClock;
+    };
+}
+
+void SignalLogTest()
+{
+    printf( "Testing signal recording and replay...\n" );
+
+    StaticSignalConnectionAllocator< 16 > oConnectionAllocator;
+    StaticObserverConnectionAllocator< 16 > oObserverAllocator;
+
+    Signal0< void > oTick( & oConnectionAllocator );
+    Signal2< int, short > oDamaged( & oConnectionAllocator );
+    Signal1< Position > oMoved( & oConnectionAllocator );
+    Signal1< int > oUnregistered( & oConnectionAllocator );
+
+    ManualClock oRecordClock;
+    oRecordClock.Advance( 100.0 );
+
+    unsigned char pLog[ 256 ];
+
+    {
+        SignalRecorder oRecorder( & oRecordClock );
+        oRecorder.SetConnectionAllocator( & oObserverAllocator );
+        oRecorder.SetBuffer( pLog, sizeof(pLog) );
+        assert( oRecorder.GetSize() == sizeof(SignalLog::Header) );
+
+        oRecorder.Record( oTick, eSignal_Tick );
+        oRecorder.Record( oDamaged, eSignal_Damaged );
+        oRecorder.Record( oMoved, eSignal_Moved );
+        oRecorder.Record( oUnregistered, eSignal_Unregistered );
+
+        const Position oPosition = { 1.0f, 2.0f, 3.0f };
+        oTick.Emit();
+        oRecordClock.Advance( 0.5 );
+        oDamaged.Emit( 7, 20 );
+        oUnregistered.Emit( 1 );
+        oRecordClock.Advance( 0.25 );
+        oMoved.Emit( oPosition );
+        oDamaged.Emit( 8, 5 );
+
+        // Signals that aren't recorded anymore don't reach the log
+        oRecorder.StopRecording( oTick );
+        oTick.Emit();
+        assert( oTick.CountConnections() == 0 );
+        assert( oRecorder.CountRecords() == 5 && oRecorder.CountDroppedRecords() == 0 );
+
+        const size_t nExpectedSize = sizeof( SignalLog::Header ) + 5 * sizeof( SignalLog::RecordHeader )
+            + 2 * SignalLog::GetArgumentBytes< Signal2<int, short> >() + sizeof( Position ) + sizeof( int );
+        assert( SignalLog::GetArgumentBytes< Signal0<void> >() == 0 );
+        assert( oRecorder.GetSize() == nExpectedSize );
+    }
+
+    // Destroying the recorder disconnects it
+    assert( oDamaged.CountConnections() == 0 && oConnectionAllocator.CountAllocations() == 0 );
+
+    // Replay through live signals, reproducing the recorded timing
+    Listener oListener;
+    oListener.SetConnectionAllocator( & oObserverAllocator );
+    oTick.Connect( & oListener, & Listener::OnTick );
+    oDamaged.Connect( & oListener, & Listener::OnDamaged );
+    oMoved.Connect( & oListener, & Listener::OnMoved );
+
+    ManualClock oReplayClock;
+    oListener.m_pClock = & oReplayClock;
+
+    SignalReplayer oReplayer;
+    oReplayer.Register( eSignal_Tick, & oTick );
+    oReplayer.Register( eSignal_Damaged, & oDamaged );
+    oReplayer.Register( eSignal_Moved, & oMoved );
+    oReplayer.SetClock( & oReplayClock );
+
+    const size_t nLogBytes = sizeof( SignalLog::Header ) + 5 * sizeof( SignalLog::RecordHeader ) + 2 * SignalLog::GetArgumentBytes< Signal2<int, short> >() + sizeof( Position ) + sizeof( int );
+    assert( oReplayer.Replay(pLog, nLogBytes) == 4 );
+    assert( oReplayer.CountSkippedRecords() == 1 );
+    assert( oListener.m_nTicks == 1 && oListener.m_nDamage == 25 && oListener.m_nLastTarget == 8 );
+    assert( oListener.m_oLastPosition.x == 1.0f && oListener.m_oLastPosition.y == 2.0f && oListener.m_oLastPosition.z == 3.0f );
+    assert( oListener.m_fLastSeconds == 0.75 && oReplayClock.GetSeconds() == 0.75 );
+
+    // A truncated last record is ignored, and a bad header rejects the whole log
+    assert( oReplayer.Replay(pLog, nLogBytes - 1) == 3 );
+    assert( oListener.m_nDamage == 45 && oListener.m_nLastTarget == 7 );
+
+    pLog[0] ^= 0xFF;
+    assert( oReplayer.Replay(pLog, nLogBytes) == 0 );
+
+    // A full buffer drops records
+    {
+        unsigned char pSmallLog[ sizeof(SignalLog::Header) + sizeof(SignalLog::RecordHeader) ];
+        SignalRecorder oRecorder;
+        oRecorder.SetConnectionAllocator( & oObserverAllocator );
+        oRecorder.SetBuffer( pSmallLog, sizeof(pSmallLog) );
+        oRecorder.Record( oTick, eSignal_Tick );
+
+        oTick.Emit();
+        oTick.Emit();
+        assert( oRecorder.CountRecords() == 1 && oRecorder.CountDroppedRecords() == 1 );
+        assert( oRecorder.GetSize() == sizeof(pSmallLog) );
+    }
+
+    // A reserved log commits memory as it grows
+    {
+        SignalRecorder oRecorder;
+        oRecorder.SetConnectionAllocator( & oObserverAllocator );
+
+        if ( oRecorder.Reserve(4 * 1024 * 1024) )
+        {
+            oRecorder.Record( oDamaged, eSignal_Damaged );
+
+            enum { eEmitCount = 100000 };
+            for ( int i = 0; i < eEmitCount; ++i )
+            {
+                oDamaged.Emit( i, 1 );
+            }
+
+            assert( oRecorder.CountRecords() == eEmitCount && oRecorder.CountDroppedRecords() == 0 );
+
+            SignalReplayer oCounter;
+            oCounter.Register( eSignal_Damaged, & oDamaged );
+            const int nDamage = oListener.m_nDamage;
+            assert( oCounter.Replay(oRecorder.GetData(), oRecorder.GetSize()) == eEmitCount );
+            assert( oListener.m_nDamage == nDamage + eEmitCount && oListener.m_nLastTarget == eEmitCount - 1 );
+
+            oRecorder.Clear();
+            assert( oRecorder.CountRecords() == 0 && oRecorder.GetSize() == sizeof(SignalLog::Header) );
+        }
+    }
+
+    // A gap longer than eMaxTimeDelta microseconds (about 71 minutes) carries over into
+    // the next record
+    {
+        ManualClock oLongClock;
+        SignalRecorder oRecorder( & oLongClock );
+        oRecorder.SetConnectionAllocator( & oObserverAllocator );
+        oRecorder.SetBuffer( pLog, sizeof(pLog) );
+        oRecorder.Record( oTick, eSignal_Tick );
+
+        oLongClock.Advance( 5000.0 );
+        oTick.Emit();
+        oLongClock.Advance( 1.0 );
+        oTick.Emit();
+        oRecorder.StopRecording( oTick );
+
+        SignalLog::RecordHeader oRecord;
+        memcpy( & oRecord, pLog + sizeof(SignalLog::Header), sizeof(oRecord) );
+        assert( oRecord.nTimeDelta == SignalLog::eMaxTimeDelta );
+
+        ManualClock oLongReplayClock;
+        SignalReplayer oLongReplayer;
+        oLongReplayer.Register( eSignal_Tick, & oTick );
+        oLongReplayer.SetClock( & oLongReplayClock );
+        assert( oLongReplayer.Replay(oRecorder.GetData(), oRecorder.GetSize()) == 2 );
+        assert( oLongReplayClock.GetSeconds() > 5000.999 && oLongReplayClock.GetSeconds() < 5001.001 );
+    }
+
+    oTick.DisconnectAll();
+    oDamaged.DisconnectAll();
+    oMoved.DisconnectAll();
+    assert( oConnectionAllocator.CountAllocations() == 0 );
+}
@@ -0,0 +1,44 @@
+#include "SignalShard.h"
+
+#if __cplusplus >= 201103L || ( defined( _MSC_VER ) && _MSC_VER >= 1900 )
+#include <atomic>
+#define JL_THREAD_LOCAL thread_local
+#define JL_AUTO_ASSIGN_SHARDS
+#elif defined( _MSC_VER )
+#define JL_THREAD_LOCAL __declspec( thread )
+#else
+#define JL_THREAD_LOCAL __thread
+#endif
+
+using namespace jl;
+
+namespace
+{
+    enum { eUnassignedShard = ~0u };
+    
+    JL_THREAD_LOCAL unsigned t_nShard = eUnassignedShard;
+    
+#ifdef JL_AUTO_ASSIGN_SHARDS
+    std::atomic<unsigned> g_nNextShard( 0 );
+#endif
+}
+
+void jl::SignalShard::SetCurrentThreadShard( unsigned nShard )
+{
+    JL_ASSERT( nShard != eUnassignedShard );
+    t_nShard = nShard;
+}
+
+unsigned jl::SignalShard::GetCurrentThreadShard()
+{
+    if ( t_nShard == eUnassignedShard )
+    {
+#ifdef JL_AUTO_ASSIGN_SHARDS
+        t_nShard = g_nNextShard.fetch_add( 1 ) % eUnassignedShard;
+#else
+        t_nShard = 0;
+#endif
+    }
+    
+    return t_nShard;
+}
@@ -0,0 +1,26 @@
+#ifndef _JL_SIGNAL_SHARD_H_
+#define _JL_SIGNAL_SHARD_H_
+
+#include "Utils.h"
+
+namespace jl {
+
+/**
+ * Per-thread shard selection for ShardedSignal and ShardedObjectPoolAllocator.
+ * Each thread has a shard index that every sharded container uses, modulo its
+ * shard count, to pick the shard that thread works in. Job systems should call
+ * SetCurrentThreadShard() once per worker thread, e.g. with the worker index.
+ *
+ * Threads that never call SetCurrentThreadShard() are assigned indices in the
+ * order they first ask for one (C++11 and later), or use shard 0 (C++98).
+ */
+class SignalShard
+{
+public:
+    static void SetCurrentThreadShard( unsigned nShard );
+    static unsigned GetCurrentThreadShard();
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_SIGNAL_SHARD_H_ )
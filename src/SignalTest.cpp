@@ -205,6 +205,1037 @@ namespace
     int TestObserver::s_id = 1;
     unsigned TestObserver::s_pInstanceMethodCallsByArity[ eSignalMaxArity + 1 ];
     unsigned TestObserver::s_pStaticMethodCallsByArity[ eSignalMaxArity + 1 ];    
+    
+    // Tests signal-to-signal forwarding. Requires common allocators.
+    void ForwardTest()
+    {
+        printf( "Testing signal forwarding...\n" );
+        
+        TestObserver oObserver;
+        JL_SIGNAL( int, float ) oLeaf;
+        oLeaf.Connect( & oObserver, & TestObserver::M2 );
+        
+        // Forward through a chain of signals
+        JL_SIGNAL( int, float ) oRoot;
+        JL_SIGNAL( int, float )* pMiddle = new JL_SIGNAL( int, float );
+        oRoot.Forward( pMiddle );
+        pMiddle->Forward( & oLeaf );
+        assert( oRoot.IsForwarding(pMiddle) && pMiddle->IsForwarding(& oLeaf) );
+        assert( oRoot.CountConnections() == 1 );
+        
+        TestObserver::ResetCallsByArity();
+        oRoot.Emit( 1, 2.0f );
+        assert( TestObserver::CountCallsByArity(2) == 1 );
+        
+        // Destroying the target removes the link from the source
+        delete pMiddle;
+        assert( oRoot.CountConnections() == 0 );
+        oRoot.Emit( 1, 2.0f );
+        assert( TestObserver::CountCallsByArity(2) == 1 );
+        
+        // Destroying the source removes the link from the target
+        JL_SIGNAL( int, float )* pSource = new JL_SIGNAL( int, float );
+        pSource->Forward( & oLeaf );
+        oRoot.Forward( & oLeaf );
+        assert( oLeaf.CountForwardingSignals() == 2 );
+        delete pSource;
+        assert( oLeaf.CountForwardingSignals() == 1 );
+        
+        // Explicit removal
+        oRoot.StopForwarding( & oLeaf );
+        assert( ! oRoot.IsForwarding(& oLeaf) );
+        assert( oLeaf.CountForwardingSignals() == 0 );
+        
+        oRoot.Emit( 1, 2.0f );
+        oLeaf.Emit( 1, 2.0f );
+        assert( TestObserver::CountCallsByArity(2) == 2 );
+        
+        // Every kind of emission follows links, which are always called serially
+        SerialTaskScheduler oScheduler;
+        oRoot.Forward( & oLeaf, SignalBase::eConnectionFlag_ParallelSafe );
+        assert( ! oRoot.EmitUntilConsumed(1, 2.0f) );
+        oRoot.EmitParallel( & oScheduler, 1, 2.0f );
+        assert( TestObserver::CountCallsByArity(2) == 4 );
+        
+        oRoot.StopForwarding( & oLeaf );
+    }
+    
+    // Observers of two classes that log the order of their calls
+    class GroupedObserverA : public SignalObserver
+    {
+    public:
+        void OnEmit( int n ) { s_pLog[ s_nLogCount++ ] = 'A'; JL_UNUSED( n ); }
+        void OnOtherEmit( int n ) { s_pLog[ s_nLogCount++ ] = 'a'; JL_UNUSED( n ); }
+        
+        static char s_pLog[ 64 ];
+        static unsigned s_nLogCount;
+    };
+    
+    class GroupedObserverB : public SignalObserver
+    {
+    public:
+        void OnEmit( int n ) { GroupedObserverA::s_pLog[ GroupedObserverA::s_nLogCount++ ] = 'B'; JL_UNUSED( n ); }
+    };
+    
+    char GroupedObserverA::s_pLog[ 64 ];
+    unsigned GroupedObserverA::s_nLogCount = 0;
+    
+    // Returns the number of runs of equal characters in the log
+    unsigned CountLogRuns()
+    {
+        unsigned nRuns = 0;
+        
+        for ( unsigned i = 0; i < GroupedObserverA::s_nLogCount; ++i )
+        {
+            if ( i == 0 || GroupedObserverA::s_pLog[i] != GroupedObserverA::s_pLog[i - 1] )
+            {
+                ++nRuns;
+            }
+        }
+        
+        return nRuns;
+    }
+    
+    void GroupedDispatchTest()
+    {
+        printf( "Testing grouped dispatch...\n" );
+        
+        enum { eObjects = 8 };
+        GroupedObserverA pA[ eObjects ];
+        GroupedObserverB pB[ eObjects ];
+        JL_SIGNAL( int ) oSignal;
+        
+        // Interleave the classes and methods
+        for ( unsigned i = 0; i < eObjects; ++i )
+        {
+            oSignal.Connect( & pA[i], & GroupedObserverA::OnEmit );
+            oSignal.Connect( & pB[i], & GroupedObserverB::OnEmit );
+            oSignal.Connect( & pA[eObjects - 1 - i], & GroupedObserverA::OnOtherEmit );
+        }
+        
+        GroupedObserverA::s_nLogCount = 0;
+        oSignal.Emit( 1 );
+        assert( CountLogRuns() == eObjects * 3 );
+        
+        // One run per method
+        oSignal.SetGroupedDispatch( true );
+        assert( oSignal.IsGroupedDispatch() );
+        
+        GroupedObserverA::s_nLogCount = 0;
+        oSignal.Emit( 1 );
+        assert( GroupedObserverA::s_nLogCount == eObjects * 3 );
+        assert( CountLogRuns() == 3 );
+        
+        // New connections join their group
+        GroupedObserverB oExtraB;
+        GroupedObserverA oExtraA;
+        oSignal.Connect( & oExtraB, & GroupedObserverB::OnEmit );
+        oSignal.Connect( & oExtraA, & GroupedObserverA::OnOtherEmit );
+        
+        GroupedObserverA::s_nLogCount = 0;
+        oSignal.Emit( 1 );
+        assert( GroupedObserverA::s_nLogCount == eObjects * 3 + 2 );
+        assert( CountLogRuns() == 3 );
+        
+        // Disconnection still works
+        oSignal.Disconnect( & pA[0], & GroupedObserverA::OnOtherEmit );
+        oSignal.Disconnect( & oExtraB );
+        assert( oSignal.CountConnections() == eObjects * 3 );
+        assert( oSignal.IsConnected(& pA[0], & GroupedObserverA::OnEmit) );
+        assert( ! oSignal.IsConnected(& pA[0], & GroupedObserverA::OnOtherEmit) );
+        
+        oSignal.DisconnectAll();
+    }
+    
+    class CountingObserver : public SignalObserver
+    {
+    public:
+        void OnEmit( int n ) { s_nTotal += n; }
+        
+        static int s_nTotal;
+    };
+    
+    int CountingObserver::s_nTotal = 0;
+    
+    // Observers whose method is const
+    class ConstObserver : public SignalObserver
+    {
+    public:
+        void OnEmit( int n ) const { s_nTotal += n; }
+        
+        static int s_nTotal;
+    };
+    
+    int ConstObserver::s_nTotal = 0;
+    
+    // Hands out short batches, which AllocN() is allowed to do at any time
+    template< unsigned _Size >
+    class ShortBatchAllocator : public StaticSignalConnectionAllocator< _Size, ObjectPool::eFlag_AddressOrdered >
+    {
+    public:
+        unsigned AllocN( size_t nBytes, void** ppObjects, unsigned nCount )
+        {
+            return StaticSignalConnectionAllocator< _Size, ObjectPool::eFlag_AddressOrdered >::AllocN( nBytes, ppObjects, nCount < 5 ? nCount : 5 );
+        }
+    };
+    
+    void ConnectManyTest()
+    {
+        printf( "Testing ConnectMany()...\n" );
+        
+        // More than one batch, and not a multiple of the batch size
+        enum { eObjects = 135 }; // batches are 64 connections
+        StaticSignalConnectionAllocator< eObjects + 2, ObjectPool::eFlag_AddressOrdered > oConnectionAllocator;
+        StaticObserverConnectionAllocator< 2 > oOtherObserverAllocator;
+        CountingObserver pA[ eObjects ];
+        JL_SIGNAL( int ) oSignal( & oConnectionAllocator );
+        
+        // An object with its own observer allocator in the middle of a batch
+        pA[70].SetConnectionAllocator( & oOtherObserverAllocator );
+        
+        assert( oSignal.ConnectMany(pA, eObjects, & CountingObserver::OnEmit) == eObjects );
+        assert( oSignal.CountConnections() == eObjects );
+        assert( oOtherObserverAllocator.CountAllocations() == 1 );
+        
+        // Connections are in array order and contiguous
+        const unsigned char* pPrevious = NULL;
+        for ( void* p = oConnectionAllocator.GetPool().GetFirstAllocation(); p; p = oConnectionAllocator.GetPool().GetNextAllocation(p) )
+        {
+            assert( ! pPrevious || (const unsigned char*)p == pPrevious + oConnectionAllocator.GetPool().GetStride() );
+            pPrevious = (const unsigned char*)p;
+        }
+        
+        for ( unsigned i = 0; i < eObjects; ++i )
+        {
+            assert( oSignal.IsConnected(& pA[i], & CountingObserver::OnEmit) );
+            assert( pA[i].CountSignalConnections() == 1 );
+        }
+        
+        CountingObserver::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( CountingObserver::s_nTotal == eObjects );
+        
+        // Observer-side bookkeeping works as usual
+        pA[3].DisconnectAllSignals();
+        assert( oSignal.CountConnections() == eObjects - 1 );
+        oSignal.Disconnect( & pA[eObjects - 1] );
+        assert( oSignal.CountConnections() == eObjects - 2 );
+        assert( pA[eObjects - 1].CountSignalConnections() == 0 );
+        
+        // Batches reuse the freed slots
+        CountingObserver pExtra[ 4 ];
+        assert( oSignal.ConnectMany(pExtra, JL_ARRAY_SIZE(pExtra), & CountingObserver::OnEmit) == JL_ARRAY_SIZE(pExtra) );
+        assert( oConnectionAllocator.GetPool().IsFull() );
+        
+        oSignal.DisconnectAll();
+        assert( oConnectionAllocator.CountAllocations() == 0 );
+        assert( oOtherObserverAllocator.CountAllocations() == 0 );
+        
+        for ( unsigned i = 0; i < eObjects; ++i )
+        {
+            assert( pA[i].CountSignalConnections() == 0 );
+        }
+
+        // Free-list pools aren't batched, with the same result
+        StaticSignalConnectionAllocator< eObjects > oFreeListAllocator;
+        JL_SIGNAL( int ) oFreeListSignal( & oFreeListAllocator );
+        assert( oFreeListSignal.ConnectMany(pA, eObjects, & CountingObserver::OnEmit) == eObjects );
+        assert( oFreeListAllocator.GetPool().IsFull() && oOtherObserverAllocator.CountAllocations() == 1 );
+        
+        CountingObserver::s_nTotal = 0;
+        oFreeListSignal.Emit( 1 );
+        assert( CountingObserver::s_nTotal == eObjects );
+        
+        oFreeListSignal.DisconnectAll();
+        assert( oFreeListAllocator.CountAllocations() == 0 && oOtherObserverAllocator.CountAllocations() == 0 );
+        
+        // Short batches don't cut the connections short
+        ShortBatchAllocator< eObjects > oShortBatchAllocator;
+        JL_SIGNAL( int ) oShortBatchSignal( & oShortBatchAllocator );
+        assert( oShortBatchSignal.ConnectMany(pA, eObjects, & CountingObserver::OnEmit) == eObjects );
+        assert( oShortBatchAllocator.GetPool().IsFull() );
+        
+        oShortBatchSignal.DisconnectAll();
+        assert( oShortBatchAllocator.CountAllocations() == 0 && oOtherObserverAllocator.CountAllocations() == 0 );
+        
+        // Const methods, with grouped dispatch
+        ConstObserver pConst[ 8 ];
+        GroupedObserverB pB[ 8 ];
+        oSignal.SetGroupedDispatch( true );
+        oSignal.ConnectMany( pB, 4, & GroupedObserverB::OnEmit );
+        assert( oSignal.ConnectMany(pConst, 8, & ConstObserver::OnEmit) == 8 );
+        oSignal.ConnectMany( pB + 4, 4, & GroupedObserverB::OnEmit );
+        
+        ConstObserver::s_nTotal = 0;
+        GroupedObserverA::s_nLogCount = 0;
+        oSignal.Emit( 2 );
+        assert( ConstObserver::s_nTotal == 16 );
+        assert( GroupedObserverA::s_nLogCount == 8 && CountLogRuns() == 1 );
+        
+        oSignal.DisconnectAll();
+    }
+    
+    void DisconnectObserversTest()
+    {
+        printf( "Testing SignalObserver::DisconnectObservers()...\n" );
+        
+        enum { eObjects = 12 };
+        CountingObserver pObservers[ eObjects ];
+        JL_SIGNAL( int ) oSignalA;
+        JL_SIGNAL( int ) oSignalB;
+        JL_SIGNAL( int ) oSignalC;
+        JL_SIGNAL( int ) oForwarder;
+        
+        oSignalA.ConnectMany( pObservers, eObjects, & CountingObserver::OnEmit );
+        oSignalB.ConnectMany( pObservers, eObjects / 2, & CountingObserver::OnEmit );
+        oSignalB.Connect( & pObservers[1], & CountingObserver::OnEmit ); // connected twice
+        oSignalC.Connect( & pObservers[eObjects - 1], & CountingObserver::OnEmit );
+        oSignalA.Forward( & oForwarder );
+        oForwarder.Connect( & pObservers[1], & CountingObserver::OnEmit );
+        
+        // Every other observer, a duplicate and a NULL
+        SignalObserver* ppSet[ eObjects / 2 + 2 ];
+        unsigned nSet = 0;
+        
+        for ( unsigned i = 0; i < eObjects; i += 2 )
+        {
+            ppSet[nSet++] = & pObservers[i];
+        }
+        
+        ppSet[nSet++] = & pObservers[0];
+        ppSet[nSet++] = NULL;
+        assert( nSet == JL_ARRAY_SIZE(ppSet) );
+        
+        SignalObserver::DisconnectObservers( ppSet, nSet );
+        
+        assert( oSignalA.CountConnections() == eObjects / 2 + 1 );
+        assert( oSignalB.CountConnections() == eObjects / 4 + 1 );
+        assert( oSignalC.CountConnections() == 1 );
+        assert( oSignalA.IsForwarding(& oForwarder) );
+        assert( oForwarder.CountConnections() == 1 );
+        
+        for ( unsigned i = 0; i < eObjects; ++i )
+        {
+            assert( pObservers[i].CountSignalConnections() == (i % 2 == 0 ? 0u : (i < eObjects / 2 ? 2u : 1u) + (i == 1 ? 2u : 0u) + (i == eObjects - 1 ? 1u : 0u)) );
+        }
+        
+        CountingObserver::s_nTotal = 0;
+        oSignalA.Emit( 1 );
+        oSignalB.Emit( 1 );
+        assert( CountingObserver::s_nTotal == eObjects / 2 + 1 + eObjects / 4 + 1 ); // pObservers[1] also hears oSignalA through oForwarder
+        
+        // Swept signals can be swept again by a later call
+        SignalObserver* ppRest[ eObjects / 2 ];
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(ppRest); ++i )
+        {
+            ppRest[i] = & pObservers[2 * i + 1];
+        }
+        
+        SignalObserver::DisconnectObservers( ppRest, JL_ARRAY_SIZE(ppRest) );
+        assert( oSignalA.CountConnections() == 1 && oSignalB.CountConnections() == 0 && oSignalC.CountConnections() == 0 );
+        assert( oForwarder.CountConnections() == 0 && oForwarder.CountForwardingSignals() == 1 );
+        
+        for ( unsigned i = 0; i < eObjects; ++i )
+        {
+            assert( pObservers[i].CountSignalConnections() == 0 );
+        }
+        
+        // Observers can be connected again afterwards
+        oSignalA.Connect( & pObservers[0], & CountingObserver::OnEmit );
+        CountingObserver::s_nTotal = 0;
+        oSignalA.Emit( 1 );
+        assert( CountingObserver::s_nTotal == 1 );
+        
+        oSignalA.DisconnectAll();
+    }
+    
+    // A function object with some state
+    struct AddTo
+    {
+        int* pTotal;
+        int nScale;
+        
+        void operator()( int n ) const { *pTotal += n * nScale; }
+    };
+    
+    // A function object that counts its destructions
+    struct CountDestructions
+    {
+        int* pTotal;
+        
+        ~CountDestructions() { ++s_nDestructions; }
+        void operator()( int n ) const { *pTotal += n; }
+        
+        static unsigned s_nDestructions;
+    };
+    
+    unsigned CountDestructions::s_nDestructions = 0;
+    
+    void IgnoreInt( int ) {}
+    
+    void FunctorTest()
+    {
+        printf( "Testing functor connections...\n" );
+        
+        StaticSignalConnectionAllocator< 8, ObjectPool::eFlag_AddressOrdered > oConnectionAllocator;
+        JL_SIGNAL( int ) oSignal( & oConnectionAllocator );
+        int nTotal = 0;
+        
+        // Leave a free slot below the functors, for Compact() to move them into
+        oSignal.Connect( & IgnoreInt );
+        
+        AddTo oDouble = { & nTotal, 2 };
+        AddTo oTriple = { & nTotal, 3 };
+        oSignal.Connect( oDouble );
+        oSignal.Connect( oTriple );
+        
+        {
+            CountingObserver oOwner;
+            oSignal.Connect( & oOwner, oDouble );
+            assert( oOwner.CountSignalConnections() == 1 );
+            
+            oSignal.Emit( 1 );
+            assert( nTotal == 7 );
+        }
+        
+        // The owned functor went with its observer
+        assert( oSignal.CountConnections() == 3 );
+        nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( nTotal == 5 );
+        
+        // Functor connections keep working when their nodes move
+        oSignal.Disconnect( & IgnoreInt );
+        oSignal.CompactConnections();
+        nTotal = 0;
+        oSignal.Emit( 2 );
+        assert( nTotal == 10 );
+        
+#if __cplusplus >= 201103L
+        int nLambdaTotal = 0;
+        oSignal.Connect( [&nLambdaTotal]( int n ) { nLambdaTotal += n; } );
+        oSignal.Emit( 4 );
+        assert( nLambdaTotal == 4 );
+#endif
+        
+        oSignal.DisconnectAll();
+        assert( oConnectionAllocator.CountAllocations() == 0 );
+        
+        // A functor connection can be removed on its own, and its copy is destroyed
+        const CountDestructions oCounter = { & nTotal };
+        const FunctorConnection oCounterConnection = oSignal.Connect( oCounter );
+        const FunctorConnection oDoubleConnection = oSignal.Connect( oDouble );
+        assert( oCounterConnection.IsValid() && oDoubleConnection.IsValid() );
+        
+        CountDestructions::s_nDestructions = 0;
+        assert( oSignal.Disconnect(oCounterConnection) );
+        assert( CountDestructions::s_nDestructions == 1 );
+        assert( oSignal.CountConnections() == 1 && oConnectionAllocator.CountAllocations() == 2 );
+        assert( ! oSignal.Disconnect(oCounterConnection) );
+        
+        // A stale FunctorConnection doesn't remove a later functor given the same block
+        const FunctorConnection oReused = oSignal.Connect( oTriple );
+        assert( oReused.GetSlot() == oCounterConnection.GetSlot() );
+        assert( ! oSignal.Disconnect(oCounterConnection) );
+        assert( oSignal.Disconnect(oReused) );
+        
+        // Nor with a connection index, which finds functor connections without a pass
+        Signal1< int >::ConnectionIndexSlot pSlots[ 8 ];
+        oSignal.SetConnectionIndex( pSlots, JL_ARRAY_SIZE(pSlots) );
+        const FunctorConnection oIndexed = oSignal.Connect( oTriple );
+        assert( oIndexed.GetSlot() == oCounterConnection.GetSlot() );
+        assert( ! oSignal.Disconnect(oCounterConnection) );
+        assert( oSignal.Disconnect(oIndexed) && ! oSignal.Disconnect(oIndexed) );
+        oSignal.SetConnectionIndex( NULL, 0 );
+        
+        nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( nTotal == 2 );
+        
+        // So are the ones that DisconnectAll() removes
+        oSignal.Connect( oCounter );
+        CountDestructions::s_nDestructions = 0;
+        oSignal.DisconnectAll();
+        assert( CountDestructions::s_nDestructions == 1 );
+        
+        // Removing a functor owned by an observer leaves the observer's other connections
+        {
+            CountingObserver oOwner;
+            const FunctorConnection oOwned = oSignal.Connect( & oOwner, oDouble );
+            oSignal.Connect( & oOwner, oTriple );
+            assert( oOwner.CountSignalConnections() == 2 );
+            
+            assert( oSignal.Disconnect(oOwned) );
+            assert( oOwner.CountSignalConnections() == 1 && oSignal.CountConnections() == 1 );
+            assert( ! oSignal.Connect(NULL, oDouble).IsValid() );
+        }
+        
+        assert( oSignal.CountConnections() == 0 && oConnectionAllocator.CountAllocations() == 0 );
+    }
+    
+    void ConnectionIndexTest()
+    {
+        printf( "Testing connection index...\n" );
+        
+        enum { eObjects = 40 };
+        typedef Signal1< int > IndexedSignal;
+        StaticSignalConnectionAllocator< eObjects * 2 + 4, ObjectPool::eFlag_AddressOrdered > oConnectionAllocator; // ConnectMany() allocates before skipping
+        IndexedSignal::ConnectionIndexSlot pSlots[ 64 ];
+        IndexedSignal oSignal( & oConnectionAllocator );
+        CountingObserver pObservers[ eObjects ];
+        
+        // Connections made before the index is set are indexed too
+        oSignal.Connect( & IgnoreInt );
+        oSignal.ConnectMany( pObservers, eObjects / 2, & CountingObserver::OnEmit );
+        oSignal.SetConnectionIndex( pSlots, JL_ARRAY_SIZE(pSlots) );
+        assert( oSignal.HasConnectionIndex() );
+        
+        // Already connected objects are skipped
+        assert( oSignal.ConnectMany(pObservers, eObjects, & CountingObserver::OnEmit) == eObjects - eObjects / 2 );
+        assert( oSignal.CountConnections() == eObjects + 1 );
+        
+        for ( unsigned i = 0; i < eObjects; ++i )
+        {
+            assert( oSignal.IsConnected(& pObservers[i], & CountingObserver::OnEmit) );
+        }
+        
+        assert( oSignal.IsConnected(& IgnoreInt) );
+        
+        // Connecting again does nothing
+        oSignal.Connect( & IgnoreInt );
+        oSignal.Connect( & pObservers[0], & CountingObserver::OnEmit );
+        assert( oSignal.CountConnections() == eObjects + 1 );
+        assert( pObservers[0].CountSignalConnections() == 1 );
+        
+        CountingObserver::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( CountingObserver::s_nTotal == eObjects );
+        
+        // Removing one of an observer's slots leaves the other
+        {
+            GroupedObserverA oTwoSlots;
+            oSignal.Connect( & oTwoSlots, & GroupedObserverA::OnEmit );
+            oSignal.Connect( & oTwoSlots, & GroupedObserverA::OnOtherEmit );
+            assert( oTwoSlots.CountSignalConnections() == 2 );
+            
+            oSignal.Disconnect( & oTwoSlots, & GroupedObserverA::OnEmit );
+            assert( ! oSignal.IsConnected(& oTwoSlots, & GroupedObserverA::OnEmit) );
+            assert( oSignal.IsConnected(& oTwoSlots, & GroupedObserverA::OnOtherEmit) );
+            assert( oTwoSlots.CountSignalConnections() == 1 );
+        }
+        
+        // The observer's destruction removed its other slot from the index
+        assert( oSignal.CountConnections() == eObjects + 1 );
+        
+        oSignal.Disconnect( & IgnoreInt );
+        oSignal.Disconnect( & pObservers[0], & CountingObserver::OnEmit );
+        oSignal.Disconnect( & pObservers[1] );
+        assert( ! oSignal.IsConnected(& IgnoreInt) );
+        assert( ! oSignal.IsConnected(& pObservers[0], & CountingObserver::OnEmit) );
+        assert( ! oSignal.IsConnected(& pObservers[1], & CountingObserver::OnEmit) );
+        assert( pObservers[0].CountSignalConnections() == 0 && pObservers[1].CountSignalConnections() == 0 );
+        
+        // Compaction moves nodes, and the index follows them, even part way through a pass
+        oSignal.CompactConnections( 3 );
+        assert( oSignal.HasConnectionIndex() );
+        
+        for ( unsigned i = 2; i < eObjects; ++i )
+        {
+            assert( oSignal.IsConnected(& pObservers[i], & CountingObserver::OnEmit) );
+        }
+        
+        oSignal.CompactConnections();
+        
+        for ( unsigned i = 2; i < eObjects; ++i )
+        {
+            assert( oSignal.IsConnected(& pObservers[i], & CountingObserver::OnEmit) );
+        }
+        
+        oSignal.Disconnect( & pObservers[eObjects - 1] );
+        assert( ! oSignal.IsConnected(& pObservers[eObjects - 1], & CountingObserver::OnEmit) );
+        assert( pObservers[eObjects - 1].CountSignalConnections() == 0 );
+        oSignal.Connect( & pObservers[eObjects - 1], & CountingObserver::OnEmit );
+        
+        // Without the index, duplicates are allowed again
+        oSignal.SetConnectionIndex( NULL, 0 );
+        assert( ! oSignal.HasConnectionIndex() );
+        oSignal.Connect( & pObservers[2], & CountingObserver::OnEmit );
+        assert( pObservers[2].CountSignalConnections() == 2 );
+        
+        oSignal.DisconnectAll();
+        assert( oConnectionAllocator.CountAllocations() == 0 );
+    }
+    
+    // Doesn't derive from SignalObserver
+    class PlainTarget
+    {
+    public:
+        PlainTarget( WeakHandleTable* pTable ) : m_oLifetime(pTable) {}
+        
+        void OnEmit( int n ) { s_nTotal += n; }
+        void OnConstEmit( int n ) const { s_nTotal += n * 10; }
+        
+        WeakHandleOwner m_oLifetime;
+        static int s_nTotal;
+    };
+    
+    int PlainTarget::s_nTotal = 0;
+    
+    // Emits its signal again from inside the slot, once
+    class ReentrantTarget
+    {
+    public:
+        ReentrantTarget( WeakHandleTable* pTable ) : m_oLifetime(pTable), m_pSignal(NULL), m_nCalls(0) {}
+        
+        void OnEmit( int n )
+        {
+            if ( m_nCalls++ == 0 )
+            {
+                m_pSignal->Emit( n );
+            }
+        }
+        
+        WeakHandleOwner m_oLifetime;
+        Signal1< int >* m_pSignal;
+        unsigned m_nCalls;
+    };
+    
+    void WeakConnectionTest()
+    {
+        printf( "Testing weak connections...\n" );
+        
+        StaticWeakHandleTable< 8 > oTable;
+        StaticSignalConnectionAllocator< 16 > oConnectionAllocator;
+        Signal1< int > oSignal( & oConnectionAllocator );
+        PlainTarget oSurvivor( & oTable );
+        PlainTarget::s_nTotal = 0;
+        
+        oSignal.ConnectWeak( oSurvivor.m_oLifetime.GetHandle(), & oSurvivor, & PlainTarget::OnEmit );
+        
+        {
+            PlainTarget oTarget( & oTable );
+            oSignal.ConnectWeak( oTarget.m_oLifetime.GetHandle(), & oTarget, & PlainTarget::OnConstEmit );
+            assert( oSignal.CountConnections() == 2 );
+            
+            oSignal.Emit( 1 );
+            assert( PlainTarget::s_nTotal == 11 );
+        }
+        
+        // The dead target is skipped, then removed once the Emit() is over
+        assert( oSignal.CountConnections() == 2 );
+        PlainTarget::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( PlainTarget::s_nTotal == 1 );
+        assert( oSignal.CountConnections() == 1 );
+        assert( oConnectionAllocator.CountAllocations() == 2 );
+        
+        // Dead connections stay in place until the outermost Emit() returns
+        {
+            ReentrantTarget oReentrant( & oTable );
+            oReentrant.m_pSignal = & oSignal;
+            
+            {
+                PlainTarget oDoomed( & oTable );
+                oSignal.ConnectWeak( oReentrant.m_oLifetime.GetHandle(), & oReentrant, & ReentrantTarget::OnEmit );
+                oSignal.ConnectWeak( oDoomed.m_oLifetime.GetHandle(), & oDoomed, & PlainTarget::OnEmit );
+            }
+            
+            PlainTarget::s_nTotal = 0;
+            oSignal.Emit( 1 );
+            assert( oReentrant.m_nCalls == 2 );
+            assert( PlainTarget::s_nTotal == 2 );
+            assert( oSignal.CountConnections() == 2 );
+        }
+        
+#if __cplusplus >= 201103L
+        {
+            std::shared_ptr<PlainTarget> spTarget = std::make_shared<PlainTarget>( & oTable );
+            std::weak_ptr<PlainTarget> wpTarget = spTarget;
+            oSignal.ConnectWeak( spTarget, & PlainTarget::OnConstEmit );
+            assert( spTarget.use_count() == 1 );
+            
+            PlainTarget::s_nTotal = 0;
+            oSignal.Emit( 1 );
+            assert( PlainTarget::s_nTotal == 11 );
+            
+            // Also removes the connection to oReentrant
+            spTarget.reset();
+            oSignal.Emit( 1 );
+            assert( wpTarget.expired() );
+            assert( oSignal.CountConnections() == 1 );
+        }
+#endif
+        
+        oSignal.DisconnectAll();
+        assert( oConnectionAllocator.CountAllocations() == 0 );
+    }
+    
+    // Counts its copies. Opts in to being passed by reference through a signal, below.
+    struct LargeArgument
+    {
+        LargeArgument() : nValue(0) {}
+        LargeArgument( const LargeArgument& oOther ) : nValue(oOther.nValue) { ++s_nCopies; }
+        
+        int nValue;
+        char pPadding[ 60 ];
+        static unsigned s_nCopies;
+    };
+    
+    unsigned LargeArgument::s_nCopies = 0;
+    
+    // Declared ahead of a signal that takes it
+    struct ForwardDeclared;
+    
+    // Large, but chosen to be passed by value
+    struct ValueArgument
+    {
+        char pBytes[ 64 ];
+    };
+}
+
+FASTDELEGATE_PASS_BY_REFERENCE( LargeArgument )
+FASTDELEGATE_PASS_BY_REFERENCE( ForwardDeclared )
+FASTDELEGATE_PASS_BY_VALUE( ValueArgument )
+
+namespace
+{
+    // Signals only need their parameter types to be complete where they are used
+    struct ForwardDeclaredHolder
+    {
+        Signal1< ForwardDeclared > oSignal;
+        Signal2< int, ForwardDeclared > oPairSignal;
+    };
+    
+    struct ForwardDeclared
+    {
+        int nValue;
+        char pPadding[ 60 ];
+    };
+    
+    int s_nForwardDeclaredTotal = 0;
+    void OnForwardDeclared( ForwardDeclared oArgument ) { s_nForwardDeclaredTotal += oArgument.nValue; }
+    
+    class LargeArgumentObserver : public SignalObserver
+    {
+    public:
+        LargeArgumentObserver() : m_nTotal(0) {}
+        
+        void OnEmit( LargeArgument oArgument ) { m_nTotal += oArgument.nValue; }
+        void OnEmitReference( const LargeArgument& oArgument ) { m_nTotal += oArgument.nValue; }
+        
+        int m_nTotal;
+    };
+    
+    int s_nLargeArgumentTotal = 0;
+    void OnLargeArgument( LargeArgument oArgument ) { s_nLargeArgumentTotal += oArgument.nValue; }
+    
+    void LargeArgumentTest()
+    {
+        printf( "Testing large argument passing...\n" );
+        
+        JL_COMPILER_ASSERT( ! fastdelegate::ParamTraits< int >::by_reference, Small_Arguments_Are_Passed_By_Value );
+        JL_COMPILER_ASSERT( ! fastdelegate::ParamTraits< void* >::by_reference, Pointers_Are_Passed_By_Value );
+        JL_COMPILER_ASSERT( ! fastdelegate::ParamTraits< const LargeArgument& >::by_reference, References_Are_Passed_As_Declared );
+        JL_COMPILER_ASSERT( fastdelegate::ParamTraits< LargeArgument >::by_reference, Opted_In_Arguments_Are_Passed_By_Reference );
+        JL_COMPILER_ASSERT( fastdelegate::ParamTraits< const LargeArgument >::by_reference, Const_Arguments_Are_Passed_Like_Others );
+        JL_COMPILER_ASSERT( ! fastdelegate::ParamTraits< ValueArgument >::by_reference, Opted_Out_Arguments_Are_Passed_By_Value );
+        
+#if __cplusplus >= 201103L
+        // Types that are large or expensive to copy are passed by reference without opting in
+        struct Pair { int a, b; };
+        struct Matrix { float m[16]; };
+        struct Handle { Handle( const Handle& ) {} int nId; };
+        static_assert( ! fastdelegate::ParamTraits< Pair >::by_reference, "Small arguments are passed by value" );
+        static_assert( fastdelegate::ParamTraits< Matrix >::by_reference, "Large arguments are passed by reference" );
+        static_assert( fastdelegate::ParamTraits< const Matrix >::by_reference, "Const arguments are passed like others" );
+        static_assert( fastdelegate::ParamTraits< Handle >::by_reference, "Arguments with copy constructors are passed by reference" );
+#endif
+        
+        enum { eObservers = 4 };
+        LargeArgumentObserver pObservers[ eObservers ];
+        LargeArgument oArgument;
+        oArgument.nValue = 3;
+        
+        // Each slot that takes the argument by value gets exactly one copy
+        Signal1< LargeArgument > oSignal;
+        oSignal.ConnectMany( pObservers, eObservers, & LargeArgumentObserver::OnEmit );
+        
+        LargeArgument::s_nCopies = 0;
+        oSignal.Emit( oArgument );
+        assert( LargeArgument::s_nCopies == eObservers );
+        assert( pObservers[0].m_nTotal == 3 && pObservers[eObservers - 1].m_nTotal == 3 );
+        
+        // Slots that take a reference get none
+        Signal1< const LargeArgument& > oReferenceSignal;
+        oReferenceSignal.ConnectMany( pObservers, eObservers, & LargeArgumentObserver::OnEmitReference );
+        
+        LargeArgument::s_nCopies = 0;
+        oReferenceSignal.Emit( oArgument );
+        assert( LargeArgument::s_nCopies == 0 );
+        
+        // A forwarding link passes the arguments on as Emit() received them, so it adds no copy
+        Signal1< LargeArgument > oSource;
+        oSource.Forward( & oSignal );
+        
+        LargeArgument::s_nCopies = 0;
+        oSource.Emit( oArgument );
+        assert( LargeArgument::s_nCopies == eObservers );
+        
+        // Non-instance functions are called through the delegate's own invoker, which takes the
+        // declared type too, so they get one extra copy
+        oSignal.DisconnectAll();
+        oSignal.Connect( & OnLargeArgument );
+        
+        LargeArgument::s_nCopies = 0;
+        s_nLargeArgumentTotal = 0;
+        oSignal.Emit( oArgument );
+        assert( LargeArgument::s_nCopies == 2 );
+        assert( s_nLargeArgumentTotal == 3 );
+        
+        // A signal declared while its parameter type was incomplete
+        ForwardDeclaredHolder oHolder;
+        oHolder.oSignal.Connect( & OnForwardDeclared );
+        
+        ForwardDeclared oForwardDeclared;
+        oForwardDeclared.nValue = 5;
+        s_nForwardDeclaredTotal = 0;
+        oHolder.oSignal.Emit( oForwardDeclared );
+        assert( s_nForwardDeclaredTotal == 5 );
+        
+        oHolder.oSignal.DisconnectAll();
+    }
+    
+    // An input handler that consumes the events it handles
+    class InputHandler : public SignalObserver
+    {
+    public:
+        InputHandler() : m_pSignal(NULL), m_nHandleKey(-1), m_nCalls(0) {}
+        
+        void OnKey( int nKey )
+        {
+            s_pLog[ s_nLogCount++ ] = this;
+            ++m_nCalls;
+            
+            if ( nKey == m_nHandleKey )
+            {
+                m_pSignal->Consume();
+            }
+        }
+        
+        // Consumes key 0, then emits key 1 again from inside the slot
+        void OnKeyNested( int nKey )
+        {
+            ++m_nCalls;
+            
+            if ( nKey == 0 )
+            {
+                m_pSignal->Consume();
+                s_bNestedConsumed = m_pSignal->EmitUntilConsumed( 1 );
+                m_pSignal->Emit( 1 );
+            }
+        }
+        
+        const Signal1< int >* m_pSignal;
+        int m_nHandleKey;
+        unsigned m_nCalls;
+        
+        static const InputHandler* s_pLog[ 16 ];
+        static unsigned s_nLogCount;
+        static bool s_bNestedConsumed;
+    };
+    
+    const InputHandler* InputHandler::s_pLog[ 16 ];
+    unsigned InputHandler::s_nLogCount = 0;
+    bool InputHandler::s_bNestedConsumed = false;
+    
+    void ConsumableEmitTest()
+    {
+        printf( "Testing consumable emission...\n" );
+        
+        enum { eHandlers = 4 };
+        InputHandler pHandlers[ eHandlers ];
+        Signal1< int > oKeyPressed;
+        
+        for ( unsigned i = 0; i < eHandlers; ++i )
+        {
+            pHandlers[i].m_pSignal = & oKeyPressed;
+            pHandlers[i].m_nHandleKey = int( i );
+            oKeyPressed.Connect( & pHandlers[i], & InputHandler::OnKey );
+        }
+        
+        // Emission stops at the slot that consumes it
+        InputHandler::s_nLogCount = 0;
+        assert( oKeyPressed.EmitUntilConsumed(1) );
+        assert( InputHandler::s_nLogCount == 2 && pHandlers[2].m_nCalls == 0 );
+        
+        // Unconsumed emissions reach every slot
+        InputHandler::s_nLogCount = 0;
+        assert( ! oKeyPressed.EmitUntilConsumed(10) );
+        assert( InputHandler::s_nLogCount == eHandlers );
+        
+        // Emit() ignores Consume()
+        InputHandler::s_nLogCount = 0;
+        oKeyPressed.Emit( 0 );
+        assert( InputHandler::s_nLogCount == eHandlers );
+        assert( ! oKeyPressed.EmitUntilConsumed(10) );
+        
+        // So does EmitParallel()
+        SerialTaskScheduler oScheduler;
+        InputHandler::s_nLogCount = 0;
+        oKeyPressed.EmitParallel( & oScheduler, 0 );
+        assert( InputHandler::s_nLogCount == eHandlers );
+        assert( ! oKeyPressed.EmitUntilConsumed(10) );
+        
+        // A connection made with eConnectionFlag_First sees emissions before the others, and
+        // the latest one goes first
+        InputHandler oModal;
+        oModal.m_pSignal = & oKeyPressed;
+        oModal.m_nHandleKey = 3;
+        oKeyPressed.Connect( & oModal, & InputHandler::OnKey, SignalBase::eConnectionFlag_First );
+        
+        InputHandler oTopModal;
+        oTopModal.m_pSignal = & oKeyPressed;
+        oKeyPressed.Connect( & oTopModal, & InputHandler::OnKey, SignalBase::eConnectionFlag_First );
+        
+        InputHandler::s_nLogCount = 0;
+        assert( oKeyPressed.EmitUntilConsumed(3) );
+        assert( InputHandler::s_nLogCount == 2 && InputHandler::s_pLog[0] == & oTopModal && InputHandler::s_pLog[1] == & oModal );
+        
+        // Later ordinary connections still go last, and the order holds under grouped dispatch
+        InputHandler oLast;
+        oLast.m_pSignal = & oKeyPressed;
+        oKeyPressed.Connect( & oLast, & InputHandler::OnKey );
+        oKeyPressed.SetGroupedDispatch( true );
+        
+        InputHandler::s_nLogCount = 0;
+        assert( ! oKeyPressed.EmitUntilConsumed(10) );
+        assert( InputHandler::s_nLogCount == eHandlers + 3 );
+        for ( unsigned i = 2; i < InputHandler::s_nLogCount; ++i )
+        {
+            assert( InputHandler::s_pLog[i] != & oTopModal && InputHandler::s_pLog[i] != & oModal );
+        }
+        
+        oKeyPressed.SetGroupedDispatch( false );
+        oKeyPressed.Disconnect( & oModal );
+        oKeyPressed.Disconnect( & oTopModal );
+        oKeyPressed.Disconnect( & oLast );
+        
+        // Nested emissions have their own consumed state, and leave the outer one's alone
+        InputHandler oNesting;
+        oNesting.m_pSignal = & oKeyPressed;
+        oKeyPressed.Connect( & oNesting, & InputHandler::OnKeyNested, SignalBase::eConnectionFlag_First );
+        
+        InputHandler::s_nLogCount = 0;
+        InputHandler::s_bNestedConsumed = false;
+        assert( oKeyPressed.EmitUntilConsumed(0) );
+        assert( InputHandler::s_bNestedConsumed && oNesting.m_nCalls == 3 );
+        
+        // Only the nested emissions reached the other slots: 2 calls until key 1 was consumed,
+        // then every slot for the plain Emit()
+        assert( InputHandler::s_nLogCount == 2 + eHandlers );
+        
+        oKeyPressed.DisconnectAll();
+    }
+    
+    // An observer that disconnects other slots from inside Emit()
+    class Disconnector : public SignalObserver
+    {
+    public:
+        Disconnector() : m_pSignal(NULL), m_pVictim(NULL), m_bDestroyVictim(false), m_bDisconnectAll(false) {}
+        
+        void OnEmit( int n )
+        {
+            if ( m_bDisconnectAll )
+            {
+                m_pSignal->DisconnectAll();
+            }
+            else if ( m_bDestroyVictim )
+            {
+                delete m_pVictim;
+            }
+            else
+            {
+                m_pSignal->Disconnect( m_pVictim );
+            }
+            
+            m_pVictim = NULL;
+        }
+        
+        Signal1< int >* m_pSignal;
+        CountingObserver* m_pVictim;
+        bool m_bDestroyVictim;
+        bool m_bDisconnectAll;
+    };
+    
+    // A function object that disconnects another one
+    struct DisconnectFunctor
+    {
+        Signal1< int >* pSignal;
+        const FunctorConnection* pConnection;
+        
+        void operator()( int n ) const { pSignal->Disconnect( *pConnection ); }
+    };
+    
+    void DisconnectDuringEmitTest()
+    {
+        printf( "Testing disconnection during emission...\n" );
+        
+        StaticSignalConnectionAllocator< 8 > oConnectionAllocator;
+        JL_SIGNAL( int ) oSignal( & oConnectionAllocator );
+        
+        Disconnector oDisconnector;
+        oDisconnector.m_pSignal = & oSignal;
+        CountingObserver oNext;
+        CountingObserver oLast;
+        oSignal.Connect( & oDisconnector, & Disconnector::OnEmit );
+        oSignal.Connect( & oNext, & CountingObserver::OnEmit );
+        oSignal.Connect( & oLast, & CountingObserver::OnEmit );
+        
+        // The next slot isn't called once disconnected, and its node is unlinked after Emit()
+        oDisconnector.m_pVictim = & oNext;
+        CountingObserver::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( CountingObserver::s_nTotal == 1 );
+        assert( oSignal.CountConnections() == 2 && oConnectionAllocator.CountAllocations() == 2 );
+        assert( oNext.CountSignalConnections() == 0 );
+        
+        // Same when the slot's observer is destroyed
+        CountingObserver* pDoomed = new CountingObserver;
+        oSignal.Disconnect( & oDisconnector );
+        oSignal.Connect( pDoomed, & CountingObserver::OnEmit, SignalBase::eConnectionFlag_First );
+        oSignal.Connect( & oDisconnector, & Disconnector::OnEmit, SignalBase::eConnectionFlag_First );
+        oDisconnector.m_pVictim = pDoomed;
+        oDisconnector.m_bDestroyVictim = true;
+        CountingObserver::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( CountingObserver::s_nTotal == 1 );
+        assert( oSignal.CountConnections() == 2 && oConnectionAllocator.CountAllocations() == 2 );
+        oSignal.Disconnect( & oDisconnector );
+        oDisconnector.m_bDestroyVictim = false;
+        
+        // A functor disconnecting the next functor, whose copy stays valid until Emit() returns
+        int nTotal = 0;
+        const AddTo oAdd = { & nTotal, 1 };
+        FunctorConnection oAddConnection;
+        const DisconnectFunctor oDisconnect = { & oSignal, & oAddConnection };
+        const FunctorConnection oDisconnectConnection = oSignal.Connect( oDisconnect );
+        oAddConnection = oSignal.Connect( oAdd );
+        
+        CountingObserver::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( nTotal == 0 && CountingObserver::s_nTotal == 1 );
+        assert( oSignal.CountConnections() == 2 && oConnectionAllocator.CountAllocations() == 3 );
+        oSignal.Disconnect( oDisconnectConnection );
+        
+        // Disconnecting everything, including the emitting slot
+        oSignal.Connect( & oDisconnector, & Disconnector::OnEmit, SignalBase::eConnectionFlag_First );
+        oDisconnector.m_bDisconnectAll = true;
+        CountingObserver::s_nTotal = 0;
+        oSignal.Emit( 1 );
+        assert( CountingObserver::s_nTotal == 0 );
+        assert( oSignal.CountConnections() == 0 && oConnectionAllocator.CountAllocations() == 0 );
+        assert( oDisconnector.CountSignalConnections() == 0 && oLast.CountSignalConnections() == 0 );
+    }
 } // anonymous namespace
 
 void SignalTest()
@@ -666,4 +1697,15 @@ void SignalTest()
         printf( "Arity %d, Connections: %d, Calls: %d\n", i, nConnections, nCalls);
         assert( ppSignalsByArity[i]->CountConnections() == TestObserver::CountCallsByArity(i) );
     }    
+    
+    ForwardTest();
+    GroupedDispatchTest();
+    ConnectManyTest();
+    DisconnectObserversTest();
+    FunctorTest();
+    ConnectionIndexTest();
+    WeakConnectionTest();
+    LargeArgumentTest();
+    ConsumableEmitTest();
+    DisconnectDuringEmitTest();
 }
\ No newline at end of file
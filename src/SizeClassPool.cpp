@@ -0,0 +1,205 @@
+#include <stddef.h>
+
+#include "SizeClassPool.h"
+
+jl::SizeClassPool::SizeClassPool()
+{
+    m_pPageBuffer = NULL;
+    m_pPageInfo = NULL;
+    m_nPageCount = 0;
+    m_nPageSize = 0;
+    m_nFreePageHead = eNoPage;
+    m_nFreePages = 0;
+    m_nAllocations = 0;
+    
+    for ( unsigned i = 0; i < eSizeClassCount; ++i )
+    {
+        m_pAvailableHead[i] = eNoPage;
+    }
+}
+
+void jl::SizeClassPool::Init( void* pPageBuffer, PageInfo* pPageInfo, unsigned nPageCount, unsigned nPageSize )
+{
+    JL_ASSERT( pPageBuffer && pPageInfo && nPageCount > 0 );
+    JL_ASSERT( nPageSize >= eGranularity && nPageSize % eGranularity == 0 );
+    JL_ASSERT( (size_t)pPageBuffer % eGranularity == 0 );
+    
+    m_pPageBuffer = static_cast<unsigned char*>( pPageBuffer );
+    m_pPageInfo = pPageInfo;
+    m_nPageCount = nPageCount;
+    m_nPageSize = nPageSize;
+    m_nAllocations = 0;
+    
+    for ( unsigned i = 0; i < eSizeClassCount; ++i )
+    {
+        m_pAvailableHead[i] = eNoPage;
+    }
+    
+    // Every page starts out on the free page list, in address order
+    for ( unsigned i = 0; i < nPageCount; ++i )
+    {
+        PageInfo& oPage = pPageInfo[i];
+        oPage.pFreeList = NULL;
+        oPage.nSizeClass = eSizeClassCount;
+        oPage.nLive = 0;
+        oPage.nCarved = 0;
+        oPage.nPrev = eNoPage;
+        oPage.nNext = i + 1 < nPageCount ? i + 1 : eNoPage;
+    }
+    
+    m_nFreePageHead = 0;
+    m_nFreePages = nPageCount;
+}
+
+void* jl::SizeClassPool::Alloc( size_t nBytes )
+{
+    JL_ASSERT( nBytes > 0 && nBytes <= eMaxObjectSize && nBytes <= m_nPageSize );
+    if ( nBytes == 0 || nBytes > eMaxObjectSize || nBytes > m_nPageSize )
+    {
+        return NULL;
+    }
+    
+    const unsigned nSizeClass = unsigned( (nBytes - 1) / eGranularity );
+    unsigned nPage = m_pAvailableHead[nSizeClass];
+    
+    if ( nPage == eNoPage )
+    {
+        nPage = TakeFreePage( nSizeClass );
+        
+        if ( nPage == eNoPage )
+        {
+            return NULL;
+        }
+    }
+    
+    PageInfo& oPage = m_pPageInfo[nPage];
+    const unsigned nObjectSize = ( nSizeClass + 1 ) * eGranularity;
+    const unsigned nPageCapacity = m_nPageSize / nObjectSize;
+    void* pObject;
+    
+    // Reuse freed objects first, then carve new ones from the untouched tail
+    if ( oPage.pFreeList )
+    {
+        pObject = oPage.pFreeList;
+        oPage.pFreeList = *static_cast<void**>( pObject );
+    }
+    else
+    {
+        JL_ASSERT( oPage.nCarved < nPageCapacity );
+        pObject = m_pPageBuffer + size_t(nPage) * m_nPageSize + oPage.nCarved * nObjectSize;
+        ++oPage.nCarved;
+    }
+    
+    ++oPage.nLive;
+    ++m_nAllocations;
+    
+    if ( oPage.nLive == nPageCapacity )
+    {
+        UnlinkAvailablePage( nPage );
+    }
+    
+    return pObject;
+}
+
+void jl::SizeClassPool::Free( void* pObject )
+{
+    if ( ! pObject )
+    {
+        return;
+    }
+    
+    const ptrdiff_t nOffset = static_cast<unsigned char*>( pObject ) - m_pPageBuffer;
+    JL_ASSERT( nOffset >= 0 && size_t(nOffset) < size_t(m_nPageCount) * m_nPageSize );
+    
+    const unsigned nPage = unsigned( size_t(nOffset) / m_nPageSize );
+    PageInfo& oPage = m_pPageInfo[nPage];
+    JL_ASSERT( oPage.nSizeClass < eSizeClassCount && oPage.nLive > 0 );
+    
+    const unsigned nObjectSize = ( oPage.nSizeClass + 1 ) * eGranularity;
+    const unsigned nPageCapacity = m_nPageSize / nObjectSize;
+    JL_ASSERT( ( size_t(nOffset) % m_nPageSize ) % nObjectSize == 0 );
+    
+    // A full page has room again
+    if ( oPage.nLive == nPageCapacity )
+    {
+        LinkAvailablePage( nPage );
+    }
+    
+    --oPage.nLive;
+    --m_nAllocations;
+    
+    if ( oPage.nLive == 0 )
+    {
+        // Return the page to the shared list, for any size class to use
+        UnlinkAvailablePage( nPage );
+        oPage.pFreeList = NULL;
+        oPage.nSizeClass = eSizeClassCount;
+        oPage.nCarved = 0;
+        oPage.nNext = m_nFreePageHead;
+        m_nFreePageHead = nPage;
+        ++m_nFreePages;
+    }
+    else
+    {
+        *static_cast<void**>( pObject ) = oPage.pFreeList;
+        oPage.pFreeList = pObject;
+    }
+}
+
+unsigned jl::SizeClassPool::TakeFreePage( unsigned nSizeClass )
+{
+    const unsigned nPage = m_nFreePageHead;
+    
+    if ( nPage == eNoPage )
+    {
+        return eNoPage;
+    }
+    
+    PageInfo& oPage = m_pPageInfo[nPage];
+    m_nFreePageHead = oPage.nNext;
+    --m_nFreePages;
+    
+    oPage.nSizeClass = nSizeClass;
+    LinkAvailablePage( nPage );
+    
+    return nPage;
+}
+
+void jl::SizeClassPool::LinkAvailablePage( unsigned nPage )
+{
+    PageInfo& oPage = m_pPageInfo[nPage];
+    unsigned& nHead = m_pAvailableHead[ oPage.nSizeClass ];
+    
+    oPage.nPrev = eNoPage;
+    oPage.nNext = nHead;
+    
+    if ( nHead != eNoPage )
+    {
+        m_pPageInfo[nHead].nPrev = nPage;
+    }
+    
+    nHead = nPage;
+}
+
+void jl::SizeClassPool::UnlinkAvailablePage( unsigned nPage )
+{
+    PageInfo& oPage = m_pPageInfo[nPage];
+    
+    if ( oPage.nPrev != eNoPage )
+    {
+        m_pPageInfo[ oPage.nPrev ].nNext = oPage.nNext;
+    }
+    else
+    {
+        JL_ASSERT( m_pAvailableHead[ oPage.nSizeClass ] == nPage );
+        m_pAvailableHead[ oPage.nSizeClass ] = oPage.nNext;
+    }
+    
+    if ( oPage.nNext != eNoPage )
+    {
+        m_pPageInfo[ oPage.nNext ].nPrev = oPage.nPrev;
+    }
+    
+    oPage.nPrev = eNoPage;
+    oPage.nNext = eNoPage;
+}
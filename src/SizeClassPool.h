@@ -0,0 +1,118 @@
+#ifndef _JL_SIZE_CLASS_POOL_H_
+#define _JL_SIZE_CLASS_POOL_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+#include "ScopedAllocator.h"
+
+namespace jl {
+
+/**
+ * A pool that serves objects of many sizes from one set of fixed-size pages.
+ * Requests are rounded up to a multiple of eGranularity bytes, and each of
+ * these size classes carves its objects out of pages taken from a shared list
+ * of free pages. A page that becomes empty goes back to the shared list, so
+ * capacity that one size class no longer needs can serve another.
+ *
+ * PRO:
+ *    O(1) allocate and free
+ *    One pool can serve signal and observer connections, so only their
+ *    combined peak needs to be reserved
+ *
+ * CON:
+ *    Objects can't be larger than eMaxObjectSize or a page
+ *    Partly used pages of one size class can't serve other size classes
+ *
+ * The caller provides the page buffer and one PageInfo per page.
+ */
+class SizeClassPool
+{
+public:
+    enum
+    {
+        eGranularity = 8,
+        eSizeClassCount = 32,
+        eMaxObjectSize = eGranularity * eSizeClassCount,
+        eNoPage = 0xFFFFFFFF,
+    };
+    
+    // Bookkeeping for a single page, kept outside the page itself
+    struct PageInfo
+    {
+        void* pFreeList;        // freed objects in this page
+        unsigned nSizeClass;    // eSizeClassCount if the page is unused
+        unsigned nLive;         // live objects in this page
+        unsigned nCarved;       // objects handed out from the page's untouched tail so far
+        unsigned nPrev;         // links in the size class's list of pages with room,
+        unsigned nNext;         // or the free page list
+    };
+    
+    SizeClassPool();
+    
+    // pPageBuffer must be aligned to eGranularity, and nPageSize must be a multiple of it.
+    void Init( void* pPageBuffer, PageInfo* pPageInfo, unsigned nPageCount, unsigned nPageSize );
+    
+    void* Alloc( size_t nBytes );
+    void Free( void* pObject );
+    
+    unsigned GetPageSize() const { return m_nPageSize; }
+    unsigned GetPageCount() const { return m_nPageCount; }
+    unsigned CountFreePages() const { return m_nFreePages; }
+    unsigned CountAllocations() const { return m_nAllocations; }
+    
+private:
+    unsigned TakeFreePage( unsigned nSizeClass );
+    void LinkAvailablePage( unsigned nPage );
+    void UnlinkAvailablePage( unsigned nPage );
+    
+    unsigned char* m_pPageBuffer;
+    PageInfo* m_pPageInfo;
+    unsigned m_nPageCount;
+    unsigned m_nPageSize;
+    unsigned m_nFreePageHead;
+    unsigned m_nFreePages;
+    unsigned m_nAllocations;
+    
+    // Per size class: the first page that has room
+    unsigned m_pAvailableHead[ eSizeClassCount ];
+};
+
+// A ScopedAllocator with a built-in SizeClassPool of _PageCount pages
+template< unsigned _PageSize, unsigned _PageCount >
+class StaticSizeClassPoolAllocator : public ScopedAllocator
+{
+public:
+    JL_COMPILER_ASSERT( _PageSize % SizeClassPool::eGranularity == 0, Page_Size_Must_Be_A_Multiple_Of_Granularity );
+    
+    StaticSizeClassPoolAllocator()
+    {
+        m_oPool.Init( m_oBuffer.pBytes, m_pPageInfo, _PageCount, _PageSize );
+    }
+    
+    unsigned CountAllocations() const { return m_oPool.CountAllocations(); }
+    unsigned CountFreePages() const { return m_oPool.CountFreePages(); }
+    
+    SizeClassPool& GetPool() { return m_oPool; }
+    const SizeClassPool& GetPool() const { return m_oPool; }
+    
+    // Virtual overrides
+    void* Alloc( size_t nBytes ) { return m_oPool.Alloc( nBytes ); }
+    void Free( void* pObject ) { m_oPool.Free( pObject ); }
+    
+private:
+    union Buffer
+    {
+        unsigned char pBytes[ _PageSize * _PageCount ];
+        void* pAlignPointer;
+        double fAlignDouble;
+    };
+    
+    SizeClassPool m_oPool;
+    SizeClassPool::PageInfo m_pPageInfo[ _PageCount ];
+    Buffer m_oBuffer;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_SIZE_CLASS_POOL_H_ )
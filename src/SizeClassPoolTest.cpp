@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "SizeClassPool.h"
+
+using namespace jl;
+
+namespace
+{
+    class PoolObserver : public SignalObserver
+    {
+    public:
+        void OnEmit( int n ) { s_nTotal += n; }
+
+        static int s_nTotal;
+    };
+
+    int PoolObserver::s_nTotal = 0;
+
+    typedef Signal1< int > PoolSignal;
+
+    enum { ePageSize = 1024, ePageCount = 16, eSmall = 16, eLarge = 48 };
+}
+
+void SizeClassPoolTest()
+{
+    printf( "Testing size class pool...\n" );
+
+    StaticSizeClassPoolAllocator< ePageSize, ePageCount > oAllocator;
+    assert( oAllocator.CountFreePages() == ePageCount );
+
+    // Requests are rounded up to the granularity, and sizes in one class share pages
+    void* p1 = oAllocator.Alloc( 1 );
+    void* p2 = oAllocator.Alloc( SizeClassPool::eGranularity );
+    assert( p1 && p2 );
+    assert( (char*)p2 - (char*)p1 == SizeClassPool::eGranularity );
+    assert( oAllocator.CountFreePages() == ePageCount - 1 );
+
+    // Another size class takes another page
+    void* p3 = oAllocator.Alloc( SizeClassPool::eGranularity + 1 );
+    assert( p3 && (size_t)p3 % SizeClassPool::eGranularity == 0 );
+    assert( oAllocator.CountFreePages() == ePageCount - 2 );
+    assert( oAllocator.CountAllocations() == 3 );
+
+    // Freed objects are reused first
+    oAllocator.Free( p1 );
+    assert( oAllocator.Alloc(4) == p1 );
+
+    // Empty pages go back to the shared list
+    oAllocator.Free( p1 );
+    oAllocator.Free( p2 );
+    oAllocator.Free( p3 );
+    assert( oAllocator.CountAllocations() == 0 );
+    assert( oAllocator.CountFreePages() == ePageCount );
+
+    // Filling the pool with one size class, then freeing it, leaves all of it
+    // for another size class
+    void* pObjects[ ePageCount * ePageSize / eSmall + 1 ];
+    unsigned nObjects = 0;
+
+    while ( (pObjects[nObjects] = oAllocator.GetPool().Alloc(eSmall)) != NULL )
+    {
+        ++nObjects;
+    }
+
+    assert( nObjects == ePageCount * ePageSize / eSmall );
+    assert( oAllocator.CountFreePages() == 0 );
+
+    for ( unsigned i = 0; i < nObjects; ++i )
+    {
+        oAllocator.Free( pObjects[i] );
+    }
+
+    assert( oAllocator.CountFreePages() == ePageCount );
+    nObjects = 0;
+
+    while ( (pObjects[nObjects] = oAllocator.GetPool().Alloc(eLarge)) != NULL )
+    {
+        ++nObjects;
+    }
+
+    assert( nObjects == ePageCount * (ePageSize / eLarge) );
+
+    // Freeing from a full page makes room again
+    oAllocator.Free( pObjects[nObjects / 2] );
+    assert( oAllocator.Alloc(eLarge) == pObjects[nObjects / 2] );
+
+    for ( unsigned i = 0; i < nObjects; ++i )
+    {
+        oAllocator.Free( pObjects[i] );
+    }
+
+    assert( oAllocator.CountAllocations() == 0 && oAllocator.CountFreePages() == ePageCount );
+
+    // One pool serves both signal and observer connections
+    SignalBase::SetCommonConnectionAllocator( & oAllocator );
+    SignalObserver::SetCommonConnectionAllocator( & oAllocator );
+
+    {
+        PoolSignal pSignals[4];
+        PoolObserver pObservers[16];
+
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(pSignals); ++i )
+        {
+            for ( unsigned j = 0; j < JL_ARRAY_SIZE(pObservers); ++j )
+            {
+                pSignals[i].Connect( & pObservers[j], & PoolObserver::OnEmit );
+            }
+        }
+
+        assert( oAllocator.CountAllocations() == 2 * JL_ARRAY_SIZE(pSignals) * JL_ARRAY_SIZE(pObservers) );
+
+        PoolObserver::s_nTotal = 0;
+        for ( unsigned i = 0; i < JL_ARRAY_SIZE(pSignals); ++i )
+        {
+            pSignals[i].Emit( 1 );
+        }
+
+        assert( PoolObserver::s_nTotal == int(JL_ARRAY_SIZE(pSignals) * JL_ARRAY_SIZE(pObservers)) );
+    }
+
+    assert( oAllocator.CountAllocations() == 0 && oAllocator.CountFreePages() == ePageCount );
+
+    SignalBase::SetCommonConnectionAllocator( NULL );
+    SignalObserver::SetCommonConnectionAllocator( NULL );
+}
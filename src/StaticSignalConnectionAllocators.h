@@ -8,13 +8,26 @@ namespace jl {
 
 typedef Signal0<void> TDummySignal;
 
-template< unsigned _Size >
-class StaticSignalConnectionAllocator : public StaticObjectPoolAllocator< TDummySignal::eAllocationSize, _Size >
+// _Flags are StaticObjectPool flags, e.g. ObjectPool::eFlag_AddressOrdered, and
+// _Alignment is the StaticObjectPool buffer alignment, e.g. ObjectPool::eCacheLineSize.
+template< unsigned _Size, unsigned _Flags = 0, unsigned _Alignment = 0 >
+class StaticSignalConnectionAllocator : public StaticObjectPoolAllocator< TDummySignal::eAllocationSize, _Size, _Flags, _Alignment >
 {
 };
 
-template< unsigned _Size >
-class StaticObserverConnectionAllocator : public StaticObjectPoolAllocator< SignalObserver::eAllocationSize, _Size >
+template< unsigned _Size, unsigned _Flags = 0, unsigned _Alignment = 0 >
+class StaticObserverConnectionAllocator : public StaticObjectPoolAllocator< SignalObserver::eAllocationSize, _Size, _Flags, _Alignment >
+{
+};
+
+// Per-thread connection pools; see ShardedObjectPoolAllocator.
+template< unsigned _SizePerShard, unsigned _MaxShards, unsigned _Flags = 0 >
+class ShardedSignalConnectionAllocator : public ShardedObjectPoolAllocator< TDummySignal::eAllocationSize, _SizePerShard, _MaxShards, _Flags >
+{
+};
+
+template< unsigned _SizePerShard, unsigned _MaxShards, unsigned _Flags = 0 >
+class ShardedObserverConnectionAllocator : public ShardedObjectPoolAllocator< SignalObserver::eAllocationSize, _SizePerShard, _MaxShards, _Flags >
 {
 };
     
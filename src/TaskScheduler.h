@@ -0,0 +1,43 @@
+#ifndef _JL_TASK_SCHEDULER_H_
+#define _JL_TASK_SCHEDULER_H_
+
+namespace jl {
+
+/**
+ * An interface for running batches of independent tasks, possibly in parallel.
+ * SignalN::EmitParallel() uses this to spread slots across threads. See
+ * WorkStealingTaskScheduler for a thread pool implementation.
+ */
+class TaskScheduler
+{
+public:
+    typedef void (*TaskFunction)( void* pContext, unsigned nTask );
+    
+    // The largest batch that EmitParallel() will submit in a single Run()
+    enum { eMaxTasks = 256 };
+    
+    virtual ~TaskScheduler() {};
+    
+    // Calls fpTask( pContext, i ) for every i in [0, nTasks), in any order and
+    // on any thread, and returns once every call has finished.
+    virtual void Run( TaskFunction fpTask, void* pContext, unsigned nTasks ) = 0;
+};
+
+/**
+ * Runs every task in order on the calling thread.
+ */
+class SerialTaskScheduler : public TaskScheduler
+{
+public:
+    void Run( TaskFunction fpTask, void* pContext, unsigned nTasks )
+    {
+        for ( unsigned i = 0; i < nTasks; ++i )
+        {
+            fpTask( pContext, i );
+        }
+    }
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_TASK_SCHEDULER_H_ )
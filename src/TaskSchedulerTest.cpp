@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "Signal.h"
+#include "StaticSignalConnectionAllocators.h"
+#include "WorkStealingTaskScheduler.h"
+
+using namespace jl;
+
+namespace
+{
+    enum { eParallelObservers = 1000, eSerialObservers = 8, eMaxConnections = 2048 };
+
+    class ParallelObserver : public SignalObserver
+    {
+    public:
+        ParallelObserver() : m_nCalls(0), m_nTotal(0) {}
+
+        void OnEmit( int nValue, int nScale )
+        {
+            ++m_nCalls;
+            m_nTotal += nValue * nScale;
+        }
+
+        unsigned m_nCalls;
+        int m_nTotal;
+    };
+
+    // Serial slots record the order they were called in
+    class SerialObserver : public SignalObserver
+    {
+    public:
+        SerialObserver() : m_nId(0), m_pOrder(NULL), m_pCount(NULL) {}
+
+        void OnEmit( int nValue, int nScale )
+        {
+            JL_UNUSED( nValue );
+            JL_UNUSED( nScale );
+            m_pOrder[ (*m_pCount)++ ] = m_nId;
+        }
+
+        unsigned m_nId;
+        unsigned* m_pOrder;
+        unsigned* m_pCount;
+    };
+
+    void EmitParallelTest( TaskScheduler* pScheduler, unsigned nEmissions )
+    {
+        typedef Signal2< int, int > TestSignal;
+        TestSignal oSignal;
+        ParallelObserver* pParallel = new ParallelObserver[ eParallelObservers ];
+        SerialObserver pSerial[ eSerialObservers ];
+        unsigned pOrder[ eSerialObservers ];
+        unsigned nOrderCount = 0;
+
+        // Interleave serial and parallel-safe connections
+        for ( unsigned i = 0; i < eParallelObservers; ++i )
+        {
+            if ( i % (eParallelObservers / eSerialObservers) == 0 )
+            {
+                const unsigned nSerial = i / ( eParallelObservers / eSerialObservers );
+                pSerial[nSerial].m_nId = nSerial;
+                pSerial[nSerial].m_pOrder = pOrder;
+                pSerial[nSerial].m_pCount = & nOrderCount;
+                oSignal.Connect( & pSerial[nSerial], & SerialObserver::OnEmit );
+            }
+
+            oSignal.Connect( & pParallel[i], & ParallelObserver::OnEmit, SignalBase::eConnectionFlag_ParallelSafe );
+        }
+
+        for ( unsigned nEmission = 1; nEmission <= nEmissions; ++nEmission )
+        {
+            nOrderCount = 0;
+            oSignal.EmitParallel( pScheduler, 2, 3 );
+
+            for ( unsigned i = 0; i < eParallelObservers; ++i )
+            {
+                assert( pParallel[i].m_nCalls == nEmission );
+                assert( pParallel[i].m_nTotal == (int)nEmission * 6 );
+            }
+
+            // Serial slots run exactly once each, in connection order
+            assert( nOrderCount == eSerialObservers );
+            for ( unsigned i = 0; i < eSerialObservers; ++i )
+            {
+                assert( pOrder[i] == i );
+            }
+        }
+
+        assert( oSignal.CountEmissions() == nEmissions );
+
+        oSignal.DisconnectAll();
+        delete[] pParallel;
+    }
+
+#if JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+    struct RunTestContext
+    {
+        std::atomic<unsigned>* pCounts;
+        TaskScheduler* pScheduler;
+        std::atomic<unsigned> nNestedCalls;
+    };
+
+    void CountNested( void* pContext, unsigned nTask )
+    {
+        JL_UNUSED( nTask );
+        static_cast<RunTestContext*>( pContext )->nNestedCalls.fetch_add( 1 );
+    }
+
+    void CountTask( void* pContext, unsigned nTask )
+    {
+        RunTestContext* pTest = static_cast<RunTestContext*>( pContext );
+        pTest->pCounts[nTask].fetch_add( 1 );
+
+        // Nested batches run inline
+        if ( nTask % 100 == 0 )
+        {
+            pTest->pScheduler->Run( & CountNested, pTest, 3 );
+        }
+    }
+#endif
+}
+
+void TaskSchedulerTest()
+{
+    StaticSignalConnectionAllocator< eMaxConnections > oSignalConnectionAllocator;
+    StaticObserverConnectionAllocator< eMaxConnections > oObserverConnectionAllocator;
+    SignalBase::SetCommonConnectionAllocator( & oSignalConnectionAllocator );
+    SignalObserver::SetCommonConnectionAllocator( & oObserverConnectionAllocator );
+
+    printf( "Testing EmitParallel() with a serial scheduler...\n" );
+    SerialTaskScheduler oSerialScheduler;
+    EmitParallelTest( & oSerialScheduler, 3 );
+
+#if JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+    printf( "Testing WorkStealingTaskScheduler...\n" );
+    WorkStealingTaskScheduler oScheduler( 3 );
+    assert( oScheduler.CountThreads() == 4 );
+
+    enum { eTasks = 10000 };
+    std::atomic<unsigned>* pCounts = new std::atomic<unsigned>[ eTasks ];
+
+    for ( unsigned nBatch = 0; nBatch < 20; ++nBatch )
+    {
+        const unsigned nTasks = nBatch == 0 ? 1 : eTasks / nBatch;
+
+        for ( unsigned i = 0; i < nTasks; ++i )
+        {
+            pCounts[i].store( 0 );
+        }
+
+        RunTestContext oContext;
+        oContext.pCounts = pCounts;
+        oContext.pScheduler = & oScheduler;
+        oContext.nNestedCalls.store( 0 );
+
+        oScheduler.Run( & CountTask, & oContext, nTasks );
+
+        // Every task runs exactly once
+        for ( unsigned i = 0; i < nTasks; ++i )
+        {
+            assert( pCounts[i].load() == 1 );
+        }
+
+        assert( oContext.nNestedCalls.load() == 3 * ( (nTasks + 99) / 100 ) );
+    }
+
+    delete[] pCounts;
+
+    printf( "Testing EmitParallel() with a work-stealing scheduler...\n" );
+    EmitParallelTest( & oScheduler, 50 );
+#endif
+
+    assert( oSignalConnectionAllocator.CountAllocations() == 0 );
+    assert( oObserverConnectionAllocator.CountAllocations() == 0 );
+
+    SignalBase::SetCommonConnectionAllocator( NULL );
+    SignalObserver::SetCommonConnectionAllocator( NULL );
+}
@@ -17,8 +17,14 @@
 #define JL_ASSERT( _Expr )
 #endif
 
-// A handy compile-time assert
+// A handy compile-time assert. Usable at function scope without unused typedef warnings.
+#if __cplusplus >= 201103L
+#define JL_COMPILER_ASSERT( _Expr, _Message ) static_assert( _Expr, #_Message )
+#elif defined( __GNUC__ ) || defined( __clang__ )
+#define JL_COMPILER_ASSERT( _Expr, _Message ) typedef int JL_COMPILER_ASSERT_##_Message[ _Expr ? 0 : -1 ] __attribute__(( unused ))
+#else
 #define JL_COMPILER_ASSERT( _Expr, _Message ) typedef int JL_COMPILER_ASSERT_##_Message[ _Expr ? 0 : -1 ]
+#endif
 
 //////////////////////////////
 // II. Miscellaneous utilities
@@ -27,6 +33,25 @@
 #define JL_UNUSED( _a ) (void)( _a )
 
 namespace jl {
+
+// Returns the index of the lowest set bit. The argument must be non-zero.
+inline unsigned CountTrailingZeros( unsigned n )
+{
+    JL_ASSERT( n != 0 );
+#if defined( __GNUC__ ) || defined( __clang__ )
+    return (unsigned)__builtin_ctz( n );
+#else
+    unsigned nIndex = 0;
+    
+    while ( ( n & 1 ) == 0 )
+    {
+        n >>= 1;
+        ++nIndex;
+    }
+    
+    return nIndex;
+#endif
+}
     
 template< typename _to, typename _from >
 _to BruteForceCast( _from p )
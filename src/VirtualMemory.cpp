@@ -0,0 +1,181 @@
+#include "VirtualMemory.h"
+
+#if JL_ENABLE_VIRTUAL_MEMORY
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace jl {
+    namespace
+    {
+        // The usual huge page size on x86-64 and ARM64. Commits are made in
+        // units of this size, so that each commit can be backed by one page.
+        enum { eHugePageSize = 2 * 1024 * 1024 };
+
+        size_t RoundUp( size_t n, size_t nAlignment )
+        {
+            return ( n + nAlignment - 1 ) / nAlignment * nAlignment;
+        }
+    } // anon namespace
+} // namespace jl
+
+#if defined( _WIN32 )
+
+size_t jl::VirtualMemory::GetPageSize()
+{
+    SYSTEM_INFO oInfo;
+    GetSystemInfo( & oInfo );
+    return oInfo.dwPageSize;
+}
+
+// Windows huge pages require the "Lock pages in memory" privilege and must be
+// committed along with the reservation, so requests for them are ignored.
+void* jl::VirtualMemory::Reserve( size_t& nBytes, unsigned nFlags, size_t& nGranularity, bool& bHugePages )
+{
+    JL_UNUSED( nFlags );
+    nGranularity = GetPageSize();
+    nBytes = RoundUp( nBytes, nGranularity );
+    bHugePages = false;
+
+    return VirtualAlloc( NULL, nBytes, MEM_RESERVE, PAGE_NOACCESS );
+}
+
+bool jl::VirtualMemory::Commit( void* pAddress, size_t nBytes )
+{
+    return VirtualAlloc( pAddress, nBytes, MEM_COMMIT, PAGE_READWRITE ) != NULL;
+}
+
+void jl::VirtualMemory::Release( void* pAddress, size_t nBytes )
+{
+    JL_UNUSED( nBytes );
+    VirtualFree( pAddress, 0, MEM_RELEASE );
+}
+
+#else // POSIX
+
+#if ! defined( MAP_ANONYMOUS ) && defined( MAP_ANON )
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#if ! defined( MAP_NORESERVE )
+#define MAP_NORESERVE 0
+#endif
+
+size_t jl::VirtualMemory::GetPageSize()
+{
+    return (size_t)sysconf( _SC_PAGESIZE );
+}
+
+void* jl::VirtualMemory::Reserve( size_t& nBytes, unsigned nFlags, size_t& nGranularity, bool& bHugePages )
+{
+    const int nMapFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+
+#if defined( MAP_HUGETLB )
+    if ( nFlags & eFlag_ExplicitHugePages )
+    {
+        // Without MAP_NORESERVE, the kernel sets aside enough huge pages for
+        // the whole range now, and fails here instead of raising SIGBUS when a
+        // committed page is first touched.
+        const size_t nHugeBytes = RoundUp( nBytes, eHugePageSize );
+        void* p = mmap( NULL, nHugeBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+
+        if ( p != MAP_FAILED )
+        {
+            nBytes = nHugeBytes;
+            nGranularity = eHugePageSize;
+            bHugePages = true;
+            return p;
+        }
+    }
+#endif
+
+    if ( nFlags & ( eFlag_TransparentHugePages | eFlag_ExplicitHugePages ) )
+    {
+        // Transparent huge pages are only used for aligned 2 MB ranges, so
+        // over-reserve and trim the misaligned ends.
+        const size_t nHugeBytes = RoundUp( nBytes, eHugePageSize );
+        void* p = mmap( NULL, nHugeBytes + eHugePageSize, PROT_NONE, nMapFlags, -1, 0 );
+
+        if ( p == MAP_FAILED )
+        {
+            return NULL;
+        }
+
+        unsigned char* const pRaw = static_cast<unsigned char*>( p );
+        unsigned char* const pAligned = reinterpret_cast<unsigned char*>( RoundUp((size_t)pRaw, eHugePageSize) );
+
+        if ( pAligned > pRaw )
+        {
+            munmap( pRaw, pAligned - pRaw );
+        }
+
+        if ( pRaw + eHugePageSize > pAligned )
+        {
+            munmap( pAligned + nHugeBytes, pRaw + eHugePageSize - pAligned );
+        }
+
+        nBytes = nHugeBytes;
+        nGranularity = eHugePageSize;
+        bHugePages = false;
+
+#if defined( MADV_HUGEPAGE )
+        bHugePages = madvise( pAligned, nHugeBytes, MADV_HUGEPAGE ) == 0;
+#endif
+
+        return pAligned;
+    }
+
+    nGranularity = GetPageSize();
+    nBytes = RoundUp( nBytes, nGranularity );
+    bHugePages = false;
+
+    void* p = mmap( NULL, nBytes, PROT_NONE, nMapFlags, -1, 0 );
+    return p != MAP_FAILED ? p : NULL;
+}
+
+bool jl::VirtualMemory::Commit( void* pAddress, size_t nBytes )
+{
+    return mprotect( pAddress, nBytes, PROT_READ | PROT_WRITE ) == 0;
+}
+
+void jl::VirtualMemory::Release( void* pAddress, size_t nBytes )
+{
+    munmap( pAddress, nBytes );
+}
+
+#endif // POSIX
+
+#else // ! JL_ENABLE_VIRTUAL_MEMORY
+
+size_t jl::VirtualMemory::GetPageSize()
+{
+    return 0;
+}
+
+void* jl::VirtualMemory::Reserve( size_t& nBytes, unsigned nFlags, size_t& nGranularity, bool& bHugePages )
+{
+    JL_UNUSED( nBytes );
+    JL_UNUSED( nFlags );
+    nGranularity = 0;
+    bHugePages = false;
+    return NULL;
+}
+
+bool jl::VirtualMemory::Commit( void* pAddress, size_t nBytes )
+{
+    JL_UNUSED( pAddress );
+    JL_UNUSED( nBytes );
+    return false;
+}
+
+void jl::VirtualMemory::Release( void* pAddress, size_t nBytes )
+{
+    JL_UNUSED( pAddress );
+    JL_UNUSED( nBytes );
+}
+
+#endif // ! JL_ENABLE_VIRTUAL_MEMORY
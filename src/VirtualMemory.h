@@ -0,0 +1,57 @@
+#ifndef _JL_VIRTUAL_MEMORY_H_
+#define _JL_VIRTUAL_MEMORY_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+
+// Address space reservation is available on POSIX systems and Windows. Define
+// JL_ENABLE_VIRTUAL_MEMORY to 0 to disable it explicitly.
+#ifndef JL_ENABLE_VIRTUAL_MEMORY
+#if defined( _WIN32 ) || defined( __unix__ ) || defined( __APPLE__ )
+#define JL_ENABLE_VIRTUAL_MEMORY 1
+#else
+#define JL_ENABLE_VIRTUAL_MEMORY 0
+#endif
+#endif
+
+namespace jl {
+
+/**
+ * Thin wrappers around the OS virtual memory API, for buffers that reserve a
+ * large range of addresses up front and only back it with memory as needed.
+ *
+ * Reserved memory can't be touched until it is committed. Commit() and
+ * Release() take ranges aligned to the granularity returned by Reserve().
+ */
+namespace VirtualMemory
+{
+    enum
+    {
+        // Linux only: ask for transparent huge pages. Ignored elsewhere.
+        eFlag_TransparentHugePages = 0x01,
+
+        // Linux only: back the reservation with preallocated hugetlbfs pages.
+        // Falls back to transparent huge pages if none are available.
+        eFlag_ExplicitHugePages = 0x02,
+    };
+
+    // Returns the OS page size, or 0 if virtual memory is unavailable.
+    size_t GetPageSize();
+
+    // Reserves at least nBytes of address space. On success, nBytes is rounded
+    // up to the commit granularity, which is returned in nGranularity, and
+    // bHugePages reports whether huge pages were requested successfully.
+    // Returns NULL on failure.
+    void* Reserve( size_t& nBytes, unsigned nFlags, size_t& nGranularity, bool& bHugePages );
+
+    // Makes a reserved range readable and writable. Returns false on failure.
+    bool Commit( void* pAddress, size_t nBytes );
+
+    // Releases a whole reservation.
+    void Release( void* pAddress, size_t nBytes );
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_VIRTUAL_MEMORY_H_ )
@@ -0,0 +1,65 @@
+#include <stddef.h>
+
+#include "WeakHandle.h"
+
+jl::WeakHandleTable* jl::WeakHandleTable::s_pCommonTable = NULL;
+
+jl::WeakHandleTable::WeakHandleTable()
+{
+    m_pSlots = NULL;
+    m_nSlotCount = 0;
+    m_nFreeHead = eNoSlot;
+    m_nHandles = 0;
+}
+
+void jl::WeakHandleTable::Init( Slot* pSlots, unsigned nSlotCount )
+{
+    JL_ASSERT( pSlots || nSlotCount == 0 );
+
+    m_pSlots = pSlots;
+    m_nSlotCount = nSlotCount;
+    m_nFreeHead = nSlotCount > 0 ? 0 : unsigned(eNoSlot);
+    m_nHandles = 0;
+
+    for ( unsigned i = 0; i < nSlotCount; ++i )
+    {
+        m_pSlots[i].nGeneration = 0;
+        m_pSlots[i].nNextFree = i + 1 < nSlotCount ? i + 1 : eNoSlot;
+    }
+}
+
+jl::WeakHandle jl::WeakHandleTable::Acquire()
+{
+    WeakHandle hHandle = { NULL, 0 };
+
+    if ( m_nFreeHead == eNoSlot )
+    {
+        return hHandle;
+    }
+
+    Slot& oSlot = m_pSlots[ m_nFreeHead ];
+    m_nFreeHead = oSlot.nNextFree;
+    m_nHandles += 1;
+
+    hHandle.pGeneration = & oSlot.nGeneration;
+    hHandle.nGeneration = oSlot.nGeneration;
+    return hHandle;
+}
+
+void jl::WeakHandleTable::Release( const WeakHandle& hHandle )
+{
+    // The generation is the slot's first member
+    Slot* pSlot = reinterpret_cast<Slot*>( const_cast<unsigned*>(hHandle.pGeneration) );
+    JL_ASSERT( pSlot >= m_pSlots && pSlot < m_pSlots + m_nSlotCount );
+    JL_ASSERT( hHandle.IsAlive() );
+
+    if ( ! hHandle.IsAlive() )
+    {
+        return;
+    }
+
+    pSlot->nGeneration += 1;
+    pSlot->nNextFree = m_nFreeHead;
+    m_nFreeHead = (unsigned)( pSlot - m_pSlots );
+    m_nHandles -= 1;
+}
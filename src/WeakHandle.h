@@ -0,0 +1,127 @@
+#ifndef _JL_WEAK_HANDLE_H_
+#define _JL_WEAK_HANDLE_H_
+
+#include <stddef.h>
+
+#include "Utils.h"
+
+namespace jl {
+
+/**
+ * A weak reference to an object's lifetime: IsAlive() is true until the slot
+ * the handle was taken from is released. Handles are plain values that can be
+ * copied anywhere, e.g. into signal connections. Checking one reads a single
+ * counter in the WeakHandleTable, which must outlive every copy.
+ */
+struct WeakHandle
+{
+    const unsigned* pGeneration; // NULL for a handle that was never acquired
+    unsigned nGeneration;
+
+    bool IsValid() const { return pGeneration != NULL; }
+    bool IsAlive() const { return *pGeneration == nGeneration; }
+};
+
+/**
+ * Hands out WeakHandles from a caller-provided array of slots. Releasing a
+ * handle bumps its slot's generation, which kills every copy of the handle, and
+ * makes the slot available again. A slot would have to be reused 2^32 times
+ * before a stale handle could look alive again.
+ */
+class WeakHandleTable
+{
+public:
+    enum { eNoSlot = 0xFFFFFFFF };
+
+    struct Slot
+    {
+        unsigned nGeneration;
+        unsigned nNextFree;
+    };
+
+    WeakHandleTable();
+    WeakHandleTable( Slot* pSlots, unsigned nSlotCount ) { Init( pSlots, nSlotCount ); }
+
+    void Init( Slot* pSlots, unsigned nSlotCount );
+
+    // Returns an invalid handle if every slot is in use.
+    WeakHandle Acquire();
+    void Release( const WeakHandle& hHandle );
+
+    unsigned CountHandles() const { return m_nHandles; }
+    unsigned GetSlotCount() const { return m_nSlotCount; }
+
+    // Table for WeakHandleOwners that are default-constructed
+    static void SetCommonTable( WeakHandleTable* pTable ) { s_pCommonTable = pTable; }
+    static WeakHandleTable* GetCommonTable() { return s_pCommonTable; }
+
+private:
+    Slot* m_pSlots;
+    unsigned m_nSlotCount;
+    unsigned m_nFreeHead;
+    unsigned m_nHandles;
+
+    static WeakHandleTable* s_pCommonTable;
+};
+
+// A WeakHandleTable with _SlotCount built-in slots
+template< unsigned _SlotCount >
+class StaticWeakHandleTable : public WeakHandleTable
+{
+public:
+    StaticWeakHandleTable() { Init( m_pSlots, _SlotCount ); }
+
+private:
+    Slot m_pSlots[ _SlotCount ];
+};
+
+/**
+ * Holds a handle for as long as it lives. Make one a member of an object, and
+ * the handle dies with the object:
+ *
+ *   class Enemy
+ *   {
+ *   public:
+ *       void OnExplosion( float fDamage );
+ *       jl::WeakHandleOwner m_oLifetime;
+ *   };
+ *
+ *   oExplosionSignal.ConnectWeak( pEnemy->m_oLifetime.GetHandle(), pEnemy, &Enemy::OnExplosion );
+ */
+class WeakHandleOwner
+{
+public:
+    WeakHandleOwner() { Acquire( WeakHandleTable::GetCommonTable() ); }
+    explicit WeakHandleOwner( WeakHandleTable* pTable ) { Acquire( pTable ); }
+
+    ~WeakHandleOwner()
+    {
+        if ( m_hHandle.IsValid() )
+        {
+            m_pTable->Release( m_hHandle );
+        }
+    }
+
+    // Invalid if the table was full
+    const WeakHandle& GetHandle() const { return m_hHandle; }
+
+private:
+    void Acquire( WeakHandleTable* pTable )
+    {
+        JL_ASSERT( pTable );
+        m_pTable = pTable;
+        m_hHandle = pTable->Acquire();
+        JL_ASSERT( m_hHandle.IsValid() );
+    }
+
+    // A copy would release the handle twice
+    WeakHandleOwner( const WeakHandleOwner& );
+    WeakHandleOwner& operator=( const WeakHandleOwner& );
+
+    WeakHandleTable* m_pTable;
+    WeakHandle m_hHandle;
+};
+
+} // namespace jl
+
+#endif // ! defined( _JL_WEAK_HANDLE_H_ )
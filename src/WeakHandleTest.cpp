@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <assert.h>
+
+#include "WeakHandle.h"
+
+using namespace jl;
+
+void WeakHandleTest()
+{
+    printf( "Testing weak handles...\n" );
+
+    enum { eSlotCount = 4 };
+    StaticWeakHandleTable< eSlotCount > oTable;
+    WeakHandle pHandles[ eSlotCount ];
+
+    for ( unsigned i = 0; i < eSlotCount; ++i )
+    {
+        pHandles[i] = oTable.Acquire();
+        assert( pHandles[i].IsValid() && pHandles[i].IsAlive() );
+    }
+
+    assert( oTable.CountHandles() == eSlotCount );
+    assert( ! oTable.Acquire().IsValid() );
+
+    // Releasing kills every copy of a handle, and nothing else
+    const WeakHandle hCopy = pHandles[1];
+    oTable.Release( pHandles[1] );
+    assert( ! hCopy.IsAlive() && ! pHandles[1].IsAlive() );
+    assert( pHandles[0].IsAlive() && pHandles[2].IsAlive() && pHandles[3].IsAlive() );
+
+    // A reused slot doesn't bring old handles back
+    const WeakHandle hReused = oTable.Acquire();
+    assert( hReused.pGeneration == hCopy.pGeneration );
+    assert( hReused.IsAlive() && ! hCopy.IsAlive() );
+
+    // Owners release their handle when destroyed
+    oTable.Release( hReused );
+    WeakHandle hOwned;
+    {
+        WeakHandleOwner oOwner( & oTable );
+        hOwned = oOwner.GetHandle();
+        assert( hOwned.IsAlive() && oTable.CountHandles() == eSlotCount );
+    }
+
+    assert( ! hOwned.IsAlive() && oTable.CountHandles() == eSlotCount - 1 );
+
+    // Owners can use the common table
+    WeakHandleTable::SetCommonTable( & oTable );
+    {
+        WeakHandleOwner oOwner;
+        assert( oOwner.GetHandle().IsAlive() );
+    }
+    WeakHandleTable::SetCommonTable( NULL );
+
+    oTable.Release( pHandles[0] );
+    oTable.Release( pHandles[2] );
+    oTable.Release( pHandles[3] );
+    assert( oTable.CountHandles() == 0 );
+}
@@ -0,0 +1,203 @@
+#include "WorkStealingTaskScheduler.h"
+
+#if JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+
+#include "Utils.h"
+
+using namespace jl;
+
+namespace
+{
+    // Set while a thread is running tasks, so nested Run() calls can run inline
+    thread_local bool t_bRunningTasks = false;
+    
+    inline unsigned long long PackRange( unsigned nBegin, unsigned nEnd )
+    {
+        return ( (unsigned long long)nBegin << 32 ) | nEnd;
+    }
+    
+    inline unsigned RangeBegin( unsigned long long nRange ) { return (unsigned)( nRange >> 32 ); }
+    inline unsigned RangeEnd( unsigned long long nRange ) { return (unsigned)( nRange & 0xffffffffu ); }
+}
+
+jl::WorkStealingTaskScheduler::WorkStealingTaskScheduler( unsigned nWorkerThreads /*= 0*/ )
+{
+    if ( nWorkerThreads == 0 )
+    {
+        const unsigned nHardwareThreads = std::thread::hardware_concurrency();
+        nWorkerThreads = nHardwareThreads > 1 ? nHardwareThreads - 1 : 0;
+    }
+    
+    m_nSlots = nWorkerThreads + 1;
+    m_pRanges = new TaskRange[ m_nSlots ];
+    
+    for ( unsigned i = 0; i < m_nSlots; ++i )
+    {
+        m_pRanges[i].oRange.store( PackRange(0, 0) );
+    }
+    
+    m_fpTask = NULL;
+    m_pContext = NULL;
+    m_nGeneration = 0;
+    m_bQuit = false;
+    m_nBusyWorkers.store( 0 );
+    
+    m_oWorkers.reserve( nWorkerThreads );
+    for ( unsigned i = 0; i < nWorkerThreads; ++i )
+    {
+        m_oWorkers.push_back( std::thread(& WorkStealingTaskScheduler::WorkerMain, this, i) );
+    }
+}
+
+jl::WorkStealingTaskScheduler::~WorkStealingTaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> oLock( m_oWakeMutex );
+        m_bQuit = true;
+    }
+    
+    m_oWake.notify_all();
+    
+    for ( size_t i = 0; i < m_oWorkers.size(); ++i )
+    {
+        m_oWorkers[i].join();
+    }
+    
+    delete[] m_pRanges;
+}
+
+void jl::WorkStealingTaskScheduler::Run( TaskFunction fpTask, void* pContext, unsigned nTasks )
+{
+    if ( nTasks == 0 )
+    {
+        return;
+    }
+    
+    // Small batches, nested batches and single-threaded pools run inline
+    if ( nTasks == 1 || m_oWorkers.empty() || t_bRunningTasks )
+    {
+        for ( unsigned i = 0; i < nTasks; ++i )
+        {
+            fpTask( pContext, i );
+        }
+        
+        return;
+    }
+    
+    std::lock_guard<std::mutex> oRunLock( m_oRunMutex );
+    
+    // Deal out the tasks evenly. The caller's slot is the last one.
+    for ( unsigned i = 0; i < m_nSlots; ++i )
+    {
+        const unsigned nBegin = (unsigned)( (unsigned long long)nTasks * i / m_nSlots );
+        const unsigned nEnd = (unsigned)( (unsigned long long)nTasks * (i + 1) / m_nSlots );
+        m_pRanges[i].oRange.store( PackRange(nBegin, nEnd), std::memory_order_relaxed );
+    }
+    
+    m_fpTask = fpTask;
+    m_pContext = pContext;
+    m_nBusyWorkers.store( (unsigned)m_oWorkers.size(), std::memory_order_relaxed );
+    
+    {
+        std::lock_guard<std::mutex> oLock( m_oWakeMutex );
+        ++m_nGeneration;
+    }
+    
+    m_oWake.notify_all();
+    
+    RunTasks( m_nSlots - 1 );
+    
+    // Wait until every worker has seen this batch through, so that no
+    // straggler can pick up tasks from the next one with stale state.
+    while ( m_nBusyWorkers.load(std::memory_order_acquire) != 0 )
+    {
+        std::this_thread::yield();
+    }
+}
+
+void jl::WorkStealingTaskScheduler::WorkerMain( unsigned nSlot )
+{
+    unsigned nSeenGeneration = 0;
+    
+    for ( ;; )
+    {
+        {
+            std::unique_lock<std::mutex> oLock( m_oWakeMutex );
+            
+            while ( ! m_bQuit && m_nGeneration == nSeenGeneration )
+            {
+                m_oWake.wait( oLock );
+            }
+            
+            if ( m_bQuit )
+            {
+                return;
+            }
+            
+            nSeenGeneration = m_nGeneration;
+        }
+        
+        RunTasks( nSlot );
+        m_nBusyWorkers.fetch_sub( 1, std::memory_order_acq_rel );
+    }
+}
+
+void jl::WorkStealingTaskScheduler::RunTasks( unsigned nSlot )
+{
+    t_bRunningTasks = true;
+    
+    unsigned nTask;
+    while ( PopTask(nSlot, nTask) || StealTask(nSlot, nTask) )
+    {
+        m_fpTask( m_pContext, nTask );
+    }
+    
+    t_bRunningTasks = false;
+}
+
+bool jl::WorkStealingTaskScheduler::PopTask( unsigned nSlot, unsigned& nTask )
+{
+    std::atomic<unsigned long long>& oRange = m_pRanges[nSlot].oRange;
+    unsigned long long nRange = oRange.load( std::memory_order_acquire );
+    
+    while ( RangeBegin(nRange) < RangeEnd(nRange) )
+    {
+        if ( oRange.compare_exchange_weak(nRange, PackRange(RangeBegin(nRange) + 1, RangeEnd(nRange)), std::memory_order_acq_rel) )
+        {
+            nTask = RangeBegin( nRange );
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool jl::WorkStealingTaskScheduler::StealTask( unsigned nSlot, unsigned& nTask )
+{
+    for ( unsigned nOffset = 1; nOffset < m_nSlots; ++nOffset )
+    {
+        std::atomic<unsigned long long>& oVictim = m_pRanges[ (nSlot + nOffset) % m_nSlots ].oRange;
+        unsigned long long nRange = oVictim.load( std::memory_order_acquire );
+        
+        while ( RangeBegin(nRange) < RangeEnd(nRange) )
+        {
+            // Take the back half, rounding up so that a single task can be stolen
+            const unsigned nBegin = RangeBegin( nRange );
+            const unsigned nEnd = RangeEnd( nRange );
+            const unsigned nSplit = nBegin + ( nEnd - nBegin ) / 2;
+            
+            if ( oVictim.compare_exchange_weak(nRange, PackRange(nBegin, nSplit), std::memory_order_acq_rel) )
+            {
+                // Our own range is empty, and nobody steals from an empty
+                // range, so a plain store is safe here.
+                m_pRanges[nSlot].oRange.store( PackRange(nSplit + 1, nEnd), std::memory_order_release );
+                nTask = nSplit;
+                return true;
+            }
+        }
+    }
+    
+    return false;
+}
+
+#endif // JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
@@ -0,0 +1,86 @@
+#ifndef _JL_WORK_STEALING_TASK_SCHEDULER_H_
+#define _JL_WORK_STEALING_TASK_SCHEDULER_H_
+
+#include "TaskScheduler.h"
+
+// The thread pool requires C++11 threads and atomics. Define
+// JL_ENABLE_WORK_STEALING_TASK_SCHEDULER to 0 to disable it explicitly.
+#ifndef JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+#if __cplusplus >= 201103L || ( defined( _MSC_VER ) && _MSC_VER >= 1900 )
+#define JL_ENABLE_WORK_STEALING_TASK_SCHEDULER 1
+#else
+#define JL_ENABLE_WORK_STEALING_TASK_SCHEDULER 0
+#endif
+#endif
+
+#if JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jl {
+
+/**
+ * A fixed-size thread pool. Each Run() splits the task range evenly between
+ * the workers and the calling thread, which all take tasks from the front of
+ * their own range. A thread that runs out of tasks steals the back half of
+ * another thread's remaining range, so uneven task costs still balance out.
+ *
+ * Ranges are packed into one 64-bit atomic per thread, so taking and stealing
+ * tasks are single compare-and-swap operations. Run() calls from multiple
+ * threads are serialized, and a Run() from inside a task runs its tasks inline
+ * on the calling thread.
+ */
+class WorkStealingTaskScheduler : public TaskScheduler
+{
+public:
+    // If nWorkerThreads is zero, one worker is started for each hardware
+    // thread, minus one for the thread that calls Run().
+    explicit WorkStealingTaskScheduler( unsigned nWorkerThreads = 0 );
+    ~WorkStealingTaskScheduler();
+    
+    // Threads that run tasks, including the calling thread.
+    unsigned CountThreads() const { return (unsigned)m_oWorkers.size() + 1; }
+    
+    void Run( TaskFunction fpTask, void* pContext, unsigned nTasks );
+    
+private:
+    WorkStealingTaskScheduler( const WorkStealingTaskScheduler& );
+    WorkStealingTaskScheduler& operator=( const WorkStealingTaskScheduler& );
+    
+    // One slot per thread, padded to avoid false sharing between neighbors.
+    struct TaskRange
+    {
+        std::atomic<unsigned long long> oRange; // begin in the high 32 bits, end in the low 32 bits
+        char pPadding[ 64 - sizeof(std::atomic<unsigned long long>) ];
+    };
+    
+    void WorkerMain( unsigned nSlot );
+    void RunTasks( unsigned nSlot );
+    bool PopTask( unsigned nSlot, unsigned& nTask );
+    bool StealTask( unsigned nSlot, unsigned& nTask );
+    
+    std::vector<std::thread> m_oWorkers;
+    TaskRange* m_pRanges;
+    unsigned m_nSlots;
+    
+    // Current batch. Written by Run() before it bumps the generation.
+    TaskFunction m_fpTask;
+    void* m_pContext;
+    
+    std::mutex m_oRunMutex;
+    std::mutex m_oWakeMutex;
+    std::condition_variable m_oWake;
+    unsigned m_nGeneration;
+    bool m_bQuit;
+    std::atomic<unsigned> m_nBusyWorkers;
+};
+
+} // namespace jl
+
+#endif // JL_ENABLE_WORK_STEALING_TASK_SCHEDULER
+
+#endif // ! defined( _JL_WORK_STEALING_TASK_SCHEDULER_H_ )
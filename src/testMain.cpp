@@ -1,10 +1,24 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 extern void ObjectPoolTest();
 extern void DoublyLinkedListTest();
+extern void IntrusiveDoublyLinkedListTest();
+extern void HashIndexTest();
 extern void SignalTest();
+extern void SignalCoroutineTest();
+extern void TaskSchedulerTest();
+extern void ShardedSignalTest();
+extern void CoalescingSignalTest();
+extern void RateLimitedSignalTest();
+extern void ArenaScopedAllocatorTest();
+extern void SizeClassPoolTest();
+extern void WeakHandleTest();
+extern void DynamicSignalTest();
+extern void SignalLogTest();
+extern void SignalBenchmark();
 
 int main(int argc, char** argv)
 {
@@ -12,7 +26,24 @@ int main(int argc, char** argv)
     
     ObjectPoolTest();
     DoublyLinkedListTest();
+    IntrusiveDoublyLinkedListTest();
+    HashIndexTest();
     SignalTest();
+    SignalCoroutineTest();
+    TaskSchedulerTest();
+    ShardedSignalTest();
+    CoalescingSignalTest();
+    RateLimitedSignalTest();
+    ArenaScopedAllocatorTest();
+    SizeClassPoolTest();
+    WeakHandleTest();
+    DynamicSignalTest();
+    SignalLogTest();
+
+    if ( argc > 1 && strcmp(argv[1], "-benchmark") == 0 )
+    {
+        SignalBenchmark();
+    }
     
     printf("\nDone! Press enter to continue...\n");
     getchar();    
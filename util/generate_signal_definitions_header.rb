@@ -12,6 +12,7 @@ signal_classes = (0..8).map do |arg_count|
         template_signature: 'typename _NoParam = void',
         arg_type_list: 'void',
         arg_signature: 'void',
+        param_signature: 'void',
         arg_list: '',
       }
     else
@@ -19,6 +20,7 @@ signal_classes = (0..8).map do |arg_count|
         template_signature: (1..arg_count).map{ |i| "typename _P#{i}" }.join(', '),
         arg_type_list: (1..arg_count).map{ |i| "_P#{i}" }.join(', '),
         arg_signature: (1..arg_count).map{ |i| "_P#{i} p#{i}" }.join(', '),
+        param_signature: (1..arg_count).map{ |i| "typename fastdelegate::ParamTraits< _P#{i} >::type p#{i}" }.join(', '),
         arg_list: (1..arg_count).map{ |i| "p#{i}" }.join(', '),
       }
     end